@@ -0,0 +1,64 @@
+#ifndef ANIM_CLOCK_H
+#define ANIM_CLOCK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Animation clock shared by the ESP-NOW master and its slaves.
+// The master's esp_timer is the reference; a slave estimates the offset and skew
+// of its own clock from NTP-style exchanges and follows the master's time.
+// Once synchronized the clock never goes backwards: it jumps ahead when it is late and
+// slows down when it is early. Only a restart of the master's clock moves it back.
+#define ANIM_CLOCK_FILTER_SAMPLES 4 // Exchanges kept by the min-delay filter
+#define ANIM_CLOCK_SKEW_POINTS 16   // Filtered offsets used for the skew fit
+
+/**
+ * @brief Synchronization state (for the web API)
+ */
+typedef struct {
+  bool reference;    // This device is the time reference (master)
+  bool synced;       // Offset estimated (always true for the reference)
+  int64_t offset_us; // Master time - local time, now
+  float skew_ppm;    // Master clock rate relative to the local one
+  uint32_t delay_us; // Round trip of the last filtered exchange
+  uint32_t samples;  // Exchanges accepted
+  uint32_t steps;    // Corrections applied as a jump (first sync, late, master restart)
+} anim_clock_status_t;
+
+/**
+ * @brief Make the local clock the reference (master) or follow a master (slave)
+ */
+void anim_clock_set_reference(bool reference);
+
+/**
+ * @brief Current animation time in microseconds (master timebase)
+ */
+int64_t anim_clock_now_us(void);
+
+/**
+ * @brief Current animation time in milliseconds (wraps after 49 days)
+ */
+uint32_t anim_clock_now_ms(void);
+
+/**
+ * @brief Add one request/response exchange (slave)
+ *
+ * @param t1 Local time the request was sent
+ * @param t2 Master time the request was received
+ * @param t3 Master time the response was sent
+ * @param t4 Local time the response was received
+ */
+void anim_clock_add_sample(int64_t t1, int64_t t2, int64_t t3, int64_t t4);
+
+bool anim_clock_is_synced(void);
+void anim_clock_get_status(anim_clock_status_t *status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ANIM_CLOCK_H
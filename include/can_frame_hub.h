@@ -0,0 +1,114 @@
+#ifndef CAN_FRAME_HUB_H
+#define CAN_FRAME_HUB_H
+
+#include "driver/twai.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Shared frame log: every received frame is written once, consumers read it at their own pace
+#define CAN_HUB_RING_SIZE 1024 // Frames (~500 ms at 2000 fps), must be a power of two
+#define CAN_HUB_MAX_CONSUMERS 12
+
+/**
+ * @brief Raw CAN frame as stored in the shared ring
+ */
+typedef struct {
+  uint32_t timestamp_us; // esp_timer time of reception (low 32 bits)
+  uint32_t id;           // 11-bit or 29-bit identifier
+  uint8_t bus;           // can_bus_type_t
+  uint8_t dlc;           // 0-8
+  uint8_t extended;      // 1 for 29-bit identifiers
+  uint8_t data[8];
+} can_hub_frame_t;
+
+typedef struct can_hub_consumer can_hub_consumer_t;
+
+/**
+ * @brief Per-consumer counters
+ */
+typedef struct {
+  const char *name;
+  bool enabled;
+  uint32_t backlog;     // Frames published but not read yet
+  uint32_t frames_read; // Frames read since the consumer was (re)enabled
+  uint32_t frames_lost; // Frames overwritten before the consumer read them
+} can_hub_consumer_stats_t;
+
+/**
+ * @brief Publish a received frame (called by the CAN RX tasks)
+ *
+ * Copies the frame once into the shared ring and wakes consumers whose backlog
+ * reaches their notification threshold. Never blocks.
+ */
+void can_hub_publish(int bus, const twai_message_t *msg);
+
+/**
+ * @brief Register a consumer
+ *
+ * The consumer starts at the current head of the ring (it only sees frames
+ * published after registration) and is enabled.
+ *
+ * @param name Name used in statistics (static string)
+ * @param notify_task Address of the handle of the task woken with xTaskNotifyGive
+ *                    when the backlog reaches notify_threshold. The handle may be
+ *                    NULL while that task is not running (NULL pointer: poll only)
+ * @param notify_threshold Backlog that triggers the notification (1 = wake on
+ *                         the first frame after the consumer caught up)
+ * @return Consumer handle, NULL if every consumer slot is used
+ */
+can_hub_consumer_t *can_hub_register(const char *name, TaskHandle_t *notify_task, uint32_t notify_threshold);
+
+/**
+ * @brief Enable or pause a consumer
+ *
+ * Enabling moves the read cursor to the current head and resets the counters,
+ * so a reused consumer (e.g. a new client in the same slot) never sees old frames.
+ */
+void can_hub_set_enabled(can_hub_consumer_t *consumer, bool enabled);
+
+/**
+ * @brief Read the next frames of a consumer
+ *
+ * Frames overwritten before being read (consumer too slow) are skipped and
+ * counted as lost for this consumer only.
+ *
+ * @param consumer Consumer handle (must only be read from one task)
+ * @param out Destination array
+ * @param max Capacity of out
+ * @param lost Optional: receives the number of frames lost since the previous read
+ * @return Number of frames copied to out
+ */
+int can_hub_read(can_hub_consumer_t *consumer, can_hub_frame_t *out, int max, uint32_t *lost);
+
+/**
+ * @brief Number of frames waiting for a consumer (capped at CAN_HUB_RING_SIZE)
+ */
+uint32_t can_hub_backlog(const can_hub_consumer_t *consumer);
+
+/**
+ * @brief Get counters of a consumer slot
+ *
+ * @param index Slot index (0 to CAN_HUB_MAX_CONSUMERS-1)
+ * @param out Destination
+ * @return ESP_OK, ESP_ERR_NOT_FOUND for an unused slot, ESP_ERR_INVALID_ARG if index is out of range
+ */
+esp_err_t can_hub_get_consumer_stats(int index, can_hub_consumer_stats_t *out);
+
+/**
+ * @brief Total number of frames published since boot
+ */
+uint32_t can_hub_get_published_count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAN_FRAME_HUB_H
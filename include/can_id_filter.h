@@ -0,0 +1,110 @@
+#ifndef CAN_ID_FILTER_H
+#define CAN_ID_FILTER_H
+
+#include "esp_err.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CAN_ID_FILTER_MAX_RULES 16
+#define CAN_ID_FILTER_STD_ID_COUNT 2048 // 11-bit identifiers
+#define CAN_ID_FILTER_STD_WORDS (CAN_ID_FILTER_STD_ID_COUNT / 32)
+
+/**
+ * @brief ID/mask acceptance rule
+ *
+ * A frame matches when (frame_id & mask) == (id & mask) and the frame format
+ * (standard/extended) is the same as the rule's.
+ */
+typedef struct {
+  uint32_t id;   // 11-bit or 29-bit identifier
+  uint32_t mask; // Identifier bits that must match (0 = any identifier)
+  bool extended; // Rule applies to 29-bit frames
+} can_id_filter_rule_t;
+
+/**
+ * @brief Per-client CAN ID filter
+ *
+ * Rules are expanded into a 2048-bit bitmap for standard identifiers so each
+ * frame costs a single bit test. Extended frames (unused on Tesla buses) are
+ * checked against the rule list. Without rules every frame passes.
+ *
+ * Filters are evaluated by each client's reader as it drains the frame hub.
+ * Updates are not atomic with respect to that reader: frames read while a filter
+ * is being rewritten may be evaluated against a mix of old and new rules.
+ */
+typedef struct {
+  uint32_t std_bitmap[CAN_ID_FILTER_STD_WORDS];
+  can_id_filter_rule_t rules[CAN_ID_FILTER_MAX_RULES];
+  uint8_t rule_count;
+} can_id_filter_t;
+
+/**
+ * @brief Snapshot of a streaming client and its filter rules (for the web API)
+ */
+typedef struct {
+  bool active;
+  char ip[16];
+  uint16_t port;
+  uint8_t rule_count;
+  can_id_filter_rule_t rules[CAN_ID_FILTER_MAX_RULES];
+} can_id_filter_client_info_t;
+
+/**
+ * @brief Remove all rules (every frame passes)
+ */
+void can_id_filter_clear(can_id_filter_t *filter);
+
+/**
+ * @brief Replace all rules at once
+ *
+ * @param rules Rule array (may be NULL when count is 0)
+ * @param count Number of rules, 0 to accept everything
+ * @return ESP_OK, ESP_ERR_INVALID_SIZE if count exceeds CAN_ID_FILTER_MAX_RULES
+ */
+esp_err_t can_id_filter_set(can_id_filter_t *filter, const can_id_filter_rule_t *rules, int count);
+
+/**
+ * @brief Add one rule (the first rule turns the filter into a whitelist)
+ *
+ * @return ESP_OK, ESP_ERR_NO_MEM if the rule table is full
+ */
+esp_err_t can_id_filter_add(can_id_filter_t *filter, const can_id_filter_rule_t *rule);
+
+/**
+ * @brief Remove a rule previously added with the same id, mask and format
+ *
+ * @return ESP_OK, ESP_ERR_NOT_FOUND if no such rule exists
+ */
+esp_err_t can_id_filter_remove(can_id_filter_t *filter, const can_id_filter_rule_t *rule);
+
+/**
+ * @brief Test a frame identifier against a filter (called before encoding each frame)
+ */
+static inline bool can_id_filter_match(const can_id_filter_t *filter, uint32_t identifier, bool extended) {
+  if (!extended) {
+    uint32_t id = identifier & (CAN_ID_FILTER_STD_ID_COUNT - 1);
+    return (filter->std_bitmap[id >> 5] >> (id & 31)) & 1;
+  }
+
+  if (filter->rule_count == 0) {
+    return true;
+  }
+  for (int i = 0; i < filter->rule_count; i++) {
+    const can_id_filter_rule_t *rule = &filter->rules[i];
+    if (rule->extended && ((identifier ^ rule->id) & rule->mask) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAN_ID_FILTER_H
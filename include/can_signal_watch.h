@@ -0,0 +1,129 @@
+#ifndef CAN_SIGNAL_WATCH_H
+#define CAN_SIGNAL_WATCH_H
+
+#include "esp_err.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Live watch of individual DBC signals (mapping/debugging without SavvyCAN)
+#define CAN_WATCH_MAX_SIGNALS 16
+#define CAN_WATCH_NAME_MAX 48
+#define CAN_WATCH_MAX_SINKS 2
+#define CAN_WATCH_BATCH_MAX 32 // Updates delivered to the sinks in one call
+
+/**
+ * @brief Decimation applied before a value is sent
+ */
+typedef enum {
+  CAN_WATCH_MODE_CHANGE = 0, // Value differs from the last sent one by more than deadband (at most every interval_ms)
+  CAN_WATCH_MODE_RATE   = 1, // Latest value every interval_ms, if a new one was decoded
+  CAN_WATCH_MODE_MINMAX = 2, // Min and max over each window of interval_ms
+} can_watch_mode_t;
+
+typedef enum {
+  CAN_WATCH_KIND_VALUE = 0,
+  CAN_WATCH_KIND_MIN   = 1,
+  CAN_WATCH_KIND_MAX   = 2,
+} can_watch_kind_t;
+
+/**
+ * @brief Compact value update (also the BLE wire format, 10 bytes)
+ */
+typedef struct __attribute__((packed)) {
+  uint8_t watch_id;      // Identifier returned by can_signal_watch_add
+  uint8_t kind;          // can_watch_kind_t
+  uint32_t timestamp_ms; // Reception time of the frame (window end for min/max)
+  float value;
+} can_watch_update_t;
+
+/**
+ * @brief Subscription request
+ */
+typedef struct {
+  char name[CAN_WATCH_NAME_MAX]; // "Signal" or "Message.Signal"
+  can_watch_mode_t mode;
+  uint16_t interval_ms; // Minimum interval (CHANGE), period (RATE) or window (MINMAX)
+  float deadband;       // CHANGE only
+} can_watch_request_t;
+
+/**
+ * @brief State of a subscription (for the web API)
+ */
+typedef struct {
+  uint8_t watch_id;
+  can_watch_request_t request;
+  uint32_t can_id;
+  uint8_t bus;      // Bus of the last decoded frame
+  bool has_value;   // At least one value decoded
+  float last_value; // Last decoded value (not necessarily sent)
+  uint32_t decoded; // Values decoded since the subscription
+  uint32_t sent;    // Updates sent
+} can_watch_info_t;
+
+/**
+ * @brief Global counters
+ */
+typedef struct {
+  uint8_t watch_count;
+  uint32_t frames_matched; // Frames of a watched message
+  uint32_t values_decoded; // Signal values decoded
+  uint32_t updates_sent;   // Updates delivered to the sinks
+  uint32_t frames_lost;    // Hub frames overwritten before being read
+} can_watch_stats_t;
+
+/**
+ * @brief Receives batches of updates (called from the watch task)
+ */
+typedef void (*can_watch_sink_t)(const can_watch_update_t *updates, int count);
+
+/**
+ * @brief Register an output (SSE stream, BLE characteristic...)
+ *
+ * @return ESP_OK, ESP_ERR_NO_MEM if CAN_WATCH_MAX_SINKS are already registered
+ */
+esp_err_t can_signal_watch_add_sink(can_watch_sink_t sink);
+
+/**
+ * @brief Subscribe to a signal
+ *
+ * The name is resolved once; decoding only runs while at least one
+ * subscription exists.
+ *
+ * @param request Signal name and decimation
+ * @param watch_id Receives the identifier used in updates
+ * @return ESP_OK, ESP_ERR_NOT_FOUND for an unknown signal, ESP_ERR_NO_MEM if the table is full
+ */
+esp_err_t can_signal_watch_add(const can_watch_request_t *request, uint8_t *watch_id);
+
+/**
+ * @brief Unsubscribe
+ *
+ * @return ESP_OK, ESP_ERR_NOT_FOUND if no such subscription exists
+ */
+esp_err_t can_signal_watch_remove(uint8_t watch_id);
+
+/**
+ * @brief Remove every subscription (decoding stops)
+ */
+void can_signal_watch_clear(void);
+
+/**
+ * @brief Get a subscription by table position
+ *
+ * @param index Position (0 to CAN_WATCH_MAX_SIGNALS-1)
+ * @return ESP_OK, ESP_ERR_NOT_FOUND for a free position
+ */
+esp_err_t can_signal_watch_get_info(int index, can_watch_info_t *info);
+
+void can_signal_watch_get_stats(can_watch_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAN_SIGNAL_WATCH_H
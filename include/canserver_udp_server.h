@@ -1,10 +1,11 @@
 #ifndef CANSERVER_UDP_SERVER_H
 #define CANSERVER_UDP_SERVER_H
 
-#include "driver/twai.h"
+#include "can_id_filter.h"
 #include "esp_err.h"
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -52,15 +53,45 @@ bool canserver_udp_server_is_running(void);
 int canserver_udp_server_get_client_count(void);
 
 /**
- * @brief Broadcast CAN frame to all connected CANServer clients
+ * @brief CANServer UDP batching statistics (cumulative since boot)
+ */
+typedef struct {
+  uint32_t frames_queued;     // Frames encoded into client packets
+  uint32_t frames_dropped;    // Frames a client lost because it fell behind the frame hub
+  uint32_t packets_sent;      // UDP datagrams successfully sent (all clients)
+  uint32_t send_errors;       // sendto() failures after retries
+  uint32_t batch_interval_ms; // Current adaptive batching interval
+} canserver_udp_stats_t;
+
+/**
+ * @brief Get CANServer UDP batching statistics
  *
- * Called from CAN RX task when a frame is received.
- * Encodes the frame in Panda binary format and sends to all active clients.
+ * @param out Destination structure
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if out is NULL
+ */
+esp_err_t canserver_udp_server_get_stats(canserver_udp_stats_t *out);
+
+/**
+ * @brief Replace the CAN ID filter of a registered client
+ *
+ * Clients can also manage their own filter with control packets (see
+ * canserver_udp_server.c for the format).
+ *
+ * @param slot Client slot (0-3)
+ * @param rules Rules to install (NULL/0 to stream every frame)
+ * @param count Number of rules
+ * @return ESP_OK, ESP_ERR_NOT_FOUND if the slot is not registered
+ */
+esp_err_t canserver_udp_server_set_client_filters(int slot, const can_id_filter_rule_t *rules, int count);
+
+/**
+ * @brief Get address and filter rules of a client slot
  *
- * @param bus Bus number (0 = BODY, 1 = CHASSIS)
- * @param msg Pointer to TWAI message structure
+ * @param slot Client slot (0-3)
+ * @param out Destination (out->active is false for a free slot)
+ * @return ESP_OK, ESP_ERR_INVALID_ARG if slot is out of range
  */
-void canserver_udp_broadcast_can_frame(int bus, const twai_message_t *msg);
+esp_err_t canserver_udp_server_get_client_filters(int slot, can_id_filter_client_info_t *out);
 
 /**
  * @brief Set autostart preference (saved to NVS)
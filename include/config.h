@@ -11,6 +11,8 @@
 #ifdef CONFIG_IDF_TARGET_ESP32C6
 // Configuration ESP32-C6
 #define LED_PIN 5
+// Strip outputs: one per RMT TX channel
+#define LED_OUTPUT_MAX 2
 
 // I2S pins for INMP441 microphone
 #define I2S_WS_PIN 20
@@ -28,6 +30,8 @@
 #else
 // Configuration ESP32-S3 (default)
 #define LED_PIN 5
+// Strip outputs: one per RMT TX channel
+#define LED_OUTPUT_MAX 4
 
 // I2S pins for INMP441 microphone
 #define I2S_WS_PIN 13
@@ -42,6 +46,16 @@
 
 #endif
 
+// GPIO for the status LED (integrated WS2812)
+#if CONFIG_IDF_TARGET_ESP32S3
+#define STATUS_LED_GPIO 21
+#elif CONFIG_IDF_TARGET_ESP32C6
+// Disabled on C6 to free RMT for the main LED strip
+#define STATUS_LED_GPIO 8 // No LED on other boards
+#else
+#define STATUS_LED_GPIO -1 // No LED on other boards
+#endif
+
 // Configuration WiFi
 #define WIFI_AP_SSID_BASE "CarLightSync"
 #define WIFI_AP_SSID "CarLightSync" // Will be replaced dynamically
@@ -68,9 +82,34 @@ void config_init_device_names(void);
 
 // Hardware LED configuration
 /**
- * Maximum number of LEDs supported by the system.
- * Limited to 200 to avoid memory issues on ESP32.
+ * Upper bound of the LED count setting.
+ * The buffers are allocated for the configured count (led_effects_set_led_count), so the
+ * real limits are free memory and frame time: a WS2812 takes 30 µs on the wire, about
+ * 660 LEDs per 20 ms frame.
+ */
+#define MAX_LED_COUNT 4096
+
+// Byte order of a pixel on the wire (WS2812B: GRB)
+typedef enum {
+  LED_COLOR_ORDER_GRB = 0,
+  LED_COLOR_ORDER_RGB,
+  LED_COLOR_ORDER_BRG,
+  LED_COLOR_ORDER_RBG,
+  LED_COLOR_ORDER_GBR,
+  LED_COLOR_ORDER_BGR,
+  LED_COLOR_ORDER_COUNT
+} led_color_order_t;
+
+/**
+ * Physical strip output: shows a span of the frame buffer on its own GPIO and RMT
+ * channel (led_effects_set_outputs). The first LED of the span is the last one on the
+ * wire, as for a single strip. Default: one output on LED_PIN for the whole buffer.
  */
-#define MAX_LED_COUNT 200
+typedef struct {
+  uint8_t gpio;
+  uint8_t color_order; // led_color_order_t
+  uint16_t start;      // First LED of the frame buffer
+  uint16_t count;      // 0: up to the end of the frame buffer
+} led_output_config_t;
 
 #endif // CONFIG_H
@@ -317,6 +317,15 @@ bool config_manager_set_event_enabled(uint16_t profile_id, can_event_type_t even
  */
 bool config_manager_process_can_event(can_event_type_t event);
 
+/**
+ * @brief Processes a CAN event that started at a given time
+ * @param event Event type
+ * @param start_ms Start time on the animation clock (anim_clock.h): a slave passes
+ *                 the master's time so timed events end together on every device
+ * @return true if an effect was applied
+ */
+bool config_manager_process_can_event_at(can_event_type_t event, uint32_t start_ms);
+
 /**
  * @brief Manually stops an active event
  * @param event Event type to stop
@@ -330,6 +339,16 @@ void config_manager_stop_all_events(void);
  */
 void config_manager_update(void);
 
+typedef struct {
+  uint32_t frames;          // Frames composed from active events
+  uint32_t layers_rendered; // Base and event layers rendered
+  uint32_t layers_occluded; // Event layers hidden by the ones above, not rendered
+  uint32_t base_occluded;   // Frames where the events hid the default effect
+  uint32_t split_frames;    // Frames whose layers rendered on both cores (render_worker)
+} config_manager_compositor_stats_t;
+
+void config_manager_get_compositor_stats(config_manager_compositor_stats_t *stats);
+
 /**
  * @brief Indicates if active events override the default effect
  * @return true if events are active
@@ -374,6 +393,19 @@ uint16_t config_manager_get_led_count(void);
  */
 bool config_manager_set_led_count(uint16_t led_count);
 
+/**
+ * @brief Gets the saved LED output table
+ * @param outputs Room for LED_OUTPUT_MAX outputs
+ * @return Number of outputs, 0 if none saved (default output on LED_PIN)
+ */
+uint8_t config_manager_get_led_outputs(led_output_config_t *outputs);
+
+/**
+ * @brief Saves the LED output table (apply it first with led_effects_set_outputs)
+ * @return true if successful and saved
+ */
+bool config_manager_set_led_outputs(const led_output_config_t *outputs, uint8_t count);
+
 /**
  * @brief Converts an event enum to alphanumeric ID
  * @param event Event type
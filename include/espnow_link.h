@@ -2,6 +2,8 @@
 #define ESPNOW_LINK_H
 
 #include "esp_err.h"
+#include "espnow_state_codec.h"
+#include "pixel_stream_codec.h"
 #include "vehicle_can_unified.h"
 
 #include <stdbool.h>
@@ -37,6 +39,59 @@ typedef struct {
 
 #define ESPNOW_MAX_PEERS 8
 
+// Master: per send class scheduling counters
+typedef struct {
+  uint32_t packets;          // Frames carrying a field of the class
+  uint32_t deliveries;       // Changes sent (latency samples)
+  uint64_t latency_total_us; // From the first scheduler pass that saw the change to its frame
+  uint32_t latency_max_us;
+} espnow_class_stats_t;
+
+// Vehicle state stream counters (master: sent, slave: received)
+typedef struct {
+  uint32_t packets;
+  uint32_t keyframes;
+  uint32_t bytes;             // Header included
+  uint32_t seq_gaps;          // Slave: lost packets detected
+  uint32_t keyframe_requests; // Slave: sent, master: received
+  uint32_t version_mismatch;  // Slave: packets of an unsupported wire version
+  uint8_t streams;            // Master: streams sent (one per distinct subscription)
+  uint32_t redundant;         // Master: frames sent only to repeat critical changes
+  espnow_class_stats_t classes[ESPNOW_CLASS_COUNT];
+} espnow_state_stats_t;
+
+// Pixel offload counters (master: sent, slave: received)
+typedef struct {
+  uint32_t frames;            // Master: sent, slave: complete frames displayed
+  uint32_t keyframes;         // Frames without delta chunks
+  uint32_t packets;           // Chunks
+  uint32_t bytes;             // Header included
+  uint32_t raw_bytes;         // Master: 3 bytes per LED of the frames sent
+  uint32_t encode_us;         // Master: time spent encoding
+  uint32_t dropped;           // Slave: chunks not applied (lost base frame, wrong length, malformed)
+  uint32_t keyframe_requests; // Slave: sent
+  uint32_t chunks[PIXEL_ENC_COUNT];
+} espnow_pixel_stats_t;
+
+// Reception: the WiFi callback queues packets, a worker task processes them
+typedef struct {
+  uint32_t packets;        // Processed by the worker
+  uint32_t dropped;        // Every receive slot in use
+  uint32_t oversize;       // Longer than an ESP-NOW payload
+  uint32_t queue_max;      // Most packets waiting at once
+  uint32_t latency_max_us; // Reception to start of processing
+  uint64_t latency_total_us;
+} espnow_rx_stats_t;
+
+// Master: slave whose strip is rendered here
+typedef struct {
+  uint8_t mac[6];
+  uint16_t led_count;
+} espnow_pixel_peer_t;
+
+// Pixel offload: frame period of the strips the master renders for slaves
+#define ESPNOW_PIXEL_FRAME_MS 40
+
 typedef void (*espnow_test_rx_cb_t)(void);
 typedef void (*espnow_vehicle_state_rx_cb_t)(const vehicle_state_t *state);
 
@@ -46,7 +101,29 @@ esp_err_t espnow_link_get_peers(espnow_peer_info_t *out_peers, size_t max_peers,
 esp_err_t espnow_link_send_test_frame(const uint8_t mac[6]); // if mac==NULL, send to all
 esp_err_t espnow_link_disconnect(void);                      // slave disconnect from master
 esp_err_t espnow_link_disconnect_peer(const uint8_t mac[6]); // master disconnect specific peer
-esp_err_t espnow_link_send_vehicle_state(const vehicle_state_t *state);
+// Master: run the send scheduler, to be called often (every loop of the CAN event task).
+// Each slave gets the changes of the fields it subscribed to during discovery; a frame
+// leaves once a changed field's send class is due and carries every pending change.
+// state_time_ms: animation clock time the state was captured (start time of the events it triggers).
+esp_err_t espnow_link_send_vehicle_state(const vehicle_state_t *state, uint32_t state_time_ms);
+// Slave: master animation time of the last state change received, false if unknown,
+// clock not synchronized or older than one second
+bool espnow_link_get_state_change_time_ms(uint32_t *time_ms);
+void espnow_link_get_state_stats(espnow_state_stats_t *out);
+// Master: slaves that asked for pixel offload
+size_t espnow_link_get_pixel_peers(espnow_pixel_peer_t *out, size_t max_peers);
+// Master: send a frame rendered for a slave (3 bytes per LED, RGB; led_count as subscribed)
+esp_err_t espnow_link_send_pixel_frame(const uint8_t mac[6], const uint8_t *rgb, uint16_t led_count);
+// Slave: let the master render this strip (led_count LEDs) and only display its frames
+esp_err_t espnow_link_set_pixel_offload(bool enable, uint16_t led_count);
+// Slave: offload enabled and frames arriving (false: render locally)
+bool espnow_link_pixel_offload_active(void);
+// Slave: copy the last complete frame, false if none since the previous call
+bool espnow_link_take_pixel_frame(uint8_t *rgb, uint16_t max_leds, uint16_t *led_count);
+void espnow_link_get_pixel_stats(espnow_pixel_stats_t *out);
+void espnow_link_get_rx_stats(espnow_rx_stats_t *out);
+// Master: stream and subscribed field count of a slave (ESP_ERR_NOT_FOUND: every field)
+esp_err_t espnow_link_get_peer_subscription(const uint8_t mac[6], uint8_t *stream, uint8_t *field_count);
 void espnow_link_register_vehicle_state_rx_callback(espnow_vehicle_state_rx_cb_t cb);
 espnow_role_t espnow_link_get_role(void);
 espnow_slave_type_t espnow_link_get_slave_type(void);
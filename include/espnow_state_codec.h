@@ -0,0 +1,177 @@
+#ifndef ESPNOW_STATE_CODEC_H
+#define ESPNOW_STATE_CODEC_H
+
+#include "esp_err.h"
+#include "vehicle_can_unified.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Wire encoding of vehicle_state_t for ESP-NOW.
+//
+// Each field has a stable ID (its position in the field table) and a fixed-point
+// wire encoding. A payload is:
+//   [group mask u16 LE][one presence byte per set group bit][values, ascending ID, LE]
+// Bit g of the group mask tells whether presence byte g (fields 8g..8g+7) is sent.
+// The table is append-only: a decoder stops at the first unknown ID, so older
+// firmware ignores fields added later and both sides can be updated separately.
+// The version only changes with an incompatible payload or packet header layout.
+#define ESPNOW_STATE_WIRE_VERSION 3
+#define ESPNOW_STATE_MAX_FIELDS 128
+#define ESPNOW_STATE_MASK_BYTES (ESPNOW_STATE_MAX_FIELDS / 8)
+#define ESPNOW_STATE_MAX_PAYLOAD 200 // Every field present
+
+/**
+ * @brief Send class of a field: how fast a change must reach the slaves
+ */
+typedef enum {
+  ESPNOW_CLASS_CRITICAL = 0, // Safety alerts, brake, turn signals: sent at once and repeated
+  ESPNOW_CLASS_EVENT,        // Other discrete states (doors, lights, gear...): sent at once
+  ESPNOW_CLASS_DYNAMIC,      // Driving dynamics (speed, pedal, power): 20 Hz at most
+  ESPNOW_CLASS_ENERGY,       // Slowly drifting values (SOC, voltages, odometer): 1 Hz at most
+  ESPNOW_CLASS_COUNT
+} espnow_state_class_t;
+
+/**
+ * @brief Set of field IDs
+ */
+typedef struct {
+  uint8_t bits[ESPNOW_STATE_MASK_BYTES];
+} espnow_state_mask_t;
+
+/**
+ * @brief Quantized state: one wire value per field ID
+ */
+typedef struct {
+  int32_t values[ESPNOW_STATE_MAX_FIELDS];
+} espnow_state_wire_t;
+
+/**
+ * @brief Number of fields known by this firmware
+ */
+uint8_t espnow_state_field_count(void);
+
+/**
+ * @brief Field name (for logs and the web API)
+ */
+const char *espnow_state_field_name(uint8_t field_id);
+
+/**
+ * @brief Field ID by name
+ *
+ * @return Field ID, -1 if unknown
+ */
+int espnow_state_field_id(const char *name);
+
+espnow_state_class_t espnow_state_field_class(uint8_t field_id);
+const char *espnow_state_class_name(espnow_state_class_t cls);
+
+/**
+ * @brief Fields of a send class
+ */
+void espnow_state_class_mask(espnow_state_class_t cls, espnow_state_mask_t *mask);
+
+/**
+ * @brief Set every field known by this firmware
+ */
+void espnow_state_mask_all(espnow_state_mask_t *mask);
+
+/**
+ * @brief Convert a state to wire values (floats rounded to their fixed-point step)
+ */
+void espnow_state_quantize(const vehicle_state_t *state, espnow_state_wire_t *wire);
+
+/**
+ * @brief Fields whose wire value differs between two quantized states
+ */
+void espnow_state_diff(const espnow_state_wire_t *a, const espnow_state_wire_t *b, espnow_state_mask_t *changed);
+
+/**
+ * @brief Encode the fields of a mask
+ *
+ * @return Bytes written, -1 if out_size is too small
+ */
+int espnow_state_encode(const espnow_state_wire_t *wire, const espnow_state_mask_t *fields, uint8_t *out, size_t out_size);
+
+/**
+ * @brief Encoded size of the fields of a mask (without encoding)
+ */
+size_t espnow_state_encoded_size(const espnow_state_mask_t *fields);
+
+/**
+ * @brief Decode a payload and apply the fields it carries to a state
+ *
+ * @param decoded Optional: receives the IDs of the applied fields
+ * @return ESP_OK, ESP_ERR_INVALID_SIZE if the payload is truncated
+ */
+esp_err_t espnow_state_decode(const uint8_t *in, size_t len, vehicle_state_t *state, espnow_state_mask_t *decoded);
+
+static inline void espnow_state_mask_set(espnow_state_mask_t *mask, uint8_t field_id) {
+  mask->bits[field_id >> 3] |= (uint8_t)(1u << (field_id & 7));
+}
+
+static inline bool espnow_state_mask_test(const espnow_state_mask_t *mask, uint8_t field_id) {
+  return (mask->bits[field_id >> 3] >> (field_id & 7)) & 1;
+}
+
+static inline bool espnow_state_mask_any(const espnow_state_mask_t *mask) {
+  for (int i = 0; i < ESPNOW_STATE_MASK_BYTES; i++) {
+    if (mask->bits[i]) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static inline void espnow_state_mask_clear(espnow_state_mask_t *mask, uint8_t field_id) {
+  mask->bits[field_id >> 3] &= (uint8_t)~(1u << (field_id & 7));
+}
+
+static inline void espnow_state_mask_and(espnow_state_mask_t *mask, const espnow_state_mask_t *other) {
+  for (int i = 0; i < ESPNOW_STATE_MASK_BYTES; i++) {
+    mask->bits[i] &= other->bits[i];
+  }
+}
+
+static inline void espnow_state_mask_or(espnow_state_mask_t *mask, const espnow_state_mask_t *other) {
+  for (int i = 0; i < ESPNOW_STATE_MASK_BYTES; i++) {
+    mask->bits[i] |= other->bits[i];
+  }
+}
+
+static inline bool espnow_state_mask_intersects(const espnow_state_mask_t *a, const espnow_state_mask_t *b) {
+  for (int i = 0; i < ESPNOW_STATE_MASK_BYTES; i++) {
+    if (a->bits[i] & b->bits[i]) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static inline bool espnow_state_mask_equal(const espnow_state_mask_t *a, const espnow_state_mask_t *b) {
+  for (int i = 0; i < ESPNOW_STATE_MASK_BYTES; i++) {
+    if (a->bits[i] != b->bits[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static inline uint8_t espnow_state_mask_count(const espnow_state_mask_t *mask) {
+  uint8_t count = 0;
+  for (int i = 0; i < ESPNOW_STATE_MASK_BYTES; i++) {
+    count += (uint8_t)__builtin_popcount(mask->bits[i]);
+  }
+  return count;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ESPNOW_STATE_CODEC_H
@@ -0,0 +1,79 @@
+#ifndef FIXED_MATH_H
+#define FIXED_MATH_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Integer math for the per-pixel loops of the effects (the ESP32-C6 has no FPU).
+// Angles are uint16_t, 65536 per turn. A phase is an angle in Q16.16 (uint32_t): it
+// wraps with the turn, so phase = frame * rate is exact modulo 2^32 and per-pixel
+// steps are plain additions. Floats are fine once per frame to derive the rates.
+// No dependency on ESP-IDF: also builds on the host (tools/bench).
+#define FIXED_PHASE_PER_RADIAN 683565275.6f // 2^32 / (2 pi)
+
+// sin over a quarter turn in Q15 (257 entries, the last one is sin(pi / 2))
+extern const int16_t fixed_sin_quarter[257];
+
+/**
+ * @brief Phase step of an angle in radians (negative steps wrap around)
+ */
+static inline uint32_t fixed_phase_from_radians(float radians) {
+  return (uint32_t)(int64_t)(radians * FIXED_PHASE_PER_RADIAN);
+}
+
+/**
+ * @brief sin(angle) in Q15, linearly interpolated (error below 2 LSB)
+ */
+static inline int16_t fixed_sin16(uint16_t angle) {
+  uint16_t quarter = angle >> 14;
+  uint16_t offset  = angle & 0x3FFF;
+  if (quarter & 1) {
+    offset = 0x4000 - offset;
+  }
+
+  uint16_t index = offset >> 6;
+  int32_t value  = fixed_sin_quarter[index];
+  if (index < 256) {
+    value += ((fixed_sin_quarter[index + 1] - value) * (int32_t)(offset & 0x3F)) >> 6;
+  }
+  return (int16_t)(quarter & 2 ? -value : value);
+}
+
+/**
+ * @brief (sin(angle) + 1) / 2 scaled to 0-255
+ */
+static inline uint8_t fixed_sin8(uint16_t angle) {
+  return (uint8_t)((fixed_sin16(angle) + 32768) >> 8);
+}
+
+/**
+ * @brief value * scale / 255 (0 and 255 are exact)
+ */
+static inline uint8_t fixed_scale8(uint8_t value, uint8_t scale) {
+  return (uint8_t)((value * (scale + 1u)) >> 8);
+}
+
+/**
+ * @brief Q8 interpolation: a at frac 0, b at frac 255
+ */
+static inline uint8_t fixed_lerp8(uint8_t a, uint8_t b, uint8_t frac) {
+  uint16_t weight = frac + (frac >> 7); // 0-256
+  return (uint8_t)((a * (256u - weight) + b * weight) >> 8);
+}
+
+/**
+ * @brief Q16 interpolation: a at frac 0, b at frac 65535
+ */
+static inline uint16_t fixed_lerp16(uint16_t a, uint16_t b, uint16_t frac) {
+  uint32_t weight = frac + (frac >> 15); // 0-65536
+  return (uint16_t)((a * (65536u - weight) + b * weight) >> 16);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FIXED_MATH_H
@@ -0,0 +1,70 @@
+#ifndef FRAME_SCHEDULER_H
+#define FRAME_SCHEDULER_H
+
+#include "esp_err.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Fixed-rate pacing of the LED task. Frames start on deadlines spaced one period
+// apart (vTaskDelayUntil), so render time does not add to the period. A frame that
+// ends after its deadline is an overrun: the deadlines already missed are skipped
+// rather than rendered back to back, and the schedule restarts from now.
+#define FRAME_SCHEDULER_FPS_DEFAULT 50
+#define FRAME_SCHEDULER_FPS_MIN 10
+#define FRAME_SCHEDULER_FPS_MAX 100
+#define FRAME_SCHEDULER_HISTOGRAM_BUCKETS 8
+
+/**
+ * @brief Upper bounds of the frame time histogram buckets (µs), the last one is open
+ */
+extern const uint32_t frame_scheduler_histogram_bounds_us[FRAME_SCHEDULER_HISTOGRAM_BUCKETS - 1];
+
+typedef struct {
+  uint8_t target_fps;
+  uint32_t period_us;
+  uint32_t frames;
+  uint32_t overruns;      // Frames that ended after the next deadline
+  uint32_t skipped;       // Deadlines dropped to catch up after overruns
+  uint32_t frame_us_last; // Work time of a frame (render and output)
+  uint32_t frame_us_max;
+  uint64_t frame_us_total;
+  uint32_t interval_us_max; // Between frame starts
+  uint64_t interval_us_total;
+  // Frames per work time bucket
+  uint32_t histogram[FRAME_SCHEDULER_HISTOGRAM_BUCKETS];
+} frame_scheduler_stats_t;
+
+/**
+ * @brief Start the schedule from now (call from the task it paces)
+ */
+void frame_scheduler_init(uint8_t target_fps);
+
+/**
+ * @brief Change the target frame rate (applies from the next frame)
+ * @return ESP_ERR_INVALID_ARG outside FRAME_SCHEDULER_FPS_MIN..FRAME_SCHEDULER_FPS_MAX
+ */
+esp_err_t frame_scheduler_set_fps(uint8_t target_fps);
+uint8_t frame_scheduler_get_fps(void);
+
+/**
+ * @brief Mark the start of the frame's work
+ */
+void frame_scheduler_begin_frame(void);
+
+/**
+ * @brief Account for the frame and sleep until the next deadline
+ */
+void frame_scheduler_wait_next(void);
+
+void frame_scheduler_get_stats(frame_scheduler_stats_t *stats);
+void frame_scheduler_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FRAME_SCHEDULER_H
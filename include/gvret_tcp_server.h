@@ -1,15 +1,27 @@
 #ifndef GVRET_TCP_SERVER_H
 #define GVRET_TCP_SERVER_H
 
-#include "driver/twai.h"
+#include "can_id_filter.h"
 #include "esp_err.h"
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * @brief GVRET streaming counters (cumulative since boot, all clients)
+ */
+typedef struct {
+  uint32_t frames_sent;     // Frames written to client sockets
+  uint32_t bytes_sent;      // Bytes written to client sockets
+  uint32_t frames_dropped;  // Frames a client lost because it fell behind the frame hub
+  uint32_t overflow_events; // Number of times a client started losing frames
+  uint32_t clients_evicted; // Clients disconnected for staying behind
+} gvret_tcp_stats_t;
+
 /**
  * @brief Initialize GVRET TCP server
  *
@@ -52,15 +64,34 @@ bool gvret_tcp_server_is_running(void);
 int gvret_tcp_server_get_client_count(void);
 
 /**
- * @brief Broadcast CAN frame to all connected GVRET clients
+ * @brief Get streaming counters
  *
- * Called from CAN RX task when a frame is received.
- * Encodes the frame in GVRET binary format and sends to all active clients.
+ * @param out Receives the counters
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if the server is not initialized
+ */
+esp_err_t gvret_tcp_server_get_stats(gvret_tcp_stats_t *out);
+
+/**
+ * @brief Replace the CAN ID filter of a connected client
+ *
+ * Clients can also manage their own filter with the GVRET extension commands
+ * 0x40 (add), 0x41 (remove) and 0x42 (clear).
+ *
+ * @param slot Client slot (0-3)
+ * @param rules Rules to install (NULL/0 to stream every frame)
+ * @param count Number of rules
+ * @return ESP_OK, ESP_ERR_NOT_FOUND if the slot is not connected
+ */
+esp_err_t gvret_tcp_server_set_client_filters(int slot, const can_id_filter_rule_t *rules, int count);
+
+/**
+ * @brief Get address and filter rules of a client slot
  *
- * @param bus Bus number (0 = BODY, 1 = CHASSIS)
- * @param msg Pointer to TWAI message structure
+ * @param slot Client slot (0-3)
+ * @param out Destination (out->active is false for a free slot)
+ * @return ESP_OK, ESP_ERR_INVALID_ARG if slot is out of range
  */
-void gvret_tcp_broadcast_can_frame(int bus, const twai_message_t *msg);
+esp_err_t gvret_tcp_server_get_client_filters(int slot, can_id_filter_client_info_t *out);
 
 /**
  * @brief Set autostart preference (saved to NVS)
@@ -1,6 +1,7 @@
 #ifndef LED_EFFECTS_H
 #define LED_EFFECTS_H
 
+#include "config.h"
 #include "vehicle_can_unified.h"
 
 #include <stdbool.h>
@@ -58,6 +59,10 @@
 
 #define EFFECT_ID_MAX_LEN 32 // Max length of an effect ID
 
+// Animation frame length: frame counters are derived from the shared animation clock
+// (anim_clock.h), so devices running the same effect show the same frame
+#define LED_EFFECT_FRAME_MS 20
+
 // Effect types (internal enum, may change)
 typedef enum {
   EFFECT_OFF = 0,
@@ -173,6 +178,13 @@ typedef struct {
   uint8_t b;
 } led_rgb_t;
 
+// Render layers: every effect instance rendered in a frame has its own slot, so the base
+// effect and the events can all run stateful effects at once
+#define LED_LAYER_BASE 0
+#define LED_LAYER_EVENT_FIRST 1 // + index in the active event table
+#define LED_LAYER_EVENT_COUNT 10
+#define LED_LAYER_COUNT (LED_LAYER_EVENT_FIRST + LED_LAYER_EVENT_COUNT)
+
 /**
  * @brief Initializes the LED system
  * @return true if successful
@@ -197,7 +209,16 @@ void led_effects_set_config(const effect_config_t *config);
 void led_effects_get_config(effect_config_t *config);
 
 /**
- * @brief Updates the LEDs (call regularly)
+ * @brief Starts a frame: samples the animation clock once for the event overlays and the base effect
+ *
+ * Sets the frame counter and the time elapsed since the previous frame, which
+ * effects keeping state between frames advance by. Also switches to the buffers of
+ * a new LED count (led_effects_set_led_count). Call before config_manager_update.
+ */
+void led_effects_begin_frame(void);
+
+/**
+ * @brief Updates the LEDs (call once per frame, after led_effects_begin_frame)
  */
 void led_effects_update(void);
 
@@ -208,10 +229,20 @@ void led_effects_update(void);
 void led_effects_update_vehicle_state(const vehicle_state_t *state);
 
 /**
- * @brief Sets the active event context for rendering (0 = none)
- * @param event_id Numeric ID of CAN event
+ * @brief Updates with a vehicle state received from the ESP-NOW master
+ *
+ * Speed, power and pedal position are interpolated between updates at every frame
+ * (signal_smoother), so they do not step at the master's send rate.
+ *
+ * @param state Vehicle state
+ * @param state_time_ms Animation time the master captured the state
+ */
+void led_effects_update_vehicle_state_at(const vehicle_state_t *state, uint32_t state_time_ms);
+
+/**
+ * @brief Smoothed signal changes shown at once (above the snap threshold)
  */
-void led_effects_set_event_context(uint16_t event_id);
+uint32_t led_effects_get_signal_snaps(void);
 
 /**
  * @brief Gets the name of an effect
@@ -298,22 +329,120 @@ void led_effects_show_upgrade_error(void);
 
 /**
  * @brief Changes the number of LEDs
- * @param led_count Number of LEDs
- * @return true if change was successful
+ *
+ * The frame buffers are sized for the new count here and take over at the start of
+ * the next frame (led_effects_begin_frame): running effects restart.
+ *
+ * @param led_count Number of LEDs (1-MAX_LED_COUNT)
+ * @return false if out of range or if the buffers do not fit in memory (count unchanged)
  */
 bool led_effects_set_led_count(uint16_t led_count);
 
 /**
- * @brief Renders an effect to a buffer without sending to LEDs
+ * @brief Maps the frame buffer onto the physical strip outputs
+ *
+ * Each output shows its span on its own GPIO and RMT channel. All of them are started
+ * back to back and transmit concurrently: a frame takes the wire time of the longest
+ * span. The channels are rebuilt at the start of the next frame (led_effects_begin_frame).
+ *
+ * @param outputs 1-LED_OUTPUT_MAX outputs on distinct GPIOs, with spans that do not overlap
+ * @param count Number of outputs
+ * @return false if the table is invalid (outputs unchanged)
  */
-void led_effects_render_to_buffer(const effect_config_t *config, uint16_t segment_start, uint16_t segment_length, uint32_t frame_counter, led_rgb_t *out_buffer);
+bool led_effects_set_outputs(const led_output_config_t *outputs, uint8_t count);
+
+/**
+ * @brief Current output table (the one set last, even before it takes over)
+ * @param outputs Room for LED_OUTPUT_MAX outputs
+ * @return Number of outputs
+ */
+uint8_t led_effects_get_outputs(led_output_config_t *outputs);
+
+/**
+ * @brief Renders one layer straight into its span of a buffer, without sending to LEDs
+ *
+ * Reentrant: no global is swapped. The effect's state (trails, heat map...) is kept
+ * between frames in the layer's slot, and starts over when the layer's effect or
+ * capacity changes. The config's segment fields are ignored: the span is the segment.
+ * With config->reverse the effect renders mirrored into the span, LED 0 last.
+ *
+ * @param config Effect to render
+ * @param layer LED_LAYER_* slot of the instance
+ * @param event CAN event shown by the layer (CAN_EVENT_NONE for the base effect), for the
+ *              dynamic brightness exclusions
+ * @param frame_counter Animation frame
+ * @param out First LED of the span
+ * @param count LEDs in the span
+ * @param capacity LEDs the layer's state is kept for: the span before accel modulation,
+ *                 so a span that varies within it keeps its state (count if lower)
+ */
+void led_effects_render_layer(const effect_config_t *config, uint8_t layer, uint16_t event, uint32_t frame_counter, led_rgb_t *out, uint16_t count, uint16_t capacity);
+
+/**
+ * @brief Binds a layer to its state ahead of rendering it from another core
+ *
+ * Call from the LED task for every layer of the frame before any of them is rendered
+ * concurrently: binding allocates in the shared state arena. The next
+ * led_effects_render_layer of the layer for that frame then touches only the layer's
+ * own state, from any core: layers writing to distinct memory may render at the same
+ * time. It never binds: with another effect or capacity, the layer renders black.
+ *
+ * @return false if the layer would render without state of its own (arena full): render
+ *         the frame's layers on the LED task only
+ */
+bool led_effects_prepare_layer(const effect_config_t *config, uint8_t layer, uint32_t frame_counter, uint16_t count, uint16_t capacity);
 
 /**
  * @brief Displays a pre-calculated buffer
  */
 void led_effects_show_buffer(const led_rgb_t *buffer);
 
+/**
+ * @brief Frame buffer of the strip (led_effects_get_led_count() LEDs, NULL before init)
+ *
+ * Layers composed straight into it are shown by led_effects_show_buffer without a copy.
+ * LED task only: it is replaced when the LED count changes (led_effects_begin_frame).
+ */
+led_rgb_t *led_effects_get_frame_buffer(void);
+
+/**
+ * @brief Brightness scale (/256) the last frame was shown with, over the frame buffer
+ *
+ * The base effect alone is rendered unscaled into the frame buffer and scaled on output:
+ * a copy of the shown frame applies it to every component. 256 when already scaled.
+ */
+uint16_t led_effects_get_frame_scale(void);
+
+/**
+ * @brief LED output timing (double-buffered RMT transmission) and skipped work
+ */
+typedef struct {
+  uint32_t frames;  // Frames queued
+  uint32_t wire_us; // Transmission time of the last frame (longest output)
+  uint32_t waits;   // Frames that waited for the previous one (rendering outran the wire)
+  uint32_t wait_us_max;
+  uint64_t wait_us_total;
+  uint32_t interval_us_min; // Between frame starts
+  uint32_t interval_us_max;
+  uint64_t interval_us_total;
+  uint32_t timeouts;
+  uint32_t suppressed;      // Frames identical to the one on the strip, not sent
+  uint32_t layers_rendered; // Effect layers rendered
+  uint32_t layers_reused;   // Static or periodic layers with unchanged inputs: previous pixels shown again
+} led_output_stats_t;
+
+void led_effects_get_output_stats(led_output_stats_t *stats);
+
 uint32_t led_effects_get_frame_counter(void);
+
+/**
+ * @brief Seeds the random generators of the effects (from the hardware RNG at init)
+ *
+ * Running layers restart. With a given seed, a layer renders the same frames for the
+ * same configuration and clock: used by the host bench to compare frames exactly.
+ * Call from the LED task or before it starts.
+ */
+void led_effects_set_random_seed(uint32_t seed);
 void led_effects_advance_frame_counter(void);
 uint16_t led_effects_get_led_count(void);
 uint8_t led_effects_get_accel_pedal_pos(void);
@@ -0,0 +1,61 @@
+#ifndef PIXEL_STREAM_CODEC_H
+#define PIXEL_STREAM_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Lossless compression of rendered LED frames (3 bytes per LED, RGB) for the
+// ESP-NOW pixel offload. A frame is cut into chunks that each fit one packet;
+// every chunk picks the encoding that packs the most LEDs:
+//   RAW:         3 bytes per LED
+//   PALETTE_RLE: [n][n RGB entries][tokens: palette index << 4 | (run - 1)]
+//                (n <= 16, runs of 1..16 LEDs)
+//   DELTA:       against the previous frame, tokens 0x00-0x7F skip 1..128 unchanged
+//                LEDs, 0x80-0xFF are followed by 1..128 literal RGB LEDs
+// No dependency on ESP-IDF: the codec also builds on the host (tools/bench).
+#define PIXEL_STREAM_MAX_CHUNK 238 // ESP-NOW payload (250) minus the packet header
+#define PIXEL_STREAM_PALETTE_SIZE 16
+#define PIXEL_STREAM_MAX_RUN 16
+#define PIXEL_STREAM_MAX_DELTA_TOKEN 128
+
+typedef enum {
+  PIXEL_ENC_RAW = 0,
+  PIXEL_ENC_PALETTE_RLE,
+  PIXEL_ENC_DELTA,
+  PIXEL_ENC_COUNT
+} pixel_stream_encoding_t;
+
+/**
+ * @brief Encode as many LEDs as fit in one chunk
+ *
+ * @param frame Current frame (count LEDs)
+ * @param prev Frame the receiver has, NULL to use absolute encodings only
+ * @param first First LED of the chunk
+ * @param count LEDs in the frame
+ * @param encoded Receives the LEDs encoded (first..first + *encoded - 1)
+ * @param encoding Receives the encoding to put in the chunk header
+ * @return Bytes written, -1 if not even one LED fits
+ */
+int pixel_stream_encode_chunk(const uint8_t *frame, const uint8_t *prev, uint16_t first, uint16_t count, uint8_t *out, size_t out_size, uint16_t *encoded, pixel_stream_encoding_t *encoding);
+
+/**
+ * @brief Decode a chunk into a frame buffer
+ *
+ * For DELTA, the buffer must hold the frame the chunk was encoded against
+ * (unchanged LEDs are left as they are).
+ *
+ * @return 0, -1 if the chunk is malformed or does not decode to exactly led_count LEDs
+ */
+int pixel_stream_decode_chunk(pixel_stream_encoding_t encoding, const uint8_t *in, size_t len, uint8_t *frame, uint16_t first, uint16_t led_count);
+
+const char *pixel_stream_encoding_name(pixel_stream_encoding_t encoding);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PIXEL_STREAM_CODEC_H
@@ -0,0 +1,64 @@
+#ifndef RENDER_WORKER_H
+#define RENDER_WORKER_H
+
+#include "esp_err.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Second core of the LED task. On dual-core targets the LED task runs on LED_TASK_CORE
+// and core 0 mostly waits for WiFi: the worker, pinned there, renders a share of the
+// frame's layers while the LED task renders the rest. render_worker_wait is the per-frame
+// barrier, before composition. Single-core builds, or the split turned off, run the job
+// on the LED task in render_worker_start.
+typedef void (*render_worker_job_t)(void *arg);
+
+typedef struct {
+  uint32_t frames; // Frames with a share rendered by the worker
+  uint32_t worker_us_last;
+  uint32_t worker_us_max;
+  uint64_t worker_us_total;
+  uint32_t wait_us_max; // LED task waiting at the barrier for the worker
+  uint64_t wait_us_total;
+} render_worker_stats_t;
+
+/**
+ * @brief Start the worker task on the general core
+ * @return ESP_ERR_NOT_SUPPORTED on single-core builds
+ */
+esp_err_t render_worker_init(void);
+
+/**
+ * @brief Turn the split on or off (applies from the next frame)
+ */
+void render_worker_set_enabled(bool enabled);
+bool render_worker_is_enabled(void);
+
+/**
+ * @brief Whether render_worker_start hands the job to the other core
+ */
+bool render_worker_active(void);
+
+/**
+ * @brief Run a job on the worker, or right away on the caller when inactive
+ *
+ * LED task only, one job per frame, followed by render_worker_wait.
+ */
+void render_worker_start(render_worker_job_t job, void *arg);
+
+/**
+ * @brief Wait until the job of render_worker_start is done
+ */
+void render_worker_wait(void);
+
+void render_worker_get_stats(render_worker_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RENDER_WORKER_H
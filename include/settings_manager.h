@@ -1,6 +1,7 @@
 #ifndef SETTINGS_MANAGER_H
 #define SETTINGS_MANAGER_H
 
+#include "config.h"
 #include "esp_err.h"
 
 #include <stdbool.h>
@@ -18,6 +19,10 @@ typedef struct {
 
   // LED Hardware
   uint16_t led_count;
+  uint8_t led_output_count; // 0: default output on LED_PIN
+  led_output_config_t led_outputs[LED_OUTPUT_MAX];
+  uint8_t led_fps;
+  bool led_dual_core; // Layers render on both cores (render_worker)
 
   // Wheel control
   bool wheel_control_enabled;
@@ -93,6 +98,18 @@ bool settings_get_bool(const char *key, bool default_value);
  */
 esp_err_t settings_set_bool(const char *key, bool value);
 
+/**
+ * @brief Gets the LED output table
+ * @param outputs Room for LED_OUTPUT_MAX outputs
+ * @return Number of outputs, 0 if none saved (default output)
+ */
+uint8_t settings_get_led_outputs(led_output_config_t *outputs);
+
+/**
+ * @brief Sets the LED output table (0 outputs: back to the default one)
+ */
+esp_err_t settings_set_led_outputs(const led_output_config_t *outputs, uint8_t count);
+
 /**
  * @brief Clears all settings (factory reset)
  */
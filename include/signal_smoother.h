@@ -0,0 +1,57 @@
+#ifndef SIGNAL_SMOOTHER_H
+#define SIGNAL_SMOOTHER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Smoothing of a continuous signal received at a low rate (ESP-NOW slave).
+// Samples are stamped with the animation clock and played back SIGNAL_SMOOTHER_DELAY_MS
+// late, linearly interpolated between them. When the next sample is late, the trend is
+// continued for at most SIGNAL_SMOOTHER_EXTRAPOLATE_MS, then brought back to the last
+// value: the error of the estimate is bounded by slope * SIGNAL_SMOOTHER_EXTRAPOLATE_MS.
+// A sample further than snap_threshold from the displayed value is shown at once.
+#define SIGNAL_SMOOTHER_HISTORY 4
+#define SIGNAL_SMOOTHER_INTERVAL_MS 100 // Send period of the master's dynamic fields
+#define SIGNAL_SMOOTHER_DELAY_MS 120    // One send period plus transmission
+#define SIGNAL_SMOOTHER_EXTRAPOLATE_MS 50
+
+typedef struct {
+  uint32_t time_ms[SIGNAL_SMOOTHER_HISTORY]; // Oldest first
+  float value[SIGNAL_SMOOTHER_HISTORY];
+  uint8_t count;
+  float snap_threshold;
+  float min_value;
+  float max_value;
+  uint32_t snaps;
+} signal_smoother_t;
+
+void signal_smoother_init(signal_smoother_t *smoother, float snap_threshold, float min_value, float max_value);
+
+/**
+ * @brief Forget the history (the next sample is shown as is)
+ */
+void signal_smoother_reset(signal_smoother_t *smoother);
+
+/**
+ * @brief Add a received value
+ *
+ * Only changes need to be pushed: the value is held until the next one.
+ *
+ * @param time_ms Animation time the value was captured
+ * @param now_ms Current animation time
+ */
+void signal_smoother_push(signal_smoother_t *smoother, uint32_t time_ms, float value, uint32_t now_ms);
+
+/**
+ * @brief Value to display at now_ms
+ */
+float signal_smoother_value(const signal_smoother_t *smoother, uint32_t now_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIGNAL_SMOOTHER_H
@@ -3,8 +3,10 @@
 #define VEHICLE_CAN_UNIFIED_H
 
 #include "esp_attr.h" // For IRAM_ATTR
+#include "esp_err.h"
 #include "vehicle_can_unified_config.h"
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -204,6 +206,14 @@ void vehicle_can_unified_init(void);
 // IRAM_ATTR: Main entry point for CAN frame decoding, called for every frame (~2000 times/s)
 void IRAM_ATTR vehicle_can_process_frame_static(const can_frame_t *frame, vehicle_state_t *state);
 
+// Resolves a DBC signal name ("DI_vehicleSpeed" or "ID257DIspeed.DI_vehicleSpeed")
+// to its indexes in g_can_messages. Returns ESP_ERR_NOT_FOUND for unknown names.
+esp_err_t vehicle_can_find_signal(const char *name, uint16_t *msg_index, uint8_t *sig_index);
+
+// Decodes one signal of a frame. Returns false when the signal is multiplexed
+// and absent from this frame.
+bool vehicle_can_decode_signal(const can_message_def_t *msg, uint8_t sig_index, const uint8_t *data, uint8_t dlc, float *value);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,229 @@
+#include "anim_clock.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "ANIM_CLOCK";
+
+#define SLEW_US 1000000              // A correction is spread over this time (rate change <= 2%)
+#define STEP_THRESHOLD_US 20000      // Larger: stepped when late, slewed at half speed when early
+#define RESTART_THRESHOLD_US 2000000 // Earlier than this: the master restarted, follow it back
+#define SKEW_MIN_SPAN_US 3000000
+#define SKEW_MAX_PPM 200.0
+
+typedef struct {
+  int64_t local_us; // Local time at the middle of the exchange
+  int64_t offset_us;
+  int64_t delay_us;
+} clock_sample_t;
+
+// Master time = base_master + (local - base_local) * (1 + skew), plus slew_us spread over slew_span_us
+static portMUX_TYPE s_lock      = portMUX_INITIALIZER_UNLOCKED;
+static bool s_reference         = false;
+static bool s_synced            = false;
+static int64_t s_base_local_us  = 0;
+static int64_t s_base_master_us = 0;
+static double s_skew            = 0.0;
+static int64_t s_slew_us        = 0;
+static int64_t s_slew_span_us   = SLEW_US;
+static int64_t s_last_now_us    = 0; // Keeps the clock monotonic across corrections and skew updates
+static uint8_t s_filter_count   = 0;
+static uint8_t s_filter_next    = 0;
+static uint8_t s_point_count    = 0;
+static uint8_t s_point_next     = 0;
+static int64_t s_last_point_us  = 0;
+static int64_t s_last_delay_us  = 0;
+static uint32_t s_sample_count  = 0;
+static uint32_t s_step_count    = 0;
+static clock_sample_t s_filter[ANIM_CLOCK_FILTER_SAMPLES];
+static clock_sample_t s_points[ANIM_CLOCK_SKEW_POINTS];
+
+// Called with s_lock held
+static int64_t model_at(int64_t local_us) {
+  if (s_reference || !s_synced) {
+    return local_us;
+  }
+  int64_t dt     = local_us - s_base_local_us;
+  int64_t slewed = dt >= s_slew_span_us ? s_slew_us : (dt <= 0 ? 0 : s_slew_us * dt / s_slew_span_us);
+  return s_base_master_us + dt + (int64_t)((double)dt * s_skew) + slewed;
+}
+
+void anim_clock_set_reference(bool reference) {
+  portENTER_CRITICAL(&s_lock);
+  s_reference    = reference;
+  s_synced       = false;
+  s_filter_count = 0;
+  s_point_count  = 0;
+  s_last_now_us  = 0;
+  s_slew_span_us = SLEW_US;
+  portEXIT_CRITICAL(&s_lock);
+}
+
+int64_t anim_clock_now_us(void) {
+  int64_t local_us = esp_timer_get_time();
+
+  portENTER_CRITICAL(&s_lock);
+  int64_t now_us = model_at(local_us);
+  if (now_us < s_last_now_us) {
+    now_us = s_last_now_us;
+  } else {
+    s_last_now_us = now_us;
+  }
+  portEXIT_CRITICAL(&s_lock);
+  return now_us;
+}
+
+uint32_t anim_clock_now_ms(void) {
+  return (uint32_t)(anim_clock_now_us() / 1000);
+}
+
+// Least-squares slope of offset over local time
+static bool fit_skew(double *skew) {
+  if (s_point_count < 4) {
+    return false;
+  }
+
+  int64_t first = s_points[0].local_us;
+  int64_t last  = first;
+  double mean_x = 0.0;
+  double mean_y = 0.0;
+  for (int i = 0; i < s_point_count; i++) {
+    first = s_points[i].local_us < first ? s_points[i].local_us : first;
+    last  = s_points[i].local_us > last ? s_points[i].local_us : last;
+  }
+  if (last - first < SKEW_MIN_SPAN_US) {
+    return false;
+  }
+
+  // Centered on the first point: keeps the products small
+  for (int i = 0; i < s_point_count; i++) {
+    mean_x += (double)(s_points[i].local_us - first);
+    mean_y += (double)(s_points[i].offset_us - s_points[0].offset_us);
+  }
+  mean_x /= s_point_count;
+  mean_y /= s_point_count;
+
+  double sxx = 0.0;
+  double sxy = 0.0;
+  for (int i = 0; i < s_point_count; i++) {
+    double dx = (double)(s_points[i].local_us - first) - mean_x;
+    double dy = (double)(s_points[i].offset_us - s_points[0].offset_us) - mean_y;
+    sxx += dx * dx;
+    sxy += dx * dy;
+  }
+  if (sxx <= 0.0) {
+    return false;
+  }
+
+  double slope = sxy / sxx;
+  if (slope > SKEW_MAX_PPM * 1e-6) {
+    slope = SKEW_MAX_PPM * 1e-6;
+  } else if (slope < -SKEW_MAX_PPM * 1e-6) {
+    slope = -SKEW_MAX_PPM * 1e-6;
+  }
+  *skew = slope;
+  return true;
+}
+
+void anim_clock_add_sample(int64_t t1, int64_t t2, int64_t t3, int64_t t4) {
+  if (t4 < t1) {
+    return;
+  }
+
+  clock_sample_t sample = {
+      .local_us  = t1 + (t4 - t1) / 2,
+      .offset_us = ((t2 - t1) + (t3 - t4)) / 2,
+      .delay_us  = (t4 - t1) - (t3 - t2),
+  };
+  if (sample.delay_us < 0) {
+    sample.delay_us = 0;
+  }
+
+  bool stepped  = false;
+  int64_t error = 0;
+
+  portENTER_CRITICAL(&s_lock);
+  if (s_reference) {
+    portEXIT_CRITICAL(&s_lock);
+    return;
+  }
+  s_sample_count++;
+
+  // Min-delay filter: the exchange with the shortest round trip has the smallest asymmetry
+  s_filter[s_filter_next] = sample;
+  s_filter_next           = (s_filter_next + 1) % ANIM_CLOCK_FILTER_SAMPLES;
+  if (s_filter_count < ANIM_CLOCK_FILTER_SAMPLES) {
+    s_filter_count++;
+  }
+  const clock_sample_t *best = &s_filter[0];
+  for (int i = 1; i < s_filter_count; i++) {
+    if (s_filter[i].delay_us < best->delay_us) {
+      best = &s_filter[i];
+    }
+  }
+  s_last_delay_us = best->delay_us;
+
+  if (best->local_us != s_last_point_us) {
+    s_points[s_point_next] = *best;
+    s_point_next           = (s_point_next + 1) % ANIM_CLOCK_SKEW_POINTS;
+    s_last_point_us        = best->local_us;
+    if (s_point_count < ANIM_CLOCK_SKEW_POINTS) {
+      s_point_count++;
+    }
+    fit_skew(&s_skew);
+  }
+
+  // Where the master clock is now according to the best exchange, against the current model
+  int64_t target  = t4 + best->offset_us + (int64_t)((double)(t4 - best->local_us) * s_skew);
+  int64_t current = model_at(t4);
+  error           = target - current;
+  if (!s_synced || error > STEP_THRESHOLD_US || error < -RESTART_THRESHOLD_US) {
+    // Jumping ahead keeps the clock monotonic; only a first sync or a master restart moves it back
+    s_base_master_us = target;
+    s_slew_us        = 0;
+    s_slew_span_us   = SLEW_US;
+    if (error < 0) {
+      s_last_now_us = 0;
+    }
+    s_synced = true;
+    stepped  = true;
+    s_step_count++;
+  } else {
+    // Small errors, or running early: the clock slows down to half speed at worst, never backwards
+    s_base_master_us = current;
+    s_slew_us        = error;
+    s_slew_span_us   = error < -STEP_THRESHOLD_US ? -2 * error : SLEW_US;
+  }
+  s_base_local_us = t4;
+  portEXIT_CRITICAL(&s_lock);
+
+  if (stepped) {
+    ESP_LOGI(TAG, "Clock stepped by %lld us (delay %lld us)", (long long)error, (long long)s_last_delay_us);
+  }
+}
+
+bool anim_clock_is_synced(void) {
+  return s_reference || s_synced;
+}
+
+void anim_clock_get_status(anim_clock_status_t *status) {
+  if (!status) {
+    return;
+  }
+
+  int64_t local_us = esp_timer_get_time();
+
+  portENTER_CRITICAL(&s_lock);
+  status->reference = s_reference;
+  status->synced    = s_reference || s_synced;
+  status->offset_us = model_at(local_us) - local_us;
+  status->skew_ppm  = (float)(s_skew * 1e6);
+  status->delay_us  = (uint32_t)s_last_delay_us;
+  status->samples   = s_sample_count;
+  status->steps     = s_step_count;
+  portEXIT_CRITICAL(&s_lock);
+}
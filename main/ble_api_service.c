@@ -5,6 +5,7 @@
 #if CONFIG_BT_ENABLED && CONFIG_BT_NIMBLE_ENABLED
 
 #include "cJSON.h"
+#include "can_signal_watch.h"
 #include "config.h"
 #include "esp_heap_caps.h"
 #include "esp_http_client.h"
@@ -26,6 +27,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <strings.h>
+#include <sys/param.h>
 
 // UUIDs (128-bit) - NimBLE expects bytes in reverse order
 // Service: 4fafc201-1fb5-459e-8fcc-c5c9c331914b
@@ -40,6 +42,9 @@ static const ble_uuid128_t ble_response_uuid      = BLE_UUID128_INIT(0xdc, 0xa9,
 // Vehicle State: c5c9c331-914b-459e-8fcc-c5c91fb54fad
 static const ble_uuid128_t ble_vehicle_state_uuid = BLE_UUID128_INIT(0xad, 0x4f, 0xb5, 0x1f, 0xc9, 0xc5, 0xcc, 0x8f, 0x9e, 0x45, 0x4b, 0x91, 0x31, 0xc3, 0xc9, 0xc5);
 
+// Signal Watch: c5c9c331-914b-459e-8fcc-c5c91fb54fae
+static const ble_uuid128_t ble_signal_watch_uuid  = BLE_UUID128_INIT(0xae, 0x4f, 0xb5, 0x1f, 0xc9, 0xc5, 0xcc, 0x8f, 0x9e, 0x45, 0x4b, 0x91, 0x31, 0xc3, 0xc9, 0xc5);
+
 typedef struct {
   size_t length;
   char *payload;
@@ -58,9 +63,11 @@ static uint16_t ble_conn_handle = BLE_HS_CONN_HANDLE_NONE;
 static uint16_t ble_command_val_handle;
 static uint16_t ble_response_val_handle;
 static uint16_t ble_vehicle_state_val_handle;
+static uint16_t ble_signal_watch_val_handle;
 static bool ble_connected                       = false;
 static bool notifications_enabled               = false;
 static bool vehicle_state_notifications_enabled = false;
+static bool signal_watch_notifications_enabled  = false;
 static uint16_t negotiated_mtu                  = 23;
 static bool ble_started                         = false;
 static bool config_ack_received                 = false;
@@ -77,6 +84,7 @@ static void ble_send_json_response(cJSON *object);
 static void ble_send_text_response(const char *text);
 static void ble_send_error_response(int status, const char *status_text, const char *message);
 static bool ble_send_notification(const uint8_t *data, size_t len);
+static void ble_signal_watch_sink(const can_watch_update_t *updates, int count);
 static esp_err_t ble_perform_local_http_request(const char *method, const char *path, const char *body, size_t body_len, cJSON *headers, ble_http_response_t *out_response);
 static esp_err_t ble_http_event_handler(esp_http_client_event_t *evt);
 
@@ -125,6 +133,12 @@ static const struct ble_gatt_svc_def ble_gatt_svcs[] = {{.type            = BLE_
                                                                                                             .flags      = BLE_GATT_CHR_F_NOTIFY,
                                                                                                             .val_handle = &ble_vehicle_state_val_handle,
                                                                                                         },
+                                                                                                        {
+                                                                                                            .uuid       = &ble_signal_watch_uuid.u,
+                                                                                                            .access_cb  = ble_gatt_access_cb,
+                                                                                                            .flags      = BLE_GATT_CHR_F_NOTIFY,
+                                                                                                            .val_handle = &ble_signal_watch_val_handle,
+                                                                                                        },
                                                                                                         {0}}},
                                                         {0}};
 
@@ -155,6 +169,7 @@ static int ble_gap_event(struct ble_gap_event *event, void *arg) {
       ble_connected                       = true;
       notifications_enabled               = false;
       vehicle_state_notifications_enabled = false;
+      signal_watch_notifications_enabled  = false;
       config_ack_received                 = false;
       negotiated_mtu                      = 23;
       incoming_length                     = 0;
@@ -189,6 +204,7 @@ static int ble_gap_event(struct ble_gap_event *event, void *arg) {
     ble_connected                       = false;
     notifications_enabled               = false;
     vehicle_state_notifications_enabled = false;
+    signal_watch_notifications_enabled  = false;
     config_ack_received                 = false;
     incoming_length                     = 0;
     ESP_LOGI(TAG_BLE_API, "Client BLE deconnecte, raison=%d", event->disconnect.reason);
@@ -228,6 +244,9 @@ static int ble_gap_event(struct ble_gap_event *event, void *arg) {
     } else if (event->subscribe.attr_handle == ble_vehicle_state_val_handle) {
       vehicle_state_notifications_enabled = event->subscribe.cur_notify;
       ESP_LOGI(TAG_BLE_API, "Notifications BLE vehicle_state %s", vehicle_state_notifications_enabled ? "activees" : "desactivees");
+    } else if (event->subscribe.attr_handle == ble_signal_watch_val_handle) {
+      signal_watch_notifications_enabled = event->subscribe.cur_notify;
+      ESP_LOGI(TAG_BLE_API, "Notifications BLE signal_watch %s", signal_watch_notifications_enabled ? "activees" : "desactivees");
     }
     break;
   }
@@ -671,6 +690,9 @@ esp_err_t ble_api_service_init(void) {
 
   nimble_port_freertos_init(ble_host_task);
 
+  // Decoded CAN signal updates are notified on their own characteristic
+  can_signal_watch_add_sink(ble_signal_watch_sink);
+
   ble_started = true;
   ESP_LOGI(TAG_BLE_API, "BLE NimBLE service initialized");
   return ESP_OK;
@@ -766,6 +788,32 @@ esp_err_t ble_api_service_send_vehicle_state(const void *state, size_t size) {
   return ESP_OK;
 }
 
+// Packed can_watch_update_t records (10 bytes each), whole records per notification
+static void ble_signal_watch_sink(const can_watch_update_t *updates, int count) {
+  if (!ble_connected || !signal_watch_notifications_enabled || ble_conn_handle == BLE_HS_CONN_HANDLE_NONE) {
+    return;
+  }
+
+  size_t max_payload = negotiated_mtu > 3 ? (negotiated_mtu - 3) : 20;
+  if (max_payload > 244) {
+    max_payload = 244;
+  }
+  int per_notification = (int)(max_payload / sizeof(can_watch_update_t));
+
+  for (int offset = 0; offset < count; offset += per_notification) {
+    int records        = MIN(count - offset, per_notification);
+    struct os_mbuf *om = ble_hs_mbuf_from_flat(&updates[offset], records * sizeof(can_watch_update_t));
+    if (!om) {
+      return; // Live values: a later update replaces the lost ones
+    }
+    int rc = ble_gattc_notify_custom(ble_conn_handle, ble_signal_watch_val_handle, om);
+    if (rc != 0) {
+      ESP_LOGW(TAG_BLE_API, "BLE signal watch notification error: %d", rc);
+      return;
+    }
+  }
+}
+
 #else
 
 esp_err_t ble_api_service_init(void) {
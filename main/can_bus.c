@@ -1,17 +1,19 @@
 // can_bus.c
 #include "can_bus.h"
 
-#include "canserver_udp_server.h"
+#include "can_frame_hub.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "espnow_link.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "gvret_tcp_server.h"
 #include "vehicle_can_mapping.h"
 
 // CAN driver ESP-IDF: depending on version it's "twai" or alias "can"
 #include "driver/twai.h"
 
+#include <string.h>
+
 // Structure to manage each CAN bus
 typedef struct {
   int tx_gpio;
@@ -32,9 +34,13 @@ typedef struct {
 // Contexts for each CAN bus
 static can_bus_context_t s_can_buses[CAN_BUS_COUNT] = {0};
 
-// Shared callback for all buses
+// Shared callback for all buses, run by the dispatch task (a frame hub consumer)
+#define CAN_DISPATCH_BATCH 16
+
 static can_bus_callback_t s_callback                = NULL;
 static void *s_cb_user_data                         = NULL;
+static TaskHandle_t s_dispatch_task                 = NULL;
+static can_hub_consumer_t *volatile s_dispatch_hub  = NULL;
 
 // Structure passed to RX tasks
 typedef struct {
@@ -68,26 +74,8 @@ static void can_rx_task(void *pvParameters) {
       ctx->last_rx_tick = xTaskGetTickCount();
       ctx->rx_active    = true;
 
-      // Broadcast to GVRET TCP clients (if server active)
-      gvret_tcp_broadcast_can_frame((int)bus_type, &msg);
-
-      // Broadcast to CANServer TCP clients (if server active)
-      canserver_udp_broadcast_can_frame((int)bus_type, &msg);
-
-      if (s_callback) {
-        can_frame_t frame = {0};
-        frame.id          = msg.identifier;
-        frame.dlc         = msg.data_length_code;
-        if (frame.dlc > 8)
-          frame.dlc = 8;
-        for (int i = 0; i < frame.dlc; i++) {
-          frame.data[i] = msg.data[i];
-        }
-        frame.timestamp_ms = xTaskGetTickCount();
-        frame.bus_id       = (uint8_t)bus_type; // 0=CAN0, 1=CAN1
-
-        s_callback(&frame, bus_type, s_cb_user_data);
-      }
+      // Single write into the shared frame log: GVRET, CANServer and the decoder read it from their own tasks
+      can_hub_publish((int)bus_type, &msg);
     } else if (ret == ESP_ERR_TIMEOUT) {
       continue;
     } else {
@@ -102,6 +90,48 @@ static void can_rx_task(void *pvParameters) {
   vTaskDelete(NULL);
 }
 
+// ---- Dispatch Task (decoder callback) ----
+// Hub timestamps are the low 32 bits of esp_timer: back-date the tick count by the
+// frame's age, so time spent in the ring does not show in timestamp_ms
+static uint32_t frame_rx_tick(uint32_t timestamp_us, int64_t now_us, TickType_t now_tick) {
+  uint32_t age_us = (uint32_t)now_us - timestamp_us;
+  return (uint32_t)(now_tick - pdMS_TO_TICKS(age_us / 1000));
+}
+
+// Decoding runs outside the RX tasks so a slow callback never delays twai_receive,
+// and frames of both buses reach the callback from a single task.
+static void can_dispatch_task(void *pvParameters) {
+  can_hub_frame_t frames[CAN_DISPATCH_BATCH];
+  uint32_t lost_total = 0;
+
+  while (1) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+
+    can_hub_consumer_t *hub = s_dispatch_hub;
+    int count;
+    uint32_t lost;
+    while (hub && (count = can_hub_read(hub, frames, CAN_DISPATCH_BATCH, &lost)) > 0) {
+      if (lost) {
+        lost_total += lost;
+        ESP_LOGW(TAG_CAN_BUS, "Decoder fell behind: %lu frames lost (%lu total)", (unsigned long)lost, (unsigned long)lost_total);
+      }
+
+      int64_t now_us      = esp_timer_get_time();
+      TickType_t now_tick = xTaskGetTickCount();
+      for (int n = 0; n < count; n++) {
+        can_frame_t frame  = {0};
+        frame.id           = frames[n].id;
+        frame.dlc          = frames[n].dlc;
+        memcpy(frame.data, frames[n].data, frame.dlc);
+        frame.timestamp_ms = frame_rx_tick(frames[n].timestamp_us, now_us, now_tick);
+        frame.bus_id       = frames[n].bus; // 0=CAN0, 1=CAN1
+
+        s_callback(&frame, (can_bus_type_t)frames[n].bus, s_cb_user_data);
+      }
+    }
+  }
+}
+
 // ---- Public API ----
 
 esp_err_t can_bus_init(can_bus_type_t bus_type, int tx_gpio, int rx_gpio) {
@@ -280,6 +310,28 @@ esp_err_t can_bus_stop(can_bus_type_t bus_type) {
 esp_err_t can_bus_register_callback(can_bus_callback_t cb, void *user_data) {
   s_callback     = cb;
   s_cb_user_data = user_data;
+
+  if (s_dispatch_task == NULL) {
+    BaseType_t ret = xTaskCreatePinnedToCore(can_dispatch_task,
+                                             "can_dispatch",
+                                             4096,
+                                             NULL,
+                                             10,
+                                             &s_dispatch_task,
+                                             0 // general core, like the RX tasks
+    );
+    if (ret != pdPASS) {
+      ESP_LOGE(TAG_CAN_BUS, "Failed to create dispatch task");
+      return ESP_ERR_NO_MEM;
+    }
+
+    // Woken on the first frame after catching up, then drains in batches
+    s_dispatch_hub = can_hub_register("decoder", &s_dispatch_task, 1);
+    if (!s_dispatch_hub) {
+      return ESP_ERR_NO_MEM;
+    }
+  }
+
   return ESP_OK;
 }
 
@@ -0,0 +1,199 @@
+#include "can_frame_hub.h"
+
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/param.h>
+
+static const char *TAG = "CAN_HUB";
+
+#define CAN_HUB_RING_MASK (CAN_HUB_RING_SIZE - 1)
+
+_Static_assert((CAN_HUB_RING_SIZE & CAN_HUB_RING_MASK) == 0, "CAN_HUB_RING_SIZE must be a power of two");
+
+struct can_hub_consumer {
+  const char *name;
+  volatile bool registered;
+  volatile bool enabled;
+  TaskHandle_t *notify_task; // Handle owned by the consumer module, NULL while its task is stopped
+  uint32_t notify_threshold;
+  atomic_uint cursor; // Sequence number of the next frame to read (reader-owned)
+  uint32_t frames_read;
+  uint32_t frames_lost;
+};
+
+// Two CAN RX tasks publish: the slot write and head increment are done under a
+// spinlock (a 20-byte copy), readers are lock-free and detect overwritten frames
+static can_hub_frame_t *s_ring = NULL;
+static atomic_uint s_head      = 0; // Sequence number of the next frame to publish
+static portMUX_TYPE s_lock     = portMUX_INITIALIZER_UNLOCKED;
+static can_hub_consumer_t s_consumers[CAN_HUB_MAX_CONSUMERS];
+
+static bool hub_init(void) {
+  if (s_ring) {
+    return true;
+  }
+
+  can_hub_frame_t *ring = calloc(CAN_HUB_RING_SIZE, sizeof(can_hub_frame_t));
+  if (!ring) {
+    ESP_LOGE(TAG, "Failed to allocate frame ring (%u bytes)", (unsigned)(CAN_HUB_RING_SIZE * sizeof(can_hub_frame_t)));
+    return false;
+  }
+  s_ring = ring;
+  ESP_LOGI(TAG, "Frame ring allocated: %d frames (%u bytes)", CAN_HUB_RING_SIZE, (unsigned)(CAN_HUB_RING_SIZE * sizeof(can_hub_frame_t)));
+  return true;
+}
+
+// IRAM_ATTR: Called for every CAN frame received (~2000 fps)
+void IRAM_ATTR can_hub_publish(int bus, const twai_message_t *msg) {
+  if (!s_ring) {
+    return;
+  }
+
+  uint8_t dlc = msg->data_length_code > 8 ? 8 : msg->data_length_code;
+
+  portENTER_CRITICAL(&s_lock);
+  uint32_t seq          = atomic_load_explicit(&s_head, memory_order_relaxed);
+  can_hub_frame_t *slot = &s_ring[seq & CAN_HUB_RING_MASK];
+  slot->timestamp_us    = (uint32_t)esp_timer_get_time();
+  slot->id              = msg->identifier;
+  slot->bus             = (uint8_t)bus;
+  slot->dlc             = dlc;
+  slot->extended        = msg->extd ? 1 : 0;
+  memcpy(slot->data, msg->data, 8);
+  atomic_store_explicit(&s_head, seq + 1, memory_order_release);
+  portEXIT_CRITICAL(&s_lock);
+
+  // Wake consumers whose backlog just reached their threshold
+  for (int i = 0; i < CAN_HUB_MAX_CONSUMERS; i++) {
+    can_hub_consumer_t *c = &s_consumers[i];
+    if (!c->enabled || !c->notify_task) {
+      continue;
+    }
+    uint32_t backlog  = seq + 1 - atomic_load_explicit(&c->cursor, memory_order_relaxed);
+    TaskHandle_t task = *c->notify_task;
+    if (backlog == c->notify_threshold && task) {
+      xTaskNotifyGive(task);
+    }
+  }
+}
+
+can_hub_consumer_t *can_hub_register(const char *name, TaskHandle_t *notify_task, uint32_t notify_threshold) {
+  if (!hub_init()) {
+    return NULL;
+  }
+
+  can_hub_consumer_t *consumer = NULL;
+
+  portENTER_CRITICAL(&s_lock);
+  for (int i = 0; i < CAN_HUB_MAX_CONSUMERS; i++) {
+    if (!s_consumers[i].registered) {
+      consumer             = &s_consumers[i];
+      consumer->registered = true;
+      break;
+    }
+  }
+  portEXIT_CRITICAL(&s_lock);
+
+  if (!consumer) {
+    ESP_LOGE(TAG, "No free consumer slot for %s", name);
+    return NULL;
+  }
+
+  consumer->name             = name;
+  consumer->notify_task      = notify_task;
+  consumer->notify_threshold = notify_threshold > 0 ? notify_threshold : 1;
+  can_hub_set_enabled(consumer, true);
+
+  ESP_LOGI(TAG, "Consumer registered: %s (slot %d)", name, (int)(consumer - s_consumers));
+  return consumer;
+}
+
+void can_hub_set_enabled(can_hub_consumer_t *consumer, bool enabled) {
+  if (!consumer) {
+    return;
+  }
+
+  if (enabled) {
+    atomic_store(&consumer->cursor, atomic_load_explicit(&s_head, memory_order_acquire));
+    consumer->frames_read = 0;
+    consumer->frames_lost = 0;
+  }
+  consumer->enabled = enabled;
+}
+
+int can_hub_read(can_hub_consumer_t *consumer, can_hub_frame_t *out, int max, uint32_t *lost) {
+  uint32_t lost_now = 0;
+  int count         = 0;
+
+  if (consumer && consumer->enabled && s_ring && max > 0) {
+    uint32_t cursor = atomic_load_explicit(&consumer->cursor, memory_order_relaxed);
+    uint32_t head   = atomic_load_explicit(&s_head, memory_order_acquire);
+
+    // Too far behind: the oldest frames are already overwritten
+    if (head - cursor > CAN_HUB_RING_SIZE) {
+      lost_now += head - cursor - CAN_HUB_RING_SIZE;
+      cursor    = head - CAN_HUB_RING_SIZE;
+    }
+
+    count = (int)MIN(head - cursor, (uint32_t)max);
+    for (int i = 0; i < count; i++) {
+      out[i] = s_ring[(cursor + i) & CAN_HUB_RING_MASK];
+    }
+
+    // Frames published while copying may have overwritten the start of the copy.
+    // The slot of sequence head_after may be being written right now, so it counts too.
+    atomic_thread_fence(memory_order_acquire);
+    uint32_t head_after = atomic_load_explicit(&s_head, memory_order_acquire);
+    if (head_after - cursor >= CAN_HUB_RING_SIZE) {
+      int torn = (int)MIN(head_after - cursor - CAN_HUB_RING_SIZE + 1, (uint32_t)count);
+      memmove(out, &out[torn], (count - torn) * sizeof(can_hub_frame_t));
+      count -= torn;
+      lost_now += torn;
+      cursor += torn;
+    }
+
+    atomic_store_explicit(&consumer->cursor, cursor + count, memory_order_relaxed);
+    consumer->frames_read += count;
+    consumer->frames_lost += lost_now;
+  }
+
+  if (lost) {
+    *lost = lost_now;
+  }
+  return count;
+}
+
+uint32_t can_hub_backlog(const can_hub_consumer_t *consumer) {
+  if (!consumer || !consumer->enabled) {
+    return 0;
+  }
+  uint32_t backlog = atomic_load(&s_head) - atomic_load(&consumer->cursor);
+  return MIN(backlog, CAN_HUB_RING_SIZE);
+}
+
+esp_err_t can_hub_get_consumer_stats(int index, can_hub_consumer_stats_t *out) {
+  if (index < 0 || index >= CAN_HUB_MAX_CONSUMERS || !out) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  const can_hub_consumer_t *c = &s_consumers[index];
+  if (!c->registered) {
+    return ESP_ERR_NOT_FOUND;
+  }
+
+  out->name        = c->name;
+  out->enabled     = c->enabled;
+  out->backlog     = can_hub_backlog(c);
+  out->frames_read = c->frames_read;
+  out->frames_lost = c->frames_lost;
+  return ESP_OK;
+}
+
+uint32_t can_hub_get_published_count(void) {
+  return atomic_load(&s_head);
+}
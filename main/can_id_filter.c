@@ -0,0 +1,99 @@
+#include "can_id_filter.h"
+
+#include <string.h>
+
+#define STD_ID_MASK 0x7FFu
+#define EXT_ID_MASK 0x1FFFFFFFu
+
+// Rebuild the standard-ID bitmap from the rule list
+static void rebuild_bitmap(can_id_filter_t *filter) {
+  uint32_t bitmap[CAN_ID_FILTER_STD_WORDS];
+
+  if (filter->rule_count == 0) {
+    memset(bitmap, 0xFF, sizeof(bitmap));
+  } else {
+    memset(bitmap, 0, sizeof(bitmap));
+    for (int i = 0; i < filter->rule_count; i++) {
+      const can_id_filter_rule_t *rule = &filter->rules[i];
+      if (rule->extended) {
+        continue;
+      }
+      for (uint32_t id = 0; id < CAN_ID_FILTER_STD_ID_COUNT; id++) {
+        if (((id ^ rule->id) & rule->mask) == 0) {
+          bitmap[id >> 5] |= 1u << (id & 31);
+        }
+      }
+    }
+  }
+
+  // Word by word so a reader never sees a fully cleared bitmap
+  for (int w = 0; w < CAN_ID_FILTER_STD_WORDS; w++) {
+    filter->std_bitmap[w] = bitmap[w];
+  }
+}
+
+static can_id_filter_rule_t normalize_rule(const can_id_filter_rule_t *rule) {
+  uint32_t id_mask          = rule->extended ? EXT_ID_MASK : STD_ID_MASK;
+  can_id_filter_rule_t norm = {
+      .mask     = rule->mask & id_mask,
+      .extended = rule->extended,
+  };
+  norm.id = rule->id & norm.mask;
+  return norm;
+}
+
+static bool rule_equal(const can_id_filter_rule_t *a, const can_id_filter_rule_t *b) {
+  return a->id == b->id && a->mask == b->mask && a->extended == b->extended;
+}
+
+void can_id_filter_clear(can_id_filter_t *filter) {
+  filter->rule_count = 0;
+  rebuild_bitmap(filter);
+}
+
+esp_err_t can_id_filter_set(can_id_filter_t *filter, const can_id_filter_rule_t *rules, int count) {
+  if (count < 0 || count > CAN_ID_FILTER_MAX_RULES) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+
+  // Rules written before the count so the extended-frame scan never reads stale entries
+  filter->rule_count = 0;
+  for (int i = 0; i < count; i++) {
+    filter->rules[i] = normalize_rule(&rules[i]);
+  }
+  filter->rule_count = count;
+  rebuild_bitmap(filter);
+  return ESP_OK;
+}
+
+esp_err_t can_id_filter_add(can_id_filter_t *filter, const can_id_filter_rule_t *rule) {
+  can_id_filter_rule_t norm = normalize_rule(rule);
+
+  for (int i = 0; i < filter->rule_count; i++) {
+    if (rule_equal(&filter->rules[i], &norm)) {
+      return ESP_OK; // Already present
+    }
+  }
+  if (filter->rule_count >= CAN_ID_FILTER_MAX_RULES) {
+    return ESP_ERR_NO_MEM;
+  }
+
+  filter->rules[filter->rule_count] = norm;
+  filter->rule_count++;
+  rebuild_bitmap(filter);
+  return ESP_OK;
+}
+
+esp_err_t can_id_filter_remove(can_id_filter_t *filter, const can_id_filter_rule_t *rule) {
+  can_id_filter_rule_t norm = normalize_rule(rule);
+
+  for (int i = 0; i < filter->rule_count; i++) {
+    if (rule_equal(&filter->rules[i], &norm)) {
+      filter->rules[i] = filter->rules[filter->rule_count - 1];
+      filter->rule_count--;
+      rebuild_bitmap(filter);
+      return ESP_OK;
+    }
+  }
+  return ESP_ERR_NOT_FOUND;
+}
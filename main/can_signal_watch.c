@@ -0,0 +1,432 @@
+#include "can_signal_watch.h"
+
+#include "can_frame_hub.h"
+#include "can_id_filter.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "task_core_utils.h"
+#include "vehicle_can_unified.h"
+
+#include <math.h>
+#include <string.h>
+
+static const char *TAG = "CAN_WATCH";
+
+#define CAN_WATCH_HUB_READ_CHUNK 16
+#define CAN_WATCH_NOTIFY_FRAMES 32 // Wake the task once this many frames are waiting
+#define CAN_WATCH_POLL_MS 20       // Also wakes at this period to close rate/window timers
+#define CAN_WATCH_MIN_INTERVAL_MS 10
+
+typedef struct {
+  bool used;
+  uint8_t watch_id;
+  can_watch_request_t request;
+  const can_message_def_t *msg;
+  uint8_t sig_index;
+  uint8_t bus;
+  // Last decoded value
+  bool has_value;
+  float last_value;
+  // Decimation state
+  bool sent_once;
+  bool pending; // A value is due once the interval elapses (CHANGE/RATE)
+  float sent_value;
+  uint32_t last_sent_ms;
+  bool window_open;
+  uint32_t window_start_ms;
+  float window_min;
+  float window_max;
+  // Counters
+  uint32_t decoded;
+  uint32_t sent;
+} watch_entry_t;
+
+// Table, sinks and filter are modified by the web server and read by the watch task
+static SemaphoreHandle_t s_mutex      = NULL;
+static TaskHandle_t s_task_handle     = NULL;
+static can_hub_consumer_t *s_consumer = NULL;
+static uint8_t s_watch_count          = 0;
+static uint8_t s_next_watch_id        = 1;
+static watch_entry_t s_watches[CAN_WATCH_MAX_SIGNALS];
+static can_id_filter_t s_watched_ids; // Messages carrying at least one watched signal
+static can_watch_sink_t s_sinks[CAN_WATCH_MAX_SINKS];
+static can_watch_stats_t s_stats;
+
+// Only touched by the watch task. The batch is filled with the mutex held and handed to
+// the sinks once it is released: a sink may block (SSE socket, BLE notify).
+static can_watch_update_t s_batch[CAN_WATCH_BATCH_MAX];
+static int s_batch_len = 0;
+
+// Worst case added to the batch by one frame (every watch on its message) and by one tick
+#define CAN_WATCH_FRAME_UPDATES_MAX CAN_WATCH_MAX_SIGNALS
+#define CAN_WATCH_TICK_UPDATES_MAX (2 * CAN_WATCH_MAX_SIGNALS)
+_Static_assert(CAN_WATCH_TICK_UPDATES_MAX <= CAN_WATCH_BATCH_MAX, "a tick must fit in an empty batch");
+
+static void emit(watch_entry_t *w, can_watch_kind_t kind, uint32_t timestamp_ms, float value) {
+  if (s_batch_len >= CAN_WATCH_BATCH_MAX) {
+    return; // Not reached: the task stops decoding before the batch can overflow
+  }
+  can_watch_update_t *u = &s_batch[s_batch_len++];
+  u->watch_id           = w->watch_id;
+  u->kind               = kind;
+  u->timestamp_ms       = timestamp_ms;
+  u->value              = value;
+  w->sent++;
+}
+
+static void emit_value(watch_entry_t *w, uint32_t timestamp_ms) {
+  emit(w, CAN_WATCH_KIND_VALUE, timestamp_ms, w->last_value);
+  w->sent_once    = true;
+  w->sent_value   = w->last_value;
+  w->last_sent_ms = timestamp_ms;
+  w->pending      = false;
+}
+
+static void watch_on_value(watch_entry_t *w, float value, uint32_t timestamp_ms) {
+  w->has_value  = true;
+  w->last_value = value;
+  w->decoded++;
+
+  switch (w->request.mode) {
+  case CAN_WATCH_MODE_CHANGE:
+    if (w->sent_once && fabsf(value - w->sent_value) <= w->request.deadband) {
+      w->pending = false; // Back within the deadband of what the client has
+      break;
+    }
+    if (!w->sent_once || timestamp_ms - w->last_sent_ms >= w->request.interval_ms) {
+      emit_value(w, timestamp_ms);
+    } else {
+      w->pending = true; // Rate-limited: the latest value goes out when the interval elapses
+    }
+    break;
+
+  case CAN_WATCH_MODE_RATE:
+    w->pending = true;
+    break;
+
+  case CAN_WATCH_MODE_MINMAX:
+    if (!w->window_open) {
+      w->window_open     = true;
+      w->window_start_ms = timestamp_ms;
+      w->window_min      = value;
+      w->window_max      = value;
+    } else {
+      w->window_min = fminf(w->window_min, value);
+      w->window_max = fmaxf(w->window_max, value);
+    }
+    break;
+  }
+}
+
+static void watch_on_tick(watch_entry_t *w, uint32_t now_ms) {
+  switch (w->request.mode) {
+  case CAN_WATCH_MODE_CHANGE:
+  case CAN_WATCH_MODE_RATE:
+    if (w->pending && (!w->sent_once || now_ms - w->last_sent_ms >= w->request.interval_ms)) {
+      emit_value(w, now_ms);
+    }
+    break;
+
+  case CAN_WATCH_MODE_MINMAX:
+    if (w->window_open && now_ms - w->window_start_ms >= w->request.interval_ms) {
+      emit(w, CAN_WATCH_KIND_MIN, now_ms, w->window_min);
+      emit(w, CAN_WATCH_KIND_MAX, now_ms, w->window_max);
+      w->window_open = false;
+    }
+    break;
+  }
+}
+
+// Frame timestamps are the low 32 bits of esp_timer: rebuild the full time from the age
+static uint32_t frame_time_ms(uint32_t timestamp_us, int64_t now_us) {
+  uint32_t age_us = (uint32_t)now_us - timestamp_us;
+  return (uint32_t)((now_us - age_us) / 1000);
+}
+
+static void process_frame(const can_hub_frame_t *frame, int64_t now_us) {
+  if (!can_id_filter_match(&s_watched_ids, frame->id, frame->extended)) {
+    return;
+  }
+  s_stats.frames_matched++;
+
+  uint32_t timestamp_ms = frame_time_ms(frame->timestamp_us, now_us);
+  for (int i = 0; i < CAN_WATCH_MAX_SIGNALS; i++) {
+    watch_entry_t *w = &s_watches[i];
+    if (!w->used || frame->extended || w->msg->id != frame->id) {
+      continue;
+    }
+    float value;
+    if (vehicle_can_decode_signal(w->msg, w->sig_index, frame->data, frame->dlc, &value)) {
+      w->bus = frame->bus;
+      s_stats.values_decoded++;
+      watch_on_value(w, value, timestamp_ms);
+    }
+  }
+}
+
+static void can_watch_task(void *arg) {
+  (void)arg;
+  can_hub_frame_t frames[CAN_WATCH_HUB_READ_CHUNK];
+  int frame_count = 0; // Read from the hub
+  int frame_next  = 0; // Next one to decode
+  int64_t read_us = 0;
+
+  while (1) {
+    // Nothing to decode without subscriptions: sleep until the next one
+    ulTaskNotifyTake(pdTRUE, s_watch_count > 0 ? pdMS_TO_TICKS(CAN_WATCH_POLL_MS) : portMAX_DELAY);
+
+    // Rounds of decoding until the hub is drained and the timers ran, each ending with a
+    // delivery outside the mutex
+    bool ticked = false;
+    while (!ticked) {
+      can_watch_sink_t sinks[CAN_WATCH_MAX_SINKS];
+      xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+      bool drained = false;
+      while (s_batch_len + CAN_WATCH_FRAME_UPDATES_MAX <= CAN_WATCH_BATCH_MAX) {
+        if (frame_next < frame_count) {
+          process_frame(&frames[frame_next++], read_us);
+          continue;
+        }
+        uint32_t lost;
+        frame_count = can_hub_read(s_consumer, frames, CAN_WATCH_HUB_READ_CHUNK, &lost);
+        frame_next  = 0;
+        read_us     = esp_timer_get_time();
+        s_stats.frames_lost += lost;
+        if (frame_count == 0 && lost == 0) {
+          drained = true;
+          break;
+        }
+      }
+
+      // Rate and window timers, once the frames are in, into an empty batch
+      if (drained && s_batch_len == 0) {
+        uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+        for (int i = 0; i < CAN_WATCH_MAX_SIGNALS; i++) {
+          if (s_watches[i].used) {
+            watch_on_tick(&s_watches[i], now_ms);
+          }
+        }
+        ticked = true;
+      }
+
+      int count = s_batch_len;
+      memcpy(sinks, s_sinks, sizeof(sinks));
+      s_stats.updates_sent += count;
+      xSemaphoreGive(s_mutex);
+
+      for (int i = 0; i < CAN_WATCH_MAX_SINKS && count > 0; i++) {
+        if (sinks[i]) {
+          sinks[i](s_batch, count);
+        }
+      }
+      s_batch_len = 0;
+    }
+  }
+}
+
+static esp_err_t watch_init(void) {
+  if (s_mutex) {
+    return ESP_OK;
+  }
+
+  SemaphoreHandle_t mutex = xSemaphoreCreateMutex();
+  if (!mutex) {
+    return ESP_ERR_NO_MEM;
+  }
+
+  s_consumer = can_hub_register("signal_watch", &s_task_handle, CAN_WATCH_NOTIFY_FRAMES);
+  if (!s_consumer) {
+    vSemaphoreDelete(mutex);
+    return ESP_ERR_NO_MEM;
+  }
+  can_hub_set_enabled(s_consumer, false);
+  can_id_filter_clear(&s_watched_ids);
+  s_mutex = mutex;
+
+  if (create_task_on_general_core(can_watch_task, "can_watch", 4096, NULL, 6, &s_task_handle) != pdPASS) {
+    ESP_LOGE(TAG, "Failed to create watch task");
+    return ESP_FAIL;
+  }
+
+  ESP_LOGI(TAG, "Signal watch initialized");
+  return ESP_OK;
+}
+
+// Called with the mutex held after every table change
+static void update_watched_ids(void) {
+  can_id_filter_rule_t rules[CAN_WATCH_MAX_SIGNALS];
+  int count = 0;
+
+  for (int i = 0; i < CAN_WATCH_MAX_SIGNALS; i++) {
+    if (!s_watches[i].used) {
+      continue;
+    }
+    can_id_filter_rule_t rule = {.id = s_watches[i].msg->id, .mask = 0x7FF, .extended = false};
+    bool duplicate            = false;
+    for (int r = 0; r < count; r++) {
+      duplicate |= rules[r].id == rule.id;
+    }
+    if (!duplicate) {
+      rules[count++] = rule;
+    }
+  }
+  can_id_filter_set(&s_watched_ids, rules, count);
+
+  // The hub cursor only advances while something is watched
+  bool was_enabled = s_watch_count > 0;
+  s_watch_count    = 0;
+  for (int i = 0; i < CAN_WATCH_MAX_SIGNALS; i++) {
+    s_watch_count += s_watches[i].used ? 1 : 0;
+  }
+  s_stats.watch_count = s_watch_count;
+  if ((s_watch_count > 0) != was_enabled) {
+    can_hub_set_enabled(s_consumer, s_watch_count > 0);
+  }
+}
+
+esp_err_t can_signal_watch_add_sink(can_watch_sink_t sink) {
+  esp_err_t err = watch_init();
+  if (err != ESP_OK) {
+    return err;
+  }
+
+  err = ESP_ERR_NO_MEM;
+  xSemaphoreTake(s_mutex, portMAX_DELAY);
+  for (int i = 0; i < CAN_WATCH_MAX_SINKS; i++) {
+    if (s_sinks[i] == sink) {
+      err = ESP_OK;
+      break;
+    }
+    if (!s_sinks[i]) {
+      s_sinks[i] = sink;
+      err        = ESP_OK;
+      break;
+    }
+  }
+  xSemaphoreGive(s_mutex);
+  return err;
+}
+
+esp_err_t can_signal_watch_add(const can_watch_request_t *request, uint8_t *watch_id) {
+  if (!request || !watch_id || request->mode > CAN_WATCH_MODE_MINMAX) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  esp_err_t err = watch_init();
+  if (err != ESP_OK) {
+    return err;
+  }
+
+  // Resolved once: the watch task only compares IDs and decodes by index
+  uint16_t msg_index;
+  uint8_t sig_index;
+  err = vehicle_can_find_signal(request->name, &msg_index, &sig_index);
+  if (err != ESP_OK) {
+    ESP_LOGW(TAG, "Unknown signal: %s", request->name);
+    return err;
+  }
+
+  xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+  watch_entry_t *w = NULL;
+  for (int i = 0; i < CAN_WATCH_MAX_SIGNALS; i++) {
+    if (!s_watches[i].used) {
+      w = &s_watches[i];
+      break;
+    }
+  }
+  if (!w) {
+    xSemaphoreGive(s_mutex);
+    return ESP_ERR_NO_MEM;
+  }
+
+  memset(w, 0, sizeof(*w));
+  w->request                              = *request;
+  w->request.name[CAN_WATCH_NAME_MAX - 1] = '\0';
+  w->msg                                  = &g_can_messages[msg_index];
+  w->sig_index                            = sig_index;
+  w->watch_id                             = s_next_watch_id;
+  if (w->request.mode != CAN_WATCH_MODE_CHANGE && w->request.interval_ms < CAN_WATCH_MIN_INTERVAL_MS) {
+    w->request.interval_ms = CAN_WATCH_MIN_INTERVAL_MS;
+  }
+  w->used         = true;
+  s_next_watch_id = s_next_watch_id == UINT8_MAX ? 1 : s_next_watch_id + 1;
+  *watch_id       = w->watch_id;
+
+  update_watched_ids();
+  xSemaphoreGive(s_mutex);
+
+  xTaskNotifyGive(s_task_handle);
+  ESP_LOGI(TAG, "Watching %s (0x%03lX, id %u, mode %d, %u ms)", w->request.name, (unsigned long)w->msg->id, *watch_id, w->request.mode, w->request.interval_ms);
+  return ESP_OK;
+}
+
+esp_err_t can_signal_watch_remove(uint8_t watch_id) {
+  if (!s_mutex) {
+    return ESP_ERR_NOT_FOUND;
+  }
+
+  esp_err_t err = ESP_ERR_NOT_FOUND;
+  xSemaphoreTake(s_mutex, portMAX_DELAY);
+  for (int i = 0; i < CAN_WATCH_MAX_SIGNALS; i++) {
+    if (s_watches[i].used && s_watches[i].watch_id == watch_id) {
+      s_watches[i].used = false;
+      err               = ESP_OK;
+      break;
+    }
+  }
+  if (err == ESP_OK) {
+    update_watched_ids();
+  }
+  xSemaphoreGive(s_mutex);
+  return err;
+}
+
+void can_signal_watch_clear(void) {
+  if (!s_mutex) {
+    return;
+  }
+
+  xSemaphoreTake(s_mutex, portMAX_DELAY);
+  for (int i = 0; i < CAN_WATCH_MAX_SIGNALS; i++) {
+    s_watches[i].used = false;
+  }
+  update_watched_ids();
+  xSemaphoreGive(s_mutex);
+}
+
+esp_err_t can_signal_watch_get_info(int index, can_watch_info_t *info) {
+  if (index < 0 || index >= CAN_WATCH_MAX_SIGNALS || !info) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (!s_mutex) {
+    return ESP_ERR_NOT_FOUND;
+  }
+
+  esp_err_t err = ESP_ERR_NOT_FOUND;
+  xSemaphoreTake(s_mutex, portMAX_DELAY);
+  const watch_entry_t *w = &s_watches[index];
+  if (w->used) {
+    info->watch_id   = w->watch_id;
+    info->request    = w->request;
+    info->can_id     = w->msg->id;
+    info->bus        = w->bus;
+    info->has_value  = w->has_value;
+    info->last_value = w->last_value;
+    info->decoded    = w->decoded;
+    info->sent       = w->sent;
+    err              = ESP_OK;
+  }
+  xSemaphoreGive(s_mutex);
+  return err;
+}
+
+void can_signal_watch_get_stats(can_watch_stats_t *stats) {
+  if (stats) {
+    *stats = s_stats;
+  }
+}
@@ -1,5 +1,7 @@
 #include "canserver_udp_server.h"
 
+#include "can_frame_hub.h"
+#include "can_id_filter.h"
 #include "can_servers_config.h"
 #include "esp_log.h"
 #include "esp_timer.h"
@@ -22,6 +24,13 @@ static const char *TAG = "CANSERVER_UDP";
 #define CANSERVER_RX_BUFFER_SIZE 128
 #define CANSERVER_KEEPALIVE_TIMEOUT_MS 5000 // 5 seconds timeout
 #define MAX_FRAMES_PER_PACKET 120           // Up to ~1900 bytes per UDP packet
+#define CANSERVER_HUB_READ_CHUNK 16
+
+// Adaptive batching interval: shortened when packets fill up, stretched when traffic is low
+#define CANSERVER_BATCH_MIN_MS 2
+#define CANSERVER_BATCH_MAX_MS 20
+#define CANSERVER_BATCH_DEFAULT_MS 10
+#define CANSERVER_EARLY_SEND_FRAMES (MAX_FRAMES_PER_PACKET * 3 / 4) // Wake TX task when a client has this many frames waiting
 
 // Panda Protocol Format
 // Panda protocol uses UDP with a simple binary format:
@@ -33,22 +42,36 @@ static const char *TAG = "CANSERVER_UDP";
 // [0-3]   : f1 (uint32_t LE) - (CAN ID << 21) | (extended << 31)
 // [4-7]   : f2 (uint32_t LE) - (length & 0x0F) | (busId << 4)
 // [8-15]  : data[8] (uint8_t[8]) - CAN payload (zero-padded if DLC < 8)
+//
+// Filter control packets (sent by a registered client, filters apply to both buses):
+// 0x0F [bus:1] [id:2 BE] ...   add exact 11-bit IDs (bus byte ignored)
+// 0x0E [bus:1] [id:2 BE] ...   remove exact 11-bit IDs
+// 0x10 [id:4 BE] [mask:4 BE]   add an ID/mask rule (bit 31 of id = extended)
+// 0x18                         clear all filters (stream every frame)
 
 #define PANDA_MSG_SIZE 16
 
+#define PANDA_CTRL_FILTER_ADD 0x0F
+#define PANDA_CTRL_FILTER_REMOVE 0x0E
+#define PANDA_CTRL_FILTER_MASK 0x10
+#define PANDA_CTRL_FILTER_CLEAR 0x18
+
+// Frame hub consumer names (one consumer per client slot)
+static const char *const hub_consumer_names[MAX_CANSERVER_CLIENTS] = {"canserver0", "canserver1", "canserver2", "canserver3"};
+
 // Client structure
 typedef struct {
   struct sockaddr_in addr;
-  bool active;
+  volatile bool active;
   uint64_t last_ping_time; // Timestamp of last ping (microseconds)
   uint32_t frames_sent;
-} canserver_client_t;
 
-// Frame buffer for batching
-typedef struct {
-  uint8_t data[PANDA_MSG_SIZE * MAX_FRAMES_PER_PACKET];
-  int count;
-} frame_buffer_t;
+  // Read cursor in the shared frame hub and packet buffer, allocated on first
+  // registration of the slot and reused by the next client
+  can_hub_consumer_t *hub;
+  uint8_t *packet; // MAX_FRAMES_PER_PACKET encoded frames, sent in place
+  can_id_filter_t filter;
+} canserver_client_t;
 
 // Server state
 static bool server_initialized     = false;
@@ -57,10 +80,14 @@ static int udp_socket              = -1;
 static TaskHandle_t rx_task_handle = NULL;
 static TaskHandle_t tx_task_handle = NULL;
 static canserver_client_t clients[MAX_CANSERVER_CLIENTS];
-static SemaphoreHandle_t clients_mutex = NULL;
-static frame_buffer_t frame_buffer;
-static SemaphoreHandle_t buffer_mutex = NULL;
-static bool has_active_clients        = false; // Cached client status for fast check
+static SemaphoreHandle_t clients_mutex     = NULL;
+
+// Statistics (TX task only)
+static uint32_t stat_frames_queued         = 0;
+static uint32_t stat_frames_dropped        = 0;
+static uint32_t stat_packets_sent          = 0;
+static uint32_t stat_send_errors           = 0;
+static volatile uint32_t batch_interval_ms = CANSERVER_BATCH_DEFAULT_MS;
 
 // ============================================================================
 // Panda Protocol Frame Encoding
@@ -74,19 +101,16 @@ static bool has_active_clients        = false; // Cached client status for fast
  * [4-7]   : f2 (uint32_t LE) - (length & 0x0F) | (busId << 4)
  * [8-15]  : data[8] (uint8_t[8]) - CAN payload (zero-padded if DLC < 8)
  *
- * IRAM_ATTR: Called for every CAN frame received (~2000 fps), pure encoding logic
- *
- * @param bus Bus number (0 or 1)
- * @param msg TWAI message
+ * @param frame Frame read from the hub
  * @param out_frame Output buffer (must be at least 16 bytes)
  */
-static void IRAM_ATTR encode_panda_frame(int bus, const twai_message_t *msg, uint8_t *out_frame) {
+static void encode_panda_frame(const can_hub_frame_t *frame, uint8_t *out_frame) {
   // Clear output buffer
   memset(out_frame, 0, PANDA_MSG_SIZE);
 
   // f1 field (bytes 0-3): CAN ID << 21 (+ extended flag on bit 31)
-  uint32_t f1 = (msg->identifier & 0x1FFFFFFF) << 21;
-  if (msg->extd) {
+  uint32_t f1 = (frame->id & 0x1FFFFFFF) << 21;
+  if (frame->extended) {
     f1 |= (1u << 31);
   }
   out_frame[0] = (f1 >> 0) & 0xFF;
@@ -95,7 +119,7 @@ static void IRAM_ATTR encode_panda_frame(int bus, const twai_message_t *msg, uin
   out_frame[3] = (f1 >> 24) & 0xFF;
 
   // f2 field (bytes 4-7): DLC + bus
-  uint32_t f2  = (msg->data_length_code & 0x0F) | ((uint32_t)bus << 4);
+  uint32_t f2  = (frame->dlc & 0x0F) | ((uint32_t)frame->bus << 4);
   out_frame[4] = (f2 >> 0) & 0xFF;
   out_frame[5] = (f2 >> 8) & 0xFF;
   out_frame[6] = (f2 >> 16) & 0xFF;
@@ -103,8 +127,8 @@ static void IRAM_ATTR encode_panda_frame(int bus, const twai_message_t *msg, uin
 
   // Data field (bytes 8-15): CAN payload (8 bytes, zero-padded)
   for (int i = 0; i < 8; i++) {
-    if (i < msg->data_length_code) {
-      out_frame[8 + i] = msg->data[i];
+    if (i < frame->dlc) {
+      out_frame[8 + i] = frame->data[i];
     } else {
       out_frame[8 + i] = 0; // Zero padding
     }
@@ -133,12 +157,35 @@ static canserver_client_t *find_free_client_slot(void) {
   return NULL;
 }
 
+/**
+ * @brief Allocate (once) the packet buffer and hub consumer of a client slot, reset its filter
+ */
+static bool client_prepare(canserver_client_t *client) {
+  if (!client->packet) {
+    client->packet = malloc(PANDA_MSG_SIZE * MAX_FRAMES_PER_PACKET);
+    if (!client->packet) {
+      return false;
+    }
+  }
+  if (!client->hub) {
+    client->hub = can_hub_register(hub_consumer_names[client - clients], &tx_task_handle, CANSERVER_EARLY_SEND_FRAMES);
+    if (!client->hub) {
+      return false;
+    }
+  }
+
+  can_id_filter_clear(&client->filter);
+
+  // Start streaming from the newest frame
+  can_hub_set_enabled(client->hub, true);
+  return true;
+}
+
 static void remove_stale_clients(void) {
   uint64_t now        = esp_timer_get_time();
   uint64_t timeout_us = CANSERVER_KEEPALIVE_TIMEOUT_MS * 1000ULL;
 
   xSemaphoreTake(clients_mutex, portMAX_DELAY);
-  bool clients_changed = false;
   for (int i = 0; i < MAX_CANSERVER_CLIENTS; i++) {
     if (clients[i].active) {
       if ((now - clients[i].last_ping_time) > timeout_us) {
@@ -146,18 +193,7 @@ static void remove_stale_clients(void) {
         inet_ntop(AF_INET, &clients[i].addr.sin_addr, ip_str, sizeof(ip_str));
         ESP_LOGI(TAG, "Client %s:%d timed out (no ping for >5s), removing", ip_str, ntohs(clients[i].addr.sin_port));
         clients[i].active = false;
-        clients_changed   = true;
-      }
-    }
-  }
-
-  // Update cached status if clients changed
-  if (clients_changed) {
-    has_active_clients = false;
-    for (int i = 0; i < MAX_CANSERVER_CLIENTS; i++) {
-      if (clients[i].active) {
-        has_active_clients = true;
-        break;
+        can_hub_set_enabled(clients[i].hub, false);
       }
     }
   }
@@ -168,6 +204,47 @@ static void remove_stale_clients(void) {
 // RX Task - Handle incoming UDP packets (pings/hello)
 // ============================================================================
 
+/**
+ * @brief Apply a filter control packet from a registered client
+ *
+ * Called with clients_mutex held. Packets that are not filter commands (pings) are ignored.
+ */
+static void process_filter_packet(canserver_client_t *client, const uint8_t *data, int len) {
+  can_id_filter_rule_t rule;
+  esp_err_t err = ESP_OK;
+
+  switch (data[0]) {
+  case PANDA_CTRL_FILTER_ADD:
+  case PANDA_CTRL_FILTER_REMOVE:
+    for (int off = 1; off + 3 <= len && err == ESP_OK; off += 3) {
+      rule.id       = ((uint32_t)data[off + 1] << 8) | data[off + 2];
+      rule.mask     = 0x7FF;
+      rule.extended = false;
+      err           = data[0] == PANDA_CTRL_FILTER_ADD ? can_id_filter_add(&client->filter, &rule) : can_id_filter_remove(&client->filter, &rule);
+    }
+    break;
+
+  case PANDA_CTRL_FILTER_MASK:
+    for (int off = 1; off + 8 <= len && err == ESP_OK; off += 8) {
+      uint32_t id   = ((uint32_t)data[off] << 24) | (data[off + 1] << 16) | (data[off + 2] << 8) | data[off + 3];
+      rule.id       = id & 0x1FFFFFFF;
+      rule.extended = (id & (1u << 31)) != 0;
+      rule.mask     = ((uint32_t)data[off + 4] << 24) | (data[off + 5] << 16) | (data[off + 6] << 8) | data[off + 7];
+      err           = can_id_filter_add(&client->filter, &rule);
+    }
+    break;
+
+  case PANDA_CTRL_FILTER_CLEAR:
+    can_id_filter_clear(&client->filter);
+    break;
+
+  default:
+    return; // Ping
+  }
+
+  ESP_LOGI(TAG, "Filter packet 0x%02X (%d bytes): %s, %d rule(s)", data[0], len, esp_err_to_name(err), client->filter.rule_count);
+}
+
 static void canserver_rx_task(void *arg) {
   uint8_t rx_buf[CANSERVER_RX_BUFFER_SIZE];
   struct sockaddr_in client_addr;
@@ -213,12 +290,13 @@ static void canserver_rx_task(void *arg) {
 
       if (is_hello) {
         client = find_free_client_slot();
-        if (client) {
+        if (client && !client_prepare(client)) {
+          ESP_LOGE(TAG, "Failed to allocate packet buffers for %s:%d", client_ip, ntohs(client_addr.sin_port));
+        } else if (client) {
           client->addr           = client_addr;
           client->active         = true;
           client->last_ping_time = esp_timer_get_time();
           client->frames_sent    = 0;
-          has_active_clients     = true; // Update cached status
           ESP_LOGI(TAG, "New client registered: %s:%d (received %d bytes)", client_ip, ntohs(client_addr.sin_port), len);
         } else {
           ESP_LOGW(TAG, "Max clients reached, ignoring hello from %s:%d", client_ip, ntohs(client_addr.sin_port));
@@ -238,6 +316,7 @@ static void canserver_rx_task(void *arg) {
     } else {
       // Existing client - update ping time
       client->last_ping_time = esp_timer_get_time();
+      process_filter_packet(client, rx_buf, len);
     }
 
     xSemaphoreGive(clients_mutex);
@@ -251,93 +330,132 @@ static void canserver_rx_task(void *arg) {
 // TX Task - Send buffered frames to clients
 // ============================================================================
 
-static void canserver_tx_task(void *arg) {
-  ESP_LOGI(TAG, "TX task started");
+// Adjust the batching interval so a packet is about half full when sent
+static void adapt_batch_interval(int frame_count) {
+  uint32_t interval = batch_interval_ms;
 
-  while (server_running) {
-    // Wait a bit to accumulate frames (keep small to limit drops)
-    vTaskDelay(pdMS_TO_TICKS(10)); // 10ms batching interval
+  if (frame_count >= CANSERVER_EARLY_SEND_FRAMES) {
+    interval = interval / 2;
+  } else if (frame_count < MAX_FRAMES_PER_PACKET / 4) {
+    interval = interval + 2;
+  }
 
-    // Remove stale clients
-    remove_stale_clients();
+  batch_interval_ms = MAX(CANSERVER_BATCH_MIN_MS, MIN(interval, CANSERVER_BATCH_MAX_MS));
+}
 
-    // Get buffered frames
-    xSemaphoreTake(buffer_mutex, portMAX_DELAY);
-    int frame_count = frame_buffer.count;
+/**
+ * @brief Encode the client's pending hub frames into its packet buffer
+ *
+ * Frames filtered out by the client are skipped without being encoded.
+ *
+ * @return Number of frames in the packet (MAX_FRAMES_PER_PACKET when more may be waiting)
+ */
+static int client_fill_packet(canserver_client_t *client) {
+  can_hub_frame_t frames[CANSERVER_HUB_READ_CHUNK];
+  int frame_count = 0;
+
+  while (frame_count < MAX_FRAMES_PER_PACKET) {
+    int want = MIN(MAX_FRAMES_PER_PACKET - frame_count, CANSERVER_HUB_READ_CHUNK);
+    uint32_t lost;
+    int count = can_hub_read(client->hub, frames, want, &lost);
+    stat_frames_dropped += lost;
+
+    for (int n = 0; n < count; n++) {
+      if (can_id_filter_match(&client->filter, frames[n].id, frames[n].extended)) {
+        encode_panda_frame(&frames[n], &client->packet[frame_count * PANDA_MSG_SIZE]);
+        frame_count++;
+      }
+    }
 
-    if (frame_count == 0) {
-      xSemaphoreGive(buffer_mutex);
-      continue;
+    if (count < want) {
+      break; // Caught up
     }
+  }
 
-    // Copy buffer for sending
-    uint8_t send_buf[PANDA_MSG_SIZE * MAX_FRAMES_PER_PACKET];
-    int send_len = frame_count * PANDA_MSG_SIZE;
-    memcpy(send_buf, frame_buffer.data, send_len);
+  stat_frames_queued += frame_count;
+  return frame_count;
+}
+
+static void send_client_packet(canserver_client_t *client, int index, int frame_count) {
+  int send_len          = frame_count * PANDA_MSG_SIZE;
+
+  // Retry mechanism for ENOMEM (errno 12 - buffer full)
+  int retry_count       = 0;
+  const int max_retries = 3;
+  int sent              = -1;
+
+  while (retry_count < max_retries) {
+    sent = sendto(udp_socket, client->packet, send_len, 0, (struct sockaddr *)&client->addr, sizeof(client->addr));
 
-    // Clear buffer
-    frame_buffer.count = 0;
-    xSemaphoreGive(buffer_mutex);
+    if (sent == send_len) {
+      client->frames_sent += frame_count;
+      stat_packets_sent++;
 
-    // Send to all active clients
+      // Log every 50 frames to confirm data is flowing
+      if (client->frames_sent % 50 < frame_count) {
+        char ip_str[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &client->addr.sin_addr, ip_str, sizeof(ip_str));
+        ESP_LOGD(TAG, "Sent %u frames to %s:%d (batch: %d, size: %d bytes)", client->frames_sent, ip_str, ntohs(client->addr.sin_port), frame_count, send_len);
+      }
+      return;
+    } else if (sent < 0 && errno == ENOMEM) {
+      // Buffer full, wait and retry
+      retry_count++;
+      if (retry_count < max_retries) {
+        vTaskDelay(pdMS_TO_TICKS(2));
+      }
+    } else {
+      break;
+    }
+  }
+
+  stat_send_errors++;
+  if (sent < 0 && errno == ENOMEM) {
+    ESP_LOGW(TAG, "sendto() to client %d failed after %d retries: ENOMEM (buffer full)", index, max_retries);
+  } else {
+    ESP_LOGW(TAG, "sendto() to client %d failed: %d (%s)", index, errno, strerror(errno));
+  }
+}
+
+static void canserver_tx_task(void *arg) {
+  ESP_LOGI(TAG, "TX task started");
+
+  while (server_running) {
+    // Wait to accumulate frames; the frame hub wakes us early when a client has a packet's worth waiting
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(batch_interval_ms));
+
+    // Remove stale clients
+    remove_stale_clients();
+
+    // Encode each client's frames straight into its packet buffer and send it in place
+    int max_frames = 0;
     xSemaphoreTake(clients_mutex, portMAX_DELAY);
-    int sent_count   = 0;
-    int active_count = 0;
 
     for (int i = 0; i < MAX_CANSERVER_CLIENTS; i++) {
-      if (clients[i].active) {
-        active_count++;
-
-        // Retry mechanism for ENOMEM (errno 12 - buffer full)
-        int retry_count       = 0;
-        const int max_retries = 3;
-        int sent              = -1;
-
-        while (retry_count < max_retries) {
-          sent = sendto(udp_socket, send_buf, send_len, 0, (struct sockaddr *)&clients[i].addr, sizeof(clients[i].addr));
-
-          if (sent == send_len) {
-            clients[i].frames_sent += frame_count;
-            sent_count++;
-
-            // Log every 50 frames to confirm data is flowing
-            if (clients[i].frames_sent % 50 < frame_count) {
-              char ip_str[INET_ADDRSTRLEN];
-              inet_ntop(AF_INET, &clients[i].addr.sin_addr, ip_str, sizeof(ip_str));
-              ESP_LOGI(TAG, "Sent %u frames to %s:%d (batch: %d, size: %d bytes)", clients[i].frames_sent, ip_str, ntohs(clients[i].addr.sin_port), frame_count, send_len);
-            }
-            break;
-          } else if (sent < 0 && errno == ENOMEM) {
-            // Buffer full, wait and retry
-            retry_count++;
-            if (retry_count < max_retries) {
-              vTaskDelay(pdMS_TO_TICKS(20)); // Wait 20ms before retry
-            }
-          } else if (sent < 0) {
-            // Other error (or ENOMEM after max retries), don't retry
-            if (errno == ENOMEM) {
-              ESP_LOGW(TAG, "sendto() to client %d failed after %d retries: ENOMEM (buffer full)", i, max_retries);
-            } else {
-              ESP_LOGW(TAG, "sendto() to client %d failed: %d (%s)", i, errno, strerror(errno));
-            }
-            break;
-          }
-        }
+      canserver_client_t *client = &clients[i];
+      if (!client->active || !client->hub) {
+        continue;
+      }
 
-        // Small delay between sends to avoid overwhelming the network
-        vTaskDelay(pdMS_TO_TICKS(5));
+      int frame_count = client_fill_packet(client);
+      max_frames      = MAX(max_frames, frame_count);
+
+      // A full packet means more frames may be waiting: keep sending until caught up
+      while (frame_count > 0) {
+        send_client_packet(client, i, frame_count);
+        if (frame_count < MAX_FRAMES_PER_PACKET || !server_running) {
+          break;
+        }
+        frame_count = client_fill_packet(client);
       }
     }
 
     xSemaphoreGive(clients_mutex);
-
-    // if (active_count > 0 && sent_count == 0) {
-    //     ESP_LOGW(TAG, "Failed to send %d frames to %d active client(s)",
-    //              frame_count, active_count);
-    // }
+    adapt_batch_interval(max_frames);
   }
 
   ESP_LOGI(TAG, "TX task stopped");
+  tx_task_handle = NULL;
   vTaskDelete(NULL);
 }
 
@@ -350,11 +468,10 @@ esp_err_t canserver_udp_server_init(void) {
     return ESP_OK;
   }
 
-  // Create mutexes
+  // Create mutex for client array
   clients_mutex = xSemaphoreCreateMutex();
-  buffer_mutex  = xSemaphoreCreateMutex();
-  if (!clients_mutex || !buffer_mutex) {
-    ESP_LOGE(TAG, "Failed to create mutexes");
+  if (!clients_mutex) {
+    ESP_LOGE(TAG, "Failed to create mutex");
     return ESP_ERR_NO_MEM;
   }
 
@@ -364,9 +481,6 @@ esp_err_t canserver_udp_server_init(void) {
     clients[i].active = false;
   }
 
-  // Initialize frame buffer
-  memset(&frame_buffer, 0, sizeof(frame_buffer));
-
   server_initialized = true;
   ESP_LOGI(TAG, "CANServer UDP server initialized");
   return ESP_OK;
@@ -460,6 +574,7 @@ void canserver_udp_server_stop(void) {
   xSemaphoreTake(clients_mutex, portMAX_DELAY);
   for (int i = 0; i < MAX_CANSERVER_CLIENTS; i++) {
     clients[i].active = false;
+    can_hub_set_enabled(clients[i].hub, false);
   }
   xSemaphoreGive(clients_mutex);
 
@@ -487,38 +602,55 @@ int canserver_udp_server_get_client_count(void) {
   return count;
 }
 
-void canserver_udp_broadcast_can_frame(int bus, const twai_message_t *msg) {
-  if (!server_running) {
-    return;
-  }
-
-  // Fast check: if no clients, don't process frames at all (no mutex needed)
-  if (!has_active_clients) {
-    return; // No clients connected, skip processing
+esp_err_t canserver_udp_server_get_stats(canserver_udp_stats_t *out) {
+  if (!out) {
+    return ESP_ERR_INVALID_ARG;
   }
 
-  static uint32_t frame_rx_count = 0;
-  frame_rx_count++;
+  out->frames_queued     = stat_frames_queued;
+  out->frames_dropped    = stat_frames_dropped;
+  out->packets_sent      = stat_packets_sent;
+  out->send_errors       = stat_send_errors;
+  out->batch_interval_ms = batch_interval_ms;
+  return ESP_OK;
+}
 
-  // Log every 100 frames to confirm CAN data is being received
-  if (frame_rx_count % 100 == 0) {
-    ESP_LOGI(TAG, "Received %u CAN frames for broadcast (bus %d, ID 0x%03X)", frame_rx_count, bus, msg->identifier);
+esp_err_t canserver_udp_server_set_client_filters(int slot, const can_id_filter_rule_t *rules, int count) {
+  if (slot < 0 || slot >= MAX_CANSERVER_CLIENTS) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (!server_initialized) {
+    return ESP_ERR_INVALID_STATE;
   }
 
-  // Encode frame
-  uint8_t frame[PANDA_MSG_SIZE];
-  encode_panda_frame(bus, msg, frame);
+  xSemaphoreTake(clients_mutex, portMAX_DELAY);
+  esp_err_t err = clients[slot].active ? can_id_filter_set(&clients[slot].filter, rules, count) : ESP_ERR_NOT_FOUND;
+  xSemaphoreGive(clients_mutex);
+
+  return err;
+}
 
-  // Add to buffer
-  xSemaphoreTake(buffer_mutex, portMAX_DELAY);
+esp_err_t canserver_udp_server_get_client_filters(int slot, can_id_filter_client_info_t *out) {
+  if (slot < 0 || slot >= MAX_CANSERVER_CLIENTS || !out) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  memset(out, 0, sizeof(*out));
+  if (!server_initialized) {
+    return ESP_ERR_INVALID_STATE;
+  }
 
-  if (frame_buffer.count < MAX_FRAMES_PER_PACKET) {
-    memcpy(&frame_buffer.data[frame_buffer.count * PANDA_MSG_SIZE], frame, PANDA_MSG_SIZE);
-    frame_buffer.count++;
+  xSemaphoreTake(clients_mutex, portMAX_DELAY);
+  canserver_client_t *client = &clients[slot];
+  out->active                = client->active;
+  if (client->active) {
+    inet_ntop(AF_INET, &client->addr.sin_addr, out->ip, sizeof(out->ip));
+    out->port       = ntohs(client->addr.sin_port);
+    out->rule_count = client->filter.rule_count;
+    memcpy(out->rules, client->filter.rules, sizeof(out->rules));
   }
-  // Silently drop if buffer full (will be sent soon by TX task)
+  xSemaphoreGive(clients_mutex);
 
-  xSemaphoreGive(buffer_mutex);
+  return ESP_OK;
 }
 
 // ============================================================================
@@ -12,6 +12,7 @@
 
 #include "config_manager.h"
 
+#include "anim_clock.h"
 #include "audio_input.h"
 #include "cJSON.h"
 #include "config.h"
@@ -22,6 +23,7 @@
 #include "led_effects.h"
 #include "nvs.h"
 #include "nvs_flash.h"
+#include "render_worker.h"
 #include "settings_manager.h"
 #include "spiffs_storage.h"
 
@@ -82,20 +84,26 @@ static uint8_t wheel_control_speed_limit               = 5; // km/h
 typedef struct {
   can_event_type_t event;
   effect_config_t effect_config;
-  uint32_t start_time;
+  uint32_t start_ms; // Animation clock: identical on the ESP-NOW master and its slaves
   uint16_t duration_ms;
   uint8_t priority;
-  bool active;
 } active_event_t;
 
+_Static_assert(MAX_ACTIVE_EVENTS <= LED_LAYER_EVENT_COUNT, "One render layer per active event");
+_Static_assert(MAX_ACTIVE_EVENTS <= 16, "free_slots is a 16-bit mask");
+
+// Active events are indexed both ways: event -> slot, and the active slots sorted from the
+// top layer down (highest priority first, the higher slot first between equal priorities).
+// Written by the CAN/ESP-NOW tasks, read by the LED task: changes are made under the lock.
 static active_event_t active_events[MAX_ACTIVE_EVENTS];
+static uint8_t event_slot[CAN_EVENT_MAX]; // Slot + 1, 0 when the event is not active
+static uint8_t active_order[MAX_ACTIVE_EVENTS];
+static uint8_t active_count            = 0;
+static uint16_t free_slots             = (1u << MAX_ACTIVE_EVENTS) - 1;
+static portMUX_TYPE active_events_lock = portMUX_INITIALIZER_UNLOCKED;
+static config_manager_compositor_stats_t compositor_stats;
 static bool effect_override_active = false;
 
-// Buffers for composed LED rendering
-static led_rgb_t composed_buffer[MAX_LED_COUNT];
-static led_rgb_t temp_buffer[MAX_LED_COUNT];
-static uint8_t priority_buffer[MAX_LED_COUNT];
-
 // Profile registry helper functions for O(1) lookup
 static inline void profile_registry_set(uint16_t profile_id) {
   if (profile_id >= MAX_PROFILE_SCAN_LIMIT)
@@ -789,8 +797,45 @@ bool config_manager_set_event_enabled(uint16_t profile_id, can_event_type_t even
   return success;
 }
 
+// Layer order: a is drawn above b (caller holds active_events_lock)
+static bool slot_above(uint8_t a, uint8_t b) {
+  if (active_events[a].priority != active_events[b].priority) {
+    return active_events[a].priority > active_events[b].priority;
+  }
+  return a > b;
+}
+
+static void order_insert(uint8_t slot) {
+  uint8_t pos = active_count++;
+  while (pos > 0 && slot_above(slot, active_order[pos - 1])) {
+    active_order[pos] = active_order[pos - 1];
+    pos--;
+  }
+  active_order[pos] = slot;
+}
+
+static void order_remove(uint8_t slot) {
+  for (uint8_t k = 0; k < active_count; k++) {
+    if (active_order[k] == slot) {
+      memmove(active_order + k, active_order + k + 1, active_count - k - 1);
+      active_count--;
+      return;
+    }
+  }
+}
+
+static void release_slot(uint8_t slot) {
+  order_remove(slot);
+  event_slot[active_events[slot].event] = 0;
+  free_slots |= 1u << slot;
+}
+
 bool config_manager_process_can_event(can_event_type_t event) {
-  if (!active_profile_loaded || event > CAN_EVENT_MAX) {
+  return config_manager_process_can_event_at(event, anim_clock_now_ms());
+}
+
+bool config_manager_process_can_event_at(can_event_type_t event, uint32_t start_ms) {
+  if (!active_profile_loaded || event >= CAN_EVENT_MAX) {
     return false;
   }
 
@@ -813,72 +858,59 @@ bool config_manager_process_can_event(can_event_type_t event) {
   // If the effect is configured and enabled, use it
   if (event_effect->enabled) {
     memcpy(&effect_to_apply, &event_effect->effect_config, sizeof(effect_config_t));
-    duration_ms            = event_effect->duration_ms;
-    priority               = event_effect->priority;
+    duration_ms              = event_effect->duration_ms;
+    priority                 = event_effect->priority;
     // For CAN events, only use color1 for all colors
-    effect_to_apply.color2 = effect_to_apply.color1;
-    effect_to_apply.color3 = effect_to_apply.color1;
+    effect_to_apply.color2   = effect_to_apply.color1;
+    effect_to_apply.color3   = effect_to_apply.color1;
     // if(effect_to_apply.segment_length == 0) {
     //   effect_to_apply.segment_length = total_leds;
     // }
 
-    // Find a free slot for the event
-    int slot               = -1;
-    int existing_slot      = -1;
-    int free_slot          = -1;
+    int slot                 = -1;
+    bool existing            = false;
+    bool evicted             = false;
+    uint8_t evicted_priority = 0;
+
+    portENTER_CRITICAL(&active_events_lock);
+    if (event_slot[event] != 0) {
+      // The event is already active: update it
+      slot     = event_slot[event] - 1;
+      existing = true;
+      order_remove(slot);
+    } else if (free_slots != 0) {
+      slot = __builtin_ctz(free_slots);
+      free_slots &= ~(1u << slot);
+    } else if (active_events[active_order[active_count - 1]].priority < priority) {
+      // No free slot: take over the lowest priority event if the new one is higher
+      slot             = active_order[active_count - 1];
+      evicted          = true;
+      evicted_priority = active_events[slot].priority;
+      order_remove(slot);
+      event_slot[active_events[slot].event] = 0;
+    }
 
-    // Check if the event is already active or find a free slot
-    for (int i = 0; i < MAX_ACTIVE_EVENTS; i++) {
-      if (active_events[i].active && active_events[i].event == event) {
-        existing_slot = i;
-        break;
-      }
-      if (!active_events[i].active && free_slot == -1) {
-        free_slot = i;
+    if (slot >= 0) {
+      // Save the active event
+      active_events[slot].event         = event;
+      active_events[slot].effect_config = effect_to_apply;
+      active_events[slot].duration_ms   = duration_ms;
+      active_events[slot].priority      = priority;
+      // Keep animation phase of a running event; only reset timer for finite-duration events
+      if (!existing || duration_ms > 0) {
+        active_events[slot].start_ms = start_ms;
       }
+      event_slot[event] = slot + 1;
+      order_insert(slot);
     }
-
-    // If the event already exists, update it
-    slot = (existing_slot >= 0) ? existing_slot : free_slot;
+    portEXIT_CRITICAL(&active_events_lock);
 
     if (slot < 0) {
-      // No free slot, check if a lower priority event can be overwritten
-      // lower priority BUT only if it is the same zone or if the new
-      // event is FULL
-      int lowest_priority_slot = -1;
-      uint8_t lowest_priority  = 255;
-
-      for (int i = 0; i < MAX_ACTIVE_EVENTS; i++) {
-        if (active_events[i].active && active_events[i].priority < priority && active_events[i].priority < lowest_priority) {
-          // New event has higher priority, we can overwrite
-          lowest_priority      = active_events[i].priority;
-          lowest_priority_slot = i;
-        }
-      }
-
-      if (lowest_priority_slot >= 0) {
-        slot = lowest_priority_slot;
-        ESP_LOGI(TAG_CONFIG, "Overwriting event priority %d with priority %d", lowest_priority, priority);
-      } else {
-        ESP_LOGW(TAG_CONFIG, "Event '%s' ignored (no available slot)", config_manager_enum_to_id(event));
-        return false;
-      }
+      ESP_LOGW(TAG_CONFIG, "Event '%s' ignored (no available slot)", config_manager_enum_to_id(event));
+      return false;
     }
-
-    // Save the active event
-    active_events[slot].event         = event;
-    active_events[slot].effect_config = effect_to_apply;
-    active_events[slot].duration_ms   = duration_ms;
-    active_events[slot].priority      = priority;
-    active_events[slot].active        = true;
-
-    if (existing_slot >= 0) {
-      // Keep animation phase; only reset timer for finite-duration events
-      if (duration_ms > 0) {
-        active_events[slot].start_time = xTaskGetTickCount();
-      }
-    } else {
-      active_events[slot].start_time = xTaskGetTickCount();
+    if (evicted) {
+      ESP_LOGI(TAG_CONFIG, "Overwriting event priority %d with priority %d", evicted_priority, priority);
     }
 
     // DO NOT apply immediately - let config_manager_update() handle it
@@ -905,22 +937,166 @@ void config_manager_stop_event(can_event_type_t event) {
     return;
   }
 
-  // Disable all slots that match this event
-  for (int i = 0; i < MAX_ACTIVE_EVENTS; i++) {
-    if (active_events[i].active && active_events[i].event == event) {
-      ESP_LOGI(TAG_CONFIG, "Stopping event '%s'", config_manager_enum_to_id(event));
-      active_events[i].active = false;
-    }
+  portENTER_CRITICAL(&active_events_lock);
+  bool stopped = event_slot[event] != 0;
+  if (stopped) {
+    release_slot(event_slot[event] - 1);
+  }
+  portEXIT_CRITICAL(&active_events_lock);
+
+  if (stopped) {
+    ESP_LOGI(TAG_CONFIG, "Stopping event '%s'", config_manager_enum_to_id(event));
   }
 }
 
 void config_manager_stop_all_events(void) {
-  for (int i = 0; i < MAX_ACTIVE_EVENTS; i++) {
-    if (active_events[i].active) {
-      ESP_LOGI(TAG_CONFIG, "Stopping event '%s' globally", config_manager_enum_to_id(active_events[i].event));
-      active_events[i].active = false;
+  while (true) {
+    can_event_type_t event = CAN_EVENT_NONE;
+    bool stopped           = false;
+
+    portENTER_CRITICAL(&active_events_lock);
+    if (active_count > 0) {
+      uint8_t slot = active_order[active_count - 1];
+      event        = active_events[slot].event;
+      stopped      = true;
+      release_slot(slot);
+    }
+    portEXIT_CRITICAL(&active_events_lock);
+
+    if (!stopped) {
+      break;
+    }
+    ESP_LOGI(TAG_CONFIG, "Stopping event '%s' globally", config_manager_enum_to_id(event));
+  }
+}
+
+// LED interval [start, end)
+typedef struct {
+  uint16_t start;
+  uint16_t end;
+} led_span_t;
+
+static bool span_covered(const led_span_t *covered, uint8_t count, uint16_t start, uint16_t end) {
+  if (start >= end) {
+    return true;
+  }
+  for (uint8_t i = 0; i < count && covered[i].start <= start; i++) {
+    if (covered[i].end >= end) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Add [start, end) to the covered spans, merging the ones it overlaps or touches
+static void span_cover(led_span_t *covered, uint8_t *count, uint16_t start, uint16_t end) {
+  uint8_t first = 0;
+  while (first < *count && covered[first].end < start) {
+    first++;
+  }
+  uint8_t last = first;
+  while (last < *count && covered[last].start <= end) {
+    if (covered[last].start < start) {
+      start = covered[last].start;
+    }
+    if (covered[last].end > end) {
+      end = covered[last].end;
     }
+    last++;
+  }
+  // covered[first, last) merge into one span
+  if (last == first) {
+    memmove(covered + first + 1, covered + first, (*count - first) * sizeof(led_span_t));
+    (*count)++;
+  } else if (last > first + 1) {
+    memmove(covered + first + 1, covered + last, (*count - last) * sizeof(led_span_t));
+    *count -= last - first - 1;
+  }
+  covered[first].start = start;
+  covered[first].end   = end;
+}
+
+// One layer of the frame
+typedef struct {
+  const effect_config_t *config;
+  uint8_t layer;
+  uint16_t event;
+  uint16_t start;
+  uint16_t length;
+  uint16_t capacity; // Length before accel modulation (led_effects_render_layer)
+} layer_job_t;
+
+// Layers rendered one after the other into the same buffer
+typedef struct {
+  const layer_job_t *jobs;
+  uint8_t count;
+  uint32_t frame_counter;
+  led_rgb_t *buffer;
+} layer_batch_t;
+
+static led_rgb_t *overlay_buffer = NULL; // Upper layers of a split frame
+static uint16_t overlay_capacity = 0;
+
+static void render_layer_batch(void *arg) {
+  const layer_batch_t *batch = (const layer_batch_t *)arg;
+  for (uint8_t i = 0; i < batch->count; i++) {
+    const layer_job_t *job = &batch->jobs[i];
+    led_effects_render_layer(job->config, job->layer, job->event, batch->frame_counter, batch->buffer + job->start, job->length, job->capacity);
+  }
+}
+
+// Dual-core split (render_worker): the lower layers, base first, render on the worker
+// straight into the frame buffer while the upper ones render here into the overlay
+// buffer. A layer overwrites its whole span, so once both are done the spans of the
+// upper layers are copied over from the overlay. The split point evens out the LEDs
+// rendered on each core.
+// Returns false when the frame is to be rendered on this core alone.
+static bool render_layers_split(const layer_job_t *jobs, uint8_t count, uint32_t frame_counter, led_rgb_t *composed, uint16_t total_leds) {
+  if (!render_worker_active() || count < 2) {
+    return false;
+  }
+  if (total_leds > overlay_capacity) {
+    led_rgb_t *grown = realloc(overlay_buffer, total_leds * sizeof(led_rgb_t));
+    if (grown == NULL) {
+      return false;
+    }
+    overlay_buffer   = grown;
+    overlay_capacity = total_leds;
+  }
+
+  // State arena allocations stay on this core, before any layer renders
+  uint32_t total_length = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    if (!led_effects_prepare_layer(jobs[i].config, jobs[i].layer, frame_counter, jobs[i].length, jobs[i].capacity)) {
+      return false;
+    }
+    total_length += jobs[i].length;
+  }
+
+  uint8_t split         = 1;
+  uint32_t lower_length = jobs[0].length;
+  while (split < count - 1 && lower_length + jobs[split].length / 2 < total_length / 2) {
+    lower_length += jobs[split].length;
+    split++;
+  }
+
+  layer_batch_t lower = {.jobs = jobs, .count = split, .frame_counter = frame_counter, .buffer = composed};
+  layer_batch_t upper = {.jobs = jobs + split, .count = count - split, .frame_counter = frame_counter, .buffer = overlay_buffer};
+  render_worker_start(render_layer_batch, &lower);
+  render_layer_batch(&upper);
+
+  led_span_t spans[MAX_ACTIVE_EVENTS + 1];
+  uint8_t span_count = 0;
+  for (uint8_t i = split; i < count; i++) {
+    span_cover(spans, &span_count, jobs[i].start, jobs[i].start + jobs[i].length);
+  }
+
+  // Barrier: the lower layers are in the frame buffer
+  render_worker_wait();
+  for (uint8_t i = 0; i < span_count; i++) {
+    memcpy(composed + spans[i].start, overlay_buffer + spans[i].start, (spans[i].end - spans[i].start) * sizeof(led_rgb_t));
   }
+  return true;
 }
 
 void config_manager_update(void) {
@@ -929,34 +1105,52 @@ void config_manager_update(void) {
     return;
   }
 
-  uint32_t now        = xTaskGetTickCount();
+  uint32_t now_ms     = anim_clock_now_ms();
   uint16_t total_leds = led_effects_get_led_count();
   bool any_active     = false;
+  // Every layer renders straight into its segment of the strip's frame buffer
+  led_rgb_t *composed = led_effects_get_frame_buffer();
 
-  if (total_leds == 0) {
-    total_leds = NUM_LEDS;
-  }
-  if (total_leds == 0 || total_leds > MAX_LED_COUNT) {
-    total_leds = MAX_LED_COUNT;
+  if (composed == NULL || total_leds == 0) {
+    return;
   }
 
   // Check and expire active events
-  for (int i = 0; i < MAX_ACTIVE_EVENTS; i++) {
-    if (!active_events[i].active)
-      continue;
+  uint8_t order[MAX_ACTIVE_EVENTS];
+  uint8_t order_count;
+  portENTER_CRITICAL(&active_events_lock);
+  order_count = active_count;
+  memcpy(order, active_order, order_count);
+  portEXIT_CRITICAL(&active_events_lock);
+
+  uint8_t kept = 0;
+  for (uint8_t k = 0; k < order_count; k++) {
+    uint8_t slot = order[k];
 
     // Check if the event has expired (if duration > 0)
-    if (active_events[i].duration_ms > 0) {
-      uint32_t elapsed = now - active_events[i].start_time;
-      if (elapsed >= pdMS_TO_TICKS(active_events[i].duration_ms)) {
-        ESP_LOGI(TAG_CONFIG, "Event '%s' completed", config_manager_enum_to_id(active_events[i].event));
-        active_events[i].active = false;
-        continue;
+    if (active_events[slot].duration_ms > 0) {
+      // A start time received from the master may be slightly ahead of this pass
+      int32_t elapsed_ms = (int32_t)(now_ms - active_events[slot].start_ms);
+      if (elapsed_ms >= (int32_t)active_events[slot].duration_ms) {
+        can_event_type_t event = active_events[slot].event;
+        portENTER_CRITICAL(&active_events_lock);
+        // Unless it was stopped or restarted meanwhile
+        bool expired = event_slot[event] == slot + 1 && (int32_t)(now_ms - active_events[slot].start_ms) >= (int32_t)active_events[slot].duration_ms;
+        if (expired) {
+          release_slot(slot);
+        }
+        portEXIT_CRITICAL(&active_events_lock);
+        if (expired) {
+          ESP_LOGI(TAG_CONFIG, "Event '%s' completed", config_manager_enum_to_id(event));
+          continue;
+        }
       }
     }
 
-    any_active = true;
+    order[kept++] = slot;
   }
+  order_count = kept;
+  any_active  = order_count > 0;
 
   // Optimization: if no active event, let the default effect render
   if (!any_active) {
@@ -964,16 +1158,69 @@ void config_manager_update(void) {
     return;
   }
 
-  // Initialize buffers
-  memset(priority_buffer, 0, total_leds * sizeof(uint8_t));
-  memset(composed_buffer, 0, total_leds * sizeof(led_rgb_t));
+  // Occlusion, from the top layer down: a layer whose span is already covered by the
+  // layers above is not rendered. Covered spans are kept merged, sorted and disjoint,
+  // so a span is hidden when a single covered span contains it.
+  // The layers render from copies of their event taken under the lock: the CAN task may
+  // evict or restart an event meanwhile, and a layer prepared for the other core
+  // (render_layers_split) must render the config it was bound with.
+  led_span_t covered[MAX_ACTIVE_EVENTS];
+  uint8_t visible[MAX_ACTIVE_EVENTS];
+  uint16_t visible_start[MAX_ACTIVE_EVENTS];
+  uint16_t visible_length[MAX_ACTIVE_EVENTS];
+  effect_config_t visible_config[MAX_ACTIVE_EVENTS];
+  can_event_type_t visible_event[MAX_ACTIVE_EVENTS];
+  uint8_t covered_count = 0;
+  uint8_t visible_count = 0;
+  uint32_t occluded     = 0;
+
+  for (uint8_t k = 0; k < order_count; k++) {
+    uint8_t slot = order[k];
+    portENTER_CRITICAL(&active_events_lock);
+    visible_config[visible_count] = active_events[slot].effect_config;
+    visible_event[visible_count]  = active_events[slot].event;
+    portEXIT_CRITICAL(&active_events_lock);
+    uint16_t start  = visible_config[visible_count].segment_start;
+    uint16_t length = visible_config[visible_count].segment_length;
 
+    // Normalize length == 0 -> full strip
+    if (length == 0) {
+      length = total_leds;
+    }
+
+    if (start >= total_leds) {
+      continue;
+    }
+    if ((uint32_t)start + length > total_leds) {
+      length = total_leds - start;
+    }
+
+    if (span_covered(covered, covered_count, start, start + length)) {
+      occluded++;
+      continue;
+    }
+    span_cover(covered, &covered_count, start, start + length);
+
+    visible[visible_count]        = slot;
+    visible_start[visible_count]  = start;
+    visible_length[visible_count] = length;
+    visible_count++;
+  }
+
+  // Initialize buffer
+  memset(composed, 0, total_leds * sizeof(led_rgb_t));
+
+  // Layers of the frame, bottom-up
+  layer_job_t jobs[MAX_ACTIVE_EVENTS + 1];
+  effect_config_t base;
+  uint8_t job_count      = 0;
   uint32_t frame_counter = led_effects_get_frame_counter();
   bool needs_fft         = false;
+  bool base_occluded     = false;
 
-  // Render the default effect as a base layer
+  // Render the default effect as a base layer, unless the events cover it
   if (active_profile_loaded) {
-    effect_config_t base    = active_profile.default_effect;
+    base                    = active_profile.default_effect;
 
     // Use the segment configured in the profile (or full strip if none)
     uint16_t default_start  = base.segment_start;
@@ -983,75 +1230,68 @@ void config_manager_update(void) {
     led_effects_normalize_segment(&default_start, &default_length, total_leds);
 
     // Modulate by accel_pedal_pos if enabled
+    uint16_t default_capacity = default_length;
     if (base.accel_pedal_pos_enabled) {
       default_length = led_effects_apply_accel_modulation(default_length, led_effects_get_accel_pedal_pos(), base.accel_pedal_offset);
     }
 
-    memset(temp_buffer, 0, total_leds * sizeof(led_rgb_t));
-    led_effects_set_event_context(CAN_EVENT_NONE);
-    led_effects_render_to_buffer(&base, default_start, default_length, frame_counter, temp_buffer);
-
-    for (uint16_t idx = 0; idx < total_leds; idx++) {
-      composed_buffer[idx] = temp_buffer[idx];
+    base_occluded = span_covered(covered, covered_count, default_start, default_start + default_length);
+    if (!base_occluded) {
+      jobs[job_count++] = (layer_job_t){.config = &base, .layer = LED_LAYER_BASE, .event = CAN_EVENT_NONE, .start = default_start, .length = default_length, .capacity = default_capacity};
+      needs_fft |= led_effects_requires_fft(base.effect);
     }
-
-    needs_fft |= led_effects_requires_fft(active_profile.default_effect.effect);
   }
 
-  // Render events on top of the base layer (per-LED priority)
-  for (int i = 0; i < MAX_ACTIVE_EVENTS; i++) {
-    if (!active_events[i].active)
-      continue;
-
-    uint16_t start  = active_events[i].effect_config.segment_start;
-    uint16_t length = active_events[i].effect_config.segment_length;
-
-    // Normalize length == 0 -> full strip
-    if (length == 0) {
-      length = total_leds;
-    }
-
-    if (start >= total_leds) {
-      continue;
-    }
-    if ((uint32_t)start + length > total_leds) {
-      length = total_leds - start;
-    }
-
-    memset(temp_buffer, 0, total_leds * sizeof(led_rgb_t));
-
-    effect_config_t event_config = active_events[i].effect_config;
-    event_config.segment_start   = 0;
-    event_config.segment_length  = length;
-
-    led_effects_set_event_context(active_events[i].event);
-    led_effects_render_to_buffer(&event_config, 0, length, frame_counter, temp_buffer);
-
-    // Apply per-LED priority overlay (segment-local buffer)
-    for (uint16_t j = 0; j < length; j++) {
-      uint16_t idx = start + j;
-      if (idx >= total_leds) {
-        break;
-      }
-      if (active_events[i].priority >= priority_buffer[idx]) {
-        composed_buffer[idx] = temp_buffer[j];
-        priority_buffer[idx] = active_events[i].priority;
-      }
-    }
+  // Visible events on top of the base layer, from the bottom up: partly covered layers are
+  // rendered whole (effects lay out their whole span) and overdrawn by the layers above
+  for (int k = visible_count - 1; k >= 0; k--) {
+    layer_job_t *job = &jobs[job_count++];
+    job->config      = &visible_config[k];
+    job->layer       = LED_LAYER_EVENT_FIRST + visible[k];
+    job->event       = visible_event[k];
+    job->start       = visible_start[k];
+    job->length      = visible_length[k];
+    job->capacity    = visible_length[k];
 
-    if (led_effects_requires_fft(active_events[i].effect_config.effect)) {
+    if (led_effects_requires_fft(visible_config[k].effect)) {
       needs_fft = true;
     }
   }
 
+  bool split = render_layers_split(jobs, job_count, frame_counter, composed, total_leds);
+  if (!split) {
+    layer_batch_t all = {.jobs = jobs, .count = job_count, .frame_counter = frame_counter, .buffer = composed};
+    render_layer_batch(&all);
+  }
+
   audio_input_set_fft_enabled(needs_fft);
 
-  led_effects_set_event_context(CAN_EVENT_NONE);
-  led_effects_show_buffer(composed_buffer);
+  led_effects_show_buffer(composed);
+
+  portENTER_CRITICAL(&active_events_lock);
+  compositor_stats.frames++;
+  compositor_stats.layers_rendered += visible_count + (active_profile_loaded && !base_occluded ? 1 : 0);
+  compositor_stats.layers_occluded += occluded;
+  if (base_occluded) {
+    compositor_stats.base_occluded++;
+  }
+  if (split) {
+    compositor_stats.split_frames++;
+  }
+  portEXIT_CRITICAL(&active_events_lock);
 
   effect_override_active = any_active;
 }
 
+void config_manager_get_compositor_stats(config_manager_compositor_stats_t *stats) {
+  if (stats == NULL) {
+    return;
+  }
+  portENTER_CRITICAL(&active_events_lock);
+  *stats = compositor_stats;
+  portEXIT_CRITICAL(&active_events_lock);
+}
+
 bool config_manager_has_active_events(void) {
   return effect_override_active;
 }
@@ -1723,8 +1963,8 @@ uint16_t config_manager_get_led_count(void) {
 
 bool config_manager_set_led_count(uint16_t led_count) {
   // Validation
-  if (led_count < 1 || led_count > 200) {
-    ESP_LOGE(TAG_CONFIG, "Invalid LED count: %d (1-200)", led_count);
+  if (led_count < 1 || led_count > MAX_LED_COUNT) {
+    ESP_LOGE(TAG_CONFIG, "Invalid LED count: %d (1-%d)", led_count, MAX_LED_COUNT);
     return false;
   }
 
@@ -1736,6 +1976,19 @@ bool config_manager_set_led_count(uint16_t led_count) {
   return false;
 }
 
+uint8_t config_manager_get_led_outputs(led_output_config_t *outputs) {
+  return settings_get_led_outputs(outputs);
+}
+
+bool config_manager_set_led_outputs(const led_output_config_t *outputs, uint8_t count) {
+  esp_err_t err = settings_set_led_outputs(outputs, count);
+  if (err == ESP_OK) {
+    ESP_LOGI(TAG_CONFIG, "LED outputs saved: %u", count);
+    return true;
+  }
+  return false;
+}
+
 void config_manager_reapply_default_effect(void) {
   if (!active_profile_loaded) {
     ESP_LOGW(TAG_CONFIG, "No active profile, cannot reapply effect");
@@ -1,5 +1,6 @@
 #include "espnow_link.h"
 
+#include "anim_clock.h"
 #include "ble_api_service.h"
 #include "config.h"
 #include "esp_log.h"
@@ -7,15 +8,22 @@
 #include "esp_random.h"
 #include "esp_timer.h"
 #include "esp_wifi.h"
+#include "espnow_state_codec.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "pixel_stream_codec.h"
 #include "spiffs_storage.h"
 #include "status_led.h"
 #include "status_manager.h"
+#include "task_core_utils.h"
 #include "vehicle_can_unified.h"
 #include "wifi_manager.h"
 
 #include <assert.h>
 #include <stddef.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/param.h>
 
 #define DISCOVERY_TIMEOUT_S 30
 
@@ -26,10 +34,65 @@ typedef enum {
   MSG_DISCOVERY_REQ  = 0x01,
   MSG_DISCOVERY_RESP = 0x02,
   MSG_TEST           = 0x03,
-  MSG_VEHICLE_STATE  = 0x04,
+  // 0x04 was the raw vehicle_state_t broadcast, no longer sent
+  MSG_STATE          = 0x05,
+  MSG_KEYFRAME_REQ   = 0x06,
+  MSG_TIME_REQ       = 0x07,
+  MSG_TIME_RESP      = 0x08,
+  MSG_PIXEL_SUB      = 0x09,
+  MSG_PIXELS         = 0x0A,
 } msg_type_t;
 
-// Sent by slave during discovery
+// Vehicle state: keyframe (every field) every ESPNOW_KEYFRAME_INTERVAL_US or on
+// request, otherwise deltas holding only the fields changed since the previous packet
+#define ESPNOW_KEYFRAME_INTERVAL_US 1000000
+#define ESPNOW_KEYFRAME_REQ_MIN_US 100000 // Slave: minimum interval between keyframe requests
+#define ESPNOW_STREAM_SILENT_US 3000000   // Slave: own stream considered gone after this delay
+#define STATE_FLAG_KEYFRAME 0x01
+
+// Animation clock: the slave times an exchange with the master after a state packet
+// (state traffic is the heartbeat), quickly until synchronized, then once per second
+#define ESPNOW_TIME_REQ_FAST_US 250000
+#define ESPNOW_TIME_REQ_SLOW_US 1000000
+#define ESPNOW_TIME_FAST_SAMPLES 8
+#define ESPNOW_STATE_TIME_MAX_AGE_MS 1000 // Older change times are not used for event starts
+
+// Pixel offload: the master renders the strip of the slaves asking for it and sends
+// every frame as pixel_stream_codec chunks; a frame is only shown once complete.
+// Deltas need the previous frame: a slave that misses a chunk asks for a keyframe.
+#define ESPNOW_PIXEL_KEYFRAME_INTERVAL_US 1000000
+#define ESPNOW_PIXEL_SUB_RETRY_US 500000 // Slave: subscription renewal while no frame arrives
+#define ESPNOW_PIXEL_SILENT_US 1000000   // Slave: render locally again after this delay without frame
+#define PIXEL_FLAG_KEYFRAME 0x01         // No delta chunk in this frame
+#define PIXEL_FLAG_LAST 0x02             // Last chunk of the frame
+#define PIXEL_SUB_FLAG_KEYFRAME 0x01     // Slave lost its base frame
+
+// Reception: the WiFi task only copies each packet into a preallocated slot and queues
+// it; a worker task parses it (peer bookkeeping, replies, state publication).
+// A packet arriving while every slot is in use is dropped.
+#define ESPNOW_RX_POOL_SIZE 16
+#define ESPNOW_RX_TASK_STACK 6144
+#define ESPNOW_RX_TASK_PRIORITY 6 // Above the LED and CAN event tasks
+
+// Each slave subscribes to the fields it uses. Slaves with the same subscription
+// share a stream (0 = every field, for slaves without subscription); a stream
+// with a single member is sent unicast, otherwise broadcast.
+#define ESPNOW_MAX_STREAMS (ESPNOW_MAX_PEERS + 1)
+
+// Send scheduling: a frame leaves when a changed field's class is due, and carries
+// every pending change. Critical changes are repeated in the next frames (a lost
+// broadcast would otherwise wait for the slave's keyframe request).
+#define ESPNOW_CRITICAL_REPEATS 2
+#define ESPNOW_REPEAT_INTERVAL_US 20000
+static const uint32_t s_class_period_us[ESPNOW_CLASS_COUNT] = {
+    [ESPNOW_CLASS_CRITICAL] = 0,
+    [ESPNOW_CLASS_EVENT]    = 0,
+    [ESPNOW_CLASS_DYNAMIC]  = 100000,  // 10 Hz, slaves interpolate (SIGNAL_SMOOTHER_INTERVAL_MS)
+    [ESPNOW_CLASS_ENERGY]   = 1000000, // 1 Hz
+};
+
+// Sent by slave during discovery, followed by req_count 32-bit words holding the
+// bitmap of the state fields it uses (field i: byte i/8, bit i%8). req_count = 0: every field.
 typedef struct __attribute__((packed)) {
   uint8_t type;
   uint8_t proto_ver;
@@ -42,7 +105,8 @@ typedef struct __attribute__((packed)) {
 typedef struct __attribute__((packed)) {
   uint8_t type;
   uint8_t status; // 0 = OK, 1 = Denied
-  uint16_t reserved;
+  uint8_t stream; // State stream the slave follows
+  uint8_t reserved;
   uint32_t master_device_id;
 } msg_discovery_resp_t;
 
@@ -51,11 +115,58 @@ typedef struct __attribute__((packed)) {
   uint8_t pattern[4];
 } msg_test_t;
 
+// Followed by an espnow_state_codec payload
 typedef struct __attribute__((packed)) {
   uint8_t type;
-  vehicle_state_t state;
-} msg_vehicle_state_t;
-_Static_assert(sizeof(msg_vehicle_state_t) == (1 + sizeof(vehicle_state_t)), "msg_vehicle_state_t size mismatch");
+  uint8_t wire_version; // ESPNOW_STATE_WIRE_VERSION
+  uint8_t flags;        // STATE_FLAG_*
+  uint8_t stream;       // Subscription stream
+  uint16_t seq;         // +1 per packet of the stream, keyframes included
+  uint32_t time_ms;     // Master animation clock when the state was captured
+} msg_state_hdr_t;
+
+// Sent by a slave that missed a packet
+typedef struct __attribute__((packed)) {
+  uint8_t type;
+  uint8_t stream;
+  uint16_t last_seq; // Last sequence number received
+} msg_keyframe_req_t;
+
+// Clock exchange: t1 = slave send time (echoed), t2/t3 = master receive/send times
+typedef struct __attribute__((packed)) {
+  uint8_t type;
+  uint8_t reserved[3];
+  int64_t t1;
+} msg_time_req_t;
+
+typedef struct __attribute__((packed)) {
+  uint8_t type;
+  uint8_t reserved[3];
+  int64_t t1;
+  int64_t t2;
+  int64_t t3;
+} msg_time_resp_t;
+
+// Sent by a slave that wants its pixels rendered by the master (led_count = 0: stop)
+typedef struct __attribute__((packed)) {
+  uint8_t type;
+  uint8_t flags; // PIXEL_SUB_FLAG_*
+  uint16_t led_count;
+} msg_pixel_sub_t;
+
+// Followed by a pixel_stream_codec chunk
+typedef struct __attribute__((packed)) {
+  uint8_t type;
+  uint8_t flags;    // PIXEL_FLAG_*
+  uint8_t encoding; // pixel_stream_encoding_t
+  uint8_t reserved;
+  uint16_t seq;       // +1 per frame
+  uint16_t first_led; // First LED of the chunk
+  uint16_t led_count; // LEDs in the chunk
+  uint16_t total_leds;
+} msg_pixels_hdr_t;
+
+_Static_assert(sizeof(msg_pixels_hdr_t) + PIXEL_STREAM_MAX_CHUNK <= ESP_NOW_MAX_DATA_LEN, "Pixel chunk larger than an ESP-NOW packet");
 
 static espnow_role_t s_role                            = ESP_NOW_ROLE_MASTER;
 static espnow_slave_type_t s_slave_type                = ESP_NOW_SLAVE_NONE;
@@ -75,6 +186,100 @@ static uint32_t s_send_nomem_drop_count                = 0;
 static vehicle_state_t s_last_vehicle_state            = {0};
 static espnow_vehicle_state_rx_cb_t s_vehicle_state_cb = NULL;
 
+// Master: state stream sent to the slaves sharing a subscription
+typedef struct {
+  espnow_state_mask_t fields; // Subscribed fields
+  espnow_state_wire_t wire;   // Values the members have
+  uint8_t dest[6];            // Single member, or broadcast
+  uint8_t members;
+  bool has_keyframe;
+  volatile bool keyframe_wanted;
+  uint64_t last_keyframe_us;
+  uint64_t last_frame_us;
+  uint64_t class_sent_us[ESPNOW_CLASS_COUNT];    // Last frame carrying the class
+  uint64_t class_pending_us[ESPNOW_CLASS_COUNT]; // First pass that saw an unsent change, 0 if none
+  espnow_state_mask_t repeat;                    // Critical fields sent again for redundancy
+  uint8_t repeats_left;
+  uint16_t seq;
+} state_stream_t;
+
+// Master: subscription declared by a slave during discovery
+typedef struct {
+  uint8_t mac[6];
+  uint8_t stream;
+  espnow_state_mask_t fields;
+} peer_subscription_t;
+
+// Vehicle state streams (master: what slaves have, slave: sequence tracking)
+static state_stream_t s_streams[ESPNOW_MAX_STREAMS];
+static uint8_t s_stream_count = 0;
+static espnow_state_wire_t s_tx_scratch;
+static uint32_t s_tx_time_ms = 0;
+static espnow_state_mask_t s_class_masks[ESPNOW_CLASS_COUNT];
+static peer_subscription_t s_subs[ESPNOW_MAX_PEERS];
+static size_t s_sub_count              = 0;
+static portMUX_TYPE s_subs_lock        = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool s_streams_dirty   = true; // Peers or subscriptions changed
+static uint8_t s_rx_stream             = 0;
+static uint16_t s_rx_next_seq          = 0;
+static bool s_rx_synced                = false;
+static uint64_t s_rx_last_us           = 0;
+static uint64_t s_last_keyframe_req_us = 0;
+static uint32_t s_rx_change_ms         = 0; // Master time of the last state change received
+static bool s_rx_change_valid          = false;
+static int64_t s_time_req_t1           = 0; // Pending clock exchange, 0 if none
+static uint64_t s_time_req_sent_us     = 0;
+static uint32_t s_time_samples         = 0;
+static espnow_state_stats_t s_state_stats;
+
+// Master: slave whose pixels are rendered here (slot free when led_count = 0)
+typedef struct {
+  uint8_t mac[6];
+  uint16_t led_count;
+  volatile bool keyframe_wanted;
+  bool has_prev; // prev holds the frame the slave has
+  uint16_t seq;
+  uint64_t last_keyframe_us;
+  uint8_t *prev;
+  size_t prev_size;
+} pixel_peer_t;
+
+// Pixel offload (master: rendered slaves, slave: frame assembly)
+static pixel_peer_t s_pixel_peers[ESPNOW_MAX_PEERS];
+static portMUX_TYPE s_px_lock         = portMUX_INITIALIZER_UNLOCKED;
+static bool s_px_enabled              = false;
+static uint16_t s_px_led_count        = 0;
+static uint8_t *s_px_frame            = NULL; // Frame being decoded, base of the deltas
+static uint8_t *s_px_ready            = NULL; // Last complete frame, for the LED task
+static uint16_t s_px_sub_led_count    = 0;    // Strip length asked of the master
+static uint8_t *s_px_new_frame        = NULL; // Buffers for a new length, installed by the RX worker
+static uint8_t *s_px_new_ready        = NULL;
+static uint16_t s_px_new_led_count    = 0; // 0: nothing to install
+static bool s_px_ready_new            = false;
+static uint16_t s_px_seq              = 0;
+static uint16_t s_px_next_led         = 0;
+static bool s_px_frame_ok             = false;
+static bool s_px_base_ok              = false; // s_px_frame holds frame s_px_seq, complete
+static uint64_t s_px_last_frame_us    = 0;
+static uint64_t s_px_last_sub_us      = 0;
+static espnow_pixel_stats_t s_px_stats;
+
+typedef struct {
+  int64_t rx_clock_us; // Animation clock at reception (clock exchange t2)
+  int64_t rx_local_us; // Local time at reception (queue latency, clock exchange t4)
+  uint8_t src[6];
+  bool has_src;
+  bool unicast;
+  uint16_t len;
+  uint8_t data[ESP_NOW_MAX_DATA_LEN];
+} rx_packet_t;
+
+static rx_packet_t s_rx_pool[ESPNOW_RX_POOL_SIZE];
+static QueueHandle_t s_rx_free_queue = NULL; // Indexes of the free slots
+static QueueHandle_t s_rx_queue      = NULL; // Indexes of the slots to process, in arrival order
+static TaskHandle_t s_rx_task        = NULL;
+static espnow_rx_stats_t s_rx_stats;
+
 static void log_send_error(esp_err_t ret, const char *context) {
   if (ret == ESP_ERR_ESPNOW_NO_MEM) {
     s_send_nomem_drop_count++;
@@ -91,17 +296,20 @@ static void log_send_error(esp_err_t ret, const char *context) {
 
 #define ESPNOW_MAX_PEERS 8
 static espnow_peer_info_t s_peers[ESPNOW_MAX_PEERS];
-static size_t s_peer_count = 0;
+static size_t s_peer_count      = 0;
+static portMUX_TYPE s_peer_lock = portMUX_INITIALIZER_UNLOCKED; // Written by the RX worker and the API, read by the state sender
 
 static void persist_peers_to_spiffs(void) {
   struct {
     uint8_t count;
     espnow_peer_info_t peers[ESPNOW_MAX_PEERS];
-  } blob     = {0};
+  } blob = {0};
+
+  portENTER_CRITICAL(&s_peer_lock);
   blob.count = (s_peer_count > ESPNOW_MAX_PEERS) ? ESPNOW_MAX_PEERS : s_peer_count;
-  if (blob.count) {
-    memcpy(blob.peers, s_peers, blob.count * sizeof(espnow_peer_info_t));
-  }
+  memcpy(blob.peers, s_peers, blob.count * sizeof(espnow_peer_info_t));
+  portEXIT_CRITICAL(&s_peer_lock);
+
   esp_err_t err = spiffs_save_blob("/spiffs/ble/espnow_peers.bin", &blob, sizeof(blob));
   if (err != ESP_OK) {
     ESP_LOGW(TAG_ESP_NOW, "Failed to persist peers to SPIFFS: %s", esp_err_to_name(err));
@@ -132,6 +340,221 @@ static void load_peers_from_spiffs(void) {
   }
 }
 
+static void persist_subscriptions_to_spiffs(void) {
+  struct {
+    uint8_t count;
+    peer_subscription_t subs[ESPNOW_MAX_PEERS];
+  } blob = {0};
+
+  portENTER_CRITICAL(&s_subs_lock);
+  blob.count = (uint8_t)s_sub_count;
+  memcpy(blob.subs, s_subs, s_sub_count * sizeof(peer_subscription_t));
+  portEXIT_CRITICAL(&s_subs_lock);
+
+  esp_err_t err = spiffs_save_blob("/spiffs/ble/espnow_subs.bin", &blob, sizeof(blob));
+  if (err != ESP_OK) {
+    ESP_LOGW(TAG_ESP_NOW, "Failed to persist subscriptions to SPIFFS: %s", esp_err_to_name(err));
+  }
+}
+
+static void load_subscriptions_from_spiffs(void) {
+  struct {
+    uint8_t count;
+    peer_subscription_t subs[ESPNOW_MAX_PEERS];
+  } blob          = {0};
+  size_t required = sizeof(blob);
+
+  s_sub_count     = 0;
+  if (spiffs_load_blob("/spiffs/ble/espnow_subs.bin", &blob, &required) != ESP_OK || required != sizeof(blob)) {
+    return;
+  }
+  for (size_t i = 0; i < blob.count && i < ESPNOW_MAX_PEERS; i++) {
+    if (blob.subs[i].stream > 0 && blob.subs[i].stream < ESPNOW_MAX_STREAMS) {
+      s_subs[s_sub_count++] = blob.subs[i];
+    }
+  }
+  s_streams_dirty = true;
+}
+
+static bool is_cached_peer(const uint8_t mac[6]) {
+  bool found = false;
+  portENTER_CRITICAL(&s_peer_lock);
+  for (size_t i = 0; i < s_peer_count && !found; i++) {
+    found = memcmp(s_peers[i].mac, mac, 6) == 0;
+  }
+  portEXIT_CRITICAL(&s_peer_lock);
+  return found;
+}
+
+// Master: record the fields a slave uses (NULL: every field)
+// Returns the stream the slave must follow
+static uint8_t set_peer_subscription(const uint8_t mac[6], const espnow_state_mask_t *fields) {
+  uint8_t stream = 0;
+  bool changed   = false;
+
+  portENTER_CRITICAL(&s_subs_lock);
+  int index = -1;
+  for (size_t i = 0; i < s_sub_count; i++) {
+    if (memcmp(s_subs[i].mac, mac, 6) == 0) {
+      index = (int)i;
+      break;
+    }
+  }
+
+  if (index >= 0 && fields && espnow_state_mask_equal(&s_subs[index].fields, fields)) {
+    stream = s_subs[index].stream;
+  } else {
+    if (index >= 0) {
+      s_subs[index] = s_subs[--s_sub_count];
+      changed       = true;
+    }
+    // Table full: forget a slave that is no longer paired
+    for (size_t i = 0; fields && s_sub_count >= ESPNOW_MAX_PEERS && i < s_sub_count; i++) {
+      if (!is_cached_peer(s_subs[i].mac)) {
+        s_subs[i] = s_subs[--s_sub_count];
+      }
+    }
+    if (fields && s_sub_count < ESPNOW_MAX_PEERS) {
+      // Same fields as another slave: share its stream, otherwise take a free one
+      uint32_t used = 0;
+      for (size_t i = 0; i < s_sub_count && !stream; i++) {
+        used |= 1u << s_subs[i].stream;
+        if (espnow_state_mask_equal(&s_subs[i].fields, fields)) {
+          stream = s_subs[i].stream;
+        }
+      }
+      for (uint8_t id = 1; id < ESPNOW_MAX_STREAMS && !stream; id++) {
+        if (!(used & (1u << id))) {
+          stream = id;
+        }
+      }
+      peer_subscription_t *sub = &s_subs[s_sub_count++];
+      memcpy(sub->mac, mac, 6);
+      sub->stream = stream;
+      sub->fields = *fields;
+      changed     = true;
+    }
+  }
+  if (changed) {
+    s_streams_dirty = true;
+  }
+  portEXIT_CRITICAL(&s_subs_lock);
+
+  if (changed) {
+    persist_subscriptions_to_spiffs();
+  }
+  return stream;
+}
+
+static void remove_peer_subscription(const uint8_t mac[6]) {
+  bool removed = false;
+
+  portENTER_CRITICAL(&s_subs_lock);
+  for (size_t i = 0; i < s_sub_count; i++) {
+    if (memcmp(s_subs[i].mac, mac, 6) == 0) {
+      s_subs[i] = s_subs[--s_sub_count];
+      removed   = true;
+      break;
+    }
+  }
+  portEXIT_CRITICAL(&s_subs_lock);
+
+  if (removed) {
+    persist_subscriptions_to_spiffs();
+  }
+}
+
+// Master: start/stop rendering the pixels of a slave (led_count = 0: stop)
+static void set_pixel_peer(const uint8_t mac[6], uint16_t led_count) {
+  if (led_count > MAX_LED_COUNT) {
+    led_count = MAX_LED_COUNT;
+  }
+
+  portENTER_CRITICAL(&s_subs_lock);
+  pixel_peer_t *peer = NULL;
+  for (int i = 0; i < ESPNOW_MAX_PEERS && !peer; i++) {
+    if (s_pixel_peers[i].led_count && memcmp(s_pixel_peers[i].mac, mac, 6) == 0) {
+      peer = &s_pixel_peers[i];
+    }
+  }
+  for (int i = 0; i < ESPNOW_MAX_PEERS && !peer && led_count; i++) {
+    if (!s_pixel_peers[i].led_count) {
+      peer = &s_pixel_peers[i];
+      memcpy(peer->mac, mac, 6);
+    }
+  }
+  if (peer) {
+    peer->led_count       = led_count;
+    peer->keyframe_wanted = true;
+  }
+  portEXIT_CRITICAL(&s_subs_lock);
+
+  if (!peer) {
+    ESP_LOGW(TAG_ESP_NOW, "Pixel offload: no free slot");
+  }
+}
+
+// Master: assign peers to streams (sender side, when peers or subscriptions changed)
+static void rebuild_state_streams(void) {
+  peer_subscription_t subs[ESPNOW_MAX_PEERS];
+  size_t sub_count;
+
+  portENTER_CRITICAL(&s_subs_lock);
+  s_streams_dirty = false;
+  sub_count       = s_sub_count;
+  memcpy(subs, s_subs, sizeof(subs));
+  portEXIT_CRITICAL(&s_subs_lock);
+
+  // The RX worker adds and evicts peers meanwhile: work from a copy
+  espnow_peer_info_t peers[ESPNOW_MAX_PEERS];
+  size_t peer_count;
+  portENTER_CRITICAL(&s_peer_lock);
+  peer_count = s_peer_count;
+  memcpy(peers, s_peers, peer_count * sizeof(espnow_peer_info_t));
+  portEXIT_CRITICAL(&s_peer_lock);
+
+  for (int i = 0; i < ESPNOW_MAX_STREAMS; i++) {
+    s_streams[i].members      = 0;
+    s_streams[i].has_keyframe = false; // Members may have changed: restart from a keyframe
+  }
+  espnow_state_mask_all(&s_streams[0].fields);
+  s_stream_count = 1;
+  for (int c = 0; c < ESPNOW_CLASS_COUNT; c++) {
+    espnow_state_class_mask((espnow_state_class_t)c, &s_class_masks[c]);
+  }
+
+  for (size_t p = 0; p < peer_count; p++) {
+    if (peers[p].role != ESP_NOW_ROLE_SLAVE) {
+      continue;
+    }
+    uint8_t id = 0;
+    for (size_t i = 0; i < sub_count; i++) {
+      if (memcmp(subs[i].mac, peers[p].mac, 6) == 0) {
+        id                   = subs[i].stream;
+        s_streams[id].fields = subs[i].fields;
+        break;
+      }
+    }
+    state_stream_t *stream = &s_streams[id];
+    if (stream->members == 0) {
+      memcpy(stream->dest, peers[p].mac, 6);
+    } else {
+      memset(stream->dest, 0xFF, 6);
+    }
+    stream->members++;
+    s_stream_count = MAX(s_stream_count, id + 1);
+  }
+
+  uint8_t active = 0;
+  for (uint8_t i = 0; i < s_stream_count; i++) {
+    if (s_streams[i].members) {
+      active++;
+      ESP_LOGI(TAG_ESP_NOW, "State stream %u: %u slave(s), %u fields", i, s_streams[i].members, espnow_state_mask_count(&s_streams[i].fields));
+    }
+  }
+  s_state_stats.streams = active;
+}
+
 // Pairing mode
 static bool s_is_pairing_mode                  = false;
 static esp_timer_handle_t s_pairing_mode_timer = NULL;
@@ -191,6 +614,83 @@ bool espnow_link_slave_type_from_str(const char *s, espnow_slave_type_t *out) {
   return false;
 }
 
+// State fields each slave type leaves out (the other side of the car) or keeps (speedometer)
+static const char *const s_left_unused_fields[] = {
+    "door_front_right_open",
+    "door_rear_right_open",
+    "turn_right",
+    "blindspot_right",
+    "blindspot_right_alert",
+    "side_collision_right",
+    "lane_departure_right_lv1",
+    "lane_departure_right_lv2",
+};
+
+static const char *const s_right_unused_fields[] = {
+    "door_front_left_open",
+    "door_rear_left_open",
+    "turn_left",
+    "blindspot_left",
+    "blindspot_left_alert",
+    "side_collision_left",
+    "lane_departure_left_lv1",
+    "lane_departure_left_lv2",
+};
+
+static const char *const s_speedometer_fields[] = {
+    "speed_kph",
+    "speed_limit",
+    "pedal_map",
+    "gear",
+    "accel_pedal_pos",
+    "brake_pressed",
+    "rear_power",
+    "front_power",
+    "max_regen",
+    "soc_percent",
+    "turn_left",
+    "turn_right",
+    "hazard",
+    "night_mode",
+    "brightness",
+    "autopilot",
+    "cruise",
+};
+
+static void mask_apply_names(espnow_state_mask_t *mask, const char *const *names, size_t count, bool set) {
+  for (size_t i = 0; i < count; i++) {
+    int id = espnow_state_field_id(names[i]);
+    if (id < 0) {
+      continue;
+    }
+    if (set) {
+      espnow_state_mask_set(mask, (uint8_t)id);
+    } else {
+      espnow_state_mask_clear(mask, (uint8_t)id);
+    }
+  }
+}
+
+// Slave: fields declared during discovery, false to receive every field
+static bool get_slave_subscription(espnow_slave_type_t type, espnow_state_mask_t *fields) {
+  switch (type) {
+  case ESP_NOW_SLAVE_EVENTS_LEFT:
+    espnow_state_mask_all(fields);
+    mask_apply_names(fields, s_left_unused_fields, sizeof(s_left_unused_fields) / sizeof(s_left_unused_fields[0]), false);
+    return true;
+  case ESP_NOW_SLAVE_EVENTS_RIGHT:
+    espnow_state_mask_all(fields);
+    mask_apply_names(fields, s_right_unused_fields, sizeof(s_right_unused_fields) / sizeof(s_right_unused_fields[0]), false);
+    return true;
+  case ESP_NOW_SLAVE_SPEEDOMETER:
+    memset(fields, 0, sizeof(*fields));
+    mask_apply_names(fields, s_speedometer_fields, sizeof(s_speedometer_fields) / sizeof(s_speedometer_fields[0]), true);
+    return true;
+  default:
+    return false;
+  }
+}
+
 static void pairing_mode_timer_callback(void *arg) {
   ESP_LOGI(TAG_ESP_NOW, "Pairing mode disabled by timer");
   s_is_pairing_mode = false;
@@ -280,13 +780,14 @@ static void register_cached_peers(void) {
 }
 
 static bool is_peer_known(const uint8_t mac[6], uint32_t device_id) {
-  for (size_t i = 0; i < s_peer_count; i++) {
-    if (mac && memcmp(s_peers[i].mac, mac, 6) == 0) {
-      return true;
-    }
-    if (device_id != 0 && s_peers[i].device_id == device_id) {
-      return true;
-    }
+  bool found = false;
+  portENTER_CRITICAL(&s_peer_lock);
+  for (size_t i = 0; i < s_peer_count && !found; i++) {
+    found = (mac && memcmp(s_peers[i].mac, mac, 6) == 0) || (device_id != 0 && s_peers[i].device_id == device_id);
+  }
+  portEXIT_CRITICAL(&s_peer_lock);
+  if (found) {
+    return true;
   }
   if (mac && esp_now_is_peer_exist(mac)) {
     return true;
@@ -298,80 +799,265 @@ static void update_peer_info(const uint8_t mac[6], espnow_role_t role, espnow_sl
   if (!mac)
     return;
   uint8_t channel = channel_hint ? channel_hint : get_current_channel();
+  int64_t now_us  = esp_timer_get_time();
+  bool changed    = false;
+
+  portENTER_CRITICAL(&s_peer_lock);
+  espnow_peer_info_t *peer = NULL;
   // search existing
   for (size_t i = 0; i < s_peer_count; i++) {
     if (memcmp(s_peers[i].mac, mac, 6) == 0) {
-      bool changed = false;
-      if (s_peers[i].role != role) {
-        s_peers[i].role = role;
-        changed         = true;
-      }
-      if (s_peers[i].type != type) {
-        s_peers[i].type = type;
-        changed         = true;
-      }
-      if (device_id != 0 && s_peers[i].device_id != device_id) {
-        s_peers[i].device_id = device_id;
-        changed              = true;
-      }
-      if (s_peers[i].channel != channel) {
-        s_peers[i].channel = channel;
-        changed            = true;
-      }
-      s_peers[i].last_seen_us = esp_timer_get_time();
-      if (changed) {
-        persist_peers_to_spiffs();
-      }
-      return;
+      peer = &s_peers[i];
+      break;
     }
   }
-  if (s_peer_count >= ESPNOW_MAX_PEERS) {
-    // overwrite the oldest
-    size_t oldest = 0;
-    for (size_t i = 1; i < s_peer_count; i++) {
-      if (s_peers[i].last_seen_us < s_peers[oldest].last_seen_us) {
-        oldest = i;
+  if (peer) {
+    if (peer->role != role) {
+      peer->role      = role;
+      changed         = true;
+      s_streams_dirty = true;
+    }
+    if (peer->type != type) {
+      peer->type = type;
+      changed    = true;
+    }
+    if (device_id != 0 && peer->device_id != device_id) {
+      peer->device_id = device_id;
+      changed         = true;
+    }
+    if (peer->channel != channel) {
+      peer->channel = channel;
+      changed       = true;
+    }
+    peer->last_seen_us = now_us;
+  } else {
+    if (s_peer_count >= ESPNOW_MAX_PEERS) {
+      // overwrite the oldest
+      peer = &s_peers[0];
+      for (size_t i = 1; i < s_peer_count; i++) {
+        if (s_peers[i].last_seen_us < peer->last_seen_us) {
+          peer = &s_peers[i];
+        }
       }
+    } else {
+      peer    = &s_peers[s_peer_count++];
+      changed = true;
     }
-    memcpy(s_peers[oldest].mac, mac, 6);
-    s_peers[oldest].role         = role;
-    s_peers[oldest].type         = type;
-    s_peers[oldest].device_id    = device_id;
-    s_peers[oldest].last_seen_us = esp_timer_get_time();
-    s_peers[oldest].channel      = channel;
-    return;
+    memcpy(peer->mac, mac, 6);
+    peer->role         = role;
+    peer->type         = type;
+    peer->device_id    = device_id;
+    peer->last_seen_us = now_us;
+    peer->channel      = channel;
+    s_streams_dirty    = true;
+  }
+  portEXIT_CRITICAL(&s_peer_lock);
+
+  // Flash write outside the critical section
+  if (changed) {
+    persist_peers_to_spiffs();
   }
-  memcpy(s_peers[s_peer_count].mac, mac, 6);
-  s_peers[s_peer_count].role         = role;
-  s_peers[s_peer_count].type         = type;
-  s_peers[s_peer_count].device_id    = device_id;
-  s_peers[s_peer_count].last_seen_us = esp_timer_get_time();
-  s_peers[s_peer_count].channel      = channel;
-  s_peer_count++;
-  persist_peers_to_spiffs();
 }
 
 static void remove_peer_from_cache(const uint8_t mac[6]) {
   if (!mac)
     return;
+  bool removed = false;
+  portENTER_CRITICAL(&s_peer_lock);
   for (size_t i = 0; i < s_peer_count; i++) {
     if (memcmp(s_peers[i].mac, mac, 6) == 0) {
       if (i != s_peer_count - 1) {
         s_peers[i] = s_peers[s_peer_count - 1];
       }
       s_peer_count--;
-      persist_peers_to_spiffs();
+      s_streams_dirty = true;
+      removed         = true;
       break;
     }
   }
+  portEXIT_CRITICAL(&s_peer_lock);
+
+  if (removed) {
+    persist_peers_to_spiffs();
+  }
 }
 
-// ESP-NOW callbacks
-static void espnow_recv_cb(const esp_now_recv_info_t *recv_info, const uint8_t *data, int len) {
-  if (!data || len < 1)
+// Slave: start a clock exchange (an unanswered request is simply replaced)
+static void send_time_request(const uint8_t *mac, uint64_t now_us) {
+  msg_time_req_t req = {.type = MSG_TIME_REQ};
+  s_time_req_sent_us = now_us;
+  req.t1             = esp_timer_get_time();
+  esp_err_t ret      = esp_now_send(mac, (const uint8_t *)&req, sizeof(req));
+  if (ret != ESP_OK) {
+    log_send_error(ret, "esp_now_send time_req");
     return;
-  const uint8_t *mac = recv_info ? recv_info->src_addr : NULL;
-  uint8_t type       = data[0];
+  }
+  s_time_req_t1 = req.t1;
+}
+
+// Slave: ask the master for pixel frames (again), or stop them
+static void send_pixel_subscription(const uint8_t *mac, uint8_t flags, uint64_t now_us) {
+  msg_pixel_sub_t sub = {.type = MSG_PIXEL_SUB, .flags = flags, .led_count = s_px_enabled ? s_px_sub_led_count : 0};
+  s_px_last_sub_us    = now_us;
+  esp_err_t ret       = esp_now_send(mac, (const uint8_t *)&sub, sizeof(sub));
+  if (ret != ESP_OK) {
+    log_send_error(ret, "esp_now_send pixel_sub");
+  }
+  if (flags & PIXEL_SUB_FLAG_KEYFRAME) {
+    s_px_stats.keyframe_requests++;
+  }
+}
+
+// Slave (RX worker): switch to the buffers of a new strip length. The swap is done under
+// s_px_lock for the LED task; s_px_frame is only used by this task, so the old buffers can go.
+static void install_pixel_buffers(void) {
+  if (!s_px_new_led_count) {
+    return;
+  }
+  portENTER_CRITICAL(&s_px_lock);
+  uint8_t *old_frame = s_px_frame;
+  uint8_t *old_ready = s_px_ready;
+  s_px_frame         = s_px_new_frame;
+  s_px_ready         = s_px_new_ready;
+  s_px_led_count     = s_px_new_led_count;
+  s_px_new_frame     = NULL;
+  s_px_new_ready     = NULL;
+  s_px_new_led_count = 0;
+  s_px_ready_new     = false;
+  portEXIT_CRITICAL(&s_px_lock);
+  free(old_frame);
+  free(old_ready);
+
+  s_px_frame_ok = false;
+  s_px_base_ok  = false;
+  s_px_next_led = 0;
+}
+
+// Slave: decode a chunk of the current frame, publish the frame once complete
+static void handle_pixel_chunk(const uint8_t *mac, const msg_pixels_hdr_t *hdr, const uint8_t *payload, size_t payload_len) {
+  install_pixel_buffers();
+  if (!s_px_enabled || !s_px_frame) {
+    return;
+  }
+  uint64_t now_us = esp_timer_get_time();
+  s_px_stats.packets++;
+  s_px_stats.bytes += sizeof(msg_pixels_hdr_t) + payload_len;
+
+  if (hdr->seq != s_px_seq) {
+    // New frame: deltas need the previous one, complete
+    bool follows  = s_px_base_ok && hdr->seq == (uint16_t)(s_px_seq + 1);
+    s_px_frame_ok = (hdr->flags & PIXEL_FLAG_KEYFRAME) || follows;
+    s_px_seq      = hdr->seq;
+    s_px_next_led = 0;
+    s_px_base_ok  = false;
+  }
+
+  // Wrong length: the master renders the former strip length until it gets the subscription
+  bool valid = hdr->total_leds == s_px_led_count && hdr->first_led == s_px_next_led && (uint32_t)hdr->first_led + hdr->led_count <= s_px_led_count;
+  if (!s_px_frame_ok || !valid || pixel_stream_decode_chunk((pixel_stream_encoding_t)hdr->encoding, payload, payload_len, s_px_frame, hdr->first_led, hdr->led_count) != 0) {
+    s_px_frame_ok = false;
+    s_px_stats.dropped++;
+    if (mac && now_us - s_px_last_sub_us >= ESPNOW_KEYFRAME_REQ_MIN_US) {
+      send_pixel_subscription(mac, PIXEL_SUB_FLAG_KEYFRAME, now_us);
+    }
+    return;
+  }
+  if (hdr->encoding < PIXEL_ENC_COUNT) {
+    s_px_stats.chunks[hdr->encoding]++;
+  }
+  s_px_next_led += hdr->led_count;
+
+  if ((hdr->flags & PIXEL_FLAG_LAST) && s_px_next_led == s_px_led_count) {
+    portENTER_CRITICAL(&s_px_lock);
+    memcpy(s_px_ready, s_px_frame, s_px_led_count * 3u);
+    s_px_ready_new = true;
+    portEXIT_CRITICAL(&s_px_lock);
+    s_px_base_ok       = true;
+    s_px_last_frame_us = now_us;
+    s_px_stats.frames++;
+    if (hdr->flags & PIXEL_FLAG_KEYFRAME) {
+      s_px_stats.keyframes++;
+    }
+  }
+}
+
+// Slave: apply a keyframe/delta of its stream and track sequence numbers
+static void handle_state_packet(const uint8_t *mac, bool unicast, const msg_state_hdr_t *hdr, const uint8_t *payload, size_t payload_len) {
+  bool keyframe   = (hdr->flags & STATE_FLAG_KEYFRAME) != 0;
+  uint64_t now_us = esp_timer_get_time();
+
+  if (hdr->stream != s_rx_stream) {
+    // Broadcast streams of other subscriptions are ignored. Follow another stream only
+    // when it is addressed to this slave (the master moved it), or when it is the
+    // full stream and ours went silent (the master no longer knows the subscription).
+    bool fallback = hdr->stream == 0 && keyframe && now_us - s_rx_last_us >= ESPNOW_STREAM_SILENT_US;
+    if (!unicast && !fallback) {
+      return;
+    }
+    ESP_LOGI(TAG_ESP_NOW, "Following state stream %u (was %u)", hdr->stream, s_rx_stream);
+    s_rx_stream = hdr->stream;
+    s_rx_synced = false;
+  }
+  s_rx_last_us = now_us;
+
+  s_state_stats.packets++;
+  s_state_stats.bytes += sizeof(msg_state_hdr_t) + payload_len;
+  if (keyframe) {
+    s_state_stats.keyframes++;
+    s_rx_synced = true;
+  } else if (s_rx_synced && hdr->seq != s_rx_next_seq) {
+    // Changes carried by the lost packets are missing until the next keyframe
+    s_state_stats.seq_gaps++;
+    s_rx_synced = false;
+  }
+  s_rx_next_seq          = hdr->seq + 1;
+
+  // Deltas are still applied while unsynced: the fields they carry are current
+  vehicle_state_t before = s_last_vehicle_state;
+  if (espnow_state_decode(payload, payload_len, &s_last_vehicle_state, NULL) != ESP_OK) {
+    ESP_LOGW(TAG_ESP_NOW, "Malformed vehicle state packet (seq=%u len=%u)", hdr->seq, (unsigned)payload_len);
+    s_rx_synced = false;
+  }
+  // Repeats and keyframes carry the time of their own capture, not of the change
+  if (memcmp(&before, &s_last_vehicle_state, sizeof(before)) != 0) {
+    s_rx_change_ms    = hdr->time_ms;
+    s_rx_change_valid = true;
+  }
+
+  uint64_t time_req_period = s_time_samples < ESPNOW_TIME_FAST_SAMPLES || !anim_clock_is_synced() ? ESPNOW_TIME_REQ_FAST_US : ESPNOW_TIME_REQ_SLOW_US;
+  if (mac && now_us - s_time_req_sent_us >= time_req_period) {
+    send_time_request(mac, now_us);
+  }
+
+  // Pixel offload: (re)subscribe while no frame arrives (master restarted, subscription lost)
+  if (mac && s_px_enabled && now_us - s_px_last_frame_us >= ESPNOW_PIXEL_SILENT_US / 2 && now_us - s_px_last_sub_us >= ESPNOW_PIXEL_SUB_RETRY_US) {
+    send_pixel_subscription(mac, PIXEL_SUB_FLAG_KEYFRAME, now_us);
+  }
+
+  if (!s_rx_synced && mac && now_us - s_last_keyframe_req_us >= ESPNOW_KEYFRAME_REQ_MIN_US) {
+    msg_keyframe_req_t req = {.type = MSG_KEYFRAME_REQ, .stream = s_rx_stream, .last_seq = hdr->seq};
+    esp_err_t ret          = esp_now_send(mac, (const uint8_t *)&req, sizeof(req));
+    if (ret != ESP_OK) {
+      log_send_error(ret, "esp_now_send keyframe_req");
+    }
+    s_last_keyframe_req_us = now_us;
+    s_state_stats.keyframe_requests++;
+  }
+
+  if (s_vehicle_state_cb) {
+    vehicle_state_t state = s_last_vehicle_state;
+    s_vehicle_state_cb(&state);
+  }
+}
+
+// ESP-NOW callbacks
+// Runs in the receive worker
+static void process_rx_packet(const rx_packet_t *pkt) {
+  const uint8_t *data = pkt->data;
+  int len             = pkt->len;
+  int64_t rx_time_us  = pkt->rx_clock_us;
+  const uint8_t *mac  = pkt->has_src ? pkt->src : NULL;
+  uint8_t type        = data[0];
   ESP_LOGD(TAG_ESP_NOW,
            "RX type=0x%02X len=%d from %02X:%02X:%02X:%02X:%02X:%02X",
            type,
@@ -409,6 +1095,15 @@ static void espnow_recv_cb(const esp_now_recv_info_t *recv_info, const uint8_t *
 
     msg_discovery_resp_t resp = {.type = MSG_DISCOVERY_RESP, .status = 0, .master_device_id = s_device_id};
     if (mac) {
+      // Field subscription: words beyond the fields known here are ignored
+      uint8_t word_count = MIN(req->req_count, max_ids_from_len);
+      if (word_count > 0) {
+        espnow_state_mask_t fields = {0};
+        memcpy(fields.bits, data + sizeof(msg_discovery_req_t), MIN(word_count * 4u, sizeof(fields.bits)));
+        resp.stream = set_peer_subscription(mac, &fields);
+      } else {
+        set_peer_subscription(mac, NULL);
+      }
       espnow_link_register_peer(mac);
       esp_now_send(mac, (const uint8_t *)&resp, sizeof(resp));
     }
@@ -418,9 +1113,17 @@ static void espnow_recv_cb(const esp_now_recv_info_t *recv_info, const uint8_t *
   } else if (s_role == ESP_NOW_ROLE_SLAVE && type == MSG_DISCOVERY_RESP && len == sizeof(msg_discovery_resp_t)) {
     const msg_discovery_resp_t *resp = (const msg_discovery_resp_t *)data;
     s_last_peer_hb_us                = esp_timer_get_time();
+    if (resp->stream != s_rx_stream) {
+      s_rx_stream = resp->stream;
+      s_rx_synced = false;
+    }
+    s_rx_last_us = s_last_peer_hb_us; // Give the assigned stream time to start
     if (mac) {
       espnow_link_register_peer(mac);
       update_peer_info(mac, ESP_NOW_ROLE_MASTER, ESP_NOW_SLAVE_NONE, resp->master_device_id, 0);
+      if (s_px_enabled) {
+        send_pixel_subscription(mac, PIXEL_SUB_FLAG_KEYFRAME, s_last_peer_hb_us);
+      }
     }
     if (s_discovery_timer && esp_timer_is_active(s_discovery_timer)) {
       esp_timer_stop(s_discovery_timer);
@@ -428,19 +1131,55 @@ static void espnow_recv_cb(const esp_now_recv_info_t *recv_info, const uint8_t *
     s_slave_pairing_active = false;
     status_manager_update_led_now();
 
-  } else if (s_role == ESP_NOW_ROLE_SLAVE && type == MSG_VEHICLE_STATE) {
-    if (len < (int)sizeof(msg_vehicle_state_t)) {
+  } else if (s_role == ESP_NOW_ROLE_SLAVE && type == MSG_STATE) {
+    if (len < (int)sizeof(msg_state_hdr_t)) {
       ESP_LOGW(TAG_ESP_NOW, "Vehicle state too short: len=%d", len);
       return;
     }
-    const msg_vehicle_state_t *msg = (const msg_vehicle_state_t *)data;
-    vehicle_state_t state          = {0};
-    memcpy(&state, &msg->state, sizeof(vehicle_state_t));
-    s_last_peer_hb_us    = esp_timer_get_time();
-    s_last_vehicle_state = state;
-    if (s_vehicle_state_cb) {
-      s_vehicle_state_cb(&state);
+    const msg_state_hdr_t *hdr = (const msg_state_hdr_t *)data;
+    if (hdr->wire_version != ESPNOW_STATE_WIRE_VERSION) {
+      s_state_stats.version_mismatch++;
+      return;
+    }
+    s_last_peer_hb_us = esp_timer_get_time();
+    handle_state_packet(mac, pkt->unicast, hdr, data + sizeof(msg_state_hdr_t), (size_t)len - sizeof(msg_state_hdr_t));
+
+  } else if (s_role == ESP_NOW_ROLE_MASTER && type == MSG_KEYFRAME_REQ && len >= (int)sizeof(msg_keyframe_req_t)) {
+    const msg_keyframe_req_t *req = (const msg_keyframe_req_t *)data;
+    if (req->stream < ESPNOW_MAX_STREAMS) {
+      s_streams[req->stream].keyframe_wanted = true;
+    }
+    s_state_stats.keyframe_requests++;
+
+  } else if (s_role == ESP_NOW_ROLE_MASTER && type == MSG_TIME_REQ && len >= (int)sizeof(msg_time_req_t)) {
+    const msg_time_req_t *req = (const msg_time_req_t *)data;
+    msg_time_resp_t resp      = {.type = MSG_TIME_RESP, .t1 = req->t1, .t2 = rx_time_us};
+    if (mac) {
+      resp.t3       = anim_clock_now_us();
+      esp_err_t ret = esp_now_send(mac, (const uint8_t *)&resp, sizeof(resp));
+      if (ret != ESP_OK) {
+        log_send_error(ret, "esp_now_send time_resp");
+      }
     }
+
+  } else if (s_role == ESP_NOW_ROLE_SLAVE && type == MSG_TIME_RESP && len >= (int)sizeof(msg_time_resp_t)) {
+    const msg_time_resp_t *resp = (const msg_time_resp_t *)data;
+    // Only the pending exchange: a late answer to a replaced request has an unknown delay
+    if (s_time_req_t1 != 0 && resp->t1 == s_time_req_t1) {
+      anim_clock_add_sample(resp->t1, resp->t2, resp->t3, pkt->rx_local_us);
+      s_time_req_t1 = 0;
+      s_time_samples++;
+    }
+
+  } else if (s_role == ESP_NOW_ROLE_MASTER && type == MSG_PIXEL_SUB && len >= (int)sizeof(msg_pixel_sub_t)) {
+    const msg_pixel_sub_t *sub = (const msg_pixel_sub_t *)data;
+    if (mac) {
+      set_pixel_peer(mac, sub->led_count);
+    }
+
+  } else if (s_role == ESP_NOW_ROLE_SLAVE && type == MSG_PIXELS && len >= (int)sizeof(msg_pixels_hdr_t)) {
+    handle_pixel_chunk(mac, (const msg_pixels_hdr_t *)data, data + sizeof(msg_pixels_hdr_t), (size_t)len - sizeof(msg_pixels_hdr_t));
+
   } else if (type == MSG_TEST) {
     s_last_test_rx_us = esp_timer_get_time();
     if (s_test_rx_cb) {
@@ -449,6 +1188,85 @@ static void espnow_recv_cb(const esp_now_recv_info_t *recv_info, const uint8_t *
   }
 }
 
+// WiFi task: copy the packet and hand it to the worker, nothing else
+static void espnow_recv_cb(const esp_now_recv_info_t *recv_info, const uint8_t *data, int len) {
+  int64_t rx_local_us = esp_timer_get_time();
+  int64_t rx_clock_us = anim_clock_now_us();
+  if (!data || len < 1) {
+    return;
+  }
+  if (len > ESP_NOW_MAX_DATA_LEN) {
+    s_rx_stats.oversize++;
+    return;
+  }
+
+  uint8_t slot;
+  if (!s_rx_free_queue || xQueueReceive(s_rx_free_queue, &slot, 0) != pdTRUE) {
+    s_rx_stats.dropped++;
+    return;
+  }
+  rx_packet_t *pkt = &s_rx_pool[slot];
+  pkt->rx_clock_us = rx_clock_us;
+  pkt->rx_local_us = rx_local_us;
+  pkt->has_src     = recv_info && recv_info->src_addr;
+  pkt->unicast     = recv_info && recv_info->des_addr && (recv_info->des_addr[0] & 0x01) == 0;
+  pkt->len         = (uint16_t)len;
+  if (pkt->has_src) {
+    memcpy(pkt->src, recv_info->src_addr, 6);
+  }
+  memcpy(pkt->data, data, len);
+
+  if (xQueueSend(s_rx_queue, &slot, 0) != pdTRUE) {
+    xQueueSend(s_rx_free_queue, &slot, 0);
+    s_rx_stats.dropped++;
+    return;
+  }
+  UBaseType_t waiting = uxQueueMessagesWaiting(s_rx_queue);
+  if (waiting > s_rx_stats.queue_max) {
+    s_rx_stats.queue_max = waiting;
+  }
+}
+
+static void espnow_rx_task(void *arg) {
+  (void)arg;
+  uint8_t slot;
+  while (1) {
+    if (xQueueReceive(s_rx_queue, &slot, portMAX_DELAY) != pdTRUE) {
+      continue;
+    }
+    rx_packet_t *pkt    = &s_rx_pool[slot];
+    uint32_t latency_us = (uint32_t)(esp_timer_get_time() - pkt->rx_local_us);
+    s_rx_stats.packets++;
+    s_rx_stats.latency_total_us += latency_us;
+    if (latency_us > s_rx_stats.latency_max_us) {
+      s_rx_stats.latency_max_us = latency_us;
+    }
+
+    process_rx_packet(pkt);
+    xQueueSend(s_rx_free_queue, &slot, 0);
+  }
+}
+
+static esp_err_t start_rx_worker(void) {
+  if (s_rx_task) {
+    return ESP_OK;
+  }
+  s_rx_free_queue = xQueueCreate(ESPNOW_RX_POOL_SIZE, sizeof(uint8_t));
+  s_rx_queue      = xQueueCreate(ESPNOW_RX_POOL_SIZE, sizeof(uint8_t));
+  if (!s_rx_free_queue || !s_rx_queue) {
+    ESP_LOGE(TAG_ESP_NOW, "Failed to create RX queues");
+    return ESP_ERR_NO_MEM;
+  }
+  for (uint8_t i = 0; i < ESPNOW_RX_POOL_SIZE; i++) {
+    xQueueSend(s_rx_free_queue, &i, 0);
+  }
+  if (create_task_on_general_core(espnow_rx_task, "espnow_rx", ESPNOW_RX_TASK_STACK, NULL, ESPNOW_RX_TASK_PRIORITY, &s_rx_task) != pdPASS) {
+    ESP_LOGE(TAG_ESP_NOW, "Failed to create RX task");
+    return ESP_ERR_NO_MEM;
+  }
+  return ESP_OK;
+}
+
 static void espnow_send_cb(const wifi_tx_info_t *tx_info, esp_now_send_status_t status) {
   if (status == ESP_NOW_SEND_SUCCESS) {
     ESP_LOGD(TAG_ESP_NOW, "ESP-NOW send success");
@@ -480,10 +1298,22 @@ static void espnow_send_discovery_request(void *arg) {
     return;
   }
 
-  uint8_t bcast[6]        = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
-  msg_discovery_req_t req = {.type = MSG_DISCOVERY_REQ, .proto_ver = PROTOCOL_VERSION, .slave_type = (uint8_t)s_slave_type, .device_id = s_device_id, .req_count = 0};
-  size_t payload_len      = sizeof(msg_discovery_req_t);
-  esp_err_t err           = esp_now_send(bcast, (uint8_t *)&req, payload_len);
+  uint8_t bcast[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+  uint8_t packet[sizeof(msg_discovery_req_t) + ESPNOW_STATE_MASK_BYTES];
+  msg_discovery_req_t *req = (msg_discovery_req_t *)packet;
+  req->type                = MSG_DISCOVERY_REQ;
+  req->proto_ver           = PROTOCOL_VERSION;
+  req->slave_type          = (uint8_t)s_slave_type;
+  req->device_id           = s_device_id;
+  req->req_count           = 0;
+
+  espnow_state_mask_t fields;
+  if (get_slave_subscription(s_slave_type, &fields)) {
+    memcpy(packet + sizeof(msg_discovery_req_t), fields.bits, ESPNOW_STATE_MASK_BYTES);
+    req->req_count = ESPNOW_STATE_MASK_BYTES / 4;
+  }
+  size_t payload_len = sizeof(msg_discovery_req_t) + req->req_count * 4u;
+  esp_err_t err      = esp_now_send(bcast, packet, payload_len);
   if (err != ESP_OK) {
     ESP_LOGW(TAG_ESP_NOW, "esp_now_send discovery failed: %s", esp_err_to_name(err));
   }
@@ -508,11 +1338,16 @@ esp_err_t espnow_link_init(espnow_role_t role, espnow_slave_type_t slave_type) {
   s_role       = role;
   s_slave_type = slave_type;
   s_device_id  = esp_random();
+  anim_clock_set_reference(role == ESP_NOW_ROLE_MASTER);
 
   // Load persisted peers
   load_peers_from_spiffs();
+  if (s_role == ESP_NOW_ROLE_MASTER) {
+    load_subscriptions_from_spiffs();
+  }
   load_self_mac();
 
+  ESP_ERROR_CHECK(start_rx_worker());
   ESP_ERROR_CHECK(esp_now_init());
   ESP_ERROR_CHECK(esp_now_register_recv_cb(espnow_recv_cb));
   ESP_ERROR_CHECK(esp_now_register_send_cb(espnow_send_cb));
@@ -691,7 +1526,110 @@ esp_err_t espnow_link_register_peer(const uint8_t mac[6]) {
   return add_ret;
 }
 
-esp_err_t espnow_link_send_vehicle_state(const vehicle_state_t *state) {
+// Master: schedule one stream. Sends its due changes (every subscribed field for a keyframe).
+static esp_err_t send_state_stream(uint8_t id, uint64_t now_us) {
+  state_stream_t *stream = &s_streams[id];
+  bool keyframe          = stream->keyframe_wanted || !stream->has_keyframe || (now_us - stream->last_keyframe_us) >= ESPNOW_KEYFRAME_INTERVAL_US;
+
+  espnow_state_mask_t changed;
+  espnow_state_diff(&s_tx_scratch, &stream->wire, &changed);
+  espnow_state_mask_and(&changed, &stream->fields);
+
+  bool due = false;
+  for (int c = 0; c < ESPNOW_CLASS_COUNT; c++) {
+    if (!espnow_state_mask_intersects(&changed, &s_class_masks[c])) {
+      continue;
+    }
+    if (!stream->class_pending_us[c]) {
+      stream->class_pending_us[c] = now_us;
+    }
+    if (now_us - stream->class_sent_us[c] >= s_class_period_us[c]) {
+      due = true;
+    }
+  }
+  bool repeat = stream->repeats_left > 0 && now_us - stream->last_frame_us >= ESPNOW_REPEAT_INTERVAL_US;
+
+  espnow_state_mask_t fields;
+  if (keyframe) {
+    fields = stream->fields;
+  } else if (due || repeat) {
+    // Changes of classes not yet due ride along: they would need their own frame later
+    fields = changed;
+    if (repeat) {
+      espnow_state_mask_or(&fields, &stream->repeat);
+    }
+  } else {
+    return ESP_OK;
+  }
+
+  uint8_t packet[sizeof(msg_state_hdr_t) + ESPNOW_STATE_MAX_PAYLOAD];
+  msg_state_hdr_t *hdr = (msg_state_hdr_t *)packet;
+  hdr->type            = MSG_STATE;
+  hdr->wire_version    = ESPNOW_STATE_WIRE_VERSION;
+  hdr->flags           = keyframe ? STATE_FLAG_KEYFRAME : 0;
+  hdr->stream          = id;
+  hdr->seq             = stream->seq;
+  hdr->time_ms         = s_tx_time_ms;
+
+  int payload_len      = espnow_state_encode(&s_tx_scratch, &fields, packet + sizeof(msg_state_hdr_t), sizeof(packet) - sizeof(msg_state_hdr_t));
+  if (payload_len < 0) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+  size_t packet_len = sizeof(msg_state_hdr_t) + (size_t)payload_len;
+
+  esp_err_t ret     = esp_now_send(stream->dest, packet, packet_len);
+  if (ret != ESP_OK) {
+    // Not sent: the same changes are diffed again next time
+    log_send_error(ret, "esp_now_send vehicle_state");
+    return ret;
+  }
+
+  for (int c = 0; c < ESPNOW_CLASS_COUNT; c++) {
+    if (!espnow_state_mask_intersects(&fields, &s_class_masks[c])) {
+      continue;
+    }
+    espnow_class_stats_t *cs = &s_state_stats.classes[c];
+    cs->packets++;
+    if (stream->class_pending_us[c]) {
+      uint32_t latency_us         = (uint32_t)(now_us - stream->class_pending_us[c]);
+      cs->latency_max_us          = MAX(cs->latency_max_us, latency_us);
+      stream->class_pending_us[c] = 0;
+      cs->deliveries++;
+      cs->latency_total_us += latency_us;
+    }
+    stream->class_sent_us[c] = now_us;
+  }
+
+  // Redundancy: new critical changes restart the repeat cycle
+  espnow_state_mask_t critical = changed;
+  espnow_state_mask_and(&critical, &s_class_masks[ESPNOW_CLASS_CRITICAL]);
+  if (espnow_state_mask_any(&critical)) {
+    espnow_state_mask_or(&stream->repeat, &critical);
+    stream->repeats_left = ESPNOW_CRITICAL_REPEATS;
+  } else if (repeat) {
+    if (!due && !keyframe) {
+      s_state_stats.redundant++;
+    }
+    if (--stream->repeats_left == 0) {
+      memset(&stream->repeat, 0, sizeof(stream->repeat));
+    }
+  }
+
+  stream->wire          = s_tx_scratch;
+  stream->last_frame_us = now_us;
+  stream->seq++;
+  s_state_stats.packets++;
+  s_state_stats.bytes += packet_len;
+  if (keyframe) {
+    stream->has_keyframe     = true;
+    stream->keyframe_wanted  = false;
+    stream->last_keyframe_us = now_us;
+    s_state_stats.keyframes++;
+  }
+  return ESP_OK;
+}
+
+esp_err_t espnow_link_send_vehicle_state(const vehicle_state_t *state, uint32_t state_time_ms) {
   if (!state) {
     return ESP_ERR_INVALID_ARG;
   }
@@ -704,18 +1642,245 @@ esp_err_t espnow_link_send_vehicle_state(const vehicle_state_t *state) {
     return ESP_OK; // No peers connected, skip sending
   }
 
-  msg_vehicle_state_t msg = {.type = MSG_VEHICLE_STATE};
-  memcpy(&msg.state, state, sizeof(vehicle_state_t));
+  if (s_streams_dirty) {
+    rebuild_state_streams();
+  }
+  espnow_state_quantize(state, &s_tx_scratch);
+  s_tx_time_ms     = state_time_ms;
 
-  uint8_t bcast[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
-  esp_err_t ret    = esp_now_send(bcast, (const uint8_t *)&msg, sizeof(msg));
-  if (ret != ESP_OK) {
-    log_send_error(ret, "esp_now_send vehicle_state");
+  uint64_t now_us  = esp_timer_get_time();
+  esp_err_t result = ESP_OK;
+  for (uint8_t i = 0; i < s_stream_count; i++) {
+    if (s_streams[i].members == 0) {
+      continue;
+    }
+    esp_err_t ret = send_state_stream(i, now_us);
+    if (ret != ESP_OK) {
+      result = ret;
+    }
+  }
+  return result;
+}
+
+bool espnow_link_get_state_change_time_ms(uint32_t *time_ms) {
+  if (!time_ms || s_role != ESP_NOW_ROLE_SLAVE || !s_rx_change_valid || !anim_clock_is_synced()) {
+    return false;
+  }
+  uint32_t change_ms = s_rx_change_ms;
+  int32_t age_ms     = (int32_t)(anim_clock_now_ms() - change_ms);
+  if (age_ms < 0 || age_ms > ESPNOW_STATE_TIME_MAX_AGE_MS) {
+    return false;
   }
+  *time_ms = change_ms;
+  return true;
+}
 
+void espnow_link_get_state_stats(espnow_state_stats_t *out) {
+  if (out) {
+    *out = s_state_stats;
+  }
+}
+
+esp_err_t espnow_link_get_peer_subscription(const uint8_t mac[6], uint8_t *stream, uint8_t *field_count) {
+  if (!mac) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  esp_err_t ret = ESP_ERR_NOT_FOUND;
+  portENTER_CRITICAL(&s_subs_lock);
+  for (size_t i = 0; i < s_sub_count; i++) {
+    if (memcmp(s_subs[i].mac, mac, 6) == 0) {
+      if (stream) {
+        *stream = s_subs[i].stream;
+      }
+      if (field_count) {
+        *field_count = espnow_state_mask_count(&s_subs[i].fields);
+      }
+      ret = ESP_OK;
+      break;
+    }
+  }
+  portEXIT_CRITICAL(&s_subs_lock);
   return ret;
 }
 
+size_t espnow_link_get_pixel_peers(espnow_pixel_peer_t *out, size_t max_peers) {
+  size_t count = 0;
+  portENTER_CRITICAL(&s_subs_lock);
+  for (int i = 0; i < ESPNOW_MAX_PEERS && count < max_peers; i++) {
+    if (s_pixel_peers[i].led_count) {
+      memcpy(out[count].mac, s_pixel_peers[i].mac, 6);
+      out[count].led_count = s_pixel_peers[i].led_count;
+      count++;
+    }
+  }
+  portEXIT_CRITICAL(&s_subs_lock);
+  return count;
+}
+
+esp_err_t espnow_link_send_pixel_frame(const uint8_t mac[6], const uint8_t *rgb, uint16_t led_count) {
+  if (!mac || !rgb || led_count == 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (!s_init_done || s_role != ESP_NOW_ROLE_MASTER) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  uint64_t now_us    = esp_timer_get_time();
+  pixel_peer_t *peer = NULL;
+  bool keyframe      = false;
+  portENTER_CRITICAL(&s_subs_lock);
+  for (int i = 0; i < ESPNOW_MAX_PEERS && !peer; i++) {
+    if (s_pixel_peers[i].led_count == led_count && memcmp(s_pixel_peers[i].mac, mac, 6) == 0) {
+      peer                  = &s_pixel_peers[i];
+      keyframe              = peer->keyframe_wanted || !peer->has_prev || now_us - peer->last_keyframe_us >= ESPNOW_PIXEL_KEYFRAME_INTERVAL_US;
+      peer->keyframe_wanted = false;
+    }
+  }
+  portEXIT_CRITICAL(&s_subs_lock);
+  if (!peer) {
+    return ESP_ERR_NOT_FOUND;
+  }
+
+  // Frame the slave has, grown with its strip (keyframes only if it cannot be allocated)
+  size_t frame_size = led_count * 3u;
+  if (peer->prev_size < frame_size) {
+    uint8_t *prev = realloc(peer->prev, frame_size);
+    if (prev) {
+      peer->prev      = prev;
+      peer->prev_size = frame_size;
+    }
+    peer->has_prev = false;
+    keyframe       = true;
+  }
+
+  uint8_t packet[sizeof(msg_pixels_hdr_t) + PIXEL_STREAM_MAX_CHUNK];
+  msg_pixels_hdr_t *hdr = (msg_pixels_hdr_t *)packet;
+  const uint8_t *base   = keyframe ? NULL : peer->prev;
+  int64_t encode_start  = esp_timer_get_time();
+  for (uint16_t first = 0; first < led_count;) {
+    uint16_t encoded = 0;
+    pixel_stream_encoding_t encoding;
+    int payload_len = pixel_stream_encode_chunk(rgb, base, first, led_count, packet + sizeof(*hdr), PIXEL_STREAM_MAX_CHUNK, &encoded, &encoding);
+    if (payload_len < 0) {
+      return ESP_ERR_INVALID_SIZE;
+    }
+    hdr->type       = MSG_PIXELS;
+    hdr->flags      = (keyframe ? PIXEL_FLAG_KEYFRAME : 0) | (first + encoded == led_count ? PIXEL_FLAG_LAST : 0);
+    hdr->encoding   = (uint8_t)encoding;
+    hdr->reserved   = 0;
+    hdr->seq        = peer->seq;
+    hdr->first_led  = first;
+    hdr->led_count  = encoded;
+    hdr->total_leds = led_count;
+    s_px_stats.encode_us += (uint32_t)(esp_timer_get_time() - encode_start);
+
+    esp_err_t ret = esp_now_send(mac, packet, sizeof(*hdr) + (size_t)payload_len);
+    if (ret != ESP_OK) {
+      // The slave misses this frame: the next one must not be a delta
+      log_send_error(ret, "esp_now_send pixels");
+      peer->has_prev = false;
+      peer->seq++;
+      return ret;
+    }
+    s_px_stats.packets++;
+    s_px_stats.bytes += sizeof(*hdr) + (size_t)payload_len;
+    s_px_stats.chunks[encoding]++;
+    first += encoded;
+    encode_start = esp_timer_get_time();
+  }
+
+  if (peer->prev_size >= frame_size) {
+    memcpy(peer->prev, rgb, frame_size);
+    peer->has_prev = true;
+  }
+  peer->seq++;
+  s_px_stats.frames++;
+  s_px_stats.raw_bytes += frame_size;
+  if (keyframe) {
+    peer->last_keyframe_us = now_us;
+    s_px_stats.keyframes++;
+  }
+  return ESP_OK;
+}
+
+esp_err_t espnow_link_set_pixel_offload(bool enable, uint16_t led_count) {
+  if (enable && (led_count == 0 || led_count > MAX_LED_COUNT)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  // New length: the RX worker and the LED task may be using the current buffers, so the
+  // new ones are handed over and installed by the RX worker before its next chunk
+  if (enable && led_count != s_px_sub_led_count) {
+    uint8_t *frame = calloc(led_count, 3);
+    uint8_t *ready = calloc(led_count, 3);
+    if (!frame || !ready) {
+      free(frame);
+      free(ready);
+      return ESP_ERR_NO_MEM;
+    }
+    portENTER_CRITICAL(&s_px_lock);
+    uint8_t *old_frame = s_px_new_frame;
+    uint8_t *old_ready = s_px_new_ready;
+    s_px_new_frame     = frame;
+    s_px_new_ready     = ready;
+    s_px_new_led_count = led_count;
+    portEXIT_CRITICAL(&s_px_lock);
+    free(old_frame); // Never installed
+    free(old_ready);
+    s_px_sub_led_count = led_count;
+  }
+  portENTER_CRITICAL(&s_px_lock);
+  s_px_ready_new = false;
+  portEXIT_CRITICAL(&s_px_lock);
+  s_px_last_frame_us = 0;
+  s_px_enabled       = enable;
+
+  // Tell the master now (otherwise at the next state packet)
+  espnow_peer_info_t master;
+  if (s_init_done && s_role == ESP_NOW_ROLE_SLAVE && espnow_link_get_master_info(&master)) {
+    send_pixel_subscription(master.mac, enable ? PIXEL_SUB_FLAG_KEYFRAME : 0, esp_timer_get_time());
+  }
+  ESP_LOGI(TAG_ESP_NOW, "Pixel offload %s (%u LEDs)", enable ? "enabled" : "disabled", s_px_sub_led_count);
+  return ESP_OK;
+}
+
+bool espnow_link_pixel_offload_active(void) {
+  return s_px_enabled && s_px_last_frame_us && esp_timer_get_time() - s_px_last_frame_us < ESPNOW_PIXEL_SILENT_US;
+}
+
+bool espnow_link_take_pixel_frame(uint8_t *rgb, uint16_t max_leds, uint16_t *led_count) {
+  if (!rgb || !s_px_enabled) {
+    return false;
+  }
+
+  bool fresh = false;
+  portENTER_CRITICAL(&s_px_lock);
+  if (s_px_ready_new && s_px_ready) {
+    uint16_t count = MIN(s_px_led_count, max_leds);
+    memcpy(rgb, s_px_ready, count * 3u);
+    s_px_ready_new = false;
+    fresh          = true;
+    if (led_count) {
+      *led_count = count;
+    }
+  }
+  portEXIT_CRITICAL(&s_px_lock);
+  return fresh;
+}
+
+void espnow_link_get_pixel_stats(espnow_pixel_stats_t *out) {
+  if (out) {
+    *out = s_px_stats;
+  }
+}
+
+void espnow_link_get_rx_stats(espnow_rx_stats_t *out) {
+  if (out) {
+    *out = s_rx_stats;
+  }
+}
+
 espnow_role_t espnow_link_get_role(void) {
   return s_role;
 }
@@ -755,7 +1920,9 @@ esp_err_t espnow_link_disconnect(void) {
     esp_now_del_peer(peer.peer_addr);
     remove_peer_from_cache(peer.peer_addr);
   }
+  portENTER_CRITICAL(&s_peer_lock);
   s_peer_count = 0;
+  portEXIT_CRITICAL(&s_peer_lock);
   persist_peers_to_spiffs();
   s_last_peer_hb_us = 0;
   if (s_discovery_timer && esp_timer_is_active(s_discovery_timer)) {
@@ -774,6 +1941,8 @@ esp_err_t espnow_link_disconnect_peer(const uint8_t mac[6]) {
     esp_now_del_peer(mac);
   }
   remove_peer_from_cache(mac);
+  remove_peer_subscription(mac);
+  set_pixel_peer(mac, 0);
   persist_peers_to_spiffs();
   return ESP_OK;
 }
@@ -785,8 +1954,10 @@ esp_err_t espnow_link_get_peers(espnow_peer_info_t *out_peers, size_t max_peers,
   if (!out_peers || max_peers == 0) {
     return ESP_OK;
   }
+  portENTER_CRITICAL(&s_peer_lock);
   size_t copy_count = (s_peer_count < max_peers) ? s_peer_count : max_peers;
   memcpy(out_peers, s_peers, copy_count * sizeof(espnow_peer_info_t));
+  portEXIT_CRITICAL(&s_peer_lock);
   if (out_count) {
     *out_count = copy_count;
   }
@@ -850,6 +2021,11 @@ uint64_t espnow_link_get_last_test_rx_us(void) {
 }
 
 void espnow_link_set_role_type(espnow_role_t role, espnow_slave_type_t type) {
+  if (role != s_role) {
+    anim_clock_set_reference(role == ESP_NOW_ROLE_MASTER);
+    s_time_samples    = 0;
+    s_rx_change_valid = false;
+  }
   s_role       = role;
   s_slave_type = type;
 
@@ -0,0 +1,344 @@
+#include "espnow_state_codec.h"
+
+#include <math.h>
+#include <string.h>
+
+typedef enum {
+  SRC_U8 = 0,
+  SRC_I8,
+  SRC_F32,
+} field_src_t;
+
+typedef enum {
+  WIRE_U8 = 0,
+  WIRE_I8,
+  WIRE_U16,
+  WIRE_I16,
+  WIRE_U32,
+} field_wire_t;
+
+typedef struct {
+  const char *name;
+  uint16_t offset;
+  uint8_t src;
+  uint8_t wire;
+  uint8_t cls; // espnow_state_class_t
+  float step;  // Value of one wire unit (SRC_F32 only)
+} field_def_t;
+
+#define FIELD_U8(member, cls) {#member, offsetof(vehicle_state_t, member), SRC_U8, WIRE_U8, cls, 1.0f}
+#define FIELD_I8(member, cls) {#member, offsetof(vehicle_state_t, member), SRC_I8, WIRE_I8, cls, 1.0f}
+#define FIELD_F32(member, wire, step, cls) {#member, offsetof(vehicle_state_t, member), SRC_F32, wire, cls, step}
+
+// Field IDs are positions in this table: only append, never reorder or remove
+// (a field that is no longer used keeps its slot)
+static const field_def_t s_fields[] = {
+    FIELD_F32(speed_kph, WIRE_I16, 0.01f, ESPNOW_CLASS_DYNAMIC),
+    FIELD_F32(speed_limit, WIRE_U8, 1.0f, ESPNOW_CLASS_EVENT),
+    FIELD_I8(pedal_map, ESPNOW_CLASS_EVENT),
+    FIELD_I8(gear, ESPNOW_CLASS_EVENT),
+    FIELD_U8(accel_pedal_pos, ESPNOW_CLASS_DYNAMIC),
+    FIELD_U8(brake_pressed, ESPNOW_CLASS_CRITICAL),
+    FIELD_U8(locked, ESPNOW_CLASS_EVENT),
+    FIELD_U8(door_front_left_open, ESPNOW_CLASS_EVENT),
+    FIELD_U8(door_rear_left_open, ESPNOW_CLASS_EVENT),
+    FIELD_U8(door_front_right_open, ESPNOW_CLASS_EVENT),
+    FIELD_U8(door_rear_right_open, ESPNOW_CLASS_EVENT),
+    FIELD_U8(frunk_open, ESPNOW_CLASS_EVENT),
+    FIELD_U8(trunk_open, ESPNOW_CLASS_EVENT),
+    FIELD_U8(left_btn_scroll_up, ESPNOW_CLASS_EVENT),
+    FIELD_U8(left_btn_scroll_down, ESPNOW_CLASS_EVENT),
+    FIELD_U8(left_btn_press, ESPNOW_CLASS_EVENT),
+    FIELD_U8(left_btn_dbl_press, ESPNOW_CLASS_EVENT),
+    FIELD_U8(left_btn_tilt_right, ESPNOW_CLASS_EVENT),
+    FIELD_U8(left_btn_tilt_left, ESPNOW_CLASS_EVENT),
+    FIELD_U8(right_btn_scroll_up, ESPNOW_CLASS_EVENT),
+    FIELD_U8(right_btn_scroll_down, ESPNOW_CLASS_EVENT),
+    FIELD_U8(right_btn_press, ESPNOW_CLASS_EVENT),
+    FIELD_U8(right_btn_dbl_press, ESPNOW_CLASS_EVENT),
+    FIELD_U8(right_btn_tilt_right, ESPNOW_CLASS_EVENT),
+    FIELD_U8(right_btn_tilt_left, ESPNOW_CLASS_EVENT),
+    FIELD_U8(turn_left, ESPNOW_CLASS_CRITICAL),
+    FIELD_U8(turn_right, ESPNOW_CLASS_CRITICAL),
+    FIELD_U8(hazard, ESPNOW_CLASS_CRITICAL),
+    FIELD_U8(headlights, ESPNOW_CLASS_EVENT),
+    FIELD_U8(high_beams, ESPNOW_CLASS_EVENT),
+    FIELD_U8(fog_lights, ESPNOW_CLASS_EVENT),
+    FIELD_F32(soc_percent, WIRE_U16, 0.01f, ESPNOW_CLASS_ENERGY),
+    FIELD_F32(pack_energy, WIRE_U16, 0.01f, ESPNOW_CLASS_ENERGY),
+    FIELD_F32(remaining_energy, WIRE_U16, 0.01f, ESPNOW_CLASS_ENERGY),
+    FIELD_F32(buffer_energy, WIRE_U16, 0.01f, ESPNOW_CLASS_ENERGY),
+    FIELD_U8(charging_cable, ESPNOW_CLASS_EVENT),
+    FIELD_U8(charging, ESPNOW_CLASS_EVENT),
+    FIELD_U8(charge_status, ESPNOW_CLASS_EVENT),
+    FIELD_F32(charge_power_kw, WIRE_I16, 0.1f, ESPNOW_CLASS_ENERGY),
+    FIELD_U8(charging_port, ESPNOW_CLASS_EVENT),
+    FIELD_F32(rear_power, WIRE_I16, 0.1f, ESPNOW_CLASS_DYNAMIC),
+    FIELD_F32(rear_power_limit, WIRE_I16, 0.1f, ESPNOW_CLASS_ENERGY),
+    FIELD_F32(front_power, WIRE_I16, 0.1f, ESPNOW_CLASS_DYNAMIC),
+    FIELD_F32(front_power_limit, WIRE_I16, 0.1f, ESPNOW_CLASS_ENERGY),
+    FIELD_F32(max_regen, WIRE_I16, 0.1f, ESPNOW_CLASS_ENERGY),
+    FIELD_U8(train_type, ESPNOW_CLASS_EVENT),
+    FIELD_U8(sentry_mode, ESPNOW_CLASS_EVENT),
+    FIELD_U8(sentry_alert, ESPNOW_CLASS_CRITICAL),
+    FIELD_F32(battery_voltage_LV, WIRE_U16, 0.01f, ESPNOW_CLASS_ENERGY),
+    FIELD_F32(battery_voltage_HV, WIRE_U16, 0.1f, ESPNOW_CLASS_ENERGY),
+    FIELD_F32(odometer_km, WIRE_U32, 0.1f, ESPNOW_CLASS_ENERGY),
+    FIELD_U8(blindspot_left, ESPNOW_CLASS_CRITICAL),
+    FIELD_U8(blindspot_right, ESPNOW_CLASS_CRITICAL),
+    FIELD_U8(blindspot_left_alert, ESPNOW_CLASS_CRITICAL),
+    FIELD_U8(blindspot_right_alert, ESPNOW_CLASS_CRITICAL),
+    FIELD_U8(side_collision_left, ESPNOW_CLASS_CRITICAL),
+    FIELD_U8(side_collision_right, ESPNOW_CLASS_CRITICAL),
+    FIELD_U8(lane_departure_left_lv1, ESPNOW_CLASS_CRITICAL),
+    FIELD_U8(lane_departure_left_lv2, ESPNOW_CLASS_CRITICAL),
+    FIELD_U8(lane_departure_right_lv1, ESPNOW_CLASS_CRITICAL),
+    FIELD_U8(lane_departure_right_lv2, ESPNOW_CLASS_CRITICAL),
+    FIELD_U8(forward_collision, ESPNOW_CLASS_CRITICAL),
+    FIELD_U8(night_mode, ESPNOW_CLASS_EVENT),
+    FIELD_F32(brightness, WIRE_U16, 0.01f, ESPNOW_CLASS_DYNAMIC),
+    FIELD_U8(autopilot, ESPNOW_CLASS_EVENT),
+    FIELD_U8(autopilot_alert_lv1, ESPNOW_CLASS_CRITICAL),
+    FIELD_U8(autopilot_alert_lv2, ESPNOW_CLASS_CRITICAL),
+    FIELD_U8(cruise, ESPNOW_CLASS_EVENT),
+};
+
+#define FIELD_COUNT (sizeof(s_fields) / sizeof(s_fields[0]))
+
+_Static_assert(FIELD_COUNT <= ESPNOW_STATE_MAX_FIELDS, "Too many ESP-NOW state fields");
+_Static_assert(ESPNOW_STATE_MASK_BYTES <= 16, "The group mask covers 16 presence bytes");
+
+static const uint8_t s_wire_size[] = {[WIRE_U8] = 1, [WIRE_I8] = 1, [WIRE_U16] = 2, [WIRE_I16] = 2, [WIRE_U32] = 4};
+
+uint8_t espnow_state_field_count(void) {
+  return (uint8_t)FIELD_COUNT;
+}
+
+const char *espnow_state_field_name(uint8_t field_id) {
+  return field_id < FIELD_COUNT ? s_fields[field_id].name : "unknown";
+}
+
+int espnow_state_field_id(const char *name) {
+  if (!name) {
+    return -1;
+  }
+  for (size_t i = 0; i < FIELD_COUNT; i++) {
+    if (strcmp(s_fields[i].name, name) == 0) {
+      return (int)i;
+    }
+  }
+  return -1;
+}
+
+espnow_state_class_t espnow_state_field_class(uint8_t field_id) {
+  return field_id < FIELD_COUNT ? (espnow_state_class_t)s_fields[field_id].cls : ESPNOW_CLASS_EVENT;
+}
+
+const char *espnow_state_class_name(espnow_state_class_t cls) {
+  switch (cls) {
+  case ESPNOW_CLASS_CRITICAL:
+    return "critical";
+  case ESPNOW_CLASS_EVENT:
+    return "event";
+  case ESPNOW_CLASS_DYNAMIC:
+    return "dynamic";
+  case ESPNOW_CLASS_ENERGY:
+    return "energy";
+  default:
+    return "unknown";
+  }
+}
+
+void espnow_state_class_mask(espnow_state_class_t cls, espnow_state_mask_t *mask) {
+  memset(mask, 0, sizeof(*mask));
+  for (size_t i = 0; i < FIELD_COUNT; i++) {
+    if (s_fields[i].cls == cls) {
+      espnow_state_mask_set(mask, (uint8_t)i);
+    }
+  }
+}
+
+void espnow_state_mask_all(espnow_state_mask_t *mask) {
+  memset(mask, 0, sizeof(*mask));
+  for (size_t i = 0; i < FIELD_COUNT; i++) {
+    espnow_state_mask_set(mask, (uint8_t)i);
+  }
+}
+
+static int32_t clamp_to_wire(int64_t v, uint8_t wire) {
+  int64_t lo = 0;
+  int64_t hi = UINT8_MAX;
+  switch (wire) {
+  case WIRE_I8:
+    lo = INT8_MIN;
+    hi = INT8_MAX;
+    break;
+  case WIRE_U16:
+    hi = UINT16_MAX;
+    break;
+  case WIRE_I16:
+    lo = INT16_MIN;
+    hi = INT16_MAX;
+    break;
+  case WIRE_U32:
+    hi = INT32_MAX;
+    break;
+  }
+  return (int32_t)(v < lo ? lo : (v > hi ? hi : v));
+}
+
+void espnow_state_quantize(const vehicle_state_t *state, espnow_state_wire_t *wire) {
+  const uint8_t *base = (const uint8_t *)state;
+
+  for (size_t i = 0; i < FIELD_COUNT; i++) {
+    const field_def_t *f = &s_fields[i];
+    int64_t v;
+    switch (f->src) {
+    case SRC_U8:
+      v = base[f->offset];
+      break;
+    case SRC_I8:
+      v = (int8_t)base[f->offset];
+      break;
+    default: {
+      float value;
+      memcpy(&value, base + f->offset, sizeof(value));
+      v = isfinite(value) ? llroundf(value / f->step) : 0;
+      break;
+    }
+    }
+    wire->values[i] = clamp_to_wire(v, f->wire);
+  }
+}
+
+void espnow_state_diff(const espnow_state_wire_t *a, const espnow_state_wire_t *b, espnow_state_mask_t *changed) {
+  memset(changed, 0, sizeof(*changed));
+  for (size_t i = 0; i < FIELD_COUNT; i++) {
+    if (a->values[i] != b->values[i]) {
+      espnow_state_mask_set(changed, (uint8_t)i);
+    }
+  }
+}
+
+size_t espnow_state_encoded_size(const espnow_state_mask_t *fields) {
+  size_t size = 2;
+  for (int g = 0; g < ESPNOW_STATE_MASK_BYTES; g++) {
+    if (fields->bits[g]) {
+      size++;
+    }
+  }
+  for (size_t i = 0; i < FIELD_COUNT; i++) {
+    if (espnow_state_mask_test(fields, (uint8_t)i)) {
+      size += s_wire_size[s_fields[i].wire];
+    }
+  }
+  return size;
+}
+
+int espnow_state_encode(const espnow_state_wire_t *wire, const espnow_state_mask_t *fields, uint8_t *out, size_t out_size) {
+  if (espnow_state_encoded_size(fields) > out_size) {
+    return -1;
+  }
+
+  uint16_t group_mask = 0;
+  size_t pos          = 2;
+  for (int g = 0; g < ESPNOW_STATE_MASK_BYTES; g++) {
+    if (fields->bits[g]) {
+      group_mask |= (uint16_t)(1u << g);
+      out[pos++] = fields->bits[g];
+    }
+  }
+  out[0] = (uint8_t)group_mask;
+  out[1] = (uint8_t)(group_mask >> 8);
+
+  for (size_t i = 0; i < FIELD_COUNT; i++) {
+    if (!espnow_state_mask_test(fields, (uint8_t)i)) {
+      continue;
+    }
+    uint32_t v = (uint32_t)wire->values[i];
+    for (int b = 0; b < s_wire_size[s_fields[i].wire]; b++) {
+      out[pos++] = (uint8_t)(v >> (8 * b));
+    }
+  }
+  return (int)pos;
+}
+
+static void apply_field(const field_def_t *f, int32_t v, vehicle_state_t *state) {
+  uint8_t *base = (uint8_t *)state;
+  switch (f->src) {
+  case SRC_U8:
+  case SRC_I8:
+    base[f->offset] = (uint8_t)v;
+    break;
+  default: {
+    float value = (float)v * f->step;
+    memcpy(base + f->offset, &value, sizeof(value));
+    break;
+  }
+  }
+}
+
+esp_err_t espnow_state_decode(const uint8_t *in, size_t len, vehicle_state_t *state, espnow_state_mask_t *decoded) {
+  espnow_state_mask_t fields = {0};
+
+  if (decoded) {
+    memset(decoded, 0, sizeof(*decoded));
+  }
+  if (len < 2) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+
+  uint16_t group_mask = (uint16_t)(in[0] | (in[1] << 8));
+  size_t pos          = 2;
+  for (int g = 0; g < 16; g++) {
+    if (!(group_mask & (1u << g))) {
+      continue;
+    }
+    if (pos >= len) {
+      return ESP_ERR_INVALID_SIZE;
+    }
+    if (g < ESPNOW_STATE_MASK_BYTES) {
+      fields.bits[g] = in[pos];
+    }
+    pos++;
+  }
+
+  for (size_t i = 0; i < ESPNOW_STATE_MAX_FIELDS; i++) {
+    if (!espnow_state_mask_test(&fields, (uint8_t)i)) {
+      continue;
+    }
+    if (i >= FIELD_COUNT) {
+      break; // Added by a newer firmware: its size is unknown, and every later field is newer too
+    }
+
+    const field_def_t *f = &s_fields[i];
+    uint8_t size         = s_wire_size[f->wire];
+    if (pos + size > len) {
+      return ESP_ERR_INVALID_SIZE;
+    }
+
+    uint32_t raw = 0;
+    for (int b = 0; b < size; b++) {
+      raw |= (uint32_t)in[pos + b] << (8 * b);
+    }
+    pos += size;
+
+    int32_t v;
+    switch (f->wire) {
+    case WIRE_I8:
+      v = (int8_t)raw;
+      break;
+    case WIRE_I16:
+      v = (int16_t)raw;
+      break;
+    default:
+      v = (int32_t)raw;
+      break;
+    }
+    apply_field(f, v, state);
+    if (decoded) {
+      espnow_state_mask_set(decoded, (uint8_t)i);
+    }
+  }
+  return ESP_OK;
+}
@@ -0,0 +1,119 @@
+#include "frame_scheduler.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include <string.h>
+
+static const char *TAG = "FRAME_SCHED";
+
+static frame_scheduler_stats_t s_stats;
+static portMUX_TYPE s_lock           = portMUX_INITIALIZER_UNLOCKED;
+static volatile uint8_t s_target_fps = FRAME_SCHEDULER_FPS_DEFAULT;
+static TickType_t s_last_wake        = 0; // Deadline the current frame started on
+static int64_t s_frame_start_us      = 0;
+
+// The period is a whole number of ticks (1 ms at CONFIG_FREERTOS_HZ=1000)
+static TickType_t period_ticks(uint8_t fps) {
+  TickType_t ticks = (configTICK_RATE_HZ + fps / 2) / fps;
+  return ticks > 0 ? ticks : 1;
+}
+
+const uint32_t frame_scheduler_histogram_bounds_us[FRAME_SCHEDULER_HISTOGRAM_BUCKETS - 1] = {1000, 2000, 4000, 8000, 12000, 16000, 20000};
+
+static uint8_t histogram_bucket(uint32_t frame_us) {
+  uint8_t bucket = 0;
+  while (bucket < FRAME_SCHEDULER_HISTOGRAM_BUCKETS - 1 && frame_us >= frame_scheduler_histogram_bounds_us[bucket]) {
+    bucket++;
+  }
+  return bucket;
+}
+
+void frame_scheduler_init(uint8_t target_fps) {
+  if (frame_scheduler_set_fps(target_fps) != ESP_OK) {
+    s_target_fps = FRAME_SCHEDULER_FPS_DEFAULT;
+  }
+  frame_scheduler_reset_stats();
+  s_last_wake      = xTaskGetTickCount();
+  s_frame_start_us = 0;
+  ESP_LOGI(TAG, "Frame scheduler: %u FPS (%lu ms period)", s_target_fps, (unsigned long)(period_ticks(s_target_fps) * portTICK_PERIOD_MS));
+}
+
+esp_err_t frame_scheduler_set_fps(uint8_t target_fps) {
+  if (target_fps < FRAME_SCHEDULER_FPS_MIN || target_fps > FRAME_SCHEDULER_FPS_MAX) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (target_fps != s_target_fps) {
+    ESP_LOGI(TAG, "Target frame rate: %u FPS", target_fps);
+  }
+  s_target_fps = target_fps;
+  return ESP_OK;
+}
+
+uint8_t frame_scheduler_get_fps(void) {
+  return s_target_fps;
+}
+
+void frame_scheduler_begin_frame(void) {
+  int64_t now_us = esp_timer_get_time();
+  if (s_frame_start_us != 0) {
+    uint32_t interval_us = (uint32_t)(now_us - s_frame_start_us);
+    portENTER_CRITICAL(&s_lock);
+    if (interval_us > s_stats.interval_us_max) {
+      s_stats.interval_us_max = interval_us;
+    }
+    s_stats.interval_us_total += interval_us;
+    portEXIT_CRITICAL(&s_lock);
+  }
+  s_frame_start_us = now_us;
+}
+
+void frame_scheduler_wait_next(void) {
+  uint32_t frame_us = (uint32_t)(esp_timer_get_time() - s_frame_start_us);
+  TickType_t period = period_ticks(s_target_fps);
+  TickType_t late   = xTaskGetTickCount() - s_last_wake;
+  // Deadlines passed since this frame's: the first one is taken by the next frame
+  uint32_t missed   = late / period;
+
+  portENTER_CRITICAL(&s_lock);
+  s_stats.frames++;
+  s_stats.frame_us_last = frame_us;
+  if (frame_us > s_stats.frame_us_max) {
+    s_stats.frame_us_max = frame_us;
+  }
+  s_stats.frame_us_total += frame_us;
+  s_stats.histogram[histogram_bucket(frame_us)]++;
+  if (missed > 0) {
+    s_stats.overruns++;
+    s_stats.skipped += missed - 1;
+  }
+  portEXIT_CRITICAL(&s_lock);
+
+  if (missed > 0) {
+    // Restart the schedule from now instead of rendering the missed frames back to
+    // back. Still block for a tick so lower priority tasks on this core get to run.
+    vTaskDelay(1);
+    s_last_wake = xTaskGetTickCount();
+    return;
+  }
+  vTaskDelayUntil(&s_last_wake, period);
+}
+
+void frame_scheduler_get_stats(frame_scheduler_stats_t *stats) {
+  if (stats == NULL) {
+    return;
+  }
+  portENTER_CRITICAL(&s_lock);
+  *stats = s_stats;
+  portEXIT_CRITICAL(&s_lock);
+  stats->target_fps = s_target_fps;
+  stats->period_us  = period_ticks(s_target_fps) * portTICK_PERIOD_MS * 1000;
+}
+
+void frame_scheduler_reset_stats(void) {
+  portENTER_CRITICAL(&s_lock);
+  memset(&s_stats, 0, sizeof(s_stats));
+  portEXIT_CRITICAL(&s_lock);
+}
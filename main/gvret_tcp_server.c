@@ -1,5 +1,7 @@
 #include "gvret_tcp_server.h"
 
+#include "can_frame_hub.h"
+#include "can_id_filter.h"
 #include "can_servers_config.h"
 #include "esp_log.h"
 #include "esp_timer.h"
@@ -20,7 +22,19 @@ static const char *TAG = "GVRET_TCP";
 #define GVRET_TCP_PORT 23 // Standard GVRET network port (hardcoded in SavvyCAN)
 #define MAX_GVRET_CLIENTS 4
 #define GVRET_RX_BUFFER_SIZE 128
-#define GVRET_TX_BUFFER_SIZE 2048
+
+// TX batching: the sender task reads each client's frames from the shared frame hub,
+// encodes them into MSS-sized writes (or flushes after GVRET_COALESCE_MS at low traffic)
+#ifdef CONFIG_LWIP_TCP_MSS
+#define GVRET_TX_BATCH_SIZE CONFIG_LWIP_TCP_MSS
+#else
+#define GVRET_TX_BATCH_SIZE 1436
+#endif
+#define GVRET_CTRL_BUFFER_SIZE 64
+#define GVRET_COALESCE_MS 5
+#define GVRET_SLOW_CLIENT_TIMEOUT_MS 3000 // Disconnect clients that keep losing frames
+#define GVRET_SLOW_CLIENT_RECOVER_MS 500  // No frame lost for this long: the client caught up
+#define GVRET_HUB_READ_CHUNK 16
 
 // GVRET Protocol Commands
 #define GVRET_CMD_BUILD_CAN_FRAME 0x00
@@ -38,16 +52,60 @@ static const char *TAG = "GVRET_TCP";
 #define GVRET_CMD_GET_NUM_BUSES 0x0C
 #define GVRET_CMD_SETUP_EXT_BUSES 0x0E
 
+// Filter commands (extension, not part of upstream GVRET/SavvyCAN)
+// ADD/REMOVE payload: [id:4 LE, bit 31 = extended] [mask:4 LE], reply: [0xF1] [cmd] [status]
+#define GVRET_CMD_ADD_FILTER 0x40
+#define GVRET_CMD_REMOVE_FILTER 0x41
+#define GVRET_CMD_CLEAR_FILTERS 0x42
+#define GVRET_FILTER_PAYLOAD_LEN 8
+
 // Frame markers
 #define GVRET_FRAME_START 0xF1
 #define GVRET_BINARY_MODE 0xE7 // Enter binary mode command
 
+// Encoded CAN frame layout: 11-byte header followed by 0-8 data bytes
+#define GVRET_FRAME_HEADER_LEN 11
+#define GVRET_FRAME_MAX_LEN (GVRET_FRAME_HEADER_LEN + 8)
+
+// Wake the sender as soon as a client has a full segment worth of frames waiting
+#define GVRET_HUB_NOTIFY_FRAMES (GVRET_TX_BATCH_SIZE / GVRET_FRAME_MAX_LEN)
+
+// Frame hub consumer names (one consumer per client slot)
+static const char *const hub_consumer_names[MAX_GVRET_CLIENTS] = {"gvret0", "gvret1", "gvret2", "gvret3"};
+
 // Client structure
 typedef struct {
   int socket;
+  struct sockaddr_in addr;
   TaskHandle_t task_handle;
-  bool active;
+  volatile bool active;
+  volatile bool evicted; // Shut down by the sender task (too slow)
+
+  // CAN ID subscription, evaluated by the sender task on each frame read from the hub
+  can_id_filter_t filter;
+
+  // Read cursor in the shared frame hub (registered once per slot, kept)
+  can_hub_consumer_t *hub;
+  bool lagging; // Set while the hub overwrites frames this client has not read
+
+  // Sender-side batch: only holds whole frames so a partial send never splits one
+  uint8_t *batch;
+  uint16_t batch_len;
+  uint16_t batch_off;
+  int64_t last_flush_us;
+  uint32_t behind_since_ms; // 0 when the client keeps up
+  uint32_t last_lost_ms;    // Last hub overrun of this client
+
+  // Command responses queued by the client task, flushed between frames
+  uint8_t ctrl[GVRET_CTRL_BUFFER_SIZE];
+  uint8_t ctrl_len;
+  portMUX_TYPE ctrl_lock;
+
+  // Statistics
   uint32_t frames_sent;
+  uint32_t bytes_sent;
+  uint32_t frames_dropped;
+  uint32_t overflow_events;
 } gvret_client_t;
 
 // Server state
@@ -55,9 +113,10 @@ static bool server_initialized         = false;
 static bool server_running             = false;
 static int listen_socket               = -1;
 static TaskHandle_t accept_task_handle = NULL;
+static TaskHandle_t sender_task_handle = NULL;
 static gvret_client_t clients[MAX_GVRET_CLIENTS];
 static SemaphoreHandle_t clients_mutex = NULL;
-static bool has_active_clients         = false; // Cached client status for fast check
+static gvret_tcp_stats_t closed_stats  = {0}; // Counters of already disconnected clients
 
 // ============================================================================
 // GVRET Protocol Frame Encoding
@@ -69,14 +128,11 @@ static bool has_active_clients         = false; // Cached client status for fast
  * GVRET frame format (13-21 bytes):
  * [0xF1] [cmd=0x00] [timestamp:4] [id:4] [dlc+bus] [data:0-8]
  *
- * IRAM_ATTR: Called for every CAN frame received (~2000 fps), pure encoding logic
- *
- * @param bus Bus number (0 or 1)
- * @param msg TWAI message
- * @param out_frame Output buffer (must be at least 21 bytes)
+ * @param frame Frame read from the hub
+ * @param out_frame Output buffer (must be at least GVRET_FRAME_MAX_LEN bytes)
  * @return Frame length in bytes
  */
-static int IRAM_ATTR encode_gvret_frame(int bus, const twai_message_t *msg, uint8_t *out_frame) {
+static int encode_gvret_frame(const can_hub_frame_t *frame, uint8_t *out_frame) {
   int idx            = 0;
 
   // Frame start marker
@@ -85,8 +141,8 @@ static int IRAM_ATTR encode_gvret_frame(int bus, const twai_message_t *msg, uint
   // Command: BUILD_CAN_FRAME
   out_frame[idx++]   = GVRET_CMD_BUILD_CAN_FRAME;
 
-  // Timestamp (microseconds) - get current time
-  uint32_t timestamp = (uint32_t)(esp_timer_get_time() & 0xFFFFFFFF);
+  // Timestamp (microseconds) - time of reception
+  uint32_t timestamp = frame->timestamp_us;
   out_frame[idx++]   = (timestamp >> 0) & 0xFF;
   out_frame[idx++]   = (timestamp >> 8) & 0xFF;
   out_frame[idx++]   = (timestamp >> 16) & 0xFF;
@@ -94,8 +150,8 @@ static int IRAM_ATTR encode_gvret_frame(int bus, const twai_message_t *msg, uint
 
   // CAN ID (4 bytes)
   // Bit 31 = extended flag, bits 0-28 = ID
-  uint32_t id        = msg->identifier;
-  if (msg->extd) {
+  uint32_t id        = frame->id;
+  if (frame->extended) {
     id |= (1 << 31); // Set extended flag
   }
   out_frame[idx++] = (id >> 0) & 0xFF;
@@ -104,14 +160,15 @@ static int IRAM_ATTR encode_gvret_frame(int bus, const twai_message_t *msg, uint
   out_frame[idx++] = (id >> 24) & 0xFF;
 
   // DLC + Bus (1 byte)
-  // Low nibble = data length (0-8)
+  // Low nibble = data length (0-8), clamped so the frame length can be derived from it
   // High nibble = bus number (0-15)
-  uint8_t dlc_bus  = (msg->data_length_code & 0x0F) | ((bus & 0x0F) << 4);
+  uint8_t dlc      = frame->dlc;
+  uint8_t dlc_bus  = dlc | ((frame->bus & 0x0F) << 4);
   out_frame[idx++] = dlc_bus;
 
   // Data bytes (0-8)
-  for (int i = 0; i < msg->data_length_code && i < 8; i++) {
-    out_frame[idx++] = msg->data[i];
+  for (int i = 0; i < dlc; i++) {
+    out_frame[idx++] = frame->data[i];
   }
 
   return idx;
@@ -121,6 +178,71 @@ static int IRAM_ATTR encode_gvret_frame(int bus, const twai_message_t *msg, uint
 // Client Management
 // ============================================================================
 
+/**
+ * @brief Allocate (once) and reset the TX state of a client slot
+ *
+ * The batch buffer and the hub consumer are kept after disconnection and reused
+ * by the next client of the same slot.
+ */
+static bool client_prepare_buffers(gvret_client_t *client) {
+  if (!client->batch) {
+    client->batch = malloc(GVRET_TX_BATCH_SIZE);
+    if (!client->batch) {
+      return false;
+    }
+  }
+  if (!client->hub) {
+    client->hub = can_hub_register(hub_consumer_names[client - clients], &sender_task_handle, GVRET_HUB_NOTIFY_FRAMES);
+    if (!client->hub) {
+      return false;
+    }
+  }
+
+  client->batch_len       = 0;
+  client->batch_off       = 0;
+  client->last_flush_us   = esp_timer_get_time();
+  client->behind_since_ms = 0;
+  client->last_lost_ms    = 0;
+  client->lagging         = false;
+  client->ctrl_len        = 0;
+  client->frames_sent     = 0;
+  client->bytes_sent      = 0;
+  client->frames_dropped  = 0;
+  client->overflow_events = 0;
+  client->evicted         = false;
+  can_id_filter_clear(&client->filter);
+
+  // Start streaming from the newest frame (nothing from the previous client)
+  can_hub_set_enabled(client->hub, true);
+  return true;
+}
+
+/**
+ * @brief Queue a command response for the sender task
+ *
+ * Responses share the socket with the frame stream, so they are inserted between
+ * two frames by the sender instead of being written from the client task.
+ */
+static void client_queue_control(gvret_client_t *client, const uint8_t *data, int len) {
+  bool queued = false;
+
+  portENTER_CRITICAL(&client->ctrl_lock);
+  if (client->ctrl_len + len <= GVRET_CTRL_BUFFER_SIZE) {
+    memcpy(&client->ctrl[client->ctrl_len], data, len);
+    client->ctrl_len += len;
+    queued = true;
+  }
+  portEXIT_CRITICAL(&client->ctrl_lock);
+
+  if (!queued) {
+    ESP_LOGW(TAG, "Control queue full, response dropped (slot %d)", (int)(client - clients));
+    return;
+  }
+  if (sender_task_handle) {
+    xTaskNotifyGive(sender_task_handle);
+  }
+}
+
 static gvret_client_t *find_free_client_slot(void) {
   xSemaphoreTake(clients_mutex, portMAX_DELAY);
   for (int i = 0; i < MAX_GVRET_CLIENTS; i++) {
@@ -135,18 +257,18 @@ static gvret_client_t *find_free_client_slot(void) {
 
 static void mark_client_inactive(gvret_client_t *client) {
   xSemaphoreTake(clients_mutex, portMAX_DELAY);
+  closed_stats.frames_sent += client->frames_sent;
+  closed_stats.bytes_sent += client->bytes_sent;
+  closed_stats.frames_dropped += client->frames_dropped;
+  closed_stats.overflow_events += client->overflow_events;
+  if (client->evicted) {
+    closed_stats.clients_evicted++;
+  }
+
   client->active      = false;
   client->socket      = -1;
   client->task_handle = NULL;
-
-  // Update cached status
-  has_active_clients  = false;
-  for (int i = 0; i < MAX_GVRET_CLIENTS; i++) {
-    if (clients[i].active) {
-      has_active_clients = true;
-      break;
-    }
-  }
+  can_hub_set_enabled(client->hub, false);
   xSemaphoreGive(clients_mutex);
 }
 
@@ -154,7 +276,7 @@ static void mark_client_inactive(gvret_client_t *client) {
 // Client Handler Task
 // ============================================================================
 
-static void send_device_info(int socket) {
+static void send_device_info(gvret_client_t *client) {
   // Response format: [0xF1] [0x07] [build_num:2] [eeprom_ver:1] [file_type:1] [auto_start:1] [single_wire:1] [payload...]
   uint8_t response[20];
   int idx            = 0;
@@ -179,11 +301,11 @@ static void send_device_info(int socket) {
   // Single wire mode (0 = no)
   response[idx++]    = 0;
 
-  send(socket, response, idx, 0);
+  client_queue_control(client, response, idx);
   ESP_LOGD(TAG, "Sent DEVICE_INFO response");
 }
 
-static void send_num_buses(int socket) {
+static void send_num_buses(gvret_client_t *client) {
   // Response format: [0xF1] [0x0C] [num_buses:1]
   uint8_t response[3];
   int idx         = 0;
@@ -192,11 +314,11 @@ static void send_num_buses(int socket) {
   response[idx++] = GVRET_CMD_GET_NUM_BUSES; // 0x0C
   response[idx++] = 2;                       // We have 2 CAN buses (BODY + CHASSIS)
 
-  send(socket, response, idx, 0);
+  client_queue_control(client, response, idx);
   ESP_LOGD(TAG, "Sent NUM_BUSES response (2 buses)");
 }
 
-static void send_canbus_params(int socket) {
+static void send_canbus_params(gvret_client_t *client) {
   // Response format: [0xF1] [0x06] [can0_config:1] [can0_speed:4] [can1_config:1] [can1_speed:4]
   // Based on GVRET protocol: https://github.com/collin80/SavvyCAN/blob/master/connections/gvretserial.cpp
   uint8_t response[12];
@@ -226,29 +348,67 @@ static void send_canbus_params(int socket) {
   response[idx++] = (speed >> 16) & 0xFF;
   response[idx++] = (speed >> 24) & 0xFF;
 
-  send(socket, response, idx, 0);
+  client_queue_control(client, response, idx);
   ESP_LOGD(TAG, "Sent CANBUS_PARAMS response (both buses)");
 }
 
-static void process_gvret_command(gvret_client_t *client, const uint8_t *data, int len) {
+static void send_filter_status(gvret_client_t *client, uint8_t cmd, esp_err_t err) {
+  // Response format: [0xF1] [cmd] [status:1] (0 = OK, 1 = table full, 2 = not found, 3 = error)
+  uint8_t status      = err == ESP_OK ? 0 : err == ESP_ERR_NO_MEM ? 1 : err == ESP_ERR_NOT_FOUND ? 2 : 3;
+  uint8_t response[3] = {GVRET_FRAME_START, cmd, status};
+  client_queue_control(client, response, sizeof(response));
+}
+
+static esp_err_t apply_filter_command(gvret_client_t *client, uint8_t cmd, const uint8_t *payload) {
+  can_id_filter_rule_t rule = {0};
+
+  if (payload) {
+    uint32_t id   = payload[0] | (payload[1] << 8) | (payload[2] << 16) | ((uint32_t)payload[3] << 24);
+    rule.id       = id & 0x1FFFFFFF;
+    rule.extended = (id & (1u << 31)) != 0;
+    rule.mask     = payload[4] | (payload[5] << 8) | (payload[6] << 16) | ((uint32_t)payload[7] << 24);
+  }
+
+  esp_err_t err = ESP_OK;
+  xSemaphoreTake(clients_mutex, portMAX_DELAY);
+  if (cmd == GVRET_CMD_ADD_FILTER) {
+    err = can_id_filter_add(&client->filter, &rule);
+  } else if (cmd == GVRET_CMD_REMOVE_FILTER) {
+    err = can_id_filter_remove(&client->filter, &rule);
+  } else {
+    can_id_filter_clear(&client->filter);
+  }
+  int rule_count = client->filter.rule_count;
+  xSemaphoreGive(clients_mutex);
+
+  ESP_LOGI(TAG, "Filter command 0x%02X (id=0x%lX mask=0x%lX): %s, %d rule(s)", cmd, (unsigned long)rule.id, (unsigned long)rule.mask, esp_err_to_name(err), rule_count);
+  return err;
+}
+
+/**
+ * @brief Process one command starting with 0xF1
+ *
+ * @return Number of bytes consumed (start byte, command and payload)
+ */
+static int process_gvret_command(gvret_client_t *client, const uint8_t *data, int len) {
   if (len < 1) {
-    return; // Too short
+    return len; // Too short
   }
 
   // Handle binary mode activation (0xE7 0xE7)
   if (data[0] == GVRET_BINARY_MODE) {
     ESP_LOGI(TAG, "Client sent BINARY_MODE command (already in binary mode)");
-    return;
+    return 1;
   }
 
   // Check for frame start marker
   if (data[0] != GVRET_FRAME_START) {
     ESP_LOGD(TAG, "Invalid frame start: 0x%02X (expected 0xF1)", data[0]);
-    return;
+    return 1;
   }
 
   if (len < 2) {
-    return; // Need at least start + command
+    return len; // Need at least start + command
   }
 
   uint8_t cmd = data[1];
@@ -256,17 +416,17 @@ static void process_gvret_command(gvret_client_t *client, const uint8_t *data, i
   switch (cmd) {
   case GVRET_CMD_GET_NUM_BUSES:
     ESP_LOGI(TAG, "Client requested NUM_BUSES");
-    send_num_buses(client->socket);
+    send_num_buses(client);
     break;
 
   case GVRET_CMD_GET_DEVICE_INFO:
     ESP_LOGI(TAG, "Client requested DEVICE_INFO");
-    send_device_info(client->socket);
+    send_device_info(client);
     break;
 
   case GVRET_CMD_GET_CANBUS_PARAMS:
     ESP_LOGI(TAG, "Client requested CANBUS_PARAMS");
-    send_canbus_params(client->socket);
+    send_canbus_params(client);
     break;
 
   case GVRET_CMD_SETUP_CANBUS:
@@ -282,15 +442,30 @@ static void process_gvret_command(gvret_client_t *client, const uint8_t *data, i
     // Send keep-alive response: [0xF1][0x09][0xDE][0xAD]
     {
       uint8_t response[4] = {GVRET_FRAME_START, GVRET_CMD_KEEP_ALIVE, 0xDE, 0xAD};
-      send(client->socket, response, sizeof(response), 0);
+      client_queue_control(client, response, sizeof(response));
       ESP_LOGD(TAG, "Sent KEEP_ALIVE response");
     }
     break;
 
+  case GVRET_CMD_ADD_FILTER:
+  case GVRET_CMD_REMOVE_FILTER:
+    if (len < 2 + GVRET_FILTER_PAYLOAD_LEN) {
+      ESP_LOGW(TAG, "Truncated filter command 0x%02X (%d bytes)", cmd, len);
+      return len;
+    }
+    send_filter_status(client, cmd, apply_filter_command(client, cmd, &data[2]));
+    return 2 + GVRET_FILTER_PAYLOAD_LEN;
+
+  case GVRET_CMD_CLEAR_FILTERS:
+    send_filter_status(client, cmd, apply_filter_command(client, cmd, NULL));
+    break;
+
   default:
     ESP_LOGD(TAG, "Unknown GVRET command: 0x%02X", cmd);
     break;
   }
+
+  return 2;
 }
 
 static void gvret_client_task(void *arg) {
@@ -336,9 +511,8 @@ static void gvret_client_task(void *arg) {
 
       // Handle 0xF1 commands (at least 2 bytes: start + cmd)
       if (rx_buf[offset] == GVRET_FRAME_START && (offset + 1) < len) {
-        // Process this command
-        process_gvret_command(client, &rx_buf[offset], len - offset);
-        offset += 2; // Minimum: start byte + command byte
+        // Process this command (consumes start byte, command byte and any parsed payload)
+        offset += process_gvret_command(client, &rx_buf[offset], len - offset);
         continue;
       }
 
@@ -349,13 +523,144 @@ static void gvret_client_task(void *arg) {
   }
 
   // Cleanup
-  ESP_LOGI(TAG, "Client disconnected (slot %d, %u frames sent)", (int)(client - clients), client->frames_sent);
+  ESP_LOGI(TAG,
+           "Client disconnected (slot %d, %u frames sent, %u dropped%s)",
+           (int)(client - clients),
+           client->frames_sent,
+           client->frames_dropped,
+           client->evicted ? ", evicted" : "");
 
   close(client->socket);
   mark_client_inactive(client);
   vTaskDelete(NULL);
 }
 
+// ============================================================================
+// Sender Task - Encode hub frames into per-client batches
+// ============================================================================
+
+/**
+ * @brief Encode the client's pending hub frames into its batch
+ *
+ * Reads only as many frames as the batch can hold in the worst case, so nothing
+ * read from the hub is ever discarded. Filtered-out frames are skipped unencoded.
+ */
+static void client_fill_batch(gvret_client_t *client, int64_t now_us) {
+  can_hub_frame_t frames[GVRET_HUB_READ_CHUNK];
+
+  while (client->batch_len + GVRET_FRAME_MAX_LEN <= GVRET_TX_BATCH_SIZE) {
+    int room = (GVRET_TX_BATCH_SIZE - client->batch_len) / GVRET_FRAME_MAX_LEN;
+    uint32_t lost;
+    int count = can_hub_read(client->hub, frames, MIN(room, GVRET_HUB_READ_CHUNK), &lost);
+
+    if (lost) {
+      // Overwritten in the hub before this client read them: the client is not keeping up
+      client->frames_dropped += lost;
+      client->last_lost_ms = (uint32_t)(now_us / 1000);
+      if (!client->lagging) {
+        client->lagging = true;
+        client->overflow_events++;
+        if (client->behind_since_ms == 0) {
+          client->behind_since_ms = (uint32_t)(now_us / 1000) | 1;
+        }
+      }
+    }
+
+    for (int n = 0; n < count; n++) {
+      if (can_id_filter_match(&client->filter, frames[n].id, frames[n].extended)) {
+        client->batch_len += encode_gvret_frame(&frames[n], &client->batch[client->batch_len]);
+        client->frames_sent++;
+      }
+    }
+
+    if (count < MIN(room, GVRET_HUB_READ_CHUNK)) {
+      break; // Caught up
+    }
+  }
+
+  // No frame lost for a while: the client caught up. A backlog alone (bursty reader) is
+  // not a reason to disconnect, only frames actually overwritten before it read them.
+  if (client->lagging && (int32_t)((uint32_t)(now_us / 1000) - client->last_lost_ms) > GVRET_SLOW_CLIENT_RECOVER_MS) {
+    client->lagging         = false;
+    client->behind_since_ms = 0;
+  }
+}
+
+static void client_flush(gvret_client_t *client, int64_t now_us) {
+  if (client->batch_off >= client->batch_len) {
+    client->batch_len = 0;
+    client->batch_off = 0;
+  }
+
+  // Top up the batch while none of it has been written (frame boundaries preserved)
+  bool has_ctrl = false;
+  if (client->batch_off == 0) {
+    portENTER_CRITICAL(&client->ctrl_lock);
+    if (client->ctrl_len > 0 && client->batch_len + client->ctrl_len <= GVRET_TX_BATCH_SIZE) {
+      memcpy(&client->batch[client->batch_len], client->ctrl, client->ctrl_len);
+      client->batch_len += client->ctrl_len;
+      client->ctrl_len = 0;
+      has_ctrl         = true;
+    }
+    portEXIT_CRITICAL(&client->ctrl_lock);
+
+    client_fill_batch(client, now_us);
+  }
+
+  int pending = client->batch_len - client->batch_off;
+  if (pending == 0) {
+    client->last_flush_us = now_us;
+    return;
+  }
+
+  // Wait for a full segment unless the coalescing deadline expired or a response is queued
+  bool full = (client->batch_len + GVRET_FRAME_MAX_LEN) > GVRET_TX_BATCH_SIZE;
+  bool due  = (now_us - client->last_flush_us) >= (GVRET_COALESCE_MS * 1000LL);
+  if (!full && !due && !has_ctrl) {
+    return;
+  }
+
+  int sent = send(client->socket, &client->batch[client->batch_off], pending, MSG_DONTWAIT);
+  if (sent > 0) {
+    client->batch_off += sent;
+    client->bytes_sent += sent;
+    client->last_flush_us = now_us;
+  } else if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+    ESP_LOGW(TAG, "send() to client %d failed: %d (%s)", (int)(client - clients), errno, strerror(errno));
+    client->evicted = true;
+    shutdown(client->socket, SHUT_RDWR);
+    return;
+  }
+
+  uint32_t behind_since = client->behind_since_ms;
+  if (behind_since != 0 && (int32_t)((uint32_t)(now_us / 1000) - behind_since) > GVRET_SLOW_CLIENT_TIMEOUT_MS) {
+    ESP_LOGW(TAG, "Client %d too slow (dropping frames for >%d ms), disconnecting", (int)(client - clients), GVRET_SLOW_CLIENT_TIMEOUT_MS);
+    client->evicted = true;
+    shutdown(client->socket, SHUT_RDWR); // Client task sees the close and releases the slot
+  }
+}
+
+static void gvret_sender_task(void *arg) {
+  ESP_LOGI(TAG, "Sender task started (batch %d bytes, coalescing %d ms)", GVRET_TX_BATCH_SIZE, GVRET_COALESCE_MS);
+
+  while (server_running) {
+    // Woken early when a client has a full segment of frames waiting or a response is queued
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(GVRET_COALESCE_MS));
+
+    int64_t now_us = esp_timer_get_time();
+    for (int i = 0; i < MAX_GVRET_CLIENTS; i++) {
+      gvret_client_t *client = &clients[i];
+      if (client->active && !client->evicted && client->socket >= 0) {
+        client_flush(client, now_us);
+      }
+    }
+  }
+
+  ESP_LOGI(TAG, "Sender task stopped");
+  sender_task_handle = NULL;
+  vTaskDelete(NULL);
+}
+
 // ============================================================================
 // Accept Task
 // ============================================================================
@@ -391,14 +696,19 @@ static void gvret_accept_task(void *arg) {
       continue;
     }
 
+    if (!client_prepare_buffers(client)) {
+      ESP_LOGE(TAG, "Failed to allocate TX buffers, rejecting connection from %s", client_ip);
+      close(client_socket);
+      continue;
+    }
+
     // Initialize client
-    client->socket      = client_socket;
-    client->active      = true;
-    client->frames_sent = 0;
-    has_active_clients  = true; // Update cached status
+    client->socket = client_socket;
+    client->addr   = client_addr;
+    client->active = true;
 
     // Set socket to non-blocking
-    int flags           = fcntl(client_socket, F_GETFL, 0);
+    int flags      = fcntl(client_socket, F_GETFL, 0);
     fcntl(client_socket, F_SETFL, flags | O_NONBLOCK);
 
     // Create client task
@@ -434,8 +744,9 @@ esp_err_t gvret_tcp_server_init(void) {
   // Initialize client array
   memset(clients, 0, sizeof(clients));
   for (int i = 0; i < MAX_GVRET_CLIENTS; i++) {
-    clients[i].socket = -1;
-    clients[i].active = false;
+    clients[i].socket    = -1;
+    clients[i].active    = false;
+    portMUX_INITIALIZE(&clients[i].ctrl_lock);
   }
 
   server_initialized = true;
@@ -505,6 +816,17 @@ esp_err_t gvret_tcp_server_start(void) {
     return ESP_FAIL;
   }
 
+  // Create sender task (batched writes to all clients, off the CAN RX path)
+  task_ret = xTaskCreate(gvret_sender_task, "gvret_tx", 4096, NULL, 10, &sender_task_handle);
+
+  if (task_ret != pdPASS) {
+    ESP_LOGE(TAG, "Failed to create sender task");
+    server_running = false; // Accept task exits on its own
+    close(listen_socket);
+    listen_socket = -1;
+    return ESP_FAIL;
+  }
+
   ESP_LOGI(TAG, "GVRET TCP server started on port %d", GVRET_TCP_PORT);
   return ESP_OK;
 }
@@ -561,33 +883,66 @@ int gvret_tcp_server_get_client_count(void) {
   return count;
 }
 
-void gvret_tcp_broadcast_can_frame(int bus, const twai_message_t *msg) {
-  if (!server_running) {
-    return;
+esp_err_t gvret_tcp_server_get_stats(gvret_tcp_stats_t *out) {
+  if (!out) {
+    return ESP_ERR_INVALID_ARG;
   }
-
-  // Fast check: if no clients, don't process frames at all (no mutex needed)
-  if (!has_active_clients) {
-    return; // No clients connected, skip processing
+  if (!server_initialized) {
+    memset(out, 0, sizeof(*out));
+    return ESP_ERR_INVALID_STATE;
   }
 
-  // Encode frame in GVRET format
-  uint8_t frame[21];
-  int frame_len = encode_gvret_frame(bus, msg, frame);
-
-  // Broadcast to all active clients
   xSemaphoreTake(clients_mutex, portMAX_DELAY);
+  *out = closed_stats;
   for (int i = 0; i < MAX_GVRET_CLIENTS; i++) {
-    if (clients[i].active && clients[i].socket >= 0) {
-      int sent = send(clients[i].socket, frame, frame_len, 0);
-      if (sent > 0) {
-        clients[i].frames_sent++;
-      } else if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
-        ESP_LOGW(TAG, "send() to client %d failed: %d (%s)", i, errno, strerror(errno));
-      }
+    if (clients[i].active) {
+      out->frames_sent += clients[i].frames_sent;
+      out->bytes_sent += clients[i].bytes_sent;
+      out->frames_dropped += clients[i].frames_dropped;
+      out->overflow_events += clients[i].overflow_events;
     }
   }
   xSemaphoreGive(clients_mutex);
+
+  return ESP_OK;
+}
+
+esp_err_t gvret_tcp_server_set_client_filters(int slot, const can_id_filter_rule_t *rules, int count) {
+  if (slot < 0 || slot >= MAX_GVRET_CLIENTS) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (!server_initialized) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  xSemaphoreTake(clients_mutex, portMAX_DELAY);
+  esp_err_t err = clients[slot].active ? can_id_filter_set(&clients[slot].filter, rules, count) : ESP_ERR_NOT_FOUND;
+  xSemaphoreGive(clients_mutex);
+
+  return err;
+}
+
+esp_err_t gvret_tcp_server_get_client_filters(int slot, can_id_filter_client_info_t *out) {
+  if (slot < 0 || slot >= MAX_GVRET_CLIENTS || !out) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  memset(out, 0, sizeof(*out));
+  if (!server_initialized) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  xSemaphoreTake(clients_mutex, portMAX_DELAY);
+  gvret_client_t *client = &clients[slot];
+  out->active            = client->active;
+  if (client->active) {
+    inet_ntop(AF_INET, &client->addr.sin_addr, out->ip, sizeof(out->ip));
+    out->port       = ntohs(client->addr.sin_port);
+    out->rule_count = client->filter.rule_count;
+    memcpy(out->rules, client->filter.rules, sizeof(out->rules));
+  }
+  xSemaphoreGive(clients_mutex);
+
+  return ESP_OK;
 }
 
 // ============================================================================
@@ -13,31 +13,41 @@
 
 #include "led_effects.h"
 
+#include "anim_clock.h"
 #include "audio_input.h"
 #include "config.h"
 #include "config_manager.h"
 #include "driver/gpio.h"
 #include "driver/rmt_tx.h"
+#include "esp_heap_caps.h"
 #include "esp_log.h"
 #include "esp_random.h"
+#include "esp_timer.h"
+#include "fixed_math.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 #include "freertos/task.h"
 #include "led_strip_encoder.h"
 #include "nvs.h"
 #include "nvs_flash.h"
+#include "signal_smoother.h"
 #include "soc/soc_caps.h"
 
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
 
-// ESP32-C6: only 2 TX channels and 4 memory blocks (48 symbols each).
+// RMT memory of an output (symbols). A TX channel takes consecutive blocks of
+// SOC_RMT_MEM_WORDS_PER_CHANNEL symbols from its own index, so with several outputs
+// each one keeps to its block. A single output gets more:
+// ESP32-C6: only 2 TX channels and 4 memory blocks, two blocks for the main strip.
+// ESP32-S3: the first output clocks out by DMA, the size is that of its DMA buffer.
 #if CONFIG_IDF_TARGET_ESP32C6
-// All 4 blocks available, reserve them for the main strip
-#define LED_RMT_MEM_BLOCK_SYMBOLS 96
+#define LED_RMT_SINGLE_OUTPUT_SYMBOLS (2 * SOC_RMT_MEM_WORDS_PER_CHANNEL)
 #else
-#define LED_RMT_MEM_BLOCK_SYMBOLS 64
+#define LED_RMT_SINGLE_OUTPUT_SYMBOLS SOC_RMT_MEM_WORDS_PER_CHANNEL
 #endif
+#define LED_RMT_DMA_SYMBOLS 64
 
 // Power limiting to avoid brownout on USB power
 #define MAX_POWER_MILLIAMPS 3000 // Max consumption in mA (USB can provide ~2A max)
@@ -72,6 +82,11 @@
 #define FADE_FACTOR_MEDIUM 90 // Medium fade: keep 90% (reduce by 10%)
 #define FADE_DIVISOR 100
 
+// Elapsed time counted for one frame: longer gaps (effect just started, task stalled)
+// do not make stateful effects jump
+#define FRAME_DT_MAX_MS 100
+#define FRAME_STEPS_MAX (FRAME_DT_MAX_MS / LED_EFFECT_FRAME_MS)
+
 // HSV conversion
 #define HSV_HUE_REGION_SIZE 43 // Size of an HSV hue region (256/6)
 #define HSV_SATURATION_MAX 255
@@ -92,25 +107,77 @@
 // Sentinel value for uninitialized indicator
 #define PROGRESS_NOT_INITIALIZED 255
 
-// Handles for new RMT API
-static rmt_channel_handle_t led_chan    = NULL;
-static rmt_encoder_handle_t led_encoder = NULL;
-
-// Structure for an RGB pixel
+// Strip outputs (led_output_config_t): each one has its own RMT channel and clocks out
+// its span of the frame buffer. All of them are started back to back and transmit
+// concurrently, so a frame takes the wire time of the longest span.
 typedef struct {
-  uint8_t r;
-  uint8_t g;
-  uint8_t b;
-} rgb_t;
+  led_output_config_t config;
+  rmt_channel_handle_t chan;
+  rmt_encoder_handle_t encoder;
+  SemaphoreHandle_t done_sem; // Given by the RMT done callback
+  volatile int64_t done_us;
+  uint16_t sent_count; // LEDs of the frame on the wire (0: none, done_sem not taken)
+} led_output_t;
+
+static const led_output_config_t default_output = {.gpio = LED_PIN, .color_order = LED_COLOR_ORDER_GRB, .start = 0, .count = 0};
+static led_output_t outputs[LED_OUTPUT_MAX];
+static uint8_t output_count = 0;
+
+// Output is double-buffered: frame N is clocked out of one buffer while frame N+1
+// is rendered and converted into the other. The RMT done callbacks give the outputs'
+// done_sem; sending waits on them only when rendering outruns the wire.
+// A frame identical to the one on the strip (hash of its GRB data) is not sent again,
+// except every LED_TX_KEEPALIVE_MS: the LEDs hold their colors, the refresh only
+// recovers a pixel upset by noise on the data line.
+#define LED_TX_TIMEOUT_MS 200
+#define LED_TX_KEEPALIVE_MS 1000
+static uint8_t led_data_index       = 0;
+static volatile int64_t tx_start_us = 0;
+static uint32_t tx_frame_hash       = 0;
+static bool tx_frame_valid          = false; // tx_frame_hash is on the strip
+static uint16_t frame_scale         = 256;   // Scale applied to leds[] on the way out (led_strip_show_scaled)
+static led_output_stats_t output_stats;
+
+// Wire byte of the red, green and blue components for each led_color_order_t
+static const uint8_t color_order_offsets[LED_COLOR_ORDER_COUNT][3] = {
+    [LED_COLOR_ORDER_GRB] = {1, 0, 2}, [LED_COLOR_ORDER_RGB] = {0, 1, 2}, [LED_COLOR_ORDER_BRG] = {1, 2, 0},
+    [LED_COLOR_ORDER_RBG] = {0, 2, 1}, [LED_COLOR_ORDER_GBR] = {2, 0, 1}, [LED_COLOR_ORDER_BGR] = {2, 1, 0},
+};
+
+// RGB pixel, laid out as led_rgb_t: layers render straight into the caller's buffer
+typedef led_rgb_t rgb_t;
 
-static rgb_t leds[MAX_LED_COUNT];
-static uint8_t led_data[MAX_LED_COUNT * 3];
+// Everything an effect reads and writes besides the shared vehicle and audio inputs.
+// Effects touch no globals, so any number of layers render in the same frame, each
+// straight into its own span of the output.
+// The span is a view (leds, stride, count): LED i of the effect is leds[i * stride]
+// (led_at). A reversed segment starts from its last LED with stride -1, so effects
+// count from the start of their segment. Only symmetric effects, which a mirror
+// leaves unchanged, still read config->reverse: as inward rather than outward
+typedef struct {
+  const effect_config_t *config;
+  uint32_t frame; // Animation frame (LED_EFFECT_FRAME_MS periods)
+  uint32_t dt_ms; // Elapsed time since this instance's previous frame
+  uint32_t steps; // LED_EFFECT_FRAME_MS periods started since then
+  rgb_t *leds;    // LED 0 of the view
+  int16_t stride; // 1, or -1 when reversed
+  uint16_t count;
+  void *state;  // Instance state (effect_state_size), zeroed when the instance starts
+  uint32_t rng; // xorshift32 state of the instance (effect_random), seeded when it starts
+} effect_ctx_t;
+
+static inline rgb_t *led_at(const effect_ctx_t *ctx, int i) {
+  return ctx->leds + i * ctx->stride;
+}
+
+// Frame buffers, sized from the LED count (led_buffers_t)
+static rgb_t *leds          = NULL;
+static uint8_t *led_data[2] = {NULL, NULL};
 static effect_config_t current_config;
 static bool enabled                                = true;
 static uint32_t effect_counter                     = 0;
 static vehicle_state_t last_vehicle_state          = {0};
 static uint8_t max_allowed_brightness              = BRIGHTNESS_NO_REDUCTION;
-static can_event_type_t active_event_context       = CAN_EVENT_NONE;
 static bool ota_progress_mode                      = false;
 static bool ota_ready_mode                         = false;
 static bool ota_error_mode                         = false;
@@ -119,14 +186,100 @@ static uint8_t ota_displayed_percent               = PROGRESS_NOT_INITIALIZED;
 static TickType_t ota_last_progress_refresh        = 0;
 static const TickType_t OTA_PROGRESS_REFRESH_LIMIT = pdMS_TO_TICKS(500);
 
-// Floating accumulator for smooth charging animation
-static float charge_anim_position                  = 0.0f;
+// Animation time of the frame being rendered (set by led_effects_begin_frame)
+static uint32_t frame_time_ms                      = 0;
 
 // Global LED strip direction (false = normal)
 static uint16_t led_count                          = NUM_LEDS;
 
-static void cleanup_rmt_channel(void);
-static bool configure_rmt_channel(void);
+// Slave: speed, power and pedal arrive from the master at a low rate and are
+// interpolated per frame (master: CAN values are used as received)
+static portMUX_TYPE signal_lock                    = portMUX_INITIALIZER_UNLOCKED;
+static bool signals_smoothed                       = false;
+static signal_smoother_t speed_smoother;
+static signal_smoother_t rear_power_smoother;
+static signal_smoother_t front_power_smoother;
+static signal_smoother_t pedal_smoother;
+
+// Render context: the brightness factors shared by every pixel, folded once instead of
+// being looked up for every pixel by apply_brightness. Dynamic vehicle brightness and
+// audio modulation are per layer (layer_scale)
+typedef struct {
+  uint8_t brightness_lut[256]; // Effect brightness -> brightness under the power cap
+} render_context_t;
+
+static render_context_t render_ctx;
+
+// Effect state arena: each layer (LED_LAYER_*) gets a slot sized for its effect and
+// length, kept between frames. When the arena is full, slots not rendered for
+// EFFECT_STATE_IDLE_MS are released and the live ones compacted to the front.
+// Sized from the LED count: EFFECT_STATE_BYTES_PER_LED, at least EFFECT_STATE_ARENA_MIN
+#define EFFECT_STATE_ARENA_MIN 4096
+#define EFFECT_STATE_BYTES_PER_LED 20
+#define EFFECT_STATE_IDLE_MS 500
+
+typedef struct {
+  led_effect_t effect; // EFFECT_OFF: no slot
+  uint16_t count;
+  uint32_t offset; // In state_arena
+  uint32_t size;
+  uint32_t frame; // Last frame rendered by the instance
+  uint32_t time_ms;
+  uint32_t rng;
+  uint32_t inputs;   // layer_inputs of the pixels kept for the render skip
+  bool inputs_valid; // Those pixels are there (cleared when the instance restarts)
+} effect_slot_t;
+
+static effect_slot_t effect_slots[LED_LAYER_COUNT];
+static uint32_t *state_arena       = NULL;
+static uint32_t state_arena_size   = 0;
+static uint32_t state_arena_used   = 0;
+static uint32_t state_misses       = 0;           // Layers rendered without persistent state (arena full)
+static uint32_t random_seed        = 0x9E3779B9u; // From the hardware RNG at init (led_effects_set_random_seed)
+static uint32_t *state_scratch     = NULL;        // Largest state of a strip-long layer: carried-over pixels plus beat_ripple_state_t
+static uint32_t state_scratch_size = 0;
+
+// Layers bound to their slot ahead of a render on another core (led_effects_prepare_layer):
+// the binding allocates in the arena and may compact it, so it stays on the LED task
+typedef struct {
+  bool ready; // Prepared for frame: its render does not bind, wherever it runs
+  bool bound; // The slot holds the layer's state (else it renders black)
+  uint32_t frame;
+  uint32_t dt_ms;
+  uint32_t steps;
+  uint32_t rng;
+} prepared_layer_t;
+
+static prepared_layer_t prepared_layers[LED_LAYER_COUNT];
+static portMUX_TYPE render_stats_lock = portMUX_INITIALIZER_UNLOCKED; // Layers render on both cores
+
+// Frame buffers of one LED count. The wire buffers (led_data) are read by the RMT driver
+// from its interrupt and stay in internal RAM; the others are only touched by the LED
+// task and go to PSRAM when there is some. Each group is a single allocation carved
+// into its buffers. A new LED count gets a new set, swapped in by the LED task at the
+// start of a frame (led_effects_begin_frame) once the wire is idle.
+typedef struct {
+  uint16_t led_count;
+  uint8_t *wire; // led_data[0], led_data[1]
+  uint8_t *work; // leds, state arena, state scratch
+  size_t wire_size;
+  size_t work_size;
+} led_buffers_t;
+
+static led_buffers_t active_buffers;
+static led_buffers_t pending_buffers; // led_count 0: none
+static portMUX_TYPE buffers_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Output table of led_effects_set_outputs, applied by the LED task between frames as well:
+// the channels are rebuilt once the wire is idle
+static led_output_config_t output_configs[LED_OUTPUT_MAX]; // Active table, for led_effects_get_outputs
+static led_output_config_t pending_outputs[LED_OUTPUT_MAX];
+static uint8_t active_output_count  = 0;
+static uint8_t pending_output_count = 0; // 0: none
+static portMUX_TYPE outputs_lock    = portMUX_INITIALIZER_UNLOCKED;
+
+static void cleanup_rmt_channels(void);
+static bool configure_rmt_channels(const led_output_config_t *configs, uint8_t count);
 static uint16_t sanitize_led_count(uint16_t requested);
 static void update_max_allowed_brightness(uint16_t led_total);
 static uint8_t map_user_brightness(uint8_t brightness);
@@ -174,6 +327,22 @@ static rgb_t rgb_lerp3(rgb_t a, rgb_t b, rgb_t c, float t) {
   return rgb_lerp(b, c, (t - 0.5f) * 2.0f);
 }
 
+// Q8 versions for the per-pixel loops: frac 0 is a, 255 is b
+static inline rgb_t rgb_lerp_q8(rgb_t a, rgb_t b, uint8_t frac) {
+  rgb_t out;
+  out.r = fixed_lerp8(a.r, b.r, frac);
+  out.g = fixed_lerp8(a.g, b.g, frac);
+  out.b = fixed_lerp8(a.b, b.b, frac);
+  return out;
+}
+
+static rgb_t rgb_lerp3_q8(rgb_t a, rgb_t b, rgb_t c, uint8_t t) {
+  if (t < 128) {
+    return rgb_lerp_q8(a, b, t * 2);
+  }
+  return rgb_lerp_q8(b, c, (t - 128) * 2 + 1);
+}
+
 static rgb_t rgb_max(rgb_t a, rgb_t b) {
   rgb_t out;
   out.r = (a.r > b.r) ? a.r : b.r;
@@ -182,58 +351,74 @@ static rgb_t rgb_max(rgb_t a, rgb_t b) {
   return out;
 }
 
-static void fill_solid(rgb_t color);
+// FNV-1a over 32-bit words, for change detection (render skip, transmit suppression).
+// A single changed word always changes the hash
+#define HASH_SEED 2166136261u
+
+static inline uint32_t hash_word(uint32_t hash, uint32_t word) {
+  return (hash ^ word) * 16777619u;
+}
 
-// Apply brightness to a color (accounts for dynamic and audio brightness)
-static rgb_t apply_brightness(rgb_t color, uint8_t brightness) {
+static inline uint32_t hash_float(uint32_t hash, float value) {
+  uint32_t word;
+  memcpy(&word, &value, sizeof(word));
+  return hash_word(hash, word);
+}
+
+// Apply brightness to a color (power cap included). Dynamic and audio brightness are
+// layer-wide: the layer is scaled by layer_scale once rendered
+static inline rgb_t apply_brightness(rgb_t color, uint8_t brightness) {
   rgb_t result;
-  uint8_t effective_brightness = map_user_brightness(brightness);
-  // Apply effect brightness
-  result.r                     = (color.r * effective_brightness) / 255;
-  result.g                     = (color.g * effective_brightness) / 255;
-  result.b                     = (color.b * effective_brightness) / 255;
+  uint8_t effective_brightness = render_ctx.brightness_lut[brightness];
+  result.r                     = fixed_scale8(color.r, effective_brightness);
+  result.g                     = fixed_scale8(color.g, effective_brightness);
+  result.b                     = fixed_scale8(color.b, effective_brightness);
+  return result;
+}
+
+// Dynamic brightness and audio modulation of a layer, folded into one Q8 scale
+static uint16_t layer_scale(const effect_config_t *config, can_event_type_t event) {
+  float scale = 1.0f;
 
   // Apply dynamic brightness if enabled (from active profile)
   bool dynamic_enabled;
   uint8_t dynamic_rate;
-  if (config_manager_get_dynamic_brightness(&dynamic_enabled, &dynamic_rate)) {
-    if (dynamic_enabled && !config_manager_is_dynamic_brightness_excluded(active_event_context)) {
-      // Formula: final_brightness = effect_brightness x (vehicle_brightness x rate / 100)
-      // Minimum 1% to ensure strip remains visible
-      float vehicle_brightness = last_vehicle_state.brightness;              // 0-100 from CAN
-      float rate               = (dynamic_rate ? dynamic_rate : 1) / 100.0f; // 0-1
-      float applied_brightness = vehicle_brightness * rate / 100.0f;         // normalized to 0-1
-      if (applied_brightness < 0.01f)
-        applied_brightness = 0.01f; // Minimum 1%
-
-      result.r = (uint8_t)(result.r * applied_brightness);
-      result.g = (uint8_t)(result.g * applied_brightness);
-      result.b = (uint8_t)(result.b * applied_brightness);
-    }
+  if (config_manager_get_dynamic_brightness(&dynamic_enabled, &dynamic_rate) && dynamic_enabled && !config_manager_is_dynamic_brightness_excluded(event)) {
+    // Formula: final_brightness = effect_brightness x (vehicle_brightness x rate / 100)
+    // Minimum 1% to ensure strip remains visible
+    float vehicle_brightness = last_vehicle_state.brightness;              // 0-100 from CAN
+    float rate               = (dynamic_rate ? dynamic_rate : 1) / 100.0f; // 0-1
+    float applied_brightness = vehicle_brightness * rate / 100.0f;         // normalized to 0-1
+    if (applied_brightness < 0.01f)
+      applied_brightness = 0.01f; // Minimum 1%
+    scale *= applied_brightness;
   }
 
   // Apply audio reactive modulation if enabled
-  if (current_config.audio_reactive && audio_input_is_enabled()) {
+  if (config->audio_reactive && audio_input_is_enabled()) {
     audio_data_t audio_data;
     if (audio_input_get_data(&audio_data)) {
       // Modulate brightness with audio amplitude (10% base + 90% audio)
       // This yields a very visible swing from 10% to 100%
-      float audio_factor = 0.1f + (audio_data.amplitude * 0.9f);
-      result.r           = (uint8_t)(result.r * audio_factor);
-      result.g           = (uint8_t)(result.g * audio_factor);
-      result.b           = (uint8_t)(result.b * audio_factor);
+      scale *= AUDIO_BRIGHTNESS_MIN + (audio_data.amplitude * AUDIO_BRIGHTNESS_MAX);
     }
   }
 
-  return result;
+  uint32_t q8 = (uint32_t)(scale * 256.0f + 0.5f);
+  if (q8 < 1) {
+    q8 = 1;
+  } else if (q8 > 256) {
+    q8 = 256;
+  }
+  return (uint16_t)q8;
 }
 
-void led_effects_set_event_context(uint16_t event_id) {
-  if (event_id >= CAN_EVENT_MAX) {
-    active_event_context = CAN_EVENT_NONE;
-  } else {
-    active_event_context = (can_event_type_t)event_id;
-  }
+static inline rgb_t scale_pixel(rgb_t color, uint16_t scale) {
+  rgb_t result;
+  result.r = (uint8_t)((color.r * scale) >> 8);
+  result.g = (uint8_t)((color.g * scale) >> 8);
+  result.b = (uint8_t)((color.b * scale) >> 8);
+  return result;
 }
 
 // static rgb_t progress_base_color = {0, 160, 32};
@@ -332,9 +517,30 @@ static rgb_t hsv_to_rgb(uint16_t h, uint8_t s, uint8_t v) {
   return rgb;
 }
 
-// Send data to LEDs via RMT
-static void led_strip_show(void) {
-  if (led_chan == NULL || led_encoder == NULL) {
+static bool IRAM_ATTR led_tx_done_cb(rmt_channel_handle_t tx_chan, const rmt_tx_done_event_data_t *edata, void *user_ctx) {
+  led_output_t *output = (led_output_t *)user_ctx;
+  BaseType_t woken     = pdFALSE;
+  output->done_us      = esp_timer_get_time();
+  xSemaphoreGiveFromISR(output->done_sem, &woken);
+  return woken == pdTRUE;
+}
+
+// LEDs of the frame buffer shown by an output (its span, cut at the end of the buffer)
+static uint16_t output_span(const led_output_config_t *config, uint16_t *first) {
+  *first = config->start;
+  if (config->start >= led_count) {
+    return 0;
+  }
+  uint16_t available = led_count - config->start;
+  return config->count == 0 || config->count > available ? available : config->count;
+}
+
+// Send data to LEDs via RMT (returns once the frame is queued)
+// scale: layer_scale of a layer rendered straight into leds[] (base effect alone),
+// applied on the way out instead of in a separate pass
+static void led_strip_show_scaled(uint16_t scale) {
+  frame_scale = scale;
+  if (output_count == 0) {
     ESP_LOGE(TAG_LED, "RMT not initialized");
     return;
   }
@@ -344,44 +550,102 @@ static void led_strip_show(void) {
     return;
   }
 
-  // Prepare data in GRB format for WS2812B
-  // Apply the global reverse if enabled
-  for (int i = 0; i < led_count; i++) {
-    int led_index       = (led_count - 1 - i);
-    led_data[i * 3 + 0] = leds[led_index].g; // Green
-    led_data[i * 3 + 1] = leds[led_index].r; // Red
-    led_data[i * 3 + 2] = leds[led_index].b; // Blue
+  // Prepare each output's data in its color order, in the buffer that is not on the
+  // wire, at the offset of its span (spans do not overlap). A span is sent last LED first.
+  uint8_t *data = led_data[led_data_index];
+  uint32_t hash = hash_word(HASH_SEED, led_count);
+  for (int o = 0; o < output_count; o++) {
+    uint16_t first;
+    uint16_t count        = output_span(&outputs[o].config, &first);
+    const uint8_t *offset = color_order_offsets[outputs[o].config.color_order];
+    uint8_t *out          = data + first * 3;
+    for (int i = 0; i < count; i++) {
+      int led_index          = first + count - 1 - i;
+      rgb_t px               = scale >= 256 ? leds[led_index] : scale_pixel(leds[led_index], scale);
+      out[i * 3 + offset[0]] = px.r;
+      out[i * 3 + offset[1]] = px.g;
+      out[i * 3 + offset[2]] = px.b;
+      hash                   = hash_word(hash, px.g | px.r << 8 | px.b << 16);
+    }
+  }
+
+  int64_t wait_start_us = esp_timer_get_time();
+  if (tx_frame_valid && hash == tx_frame_hash && wait_start_us - tx_start_us < LED_TX_KEEPALIVE_MS * 1000LL) {
+    output_stats.suppressed++;
+    return;
   }
 
-  // Data transmission
+  // Back-pressure: the previous frame must be out of every output before this one is queued
+  uint32_t wire_us = 0;
+  for (int o = 0; o < output_count; o++) {
+    led_output_t *output = &outputs[o];
+    if (output->sent_count == 0) {
+      continue;
+    }
+    if (xSemaphoreTake(output->done_sem, pdMS_TO_TICKS(LED_TX_TIMEOUT_MS)) != pdTRUE) {
+      ESP_LOGE(TAG_LED, "Timeout transmission RMT (GPIO %u)", output->config.gpio);
+      output_stats.timeouts++;
+      tx_frame_valid = false;
+      rmt_disable(output->chan);
+      rmt_enable(output->chan);
+    } else if (output->done_us > tx_start_us && (uint32_t)(output->done_us - tx_start_us) > wire_us) {
+      wire_us = (uint32_t)(output->done_us - tx_start_us);
+    }
+    output->sent_count = 0;
+  }
+  int64_t now_us   = esp_timer_get_time();
+  uint32_t wait_us = (uint32_t)(now_us - wait_start_us);
+  if (wait_us > 100) { // Below: the semaphores were already given
+    output_stats.waits++;
+    output_stats.wait_us_total += wait_us;
+    if (wait_us > output_stats.wait_us_max) {
+      output_stats.wait_us_max = wait_us;
+    }
+  }
+  if (tx_start_us != 0 && wire_us > 0) {
+    output_stats.wire_us = wire_us;
+  }
+  if (tx_start_us != 0) {
+    uint32_t interval_us = (uint32_t)(now_us - tx_start_us);
+    output_stats.interval_us_total += interval_us;
+    if (output_stats.interval_us_min == 0 || interval_us < output_stats.interval_us_min) {
+      output_stats.interval_us_min = interval_us;
+    }
+    if (interval_us > output_stats.interval_us_max) {
+      output_stats.interval_us_max = interval_us;
+    }
+  }
+
+  // Data transmission, all outputs back to back
   rmt_transmit_config_t tx_config = {.loop_count = 0, // pas de boucle
                                      .flags      = {
                                               .eot_level = 0, // Niveau EOT (end of transmission)
                                      }};
 
-  // Disable WiFi interrupts during critical transmission
-  // to avoid flickering
-  // portMUX_TYPE mux                = portMUX_INITIALIZER_UNLOCKED;
-  // portENTER_CRITICAL(&mux);
-
-  esp_err_t ret                   = rmt_transmit(led_chan, led_encoder, led_data, led_count * 3, &tx_config);
-
-  // portEXIT_CRITICAL(&mux);
-
-  if (ret != ESP_OK) {
-    ESP_LOGE(TAG_LED, "RMT transmission error: %s", esp_err_to_name(ret));
-    return;
+  tx_start_us    = now_us;
+  tx_frame_hash  = hash;
+  tx_frame_valid = true;
+  for (int o = 0; o < output_count; o++) {
+    led_output_t *output = &outputs[o];
+    uint16_t first;
+    uint16_t count = output_span(&output->config, &first);
+    if (count == 0) {
+      continue;
+    }
+    esp_err_t ret = rmt_transmit(output->chan, output->encoder, data + first * 3, count * 3, &tx_config);
+    if (ret != ESP_OK) {
+      ESP_LOGE(TAG_LED, "RMT transmission error (GPIO %u): %s", output->config.gpio, esp_err_to_name(ret));
+      tx_frame_valid = false; // No done callback for this output: done_sem stays given
+      continue;
+    }
+    output->sent_count = count;
   }
+  output_stats.frames++;
+  led_data_index ^= 1;
+}
 
-  // Wait for transmission to complete (without critical section)
-  ret = rmt_tx_wait_all_done(led_chan, pdMS_TO_TICKS(200));
-  if (ret == ESP_ERR_TIMEOUT) {
-    ESP_LOGE(TAG_LED, "Timeout transmission RMT");
-    rmt_disable(led_chan);
-    rmt_enable(led_chan);
-  } else if (ret != ESP_OK) {
-    ESP_LOGE(TAG_LED, "rmt_tx_wait_all_done error: %s", esp_err_to_name(ret));
-  }
+static void led_strip_show(void) {
+  led_strip_show_scaled(256);
 }
 
 static uint16_t sanitize_led_count(uint16_t requested) {
@@ -405,15 +669,23 @@ static uint8_t map_user_brightness(uint8_t brightness) {
   return (uint8_t)(((uint32_t)brightness * max_allowed_brightness) / BRIGHTNESS_NO_REDUCTION);
 }
 
+static void build_brightness_lut(void) {
+  for (int b = 0; b < 256; b++) {
+    render_ctx.brightness_lut[b] = map_user_brightness((uint8_t)b);
+  }
+}
+
 static void update_max_allowed_brightness(uint16_t led_total) {
   if (led_total == 0) {
     max_allowed_brightness = BRIGHTNESS_NO_REDUCTION;
+    build_brightness_lut();
     return;
   }
 
   uint32_t max_current = (uint32_t)LED_MILLIAMPS_PER_LED * led_total;
   if (max_current == 0) {
     max_allowed_brightness = BRIGHTNESS_NO_REDUCTION;
+    build_brightness_lut();
     return;
   }
 
@@ -424,42 +696,83 @@ static void update_max_allowed_brightness(uint16_t led_total) {
     brightness = BRIGHTNESS_NO_REDUCTION;
   }
   max_allowed_brightness = (uint8_t)brightness;
+  build_brightness_lut();
   ESP_LOGI(TAG_LED, "Power cap: %u LEDs, max brightness %u/255", led_total, max_allowed_brightness);
 }
 
-static void cleanup_rmt_channel(void) {
-  if (led_encoder != NULL) {
-    rmt_del_encoder(led_encoder);
-    led_encoder = NULL;
+// Wait until no output is reading the wire buffers
+static void wait_outputs_idle(void) {
+  for (int o = 0; o < output_count; o++) {
+    rmt_tx_wait_all_done(outputs[o].chan, pdMS_TO_TICKS(LED_TX_TIMEOUT_MS));
   }
+}
 
-  if (led_chan != NULL) {
-    rmt_disable(led_chan);
-    rmt_del_channel(led_chan);
-    led_chan = NULL;
+static void release_rmt_output(led_output_t *output) {
+  if (output->encoder != NULL) {
+    rmt_del_encoder(output->encoder);
+    output->encoder = NULL;
+  }
+  if (output->chan != NULL) {
+    rmt_disable(output->chan);
+    rmt_del_channel(output->chan);
+    output->chan = NULL;
   }
 }
 
-static bool configure_rmt_channel(void) {
-  cleanup_rmt_channel();
+static void cleanup_rmt_channels(void) {
+  // The encoders may still be clocking out the last frame
+  wait_outputs_idle();
 
+  for (int o = 0; o < output_count; o++) {
+    release_rmt_output(&outputs[o]);
+  }
+  output_count = 0;
+}
+
+static size_t output_mem_block_symbols(uint8_t index, uint8_t count) {
+#if SOC_RMT_SUPPORT_DMA
+  if (index == 0) {
+    return LED_RMT_DMA_SYMBOLS;
+  }
+#else
+  (void)index;
+#endif
+  return count == 1 ? LED_RMT_SINGLE_OUTPUT_SYMBOLS : SOC_RMT_MEM_WORDS_PER_CHANNEL;
+}
+
+static bool configure_rmt_output(led_output_t *output, uint8_t index, uint8_t count) {
   rmt_tx_channel_config_t tx_chan_config = {
       .clk_src           = RMT_CLK_SRC_DEFAULT,
-      .gpio_num          = LED_PIN,
-      .mem_block_symbols = LED_RMT_MEM_BLOCK_SYMBOLS,
+      .gpio_num          = output->config.gpio,
+      .mem_block_symbols = output_mem_block_symbols(index, count),
       .resolution_hz     = 10000000,
       .trans_queue_depth = 4,
       .flags.invert_out  = false,
 #if SOC_RMT_SUPPORT_DMA
-      .flags.with_dma = true,
+      .flags.with_dma = index == 0, // A single DMA channel
 #else
       .flags.with_dma = false,
 #endif
   };
 
-  esp_err_t ret = rmt_new_tx_channel(&tx_chan_config, &led_chan);
+  esp_err_t ret = rmt_new_tx_channel(&tx_chan_config, &output->chan);
+  if (ret != ESP_OK) {
+    ESP_LOGE(TAG_LED, "Error creating RMT TX channel (GPIO %u): %s", output->config.gpio, esp_err_to_name(ret));
+    output->chan = NULL;
+    return false;
+  }
+
+  if (output->done_sem == NULL) {
+    output->done_sem = xSemaphoreCreateBinary();
+    if (output->done_sem == NULL) {
+      ESP_LOGE(TAG_LED, "Error creating RMT done semaphore");
+      return false;
+    }
+  }
+  rmt_tx_event_callbacks_t tx_callbacks = {.on_trans_done = led_tx_done_cb};
+  ret                                   = rmt_tx_register_event_callbacks(output->chan, &tx_callbacks, output);
   if (ret != ESP_OK) {
-    ESP_LOGE(TAG_LED, "Error creating RMT TX channel: %s", esp_err_to_name(ret));
+    ESP_LOGE(TAG_LED, "Error registering RMT callbacks: %s", esp_err_to_name(ret));
     return false;
   }
 
@@ -467,43 +780,125 @@ static bool configure_rmt_channel(void) {
       .resolution = tx_chan_config.resolution_hz,
   };
 
-  ret = rmt_new_led_strip_encoder(&encoder_config, &led_encoder);
+  ret = rmt_new_led_strip_encoder(&encoder_config, &output->encoder);
   if (ret != ESP_OK) {
     ESP_LOGE(TAG_LED, "Error creating LED encoder: %s", esp_err_to_name(ret));
-    cleanup_rmt_channel();
+    output->encoder = NULL;
     return false;
   }
 
-  ret = rmt_enable(led_chan);
+  ret = rmt_enable(output->chan);
   if (ret != ESP_OK) {
     ESP_LOGE(TAG_LED, "RMT channel activation error: %s", esp_err_to_name(ret));
-    cleanup_rmt_channel();
     return false;
   }
 
+  // Nothing on the wire: the first frame is sent at once
+  output->sent_count = 0;
+  xSemaphoreTake(output->done_sem, 0);
+  return true;
+}
+
+// One channel per output. An output whose channel cannot be created (all taken, the
+// status LED holds one) is left dark; fails only when none of them works.
+static bool configure_rmt_channels(const led_output_config_t *configs, uint8_t count) {
+  cleanup_rmt_channels();
+
+  for (int i = 0; i < count; i++) {
+    led_output_t *output = &outputs[output_count];
+    output->config       = configs[i];
+    if (!configure_rmt_output(output, (uint8_t)i, count)) {
+      ESP_LOGE(TAG_LED, "Output %d (GPIO %u) disabled", i, configs[i].gpio);
+      release_rmt_output(output);
+      continue;
+    }
+    output_count++;
+  }
+
+  portENTER_CRITICAL(&outputs_lock);
+  memcpy(output_configs, configs, count * sizeof(led_output_config_t));
+  active_output_count = count;
+  portEXIT_CRITICAL(&outputs_lock);
+  tx_start_us    = 0;
+  tx_frame_valid = false;
+  if (output_count == 0) {
+    return false;
+  }
+  ESP_LOGI(TAG_LED, "%u/%u LED outputs on RMT", output_count, count);
   return true;
 }
 
 // Fill all LEDs with a color
-static void fill_solid(rgb_t color) {
-  for (int i = 0; i < led_count; i++) {
-    leds[i] = color;
+static void fill_solid(effect_ctx_t *ctx, rgb_t color) {
+  for (int i = 0; i < ctx->count; i++) {
+    *led_at(ctx, i) = color;
+  }
+}
+
+// Fade all LEDs, keep_percent being what remains after LED_EFFECT_FRAME_MS: the factor
+// follows the frame's elapsed time so trails last as long at any frame rate
+static void fade_all(effect_ctx_t *ctx, uint8_t keep_percent) {
+  if (ctx->dt_ms == 0) {
+    return;
+  }
+  float keep_ratio = powf((float)keep_percent / FADE_DIVISOR, (float)ctx->dt_ms / LED_EFFECT_FRAME_MS);
+  uint16_t keep    = (uint16_t)(keep_ratio * 256.0f);
+  for (int i = 0; i < ctx->count; i++) {
+    led_at(ctx, i)->r = (led_at(ctx, i)->r * keep) >> 8;
+    led_at(ctx, i)->g = (led_at(ctx, i)->g * keep) >> 8;
+    led_at(ctx, i)->b = (led_at(ctx, i)->b * keep) >> 8;
+  }
+}
+
+// Randomness of an instance: xorshift32 seeded per layer (layer_seed), so a layer
+// started with the same seed renders the same frames, and no hardware RNG register
+// read per LED
+static inline uint32_t effect_random(effect_ctx_t *ctx) {
+  uint32_t x = ctx->rng;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  ctx->rng = x;
+  return x;
+}
+
+// Uniform in [0, n) without a division (0 when n is 0)
+static inline uint32_t random_below(effect_ctx_t *ctx, uint32_t n) {
+  return (uint32_t)(((uint64_t)effect_random(ctx) * n) >> 32);
+}
+
+// n random bytes, four per draw
+static void random_fill(effect_ctx_t *ctx, uint8_t *out, size_t n) {
+  while (n >= 4) {
+    uint32_t x = effect_random(ctx);
+    memcpy(out, &x, 4);
+    out += 4;
+    n -= 4;
+  }
+  if (n > 0) {
+    uint32_t x = effect_random(ctx);
+    memcpy(out, &x, n);
   }
 }
 
+// True with probability numerator / denominator per LED_EFFECT_FRAME_MS of elapsed time
+static bool chance_per_period(effect_ctx_t *ctx, uint32_t numerator, uint32_t denominator) {
+  return random_below(ctx, denominator * LED_EFFECT_FRAME_MS) < numerator * ctx->dt_ms;
+}
+
 // Effect: Solid color
-static void effect_solid(void) {
-  if (led_count == 0) {
+static void effect_solid(effect_ctx_t *ctx) {
+  if (ctx->count == 0) {
     return;
   }
 
-  rgb_t color1 = color_to_rgb(current_config.color1);
-  rgb_t color2 = color_to_rgb(current_config.color2);
-  rgb_t color3 = color_to_rgb(current_config.color3);
-  int seg1_end = led_count / 3;
-  int seg2_end = (led_count * 2) / 3;
+  rgb_t color1 = color_to_rgb(ctx->config->color1);
+  rgb_t color2 = color_to_rgb(ctx->config->color2);
+  rgb_t color3 = color_to_rgb(ctx->config->color3);
+  int seg1_end = ctx->count / 3;
+  int seg2_end = (ctx->count * 2) / 3;
 
-  for (int i = 0; i < led_count; i++) {
+  for (int i = 0; i < ctx->count; i++) {
     rgb_t color;
     if (i < seg1_end) {
       color = color1;
@@ -512,136 +907,136 @@ static void effect_solid(void) {
     } else {
       color = color3;
     }
-    leds[i] = apply_brightness(color, current_config.brightness);
+    *led_at(ctx, i) = apply_brightness(color, ctx->config->brightness);
   }
 }
 
 // Effect: Breathing
-static void effect_breathing(void) {
-  float breath       = (sin(effect_counter * 0.01f * current_config.speed / 10.0f) + 1.0f) / 2.0f;
-  uint8_t brightness = (uint8_t)(current_config.brightness * breath);
-
-  rgb_t color1       = color_to_rgb(current_config.color1);
-  rgb_t color2       = color_to_rgb_fallback(current_config.color2, current_config.color1);
-  rgb_t color3       = color_to_rgb_fallback(current_config.color3, current_config.color1);
-  rgb_t color        = rgb_lerp3(color1, color2, color3, breath);
+static void effect_breathing(effect_ctx_t *ctx) {
+  // (sin(frame * speed / 1000) + 1) / 2
+  uint32_t phase     = ctx->frame * fixed_phase_from_radians(ctx->config->speed / 1000.0f);
+  uint8_t breath     = fixed_sin8(phase >> 16);
+  uint8_t brightness = fixed_scale8(ctx->config->brightness, breath);
+
+  rgb_t color1       = color_to_rgb(ctx->config->color1);
+  rgb_t color2       = color_to_rgb_fallback(ctx->config->color2, ctx->config->color1);
+  rgb_t color3       = color_to_rgb_fallback(ctx->config->color3, ctx->config->color1);
+  rgb_t color        = rgb_lerp3_q8(color1, color2, color3, breath);
   color              = apply_brightness(color, brightness);
-  fill_solid(color);
+  fill_solid(ctx, color);
 }
 
 // Effect: Rainbow
-static void effect_rainbow(void) {
+static void effect_rainbow(effect_ctx_t *ctx) {
   // Use speed to control animation speed
-  uint32_t speed_factor = (effect_counter * (current_config.speed + 10)) / 50;
+  uint32_t speed_factor = (ctx->frame * (ctx->config->speed + 10)) / 50;
 
-  for (int i = 0; i < led_count; i++) {
-    int led_index   = current_config.reverse ? (led_count - 1 - i) : i;
-    uint16_t hue    = (i * 256 / led_count + speed_factor) % 256;
+  for (int i = 0; i < ctx->count; i++) {
+    uint16_t hue    = (i * 256 / ctx->count + speed_factor) % 256;
     rgb_t color     = hsv_to_rgb(hue, HSV_SATURATION_MAX, HSV_VALUE_MAX);
-    color           = apply_brightness(color, current_config.brightness);
-    leds[led_index] = color;
+    color           = apply_brightness(color, ctx->config->brightness);
+    *led_at(ctx, i) = color;
   }
 }
 
 // Effect: Rainbow cycle
-static void effect_rainbow_cycle(void) {
+static void effect_rainbow_cycle(effect_ctx_t *ctx) {
   // Speed controls the cycle rate (speed: 0-255)
-  uint8_t speed_factor = current_config.speed;
+  uint8_t speed_factor = ctx->config->speed;
   if (speed_factor < 10)
     speed_factor = 10; // Minimum to avoid issues
 
-  uint16_t hue = ((effect_counter * speed_factor) / 50) % 256;
-  rgb_t color  = hsv_to_rgb(hue, 255, 255);                          // Use maximum brightness for HSV
-  color        = apply_brightness(color, current_config.brightness); // Apply brightness AND night mode
-  fill_solid(color);
+  uint16_t hue = ((ctx->frame * speed_factor) / 50) % 256;
+  rgb_t color  = hsv_to_rgb(hue, 255, 255);                        // Use maximum brightness for HSV
+  color        = apply_brightness(color, ctx->config->brightness); // Apply brightness AND night mode
+  fill_solid(ctx, color);
 }
 
 // Effect: Theater Chase
-static void effect_theater_chase(void) {
-  rgb_t color1      = apply_brightness(color_to_rgb(current_config.color1), current_config.brightness);
-  rgb_t color2      = apply_brightness(color_to_rgb_fallback(current_config.color2, current_config.color1), current_config.brightness);
-  rgb_t color3      = apply_brightness(color_to_rgb_fallback(current_config.color3, current_config.color1), current_config.brightness);
+static void effect_theater_chase(effect_ctx_t *ctx) {
+  rgb_t color1      = apply_brightness(color_to_rgb(ctx->config->color1), ctx->config->brightness);
+  rgb_t color2      = apply_brightness(color_to_rgb_fallback(ctx->config->color2, ctx->config->color1), ctx->config->brightness);
+  rgb_t color3      = apply_brightness(color_to_rgb_fallback(ctx->config->color3, ctx->config->color1), ctx->config->brightness);
 
   // Use speed to control scroll speed
-  int speed_divider = 256 - current_config.speed;
+  int speed_divider = 256 - ctx->config->speed;
   if (speed_divider < ANIM_PERIOD_FAST_MIN)
     speed_divider = ANIM_PERIOD_FAST_MIN;
-  int pos           = (effect_counter * 10 / speed_divider) % 3;
+  int pos           = (ctx->frame * 10 / speed_divider) % 3;
 
-  int color_index   = (effect_counter / 10) % 3;
+  int color_index   = (ctx->frame / 10) % 3;
   rgb_t chase_color = (color_index == 0) ? color1 : (color_index == 1 ? color2 : color3);
 
-  for (int i = 0; i < led_count; i++) {
-    int led_index = current_config.reverse ? (led_count - 1 - i) : i;
+  for (int i = 0; i < ctx->count; i++) {
     if (i % 3 == pos) {
-      leds[led_index] = chase_color;
+      *led_at(ctx, i) = chase_color;
     } else {
-      leds[led_index] = (rgb_t){0, 0, 0};
+      *led_at(ctx, i) = (rgb_t){0, 0, 0};
     }
   }
 }
 
 // Effect: Running Lights
-static void effect_running_lights(void) {
+static void effect_running_lights(effect_ctx_t *ctx) {
   // Use speed to control scroll speed
-  int speed_divider = 256 - current_config.speed;
+  int speed_divider = 256 - ctx->config->speed;
   if (speed_divider < 10)
     speed_divider = 10;
-  int pos = (effect_counter * 100 / speed_divider) % led_count;
-  if (current_config.reverse) {
-    pos = led_count - 1 - pos;
-  }
+  int pos      = (ctx->frame * 100 / speed_divider) % ctx->count;
 
-  rgb_t color1 = color_to_rgb(current_config.color1);
-  rgb_t color2 = color_to_rgb_fallback(current_config.color2, current_config.color1);
+  rgb_t color1 = color_to_rgb(ctx->config->color1);
+  rgb_t color2 = color_to_rgb_fallback(ctx->config->color2, ctx->config->color1);
 
-  for (int i = 0; i < led_count; i++) {
+  for (int i = 0; i < ctx->count; i++) {
     int distance = abs(i - pos);
-    if (distance > led_count / 2) {
-      distance = led_count - distance;
+    if (distance > ctx->count / 2) {
+      distance = ctx->count - distance;
     }
 
-    uint8_t brightness = current_config.brightness * (led_count - distance * 2) / led_count;
-    float denom        = (led_count > 1) ? (led_count / 2.0f) : 1.0f;
+    uint8_t brightness = ctx->config->brightness * (ctx->count - distance * 2) / ctx->count;
+    float denom        = (ctx->count > 1) ? (ctx->count / 2.0f) : 1.0f;
     float t            = (denom > 0.0f) ? ((float)distance / denom) : 0.0f;
     rgb_t color        = rgb_lerp(color1, color2, t);
-    leds[i]            = apply_brightness(color, brightness);
+    *led_at(ctx, i)    = apply_brightness(color, brightness);
   }
 }
 
 // Effect: Twinkle
-static void effect_twinkle(void) {
+static void effect_twinkle(effect_ctx_t *ctx) {
   // Gradually fade all LEDs
-  for (int i = 0; i < led_count; i++) {
-    leds[i].r = leds[i].r * 95 / 100;
-    leds[i].g = leds[i].g * 95 / 100;
-    leds[i].b = leds[i].b * 95 / 100;
-  }
+  fade_all(ctx, FADE_FACTOR_SLOW);
 
   // Randomly light a few LEDs
-  if (esp_random() % 10 < current_config.speed / 25) {
-    int pos       = esp_random() % led_count;
-    uint32_t pick = esp_random() % 3;
+  if (chance_per_period(ctx, ctx->config->speed / 25, 10)) {
+    int pos       = random_below(ctx, ctx->count);
+    uint32_t pick = random_below(ctx, 3);
     rgb_t color;
     if (pick == 0) {
-      color = color_to_rgb(current_config.color1);
+      color = color_to_rgb(ctx->config->color1);
     } else if (pick == 1) {
-      color = color_to_rgb_fallback(current_config.color2, current_config.color1);
+      color = color_to_rgb_fallback(ctx->config->color2, ctx->config->color1);
     } else {
-      color = color_to_rgb_fallback(current_config.color3, current_config.color1);
+      color = color_to_rgb_fallback(ctx->config->color3, ctx->config->color1);
     }
-    leds[pos] = apply_brightness(color, current_config.brightness);
+    *led_at(ctx, pos) = apply_brightness(color, ctx->config->brightness);
   }
 }
 
-// Effect: Fire
-static uint16_t heat_map[MAX_LED_COUNT]; // Heat map for the fire effect
+// Effect: Fire (state: heat map, one uint16_t per LED)
 
-static void effect_fire(void) {
-  // Refroidissement de la carte de chaleur
-  int cooling = 55 + (current_config.speed / 5);
-  for (int i = 0; i < led_count; i++) {
-    int cooldown = esp_random() % cooling;
+// One LED_EFFECT_FRAME_MS step of the heat simulation
+static void fire_step(effect_ctx_t *ctx) {
+  uint16_t *heat_map = ctx->state;
+
+  // Refroidissement de la carte de chaleur (random bytes drawn in batches)
+  int cooling        = 55 + (ctx->config->speed / 5);
+  uint8_t noise[64];
+  for (int i = 0; i < ctx->count; i++) {
+    if (i % sizeof(noise) == 0) {
+      size_t left = ctx->count - i;
+      random_fill(ctx, noise, left < sizeof(noise) ? left : sizeof(noise));
+    }
+    int cooldown = (noise[i % sizeof(noise)] * cooling) >> 8;
     if (cooldown > heat_map[i]) {
       heat_map[i] = 0;
     } else {
@@ -650,24 +1045,31 @@ static void effect_fire(void) {
   }
 
   // Propagation de la chaleur vers le haut
-  for (int i = led_count - 1; i >= 2; i--) {
+  for (int i = ctx->count - 1; i >= 2; i--) {
     heat_map[i] = (heat_map[i - 1] + heat_map[i - 2] + heat_map[i - 2]) / 3;
   }
 
   // Random ignition of new "flames" across the strip
   // Create multiple ignition points for a uniform effect
-  int num_sparks = 3 + (current_config.speed / 50); // Faster = more flames
+  int num_sparks = 3 + (ctx->config->speed / 50); // Faster = more flames
   for (int s = 0; s < num_sparks; s++) {
-    if (esp_random() % 255 < 120) {
-      int pos       = esp_random() % led_count; // Across entire strip
-      heat_map[pos] = heat_map[pos] + (esp_random() % 160) + 95;
+    if (random_below(ctx, 255) < 120) {
+      int pos       = random_below(ctx, ctx->count); // Across entire strip
+      heat_map[pos] = heat_map[pos] + random_below(ctx, 160) + 95;
       if (heat_map[pos] > 255)
         heat_map[pos] = 255;
     }
   }
+}
+
+static void effect_fire(effect_ctx_t *ctx) {
+  uint16_t *heat_map = ctx->state;
+  for (uint32_t step = 0; step < ctx->steps; step++) {
+    fire_step(ctx);
+  }
 
   // Convert heat to colors (fire palette)
-  for (int i = 0; i < led_count; i++) {
+  for (int i = 0; i < ctx->count; i++) {
     rgb_t color;
     uint8_t heat = heat_map[i];
 
@@ -689,125 +1091,113 @@ static void effect_fire(void) {
       color.b = ((heat - 170) * 2);
     }
 
-    leds[i] = apply_brightness(color, current_config.brightness);
+    *led_at(ctx, i) = apply_brightness(color, ctx->config->brightness);
   }
 }
 
 // Effect: Scan (Knight Rider)
-static void effect_scan(void) {
+static void effect_scan(effect_ctx_t *ctx) {
   // Perform a progressive fade instead of clearing completely to keep the
   // trail
-  for (int i = 0; i < led_count; i++) {
-    leds[i].r = (leds[i].r * 90) / 100; // Reduce by 10% each frame
-    leds[i].g = (leds[i].g * 90) / 100;
-    leds[i].b = (leds[i].b * 90) / 100;
-  }
+  fade_all(ctx, FADE_FACTOR_MEDIUM); // Reduce by 10% each frame period
 
   // Use speed to control scroll speed
-  int speed_divider = 256 - current_config.speed;
+  int speed_divider = 256 - ctx->config->speed;
   if (speed_divider < 10)
     speed_divider = 10;
-  int pos = (effect_counter * 100 / speed_divider) % (led_count * 2);
+  int pos = (ctx->frame * 100 / speed_divider) % (ctx->count * 2);
 
-  if (pos >= led_count) {
-    pos = led_count * 2 - pos - 1;
+  if (pos >= ctx->count) {
+    pos = ctx->count * 2 - pos - 1;
   }
 
-  if (current_config.reverse) {
-    pos = led_count - 1 - pos;
-  }
-
-  rgb_t head_color  = color_to_rgb(current_config.color1);
-  rgb_t trail_color = color_to_rgb_fallback(current_config.color2, current_config.color1);
-  rgb_t base_color  = color_to_rgb_fallback(current_config.color3, current_config.color1);
+  rgb_t head_color  = color_to_rgb(ctx->config->color1);
+  rgb_t trail_color = color_to_rgb_fallback(ctx->config->color2, ctx->config->color1);
+  rgb_t base_color  = color_to_rgb_fallback(ctx->config->color3, ctx->config->color1);
 
-  if (current_config.color3 != 0) {
-    uint8_t base_brightness = current_config.brightness / 6;
+  if (ctx->config->color3 != 0) {
+    uint8_t base_brightness = ctx->config->brightness / 6;
     if (base_brightness > 0) {
       rgb_t applied_base = apply_brightness(base_color, base_brightness);
-      for (int i = 0; i < led_count; i++) {
-        leds[i] = rgb_max(leds[i], applied_base);
+      for (int i = 0; i < ctx->count; i++) {
+        *led_at(ctx, i) = rgb_max(*led_at(ctx, i), applied_base);
       }
     }
   }
 
   // LED principale plus brillante
-  if (pos >= 0 && pos < led_count) {
-    leds[pos] = apply_brightness(head_color, current_config.brightness);
+  if (pos >= 0 && pos < ctx->count) {
+    *led_at(ctx, pos) = apply_brightness(head_color, ctx->config->brightness);
   }
 
   // Gradient trail symmetrical on both sides
   // The trail gradually decreases in brightness
   for (int i = 1; i <= 5; i++) {
     // Calculate trail brightness (decreases with distance)
-    uint8_t trail_brightness = current_config.brightness * (6 - i) / 6;
+    uint8_t trail_brightness = ctx->config->brightness * (6 - i) / 6;
     rgb_t applied_trail      = apply_brightness(trail_color, trail_brightness);
 
     // Apply the trail on both sides, but only within the limits of the
     // strip
-    if (pos - i >= 0 && pos - i < led_count) {
-      leds[pos - i] = applied_trail;
+    if (pos - i >= 0 && pos - i < ctx->count) {
+      *led_at(ctx, pos - i) = applied_trail;
     }
-    if (pos + i >= 0 && pos + i < led_count) {
-      leds[pos + i] = applied_trail;
+    if (pos + i >= 0 && pos + i < ctx->count) {
+      *led_at(ctx, pos + i) = applied_trail;
     }
   }
 }
 
 // Effect: Knight Rider (K2000 - sharp trail)
-static void effect_knight_rider(void) {
+static void effect_knight_rider(effect_ctx_t *ctx) {
   // Clear the strip to keep a sharp trail
-  fill_solid((rgb_t){0, 0, 0});
+  fill_solid(ctx, (rgb_t){0, 0, 0});
 
   // Use speed to control scroll speed
-  int speed_divider = 256 - current_config.speed;
+  int speed_divider = 256 - ctx->config->speed;
   if (speed_divider < 10)
     speed_divider = 10;
-  int pos = (effect_counter * 100 / speed_divider) % (led_count * 2);
-
-  if (pos >= led_count) {
-    pos = led_count * 2 - pos - 1;
-  }
+  int pos = (ctx->frame * 100 / speed_divider) % (ctx->count * 2);
 
-  if (current_config.reverse) {
-    pos = led_count - 1 - pos;
+  if (pos >= ctx->count) {
+    pos = ctx->count * 2 - pos - 1;
   }
 
-  rgb_t head_color  = color_to_rgb(current_config.color1);
-  rgb_t trail_color = color_to_rgb_fallback(current_config.color2, current_config.color1);
+  rgb_t head_color  = color_to_rgb(ctx->config->color1);
+  rgb_t trail_color = color_to_rgb_fallback(ctx->config->color2, ctx->config->color1);
 
   // Main LED at full brightness
-  if (pos >= 0 && pos < led_count) {
-    leds[pos] = apply_brightness(head_color, current_config.brightness);
+  if (pos >= 0 && pos < ctx->count) {
+    *led_at(ctx, pos) = apply_brightness(head_color, ctx->config->brightness);
   }
 
   // Sharp, short trail (3 LEDs on each side instead of 5)
   // Fast decay for an authentic K2000 look
   for (int i = 1; i <= 3; i++) {
     // Calculate trail brightness with exponential decay
-    uint8_t trail_brightness = current_config.brightness / (1 << i); // Division par 2, 4, 8
+    uint8_t trail_brightness = ctx->config->brightness / (1 << i); // Division par 2, 4, 8
     rgb_t applied_trail      = apply_brightness(trail_color, trail_brightness);
 
     // Apply the trail on both sides
-    if (pos - i >= 0 && pos - i < led_count) {
-      leds[pos - i] = applied_trail;
+    if (pos - i >= 0 && pos - i < ctx->count) {
+      *led_at(ctx, pos - i) = applied_trail;
     }
-    if (pos + i >= 0 && pos + i < led_count) {
-      leds[pos + i] = applied_trail;
+    if (pos + i >= 0 && pos + i < ctx->count) {
+      *led_at(ctx, pos + i) = applied_trail;
     }
   }
 }
 
 // Effect: Fade (smooth in/out)
-static void effect_fade(void) {
+static void effect_fade(effect_ctx_t *ctx) {
   // Calculate the period based on speed (speed: 0-255)
-  uint8_t speed_factor = current_config.speed;
+  uint8_t speed_factor = ctx->config->speed;
   if (speed_factor < 10)
     speed_factor = 10;
 
   // Full period (fade in + fade out)
   uint16_t period = (256 - speed_factor) * 2; // Range: ~20 (fast) to ~512 (slow)
-  uint16_t cycle  = effect_counter % period;
+  uint16_t cycle  = ctx->frame % period;
 
   // Calculate triangle brightness (0->255->0)
   uint8_t brightness;
@@ -820,86 +1210,74 @@ static void effect_fade(void) {
   }
 
   // Apply to the color (cycle across 3 colors)
-  rgb_t color1             = color_to_rgb(current_config.color1);
-  rgb_t color2             = color_to_rgb_fallback(current_config.color2, current_config.color1);
-  rgb_t color3             = color_to_rgb_fallback(current_config.color3, current_config.color1);
-  float color_phase        = (float)effect_counter / (float)period;
+  rgb_t color1             = color_to_rgb(ctx->config->color1);
+  rgb_t color2             = color_to_rgb_fallback(ctx->config->color2, ctx->config->color1);
+  rgb_t color3             = color_to_rgb_fallback(ctx->config->color3, ctx->config->color1);
+  float color_phase        = (float)ctx->frame / (float)period;
   color_phase              = fmodf(color_phase, 1.0f);
   rgb_t color              = rgb_lerp3(color1, color2, color3, color_phase);
-  uint8_t final_brightness = (brightness * current_config.brightness) / 255;
+  uint8_t final_brightness = (brightness * ctx->config->brightness) / 255;
   color                    = apply_brightness(color, final_brightness);
-  fill_solid(color);
+  fill_solid(ctx, color);
 }
 
 // Effect: Strobe (full strip flash)
-static void effect_strobe(void) {
-  rgb_t color1 = color_to_rgb(current_config.color1);
-  rgb_t color2 = color_to_rgb_fallback(current_config.color2, current_config.color1);
-  rgb_t color3 = color_to_rgb_fallback(current_config.color3, current_config.color1);
+static void effect_strobe(effect_ctx_t *ctx) {
+  rgb_t color1 = color_to_rgb(ctx->config->color1);
+  rgb_t color2 = color_to_rgb_fallback(ctx->config->color2, ctx->config->color1);
+  rgb_t color3 = color_to_rgb_fallback(ctx->config->color3, ctx->config->color1);
 
   // Flash period based on the speed parameter
   // speed: 0-255, converted to a 10-50 frame period (higher speed = shorter period
   // short = fast)
-  int period   = 50 - ((current_config.speed * 40) / 255); // Range: 50 (slow) to 10 (fast)
+  int period   = 50 - ((ctx->config->speed * 40) / 255); // Range: 50 (slow) to 10 (fast)
   if (period < 10)
     period = 10;
-  int cycle          = effect_counter % period;
-  int color_index    = (effect_counter / period) % 3;
+  int cycle          = ctx->frame % period;
+  int color_index    = (ctx->frame / period) % 3;
   rgb_t color        = (color_index == 0) ? color1 : (color_index == 1 ? color2 : color3);
-  color              = apply_brightness(color, current_config.brightness);
+  color              = apply_brightness(color, ctx->config->brightness);
 
   // Flash actif pendant 30% du cycle
   int flash_duration = (period * 30) / 100;
 
   if (cycle < flash_duration) {
     // Allumer toute la strip
-    fill_solid(color);
+    fill_solid(ctx, color);
   } else {
     // Turn off the entire strip
-    fill_solid((rgb_t){0, 0, 0});
+    fill_solid(ctx, (rgb_t){0, 0, 0});
   }
 }
 
 // Effect: Directional blindspot flash (blindspot with fast directional
 // animation)
-static void effect_blindspot_flash(void) {
-  rgb_t color   = color_to_rgb(current_config.color1);
-  color         = apply_brightness(color, current_config.brightness);
+static void effect_blindspot_flash(effect_ctx_t *ctx) {
+  rgb_t color   = color_to_rgb(ctx->config->color1);
+  color         = apply_brightness(color, ctx->config->brightness);
 
-  int half_leds = led_count / 2;
+  int half_leds = ctx->count / 2;
 
   // Fast flash period based on the speed parameter
   // speed: 0-255, converted to a 15-100 frame period (higher speed = shorter period
   // short = fast)
-  int period    = 100 - ((current_config.speed * 85) / 255); // Range: 100 (slow) to 15 (fast)
+  int period    = 100 - ((ctx->config->speed * 85) / 255); // Range: 100 (slow) to 15 (fast)
   if (period < 15)
     period = 15;
-  int cycle              = effect_counter % period;
+  int cycle              = ctx->frame % period;
 
   // Flash active for 60% of cycle (longer than turn signal for urgency)
   int animation_duration = (period * 60) / 100;
 
   // Clear entire strip
-  fill_solid((rgb_t){0, 0, 0});
+  fill_solid(ctx, (rgb_t){0, 0, 0});
 
   if (cycle < animation_duration) {
     // Fast animation: light up gradually with more intensity
     int lit_count = (cycle * half_leds) / animation_duration;
 
-    // Light up LEDs with directional animation from center
+    // Light up LEDs from the center toward the end (reversed: toward the start)
     for (int i = 0; i < lit_count && i < half_leds; i++) {
-      int led_index;
-
-      // Animate from the CENTER outward
-      if (current_config.reverse) {
-        // Left side: animate from center (half_leds-1) toward the left (0)
-        led_index = half_leds - 1 - i;
-      } else {
-        // Right side: animate from center (half_leds) toward the right
-        // (led_count-1)
-        led_index = half_leds + i;
-      }
-
       // More even intensity for the alert effect
       float brightness_factor;
       if (i < lit_count - 3) {
@@ -908,63 +1286,61 @@ static void effect_blindspot_flash(void) {
         brightness_factor = 1.0f; // Head at 100%
       }
 
-      leds[led_index] = apply_brightness(color, (uint8_t)(current_config.brightness * brightness_factor));
+      *led_at(ctx, half_leds + i) = apply_brightness(color, (uint8_t)(ctx->config->brightness * brightness_factor));
     }
   }
   // Shorter pause for alert effect
 }
 
 // Effect: Turn signals with sequential scrolling (configurable segment)
-static void effect_turn_signal(void) {
-  rgb_t base_color = color_to_rgb(current_config.color1);
+static void effect_turn_signal(effect_ctx_t *ctx) {
+  rgb_t base_color = color_to_rgb(ctx->config->color1);
 
-  int segment_len  = led_count;
+  int segment_len  = ctx->count;
   if (segment_len <= 0) {
-    fill_solid((rgb_t){0, 0, 0});
+    fill_solid(ctx, (rgb_t){0, 0, 0});
     return;
   }
 
-  int period = 120 - ((current_config.speed * 100) / 255); // Range: 120 (slow) to 20 (fast)
+  int period = 120 - ((ctx->config->speed * 100) / 255); // Range: 120 (slow) to 20 (fast)
   if (period < 20)
     period = 20;
-  int cycle              = effect_counter % period;
+  int cycle              = ctx->frame % period;
 
   int animation_duration = (period * 70) / 100;
 
-  fill_solid((rgb_t){0, 0, 0});
+  fill_solid(ctx, (rgb_t){0, 0, 0});
 
   if (cycle < animation_duration) {
     int lit_count = (cycle * segment_len) / animation_duration;
 
     for (int i = 0; i < lit_count && i < segment_len; i++) {
-      int led_index           = current_config.reverse ? (segment_len - 1 - i) : i;
-
       float brightness_factor = (i < lit_count - 5) ? 0.3f : 1.0f;
-      leds[led_index]         = apply_brightness(base_color, (uint8_t)(current_config.brightness * brightness_factor));
+      *led_at(ctx, i)         = apply_brightness(base_color, (uint8_t)(ctx->config->brightness * brightness_factor));
     }
   }
 }
 
 // Effect: Hazards (turn signals on both sides simultaneously)
-static void effect_hazard(void) {
-  rgb_t color   = color_to_rgb(current_config.color1);
-  color         = apply_brightness(color, current_config.brightness);
+static void effect_hazard(effect_ctx_t *ctx) {
+  rgb_t color   = color_to_rgb(ctx->config->color1);
+  color         = apply_brightness(color, ctx->config->brightness);
 
-  int half_leds = led_count / 2;
+  int half_leds = ctx->count / 2;
 
   // Full animation period based on the speed parameter
   // speed: 0-255, converted to a 20-120 frame period (higher speed = shorter period
   // short = fast)
-  int period    = 120 - ((current_config.speed * 100) / 255); // Range: 120 (slow) to 20 (fast)
+  int period    = 120 - ((ctx->config->speed * 100) / 255); // Range: 120 (slow) to 20 (fast)
   if (period < 20)
     period = 20;
-  int cycle              = effect_counter % period;
+  int cycle              = ctx->frame % period;
 
   // Phase 1: Progressive scroll (70% of the cycle)
   int animation_duration = (period * 70) / 100;
 
   // Clear entire strip
-  fill_solid((rgb_t){0, 0, 0});
+  fill_solid(ctx, (rgb_t){0, 0, 0});
 
   if (cycle < animation_duration) {
     // Smooth scrolling: gradually light both sides from the
@@ -981,90 +1357,86 @@ static void effect_hazard(void) {
         brightness_factor = 1.0f; // Head at 100%
       }
 
-      rgb_t dimmed_color      = apply_brightness(color, (uint8_t)(current_config.brightness * brightness_factor));
+      rgb_t dimmed_color              = apply_brightness(color, (uint8_t)(ctx->config->brightness * brightness_factor));
 
       // Left side: animate from center (half_leds-1) toward the left (0)
-      leds[half_leds - 1 - i] = dimmed_color;
+      *led_at(ctx, half_leds - 1 - i) = dimmed_color;
 
       // Right side: animate from center (half_leds) toward the right
-      // (led_count-1)
-      leds[half_leds + i]     = dimmed_color;
+      // (ctx->count-1)
+      *led_at(ctx, half_leds + i)     = dimmed_color;
     }
   }
   // Otherwise everything stays off (pause)
 }
 
 // Effect: Comet with soft trail
-static void effect_comet(void) {
-  fill_solid((rgb_t){0, 0, 0});
+static void effect_comet(effect_ctx_t *ctx) {
+  fill_solid(ctx, (rgb_t){0, 0, 0});
 
-  if (led_count == 0) {
+  if (ctx->count == 0) {
     return;
   }
 
-  int trail_length = led_count / 8;
+  int trail_length = ctx->count / 8;
   if (trail_length < 3)
     trail_length = 3;
   if (trail_length > 20)
     trail_length = 20;
 
-  int speed_divider = 256 - current_config.speed;
+  int speed_divider = 256 - ctx->config->speed;
   if (speed_divider < 10)
     speed_divider = 10;
-  int head_pos = (effect_counter * 100 / speed_divider) % led_count;
-  if (current_config.reverse) {
-    head_pos = (led_count - 1) - head_pos;
-  }
+  int head_pos      = (ctx->frame * 100 / speed_divider) % ctx->count;
 
-  rgb_t head_color  = color_to_rgb(current_config.color1);
-  rgb_t trail_color = color_to_rgb_fallback(current_config.color2, current_config.color1);
+  rgb_t head_color  = color_to_rgb(ctx->config->color1);
+  rgb_t trail_color = color_to_rgb_fallback(ctx->config->color2, ctx->config->color1);
 
   for (int i = 0; i < trail_length; i++) {
-    int offset = current_config.reverse ? i : -i;
-    int idx    = head_pos + offset;
-    if (idx < 0 || idx >= led_count) {
+    int idx = head_pos - i;
+    if (idx < 0 || idx >= ctx->count) {
       continue;
     }
 
-    uint8_t trail_brightness = (uint8_t)((current_config.brightness * (trail_length - i)) / trail_length);
+    uint8_t trail_brightness = (uint8_t)((ctx->config->brightness * (trail_length - i)) / trail_length);
     rgb_t color              = apply_brightness((i == 0) ? head_color : trail_color, trail_brightness);
-    leds[idx]                = color;
+    *led_at(ctx, idx)        = color;
   }
 }
 
 // Effect: Multiple meteor shower
-static void effect_meteor_shower(void) {
-  fill_solid((rgb_t){0, 0, 0});
+static void effect_meteor_shower(effect_ctx_t *ctx) {
+  fill_solid(ctx, (rgb_t){0, 0, 0});
 
-  if (led_count == 0) {
+  if (ctx->count == 0) {
     return;
   }
 
-  int tail_length = led_count / 10;
+  int tail_length = ctx->count / 10;
   if (tail_length < 4)
     tail_length = 4;
   if (tail_length > 24)
     tail_length = 24;
 
   int meteor_count  = 3;
-  int speed_divider = 80 - ((current_config.speed * 65) / 255);
+  int speed_divider = 80 - ((ctx->config->speed * 65) / 255);
   if (speed_divider < 5)
     speed_divider = 5;
 
-  int cycle = led_count + tail_length;
-  int step  = (effect_counter * 100 / speed_divider) % cycle;
+  int cycle = ctx->count + tail_length;
+  int step  = (ctx->frame * 100 / speed_divider) % cycle;
 
   for (int m = 0; m < meteor_count; m++) {
     int offset    = (m * cycle) / meteor_count;
     int head_pos  = (step + offset) % cycle;
-    uint32_t pick = esp_random() % 3;
+    uint32_t pick = random_below(ctx, 3);
     rgb_t meteor_color;
     if (pick == 0) {
-      meteor_color = color_to_rgb(current_config.color1);
+      meteor_color = color_to_rgb(ctx->config->color1);
     } else if (pick == 1) {
-      meteor_color = color_to_rgb_fallback(current_config.color2, current_config.color1);
+      meteor_color = color_to_rgb_fallback(ctx->config->color2, ctx->config->color1);
     } else {
-      meteor_color = color_to_rgb_fallback(current_config.color3, current_config.color1);
+      meteor_color = color_to_rgb_fallback(ctx->config->color3, ctx->config->color1);
     }
 
     for (int t = 0; t < tail_length; t++) {
@@ -1072,236 +1444,237 @@ static void effect_meteor_shower(void) {
       if (pos < 0) {
         pos += cycle;
       }
-      if (pos >= led_count) {
+      if (pos >= ctx->count) {
         continue; // portion hors du ruban visible
       }
 
-      int idx                  = current_config.reverse ? (led_count - 1 - pos) : pos;
 
-      uint8_t trail_brightness = (uint8_t)((current_config.brightness * (tail_length - t)) / tail_length);
+      uint8_t trail_brightness = (uint8_t)((ctx->config->brightness * (tail_length - t)) / tail_length);
       rgb_t color              = apply_brightness(meteor_color, trail_brightness);
-      leds[idx]                = rgb_max(leds[idx], color);
+      *led_at(ctx, pos)        = rgb_max(*led_at(ctx, pos), color);
     }
   }
 }
 
 // Effect: Concentric wave propagating from center
-static void effect_ripple_wave(void) {
-  fill_solid((rgb_t){0, 0, 0});
+static void effect_ripple_wave(effect_ctx_t *ctx) {
+  fill_solid(ctx, (rgb_t){0, 0, 0});
 
-  if (led_count == 0) {
+  if (ctx->count == 0) {
     return;
   }
 
-  float center     = (led_count - 1) / 2.0f;
-  float max_radius = center;
-  float thickness  = (float)led_count / 12.0f + 1.5f;
-  if (thickness < 2.0f)
-    thickness = 2.0f;
+  // Distances in Q8 LEDs
+  int32_t center     = (ctx->count - 1) * 128;
+  int32_t max_radius = center;
+  int32_t thickness  = ctx->count * 256 / 12 + 384;
+  if (thickness < 512)
+    thickness = 512;
 
-  float speed_factor = (current_config.speed + 10) / 12.0f;
-  float radius       = fmodf(effect_counter * speed_factor, max_radius + thickness);
-  if (current_config.reverse) {
+  // Radius moves (speed + 10) / 12 LEDs per frame (Q16)
+  uint32_t speed_q16 = (ctx->config->speed + 10) * 65536u / 12;
+  uint64_t travel    = (uint64_t)ctx->frame * speed_q16;
+  int32_t radius     = (int32_t)((travel % ((uint64_t)(max_radius + thickness) << 8)) >> 8);
+  // Symmetric, so the view's mirror is a no-op: reverse runs the wave inward
+  if (ctx->config->reverse) {
     radius = max_radius - radius;
   }
 
-  rgb_t color1 = color_to_rgb(current_config.color1);
-  rgb_t color2 = color_to_rgb_fallback(current_config.color2, current_config.color1);
-  rgb_t color3 = color_to_rgb_fallback(current_config.color3, current_config.color1);
+  // delta * 255 / thickness and dist * 255 / max_radius as Q16 reciprocals
+  uint32_t inv_thickness = (255u << 16) / thickness;
+  uint32_t inv_radius    = max_radius > 0 ? (255u << 16) / max_radius : 0;
 
-  for (int i = 0; i < led_count; i++) {
-    float dist  = fabsf((float)i - center);
-    float delta = fabsf(dist - radius);
+  rgb_t color1           = color_to_rgb(ctx->config->color1);
+  rgb_t color2           = color_to_rgb_fallback(ctx->config->color2, ctx->config->color1);
+  rgb_t color3           = color_to_rgb_fallback(ctx->config->color3, ctx->config->color1);
+
+  for (int i = 0; i < ctx->count; i++) {
+    int32_t dist  = abs(i * 256 - center);
+    int32_t delta = abs(dist - radius);
     if (delta > thickness) {
       continue;
     }
 
-    float intensity       = 1.0f - (delta / thickness);
-    uint8_t px_brightness = (uint8_t)(current_config.brightness * intensity);
-    float color_t         = (max_radius > 0.0f) ? (dist / max_radius) : 0.0f;
-    rgb_t color           = rgb_lerp3(color1, color2, color3, color_t);
-    int target_idx        = current_config.reverse ? (led_count - 1 - i) : i;
-    leds[target_idx]      = apply_brightness(color, px_brightness);
+    uint8_t intensity     = 255 - (uint8_t)(((uint32_t)delta * inv_thickness) >> 16);
+    uint8_t px_brightness = fixed_scale8(ctx->config->brightness, intensity);
+    uint8_t color_t       = (uint8_t)(((uint32_t)dist * inv_radius) >> 16);
+    rgb_t color           = rgb_lerp3_q8(color1, color2, color3, color_t);
+    *led_at(ctx, i)       = apply_brightness(color, px_brightness);
   }
 }
 
 // Effect: Slow breathing double gradient
-static void effect_dual_gradient(void) {
-  if (led_count == 0) {
+static void effect_dual_gradient(effect_ctx_t *ctx) {
+  if (ctx->count == 0) {
     return;
   }
 
-  float period            = 400.0f + (255 - current_config.speed) * 3.0f; // speed modulates the breathing
-  float phase             = fmodf(effect_counter, period) / period;       // 0-1
+  float period            = 400.0f + (255 - ctx->config->speed) * 3.0f; // speed modulates the breathing
+  float phase             = fmodf(ctx->frame, period) / period;         // 0-1
   float blend             = phase < 0.5f ? (phase * 2.0f) : (2.0f - phase * 2.0f);
 
-  rgb_t color1            = color_to_rgb(current_config.color1);
-  rgb_t color2            = color_to_rgb_fallback(current_config.color2, current_config.color1);
-  rgb_t color3            = color_to_rgb_fallback(current_config.color3, current_config.color1);
+  rgb_t color1            = color_to_rgb(ctx->config->color1);
+  rgb_t color2            = color_to_rgb_fallback(ctx->config->color2, ctx->config->color1);
+  rgb_t color3            = color_to_rgb_fallback(ctx->config->color3, ctx->config->color1);
 
   float breath            = 0.6f + 0.4f * (1.0f - fabsf(blend - 0.5f) * 2.0f);
-  uint8_t base_brightness = (uint8_t)(current_config.brightness * breath);
+  uint8_t base_brightness = (uint8_t)(ctx->config->brightness * breath);
 
-  int denom               = (led_count > 1) ? (led_count - 1) : 1;
-  for (int i = 0; i < led_count; i++) {
-    float pos    = (float)i / denom;
-    rgb_t grad_a = rgb_lerp(color1, color2, pos);
-    rgb_t grad_b = rgb_lerp(color2, color3, pos);
-    rgb_t color  = rgb_lerp(grad_a, grad_b, blend);
-    int idx      = current_config.reverse ? (led_count - 1 - i) : i;
-    leds[idx]    = apply_brightness(color, base_brightness);
+  int denom               = (ctx->count > 1) ? (ctx->count - 1) : 1;
+  for (int i = 0; i < ctx->count; i++) {
+    float pos       = (float)i / denom;
+    rgb_t grad_a    = rgb_lerp(color1, color2, pos);
+    rgb_t grad_b    = rgb_lerp(color2, color3, pos);
+    rgb_t color     = rgb_lerp(grad_a, grad_b, blend);
+    *led_at(ctx, i) = apply_brightness(color, base_brightness);
   }
 }
 
 // Effect: Subtle background + short sparkles
-static void effect_sparkle_overlay(void) {
-  if (led_count == 0) {
+static void effect_sparkle_overlay(effect_ctx_t *ctx) {
+  if (ctx->count == 0) {
     return;
   }
 
   // Fast fade to keep sparkles short
-  for (int i = 0; i < led_count; i++) {
-    leds[i].r = (leds[i].r * 92) / 100;
-    leds[i].g = (leds[i].g * 92) / 100;
-    leds[i].b = (leds[i].b * 92) / 100;
-  }
+  fade_all(ctx, 92);
 
-  rgb_t base_color   = color_to_rgb(current_config.color1);
-  rgb_t base_applied = apply_brightness(base_color, current_config.brightness / 4);
-  for (int i = 0; i < led_count; i++) {
-    leds[i] = rgb_max(leds[i], base_applied);
+  rgb_t base_color   = color_to_rgb(ctx->config->color1);
+  rgb_t base_applied = apply_brightness(base_color, ctx->config->brightness / 4);
+  for (int i = 0; i < ctx->count; i++) {
+    *led_at(ctx, i) = rgb_max(*led_at(ctx, i), base_applied);
   }
 
-  int sparkle_slots    = 1 + (current_config.speed / 128);
-  uint8_t spawn_chance = (uint8_t)(4 + current_config.speed / 10); // %
+  int sparkle_slots    = 1 + (ctx->config->speed / 128);
+  uint8_t spawn_chance = (uint8_t)(4 + ctx->config->speed / 10); // %
   if (spawn_chance > 90)
     spawn_chance = 90;
 
   for (int s = 0; s < sparkle_slots; s++) {
-    if ((esp_random() % 100) < spawn_chance) {
-      int idx             = esp_random() % led_count;
-      uint32_t pick       = esp_random() % 2;
-      rgb_t sparkle_color = (pick == 0) ? color_to_rgb_fallback(current_config.color2, current_config.color1) : color_to_rgb_fallback(current_config.color3, current_config.color1);
-      rgb_t applied       = apply_brightness(sparkle_color, current_config.brightness);
-      leds[idx]           = rgb_max(leds[idx], applied);
+    if (chance_per_period(ctx, spawn_chance, 100)) {
+      int idx             = random_below(ctx, ctx->count);
+      uint32_t pick       = random_below(ctx, 2);
+      rgb_t sparkle_color = (pick == 0) ? color_to_rgb_fallback(ctx->config->color2, ctx->config->color1) : color_to_rgb_fallback(ctx->config->color3, ctx->config->color1);
+      rgb_t applied       = apply_brightness(sparkle_color, ctx->config->brightness);
+      *led_at(ctx, idx)   = rgb_max(*led_at(ctx, idx), applied);
     }
   }
 }
 
 // Effect: Double scan center <-> edges (reverse = edges -> center)
-static void effect_center_out_scan(void) {
-  fill_solid((rgb_t){0, 0, 0});
+static void effect_center_out_scan(effect_ctx_t *ctx) {
+  fill_solid(ctx, (rgb_t){0, 0, 0});
 
-  if (led_count == 0) {
+  if (ctx->count == 0) {
     return;
   }
 
-  int half          = led_count / 2;
-  bool has_center   = (led_count % 2) != 0;
-  int speed_divider = 256 - current_config.speed;
+  int half          = ctx->count / 2;
+  bool has_center   = (ctx->count % 2) != 0;
+  int speed_divider = 256 - ctx->config->speed;
   if (speed_divider < 10)
     speed_divider = 10;
 
   int max_pos = half;
-  int pos     = (effect_counter * 100 / speed_divider) % (max_pos + 1);
+  int pos     = (ctx->frame * 100 / speed_divider) % (max_pos + 1);
 
   int width   = 3;
   if (width > half) {
     width = (half > 0) ? half : 1;
   }
 
-  rgb_t head_color = color_to_rgb(current_config.color1);
-  rgb_t mid_color  = color_to_rgb_fallback(current_config.color2, current_config.color1);
-  rgb_t tail_color = color_to_rgb_fallback(current_config.color3, current_config.color1);
+  rgb_t head_color = color_to_rgb(ctx->config->color1);
+  rgb_t mid_color  = color_to_rgb_fallback(ctx->config->color2, ctx->config->color1);
+  rgb_t tail_color = color_to_rgb_fallback(ctx->config->color3, ctx->config->color1);
 
-  if (!current_config.reverse) {
+  if (!ctx->config->reverse) {
     // Centre -> bords
     int left_head  = half - 1 - pos;
     int right_head = has_center ? (half + pos + 1) : (half + pos);
 
     if (has_center && pos == 0) {
-      leds[half] = apply_brightness(head_color, current_config.brightness);
+      *led_at(ctx, half) = apply_brightness(head_color, ctx->config->brightness);
     }
 
-    if (left_head >= 0 && left_head < led_count) {
-      leds[left_head] = apply_brightness(head_color, current_config.brightness);
+    if (left_head >= 0 && left_head < ctx->count) {
+      *led_at(ctx, left_head) = apply_brightness(head_color, ctx->config->brightness);
     }
-    if (right_head >= 0 && right_head < led_count) {
-      leds[right_head] = apply_brightness(head_color, current_config.brightness);
+    if (right_head >= 0 && right_head < ctx->count) {
+      *led_at(ctx, right_head) = apply_brightness(head_color, ctx->config->brightness);
     }
 
     for (int t = 1; t <= width; t++) {
       rgb_t trail_color        = (t == 1) ? mid_color : tail_color;
-      uint8_t trail_brightness = (uint8_t)((current_config.brightness * (width - (t - 1))) / (width + 1));
+      uint8_t trail_brightness = (uint8_t)((ctx->config->brightness * (width - (t - 1))) / (width + 1));
 
       int l_raw                = left_head + t;
-      if (l_raw >= 0 && l_raw < led_count) {
-        leds[l_raw] = apply_brightness(trail_color, trail_brightness);
+      if (l_raw >= 0 && l_raw < ctx->count) {
+        *led_at(ctx, l_raw) = apply_brightness(trail_color, trail_brightness);
       }
 
       int r_raw = right_head - t;
-      if (r_raw >= 0 && r_raw < led_count) {
-        leds[r_raw] = apply_brightness(trail_color, trail_brightness);
+      if (r_raw >= 0 && r_raw < ctx->count) {
+        *led_at(ctx, r_raw) = apply_brightness(trail_color, trail_brightness);
       }
     }
   } else {
     // Bords -> centre
     int left_head  = pos;
-    int right_head = led_count - 1 - pos;
+    int right_head = ctx->count - 1 - pos;
 
     // Light the center when the heads meet
     if (has_center && pos >= half) {
-      leds[half] = apply_brightness(head_color, current_config.brightness);
+      *led_at(ctx, half) = apply_brightness(head_color, ctx->config->brightness);
     } else if (!has_center && pos >= (half - 1)) {
       int c1 = half - 1;
       int c2 = half;
-      if (c1 >= 0 && c1 < led_count) {
-        leds[c1] = apply_brightness(head_color, current_config.brightness);
+      if (c1 >= 0 && c1 < ctx->count) {
+        *led_at(ctx, c1) = apply_brightness(head_color, ctx->config->brightness);
       }
-      if (c2 >= 0 && c2 < led_count) {
-        leds[c2] = apply_brightness(head_color, current_config.brightness);
+      if (c2 >= 0 && c2 < ctx->count) {
+        *led_at(ctx, c2) = apply_brightness(head_color, ctx->config->brightness);
       }
     }
 
-    if (left_head >= 0 && left_head < led_count) {
-      leds[left_head] = apply_brightness(head_color, current_config.brightness);
+    if (left_head >= 0 && left_head < ctx->count) {
+      *led_at(ctx, left_head) = apply_brightness(head_color, ctx->config->brightness);
     }
-    if (right_head >= 0 && right_head < led_count) {
-      leds[right_head] = apply_brightness(head_color, current_config.brightness);
+    if (right_head >= 0 && right_head < ctx->count) {
+      *led_at(ctx, right_head) = apply_brightness(head_color, ctx->config->brightness);
     }
 
     for (int t = 1; t <= width; t++) {
       rgb_t trail_color        = (t == 1) ? mid_color : tail_color;
-      uint8_t trail_brightness = (uint8_t)((current_config.brightness * (width - (t - 1))) / (width + 1));
+      uint8_t trail_brightness = (uint8_t)((ctx->config->brightness * (width - (t - 1))) / (width + 1));
 
       int l_raw                = left_head + t;
-      if (l_raw >= 0 && l_raw < led_count && l_raw <= right_head) {
-        leds[l_raw] = apply_brightness(trail_color, trail_brightness);
+      if (l_raw >= 0 && l_raw < ctx->count && l_raw <= right_head) {
+        *led_at(ctx, l_raw) = apply_brightness(trail_color, trail_brightness);
       }
 
       int r_raw = right_head - t;
-      if (r_raw >= 0 && r_raw < led_count && r_raw >= left_head) {
-        leds[r_raw] = apply_brightness(trail_color, trail_brightness);
+      if (r_raw >= 0 && r_raw < ctx->count && r_raw >= left_head) {
+        *led_at(ctx, r_raw) = apply_brightness(trail_color, trail_brightness);
       }
     }
   }
 }
 
 // Effect: Sequential fade (modern turn signal style)
-static void effect_sequential_fade(void) {
-  rgb_t base_color = color_to_rgb(current_config.color1);
+static void effect_sequential_fade(effect_ctx_t *ctx) {
+  rgb_t base_color = color_to_rgb(ctx->config->color1);
 
-  if (led_count <= 0) {
-    fill_solid((rgb_t){0, 0, 0});
+  if (ctx->count <= 0) {
+    fill_solid(ctx, (rgb_t){0, 0, 0});
     return;
   }
 
   // Period calculation based on speed (faster speed = shorter period)
-  int period = 120 - ((current_config.speed * 100) / 255);
+  int period = 120 - ((ctx->config->speed * 100) / 255);
   if (period < 20)
     period = 20;
 
-  int cycle             = effect_counter % period;
+  int cycle             = ctx->frame % period;
 
   // Phase durations
   int fade_in_duration  = (period * 50) / 100; // 50% of period for sequential fade in
@@ -1309,15 +1682,14 @@ static void effect_sequential_fade(void) {
   int fade_out_duration = (period * 20) / 100; // 20% for fade out
   // Rest is pause (not used directly, implicit in cycle logic)
 
-  fill_solid((rgb_t){0, 0, 0});
+  fill_solid(ctx, (rgb_t){0, 0, 0});
 
   if (cycle < fade_in_duration) {
     // Phase 1: Sequential fade in
-    for (int i = 0; i < led_count; i++) {
-      int led_index         = current_config.reverse ? (led_count - 1 - i) : i;
+    for (int i = 0; i < ctx->count; i++) {
 
       // Calculate when this LED should start fading in
-      int led_start_time    = (i * fade_in_duration) / led_count;
+      int led_start_time    = (i * fade_in_duration) / ctx->count;
 
       // Fade in takes a portion of the total fade_in_duration
       int led_fade_duration = fade_in_duration / 4; // Each LED fades quickly
@@ -1329,60 +1701,55 @@ static void effect_sequential_fade(void) {
         if (elapsed < led_fade_duration) {
           // Fading in
           float fade_progress = (float)elapsed / led_fade_duration;
-          uint8_t brightness  = (uint8_t)(current_config.brightness * fade_progress);
-          leds[led_index]     = apply_brightness(base_color, brightness);
+          uint8_t brightness  = (uint8_t)(ctx->config->brightness * fade_progress);
+          *led_at(ctx, i)     = apply_brightness(base_color, brightness);
         } else {
           // Fully lit
-          leds[led_index] = apply_brightness(base_color, current_config.brightness);
+          *led_at(ctx, i) = apply_brightness(base_color, ctx->config->brightness);
         }
       }
     }
   } else if (cycle < fade_in_duration + hold_duration) {
     // Phase 2: Hold all LEDs lit
-    for (int i = 0; i < led_count; i++) {
-      leds[i] = apply_brightness(base_color, current_config.brightness);
+    for (int i = 0; i < ctx->count; i++) {
+      *led_at(ctx, i) = apply_brightness(base_color, ctx->config->brightness);
     }
   } else if (cycle < fade_in_duration + hold_duration + fade_out_duration) {
     // Phase 3: Fade out all together
     int fade_cycle      = cycle - (fade_in_duration + hold_duration);
     float fade_progress = 1.0f - ((float)fade_cycle / fade_out_duration);
-    uint8_t brightness  = (uint8_t)(current_config.brightness * fade_progress);
+    uint8_t brightness  = (uint8_t)(ctx->config->brightness * fade_progress);
 
-    for (int i = 0; i < led_count; i++) {
-      leds[i] = apply_brightness(base_color, brightness);
+    for (int i = 0; i < ctx->count; i++) {
+      *led_at(ctx, i) = apply_brightness(base_color, brightness);
     }
   }
   // Phase 4: Pause (LEDs stay off)
 }
 
 // Effect: Brake lights
-static void effect_brake_light(void) {
+static void effect_brake_light(effect_ctx_t *ctx) {
   rgb_t color = last_vehicle_state.brake_pressed ? (rgb_t){255, 0, 0} : (rgb_t){64, 0, 0};
-  color       = apply_brightness(color, current_config.brightness);
-  fill_solid(color);
+  color       = apply_brightness(color, ctx->config->brightness);
+  fill_solid(ctx, color);
 }
 
-// Effect: Charge state
-static uint8_t simulated_charge = 0; // Simulated charge level (0-100)
-
-static void effect_charge_status(void) {
+// Effect: Charge state (state: float animation position)
+static void effect_charge_status(effect_ctx_t *ctx) {
+  float *anim_position     = ctx->state;
   // Simuler l'augmentation progressive de la charge
-  // Increase ULTRA slowly up to 100%, then restart
-  if (effect_counter % 50 == 0) { // Update every 50 frames (10x slower)
-    simulated_charge++;
-    if (simulated_charge > 100)
-      simulated_charge = 0;
-  }
+  // Increase ULTRA slowly up to 100% (+1 every 50 frames), then restart
+  uint8_t simulated_charge = (uint8_t)((ctx->frame / 50) % 101);
 
   // Use the simulated or real charge level
-  uint8_t charge_level = last_vehicle_state.charging ? last_vehicle_state.soc_percent : simulated_charge;
+  uint8_t charge_level     = last_vehicle_state.charging ? last_vehicle_state.soc_percent : simulated_charge;
 
-  int target_led       = (led_count * charge_level) / 100;
-  if (target_led >= led_count)
-    target_led = led_count - 1;
+  int target_led           = (ctx->count * charge_level) / 100;
+  if (target_led >= ctx->count)
+    target_led = ctx->count - 1;
 
   // Clear all
-  fill_solid((rgb_t){0, 0, 0});
+  fill_solid(ctx, (rgb_t){0, 0, 0});
 
   // Display charge bar (static) with color based on level
   for (int i = 0; i < target_led; i++) {
@@ -1402,8 +1769,7 @@ static void effect_charge_status(void) {
       color = (rgb_t){0, 255, 0};
     }
 
-    int led_index   = current_config.reverse ? (led_count - 1 - i) : i;
-    leds[led_index] = apply_brightness(color, current_config.brightness);
+    *led_at(ctx, i) = apply_brightness(color, ctx->config->brightness);
   }
 
   // Animated pixel coming from the end (smooth stacking)
@@ -1430,67 +1796,65 @@ static void effect_charge_status(void) {
     // Simulation mode: speed based on the speed parameter
     // speed 0 -> 0.017 px/frame (slow)
     // speed 255 -> 1.0 px/frame (fast)
-    speed_factor = 0.017f + (current_config.speed / 255.0f) * 0.983f;
+    speed_factor = 0.017f + (ctx->config->speed / 255.0f) * 0.983f;
   }
 
-  // Pixel position: starts at end (led_count-1) and goes to 0
+  // Pixel position: starts at end (ctx->count-1) and goes to 0
   // Full cycle: from end to charge level + trail length
   // This lets the entire trail be "consumed" before restarting
   const int TRAIL_LENGTH = 5;
-  int cycle_length       = led_count - target_led + TRAIL_LENGTH;
+  int cycle_length       = ctx->count - target_led + TRAIL_LENGTH;
 
   if (cycle_length > TRAIL_LENGTH) {
     // Increment the position accumulator smoothly
-    charge_anim_position += speed_factor;
+    *anim_position += speed_factor * ctx->dt_ms / LED_EFFECT_FRAME_MS;
 
     // Reset the accumulator when the cycle ends
-    if (charge_anim_position >= (float)cycle_length) {
-      charge_anim_position -= (float)cycle_length;
+    if (*anim_position >= (float)cycle_length) {
+      *anim_position -= (float)cycle_length;
     }
 
     // Current pixel position (convert to integer for display)
-    int anim_pos         = (int)charge_anim_position;
-    // Calculate pixel position based on direction
-    int moving_pixel_pos = current_config.reverse ? anim_pos : (led_count - 1 - anim_pos);
+    int anim_pos         = (int)*anim_position;
+    int moving_pixel_pos = ctx->count - 1 - anim_pos;
 
     // Extract the RGB components of the configured color
-    rgb_t trail_color    = color_to_rgb(current_config.color1);
+    rgb_t trail_color    = color_to_rgb(ctx->config->color1);
 
     // Bright main pixel (configured color)
     // Display only if in visible zone
-    if (moving_pixel_pos >= 0 && moving_pixel_pos < led_count) {
-      leds[moving_pixel_pos] = apply_brightness(trail_color, current_config.brightness);
+    if (moving_pixel_pos >= 0 && moving_pixel_pos < ctx->count) {
+      *led_at(ctx, moving_pixel_pos) = apply_brightness(trail_color, ctx->config->brightness);
     }
 
     // Same-color trail behind the pixel (8 pixels for the trail
     // longue et fluide)
     for (int trail = 1; trail <= TRAIL_LENGTH; trail++) {
-      // Trail direction based on reverse
-      int trail_pos        = current_config.reverse ? (moving_pixel_pos - trail) : (moving_pixel_pos + trail);
+      int trail_pos        = moving_pixel_pos + trail;
 
       // Display trail only if:
-      // 1. It is in visible zone (< led_count)
+      // 1. It is in visible zone (< ctx->count)
       // 2. It has not yet been "consumed" by the charge bar
-      bool in_visible_zone = current_config.reverse ? (trail_pos >= 0 && trail_pos < target_led) : (trail_pos >= target_led && trail_pos < led_count);
+      bool in_visible_zone = trail_pos >= target_led && trail_pos < ctx->count;
 
       if (in_visible_zone) {
         // Aggressive exponential decay for a visible trail
         // trail 1 = 80% (204), trail 2 = 60% (153), trail 3 = 40% (102), trail
         // 4 = 25% (64), trail 5 = 10% (25)
-        uint8_t fade_factor = 255 - (trail * trail * trail * 255) / 125;
+        uint8_t fade_factor     = 255 - (trail * trail * trail * 255) / 125;
 
         // Apply the colored trail with progressive fade
         // Reduce the intensity of each RGB component according to fade_factor
-        rgb_t faded_color   = {(trail_color.r * fade_factor) / 255, (trail_color.g * fade_factor) / 255, (trail_color.b * fade_factor) / 255};
+        rgb_t faded_color       = {(trail_color.r * fade_factor) / 255, (trail_color.g * fade_factor) / 255, (trail_color.b * fade_factor) / 255};
 
-        leds[trail_pos]     = apply_brightness(faded_color, current_config.brightness);
+        *led_at(ctx, trail_pos) = apply_brightness(faded_color, ctx->config->brightness);
       }
     }
   }
 }
 
 // Effect: Power meter (combined front + rear)
-static void effect_power_meter(void) {
+static void effect_power_meter(effect_ctx_t *ctx) {
   const float fallback_max_power = 200.0f;
   float rear_power               = last_vehicle_state.rear_power;
   float front_power              = last_vehicle_state.front_power;
@@ -1522,34 +1886,34 @@ static void effect_power_meter(void) {
     percent = 1.0f;
   }
 
-  int lit_leds = (int)floorf(percent * led_count + 1e-4f);
+  int lit_leds = (int)floorf(percent * ctx->count + 1e-4f);
   if (percent > 0.0f && lit_leds == 0) {
     lit_leds = 1;
   }
-  if (lit_leds > led_count) {
-    lit_leds = led_count;
+  if (lit_leds > ctx->count) {
+    lit_leds = ctx->count;
   }
 
+  // Regen fills from the other end
   bool is_negative = (total_power < 0.0f);
-  bool reverse_dir = current_config.reverse ^ is_negative;
 
-  rgb_t pos_color  = color_to_rgb(current_config.color1);
-  rgb_t neg_color  = color_to_rgb(current_config.color2);
-  pos_color        = apply_brightness(pos_color, current_config.brightness);
-  neg_color        = apply_brightness(neg_color, current_config.brightness);
+  rgb_t pos_color  = color_to_rgb(ctx->config->color1);
+  rgb_t neg_color  = color_to_rgb(ctx->config->color2);
+  pos_color        = apply_brightness(pos_color, ctx->config->brightness);
+  neg_color        = apply_brightness(neg_color, ctx->config->brightness);
 
-  for (int i = 0; i < led_count; i++) {
-    int led_index = reverse_dir ? (led_count - 1 - i) : i;
+  for (int i = 0; i < ctx->count; i++) {
+    int led_index = is_negative ? (ctx->count - 1 - i) : i;
     if (i < lit_leds) {
-      leds[led_index] = is_negative ? neg_color : pos_color;
+      *led_at(ctx, led_index) = is_negative ? neg_color : pos_color;
     } else {
-      leds[led_index] = (rgb_t){0, 0, 0};
+      *led_at(ctx, led_index) = (rgb_t){0, 0, 0};
     }
   }
 }
 
 // Effect: Power meter centered (zero in the middle)
-static void effect_power_meter_center(void) {
+static void effect_power_meter_center(effect_ctx_t *ctx) {
   const float fallback_max_power = 200.0f;
   float rear_power               = last_vehicle_state.rear_power;
   float front_power              = last_vehicle_state.front_power;
@@ -1581,7 +1945,7 @@ static void effect_power_meter_center(void) {
     percent = 1.0f;
   }
 
-  int half_len = led_count / 2;
+  int half_len = ctx->count / 2;
   int lit_side = (int)floorf(percent * half_len + 1e-4f);
   if (percent > 0.0f && lit_side == 0 && half_len > 0) {
     lit_side = 1;
@@ -1591,36 +1955,33 @@ static void effect_power_meter_center(void) {
   }
 
   bool is_negative = (total_power < 0.0f);
-  rgb_t pos_color  = color_to_rgb(current_config.color1);
-  rgb_t neg_color  = color_to_rgb(current_config.color2);
-  pos_color        = apply_brightness(pos_color, current_config.brightness);
-  neg_color        = apply_brightness(neg_color, current_config.brightness);
+  rgb_t pos_color  = color_to_rgb(ctx->config->color1);
+  rgb_t neg_color  = color_to_rgb(ctx->config->color2);
+  pos_color        = apply_brightness(pos_color, ctx->config->brightness);
+  neg_color        = apply_brightness(neg_color, ctx->config->brightness);
   rgb_t color      = is_negative ? neg_color : pos_color;
 
-  fill_solid((rgb_t){0, 0, 0});
+  fill_solid(ctx, (rgb_t){0, 0, 0});
 
-  if (led_count == 0) {
+  if (ctx->count == 0) {
     return;
   }
 
   bool use_right_side = !is_negative;
-  if (current_config.reverse) {
-    use_right_side = !use_right_side;
-  }
 
-  if (led_count % 2 == 1) {
-    int center = led_count / 2;
+  if (ctx->count % 2 == 1) {
+    int center = ctx->count / 2;
     if (percent > 0.0f) {
-      leds[center] = color;
+      *led_at(ctx, center) = color;
     }
 
     if (use_right_side) {
       for (int i = 0; i < lit_side; i++) {
         int idx = center + 1 + i;
-        if (idx >= led_count) {
+        if (idx >= ctx->count) {
           break;
         }
-        leds[idx] = color;
+        *led_at(ctx, idx) = color;
       }
     } else {
       for (int i = 0; i < lit_side; i++) {
@@ -1628,20 +1989,20 @@ static void effect_power_meter_center(void) {
         if (idx < 0) {
           break;
         }
-        leds[idx] = color;
+        *led_at(ctx, idx) = color;
       }
     }
   } else {
-    int left_center  = (led_count / 2) - 1;
-    int right_center = led_count / 2;
+    int left_center  = (ctx->count / 2) - 1;
+    int right_center = ctx->count / 2;
 
     if (use_right_side) {
       for (int i = 0; i < lit_side; i++) {
         int idx = right_center + i;
-        if (idx >= led_count) {
+        if (idx >= ctx->count) {
           break;
         }
-        leds[idx] = color;
+        *led_at(ctx, idx) = color;
       }
     } else {
       for (int i = 0; i < lit_side; i++) {
@@ -1649,14 +2010,14 @@ static void effect_power_meter_center(void) {
         if (idx < 0) {
           break;
         }
-        leds[idx] = color;
+        *led_at(ctx, idx) = color;
       }
     }
   }
 }
 
 // Effect: Vehicle sync
-static void effect_vehicle_sync(void) {
+static void effect_vehicle_sync(effect_ctx_t *ctx) {
   // Combine multiple indicators
   rgb_t base_color = {0, 0, 0};
 
@@ -1680,54 +2041,53 @@ static void effect_vehicle_sync(void) {
     base_color = (rgb_t){32, 32, 32};
   }
 
-  base_color = apply_brightness(base_color, current_config.brightness);
-  fill_solid(base_color);
+  base_color = apply_brightness(base_color, ctx->config->brightness);
+  fill_solid(ctx, base_color);
 }
 
 // Effect: Audio Reactive (VU meter)
-static void effect_audio_reactive(void) {
+static void effect_audio_reactive(effect_ctx_t *ctx) {
   audio_data_t audio_data;
   if (!audio_input_get_data(&audio_data)) {
     // No audio data, show black
-    fill_solid((rgb_t){0, 0, 0});
+    fill_solid(ctx, (rgb_t){0, 0, 0});
     return;
   }
 
   // VU meter: fill based on amplitude
-  int lit_leds = (int)(audio_data.amplitude * led_count);
-  if (lit_leds > led_count)
-    lit_leds = led_count;
+  int lit_leds = (int)(audio_data.amplitude * ctx->count);
+  if (lit_leds > ctx->count)
+    lit_leds = ctx->count;
 
-  rgb_t color1 = color_to_rgb(current_config.color1);
-  rgb_t color2 = color_to_rgb_fallback(current_config.color2, current_config.color1);
-  rgb_t color3 = color_to_rgb_fallback(current_config.color3, current_config.color1);
+  rgb_t color1 = color_to_rgb(ctx->config->color1);
+  rgb_t color2 = color_to_rgb_fallback(ctx->config->color2, ctx->config->color1);
+  rgb_t color3 = color_to_rgb_fallback(ctx->config->color3, ctx->config->color1);
 
-  for (int i = 0; i < led_count; i++) {
-    int led_index = current_config.reverse ? (led_count - 1 - i) : i;
+  for (int i = 0; i < ctx->count; i++) {
     if (i < lit_leds) {
       // Gradient color based on level
       float intensity = (float)(i + 1) / lit_leds;
       rgb_t color     = rgb_lerp3(color1, color2, color3, intensity);
-      leds[led_index] = apply_brightness(color, current_config.brightness);
+      *led_at(ctx, i) = apply_brightness(color, ctx->config->brightness);
     } else {
-      leds[led_index] = (rgb_t){0, 0, 0};
+      *led_at(ctx, i) = (rgb_t){0, 0, 0};
     }
   }
 }
 
 // Effect: Audio BPM (flash on beats)
-static void effect_audio_bpm(void) {
+static void effect_audio_bpm(effect_ctx_t *ctx) {
   audio_data_t audio_data;
   if (!audio_input_get_data(&audio_data)) {
     // No audio data, show black
-    fill_solid((rgb_t){0, 0, 0});
+    fill_solid(ctx, (rgb_t){0, 0, 0});
     return;
   }
 
-  rgb_t color1             = color_to_rgb(current_config.color1);
-  rgb_t color2             = color_to_rgb_fallback(current_config.color2, current_config.color1);
-  rgb_t color3             = color_to_rgb_fallback(current_config.color3, current_config.color1);
-  int color_index          = (effect_counter / 10) % 3;
+  rgb_t color1             = color_to_rgb(ctx->config->color1);
+  rgb_t color2             = color_to_rgb_fallback(ctx->config->color2, ctx->config->color1);
+  rgb_t color3             = color_to_rgb_fallback(ctx->config->color3, ctx->config->color1);
+  int color_index          = (ctx->frame / 10) % 3;
   rgb_t color              = (color_index == 0) ? color1 : (color_index == 1 ? color2 : color3);
 
   // If a beat was detected recently (within the last 100ms)
@@ -1740,13 +2100,13 @@ static void effect_audio_bpm(void) {
     if (decay < 0.0f)
       decay = 0.0f;
 
-    uint8_t flash_brightness = (uint8_t)(current_config.brightness * decay);
+    uint8_t flash_brightness = (uint8_t)(ctx->config->brightness * decay);
     color                    = apply_brightness(color, flash_brightness);
-    fill_solid(color);
+    fill_solid(ctx, color);
   } else {
     // Couleur faible entre les battements
-    color = apply_brightness(color, current_config.brightness / 4);
-    fill_solid(color);
+    color = apply_brightness(color, ctx->config->brightness / 4);
+    fill_solid(ctx, color);
   }
 }
 
@@ -1755,22 +2115,22 @@ static void effect_audio_bpm(void) {
 // ============================================================================
 
 // FFT effect: Full spectrum (visual equalizer)
-static void effect_fft_spectrum(void) {
+static void effect_fft_spectrum(effect_ctx_t *ctx) {
   audio_fft_data_t fft_data;
   if (!audio_input_get_fft_data(&fft_data)) {
     // FFT non disponible, afficher noir
-    fill_solid((rgb_t){0, 0, 0});
+    fill_solid(ctx, (rgb_t){0, 0, 0});
     return;
   }
 
   // Number of LEDs per band
-  int leds_per_band = led_count / AUDIO_FFT_BANDS;
+  int leds_per_band = ctx->count / AUDIO_FFT_BANDS;
   if (leds_per_band < 1)
     leds_per_band = 1;
 
-  rgb_t color1 = color_to_rgb(current_config.color1);
-  rgb_t color2 = color_to_rgb_fallback(current_config.color2, current_config.color1);
-  rgb_t color3 = color_to_rgb_fallback(current_config.color3, current_config.color1);
+  rgb_t color1 = color_to_rgb(ctx->config->color1);
+  rgb_t color2 = color_to_rgb_fallback(ctx->config->color2, ctx->config->color1);
+  rgb_t color3 = color_to_rgb_fallback(ctx->config->color3, ctx->config->color1);
 
   for (int band = 0; band < AUDIO_FFT_BANDS; band++) {
     float t          = (AUDIO_FFT_BANDS > 1) ? ((float)band / (AUDIO_FFT_BANDS - 1)) : 0.0f;
@@ -1782,33 +2142,32 @@ static void effect_fft_spectrum(void) {
       height = leds_per_band;
 
     // Light up LEDs for this band
-    for (int i = 0; i < leds_per_band && (band * leds_per_band + i) < led_count; i++) {
+    for (int i = 0; i < leds_per_band && (band * leds_per_band + i) < ctx->count; i++) {
       int pos     = band * leds_per_band + i;
-      int led_idx = current_config.reverse ? (led_count - 1 - pos) : pos;
       if (i < height) {
         // Gradient from bottom to top
         float intensity = (float)(i + 1) / height;
         rgb_t color;
-        color.r       = (uint8_t)(band_color.r * intensity);
-        color.g       = (uint8_t)(band_color.g * intensity);
-        color.b       = (uint8_t)(band_color.b * intensity);
-        leds[led_idx] = apply_brightness(color, current_config.brightness);
+        color.r           = (uint8_t)(band_color.r * intensity);
+        color.g           = (uint8_t)(band_color.g * intensity);
+        color.b           = (uint8_t)(band_color.b * intensity);
+        *led_at(ctx, pos) = apply_brightness(color, ctx->config->brightness);
       } else {
-        leds[led_idx] = (rgb_t){0, 0, 0};
+        *led_at(ctx, pos) = (rgb_t){0, 0, 0};
       }
     }
   }
 }
 
 // Effet FFT: Bass Pulse (pulse uniquement sur les kicks)
-static void effect_fft_bass_pulse(void) {
+static void effect_fft_bass_pulse(effect_ctx_t *ctx) {
   audio_fft_data_t fft_data;
   if (!audio_input_get_fft_data(&fft_data)) {
-    fill_solid((rgb_t){0, 0, 0});
+    fill_solid(ctx, (rgb_t){0, 0, 0});
     return;
   }
 
-  rgb_t color          = color_to_rgb(current_config.color1);
+  rgb_t color          = color_to_rgb(ctx->config->color1);
 
   // Pulse based on low-frequency energy
   float bass_intensity = fft_data.bass_energy;
@@ -1819,22 +2178,22 @@ static void effect_fft_bass_pulse(void) {
   }
 
   // Apply the intensity
-  uint8_t pulse_brightness = (uint8_t)(current_config.brightness * bass_intensity);
+  uint8_t pulse_brightness = (uint8_t)(ctx->config->brightness * bass_intensity);
   color                    = apply_brightness(color, pulse_brightness);
-  fill_solid(color);
+  fill_solid(ctx, color);
 }
 
 // FFT effect: Vocal Wave (voice-reactive wave)
-static void effect_fft_vocal_wave(void) {
+static void effect_fft_vocal_wave(effect_ctx_t *ctx) {
   audio_fft_data_t fft_data;
   if (!audio_input_get_fft_data(&fft_data)) {
-    fill_solid((rgb_t){0, 0, 0});
+    fill_solid(ctx, (rgb_t){0, 0, 0});
     return;
   }
 
-  rgb_t base_color  = color_to_rgb(current_config.color1);
-  rgb_t vocal_color = color_to_rgb_fallback(current_config.color2, current_config.color1);
-  rgb_t tail_color  = color_to_rgb_fallback(current_config.color3, current_config.color1);
+  rgb_t base_color  = color_to_rgb(ctx->config->color1);
+  rgb_t vocal_color = color_to_rgb_fallback(ctx->config->color2, ctx->config->color1);
+  rgb_t tail_color  = color_to_rgb_fallback(ctx->config->color3, ctx->config->color1);
 
   // Wave position based on the spectral centroid
   // The higher the centroid (treble), the further the wave moves
@@ -1844,11 +2203,10 @@ static void effect_fft_vocal_wave(void) {
   if (wave_pos > 1.0f)
     wave_pos = 1.0f;
 
-  int center = (int)(wave_pos * led_count);
+  int center = (int)(wave_pos * ctx->count);
   int width  = (int)(fft_data.mid_energy * 20.0f); // Width proportional to mid energy
 
-  for (int i = 0; i < led_count; i++) {
-    int led_index = current_config.reverse ? (led_count - 1 - i) : i;
+  for (int i = 0; i < ctx->count; i++) {
     int distance  = abs(i - center);
     if (distance < width) {
       // Gradient toward the voice
@@ -1857,36 +2215,35 @@ static void effect_fft_vocal_wave(void) {
       color.r         = (uint8_t)(vocal_color.r * (1.0f - mix) + base_color.r * mix);
       color.g         = (uint8_t)(vocal_color.g * (1.0f - mix) + base_color.g * mix);
       color.b         = (uint8_t)(vocal_color.b * (1.0f - mix) + base_color.b * mix);
-      leds[led_index] = apply_brightness(color, current_config.brightness);
+      *led_at(ctx, i) = apply_brightness(color, ctx->config->brightness);
     } else {
-      leds[led_index] = apply_brightness(tail_color, current_config.brightness / 4);
+      *led_at(ctx, i) = apply_brightness(tail_color, ctx->config->brightness / 4);
     }
   }
 }
 
 // FFT effect: Energy Bar (spectral energy bar)
-static void effect_fft_energy_bar(void) {
+static void effect_fft_energy_bar(effect_ctx_t *ctx) {
   audio_fft_data_t fft_data;
   if (!audio_input_get_fft_data(&fft_data)) {
-    fill_solid((rgb_t){0, 0, 0});
+    fill_solid(ctx, (rgb_t){0, 0, 0});
     return;
   }
 
   // Diviser le ruban en 3 sections: Bass, Mid, Treble
-  int section_size   = led_count / 3;
+  int section_size   = ctx->count / 3;
 
-  rgb_t bass_color   = color_to_rgb(current_config.color1);
-  rgb_t mid_color    = color_to_rgb_fallback(current_config.color2, current_config.color1);
-  rgb_t treble_color = color_to_rgb_fallback(current_config.color3, current_config.color1);
+  rgb_t bass_color   = color_to_rgb(ctx->config->color1);
+  rgb_t mid_color    = color_to_rgb_fallback(ctx->config->color2, ctx->config->color1);
+  rgb_t treble_color = color_to_rgb_fallback(ctx->config->color3, ctx->config->color1);
 
   // Section Bass
   int bass_leds      = (int)(fft_data.bass_energy * section_size);
   for (int i = 0; i < section_size; i++) {
-    int led_index = current_config.reverse ? (led_count - 1 - i) : i;
     if (i < bass_leds) {
-      leds[led_index] = apply_brightness(bass_color, current_config.brightness);
+      *led_at(ctx, i) = apply_brightness(bass_color, ctx->config->brightness);
     } else {
-      leds[led_index] = (rgb_t){0, 0, 0};
+      *led_at(ctx, i) = (rgb_t){0, 0, 0};
     }
   }
 
@@ -1894,11 +2251,10 @@ static void effect_fft_energy_bar(void) {
   int mid_leds = (int)(fft_data.mid_energy * section_size);
   for (int i = 0; i < section_size; i++) {
     int pos     = section_size + i;
-    int led_idx = current_config.reverse ? (led_count - 1 - pos) : pos;
-    if (i < mid_leds && pos < led_count) {
-      leds[led_idx] = apply_brightness(mid_color, current_config.brightness);
-    } else if (pos < led_count) {
-      leds[led_idx] = (rgb_t){0, 0, 0};
+    if (i < mid_leds && pos < ctx->count) {
+      *led_at(ctx, pos) = apply_brightness(mid_color, ctx->config->brightness);
+    } else if (pos < ctx->count) {
+      *led_at(ctx, pos) = (rgb_t){0, 0, 0};
     }
   }
 
@@ -1906,79 +2262,71 @@ static void effect_fft_energy_bar(void) {
   int treble_leds = (int)(fft_data.treble_energy * section_size);
   for (int i = 0; i < section_size; i++) {
     int pos     = section_size * 2 + i;
-    int led_idx = current_config.reverse ? (led_count - 1 - pos) : pos;
-    if (i < treble_leds && pos < led_count) {
-      leds[led_idx] = apply_brightness(treble_color, current_config.brightness);
-    } else if (pos < led_count) {
-      leds[led_idx] = (rgb_t){0, 0, 0};
+    if (i < treble_leds && pos < ctx->count) {
+      *led_at(ctx, pos) = apply_brightness(treble_color, ctx->config->brightness);
+    } else if (pos < ctx->count) {
+      *led_at(ctx, pos) = (rgb_t){0, 0, 0};
     }
   }
 }
 
 // Effect: Wave Collision - Two waves collide at center
-static void effect_wave_collision(void) {
-  if (led_count == 0) {
+static void effect_wave_collision(effect_ctx_t *ctx) {
+  if (ctx->count == 0) {
     return;
   }
 
-  float speed_factor = current_config.speed / 100.0f;
+  float speed_factor = ctx->config->speed / 100.0f;
   if (speed_factor < 0.1f)
     speed_factor = 0.1f;
 
-  rgb_t color1     = color_to_rgb(current_config.color1);
-  rgb_t color2     = color_to_rgb_fallback(current_config.color2, 0x00FF00);
-  rgb_t color3     = color_to_rgb_fallback(current_config.color3, 0xFFFFFF);
+  rgb_t color1        = color_to_rgb(ctx->config->color1);
+  rgb_t color2        = color_to_rgb_fallback(ctx->config->color2, 0x00FF00);
+  rgb_t color3        = color_to_rgb_fallback(ctx->config->color3, 0xFFFFFF);
 
-  int half_strip   = led_count / 2;
-  float t          = effect_counter * speed_factor * 0.05f;
+  int half_strip      = ctx->count / 2;
+  // 1 / half_strip in Q16, scaled to 255
+  uint32_t inv_half   = half_strip > 0 ? (255u << 16) / half_strip : 0;
 
-  // Wave parameters
-  float wavelength = led_count / 4.0f;
-  float wave_speed = 2.0f;
+  // Waves travel at t * wave_speed, t = frame * speed_factor * 0.05 and wave_speed = 2,
+  // with a wavelength of count / 4 radians over the strip: a quarter radian per LED
+  uint32_t wave_phase = ctx->frame * fixed_phase_from_radians(speed_factor * 0.1f);
+  uint32_t led_step   = fixed_phase_from_radians(0.25f);
+  uint32_t left_wave  = 0u - wave_phase;
+  uint32_t right_wave = ctx->count * led_step - wave_phase;
 
-  for (int i = 0; i < led_count; i++) {
-    float pos            = i / (float)led_count;
-
-    // Left wave (moving right)
-    float left_wave_pos  = (pos * wavelength - t * wave_speed);
-    float left_intensity = (sinf(left_wave_pos) + 1.0f) * 0.5f;
+  // Pulsing collision effect
+  uint8_t pulse       = fixed_sin8((wave_phase * 2) >> 16);
 
-    // Only show left wave on left half
+  for (int i = 0; i < ctx->count; i++) {
+    // Left wave (moving right), only on the left half, fading out towards the center
+    uint8_t left_intensity = 0;
     if (i < half_strip) {
-      // Fade out as it approaches center
-      float distance_factor = 1.0f - (i / (float)half_strip);
-      left_intensity *= distance_factor;
-    } else {
-      left_intensity = 0.0f;
+      uint8_t distance_factor = 255 - (uint8_t)(((uint32_t)i * inv_half) >> 16);
+      left_intensity          = fixed_scale8(fixed_sin8(left_wave >> 16), distance_factor);
     }
 
-    // Right wave (moving left)
-    float right_wave_pos  = ((1.0f - pos) * wavelength - t * wave_speed);
-    float right_intensity = (sinf(right_wave_pos) + 1.0f) * 0.5f;
-
-    // Only show right wave on right half
+    // Right wave (moving left), only on the right half, fading in from the center
+    uint8_t right_intensity = 0;
     if (i >= half_strip) {
-      // Fade out as it approaches center
-      float distance_factor = (i - half_strip) / (float)half_strip;
-      right_intensity *= distance_factor;
-    } else {
-      right_intensity = 0.0f;
+      uint32_t distance_factor = ((uint32_t)(i - half_strip) * inv_half) >> 16;
+      right_intensity          = fixed_scale8(fixed_sin8(right_wave >> 16), distance_factor > 255 ? 255 : distance_factor);
     }
 
-    // Collision energy at center
-    float center_dist         = fabsf((float)(i - half_strip)) / (float)half_strip;
-    float collision_intensity = 0.0f;
+    left_wave += led_step;
+    right_wave -= led_step;
 
-    if (center_dist < 0.2f) {
-      // Pulsing collision effect
-      float collision_pulse = (sinf(t * wave_speed * 2.0f) + 1.0f) * 0.5f;
-      collision_intensity   = (1.0f - center_dist / 0.2f) * collision_pulse;
+    // Collision energy at center (within a fifth of the half strip)
+    uint32_t center_dist        = abs(i - half_strip);
+    uint8_t collision_intensity = 0;
+    if (center_dist * 5 < (uint32_t)half_strip) {
+      collision_intensity = fixed_scale8(pulse, 255 - (uint8_t)((center_dist * 5 * inv_half) >> 16));
     }
 
-    // Combine all intensities
-    rgb_t left_contrib      = apply_brightness(color1, (uint8_t)(current_config.brightness * left_intensity));
-    rgb_t right_contrib     = apply_brightness(color2, (uint8_t)(current_config.brightness * right_intensity));
-    rgb_t collision_contrib = apply_brightness(color3, (uint8_t)(current_config.brightness * collision_intensity * 0.7f));
+    // Combine all intensities (collision at 70%)
+    rgb_t left_contrib      = apply_brightness(color1, fixed_scale8(ctx->config->brightness, left_intensity));
+    rgb_t right_contrib     = apply_brightness(color2, fixed_scale8(ctx->config->brightness, right_intensity));
+    rgb_t collision_contrib = apply_brightness(color3, fixed_scale8(ctx->config->brightness, fixed_scale8(collision_intensity, 179)));
 
     // Mix colors with saturation
     uint16_t r_sum          = (uint16_t)left_contrib.r + (uint16_t)right_contrib.r + (uint16_t)collision_contrib.r;
@@ -1986,29 +2334,28 @@ static void effect_wave_collision(void) {
     uint16_t b_sum          = (uint16_t)left_contrib.b + (uint16_t)right_contrib.b + (uint16_t)collision_contrib.b;
 
     rgb_t final_color;
-    final_color.r = (r_sum > 255) ? 255 : (uint8_t)r_sum;
-    final_color.g = (g_sum > 255) ? 255 : (uint8_t)g_sum;
-    final_color.b = (b_sum > 255) ? 255 : (uint8_t)b_sum;
+    final_color.r   = (r_sum > 255) ? 255 : (uint8_t)r_sum;
+    final_color.g   = (g_sum > 255) ? 255 : (uint8_t)g_sum;
+    final_color.b   = (b_sum > 255) ? 255 : (uint8_t)b_sum;
 
-    int idx       = current_config.reverse ? (led_count - 1 - i) : i;
-    leds[idx]     = final_color;
+    *led_at(ctx, i) = final_color;
   }
 }
 
 // Effect: Snake Chase - Multiple colored segments chasing
-static void effect_snake_chase(void) {
-  fill_solid((rgb_t){0, 0, 0});
+static void effect_snake_chase(effect_ctx_t *ctx) {
+  fill_solid(ctx, (rgb_t){0, 0, 0});
 
-  if (led_count == 0) {
+  if (ctx->count == 0) {
     return;
   }
 
-  int speed_divider = 256 - current_config.speed;
+  int speed_divider = 256 - ctx->config->speed;
   if (speed_divider < 10)
     speed_divider = 10;
 
   int snake_count  = 3;
-  int snake_length = led_count / 10;
+  int snake_length = ctx->count / 10;
   if (snake_length < 3)
     snake_length = 3;
   if (snake_length > 15)
@@ -2016,55 +2363,66 @@ static void effect_snake_chase(void) {
 
   int gap         = 5;
   int cycle       = (snake_length + gap) * snake_count;
-  int step        = (effect_counter * 100 / speed_divider) % cycle;
+  int step        = (ctx->frame * 100 / speed_divider) % cycle;
 
-  rgb_t colors[3] = {color_to_rgb(current_config.color1), color_to_rgb_fallback(current_config.color2, 0x00FF00), color_to_rgb_fallback(current_config.color3, 0x0000FF)};
+  rgb_t colors[3] = {color_to_rgb(ctx->config->color1), color_to_rgb_fallback(ctx->config->color2, 0x00FF00), color_to_rgb_fallback(ctx->config->color3, 0x0000FF)};
 
   for (int s = 0; s < snake_count; s++) {
     int snake_offset = s * (snake_length + gap);
     for (int i = 0; i < snake_length; i++) {
       int pos = (step + snake_offset + i) % cycle;
-      if (pos < led_count) {
-        int idx           = current_config.reverse ? (led_count - 1 - pos) : pos;
+      if (pos < ctx->count) {
         uint8_t intensity = (uint8_t)(255 - (i * 180 / snake_length));
-        leds[idx]         = apply_brightness(colors[s % 3], (current_config.brightness * intensity) / 255);
+        *led_at(ctx, pos) = apply_brightness(colors[s % 3], (ctx->config->brightness * intensity) / 255);
       }
     }
   }
 }
 
 // Effect: Lava Lamp - Organic lava lamp bubbles
-static void effect_lava_lamp(void) {
-  if (led_count == 0) {
+static void effect_lava_lamp(effect_ctx_t *ctx) {
+  if (ctx->count == 0) {
     return;
   }
 
-  rgb_t color1       = color_to_rgb(current_config.color1);
-  rgb_t color2       = color_to_rgb_fallback(current_config.color2, 0x8000FF);
+  rgb_t color1       = color_to_rgb(ctx->config->color1);
+  rgb_t color2       = color_to_rgb_fallback(ctx->config->color2, 0x8000FF);
 
-  float speed_factor = current_config.speed / 100.0f;
+  float speed_factor = ctx->config->speed / 100.0f;
   if (speed_factor < 0.1f)
     speed_factor = 0.1f;
 
-  for (int i = 0; i < led_count; i++) {
-    float t         = effect_counter * speed_factor * 0.01f;
-    float pos       = i / (float)led_count;
-    float wave1     = sinf(t + pos * 6.28f) * 0.5f + 0.5f;
-    float wave2     = sinf(t * 0.7f + pos * 4.0f) * 0.5f + 0.5f;
-    float wave3     = sinf(t * 1.3f - pos * 3.0f) * 0.5f + 0.5f;
-    float intensity = (wave1 + wave2 * 0.5f + wave3 * 0.3f) / 1.8f;
+  // Three waves: sin(t + pos * 6.28), sin(0.7 t + pos * 4), sin(1.3 t - pos * 3),
+  // t = frame * speed_factor * 0.01 and pos = i / count
+  float t_rate   = speed_factor * 0.01f;
+  uint32_t wave1 = ctx->frame * fixed_phase_from_radians(t_rate);
+  uint32_t wave2 = ctx->frame * fixed_phase_from_radians(t_rate * 0.7f);
+  uint32_t wave3 = ctx->frame * fixed_phase_from_radians(t_rate * 1.3f);
+  uint32_t step1 = fixed_phase_from_radians(6.28f / ctx->count);
+  uint32_t step2 = fixed_phase_from_radians(4.0f / ctx->count);
+  uint32_t step3 = fixed_phase_from_radians(-3.0f / ctx->count);
+
+  for (int i = 0; i < ctx->count; i++) {
+    uint8_t w1 = fixed_sin8(wave1 >> 16);
+    uint8_t w2 = fixed_sin8(wave2 >> 16);
+    uint8_t w3 = fixed_sin8(wave3 >> 16);
+    wave1 += step1;
+    wave2 += step2;
+    wave3 += step3;
 
-    rgb_t color     = rgb_lerp(color1, color2, wave2);
-    uint8_t bright  = (uint8_t)(current_config.brightness * intensity);
+    // (w1 + w2 * 0.5 + w3 * 0.3) / 1.8
+    uint8_t intensity = (uint8_t)(((w1 * 10u + w2 * 5u + w3 * 3u) * 3641u) >> 16);
 
-    int idx         = current_config.reverse ? (led_count - 1 - i) : i;
-    leds[idx]       = apply_brightness(color, bright);
+    rgb_t color       = rgb_lerp_q8(color1, color2, w2);
+    uint8_t bright    = fixed_scale8(ctx->config->brightness, intensity);
+
+    *led_at(ctx, i)   = apply_brightness(color, bright);
   }
 }
 
 // Effect: Speed Pulse - Pulse based on vehicle speed
-static void effect_speed_pulse(void) {
-  if (led_count == 0) {
+static void effect_speed_pulse(effect_ctx_t *ctx) {
+  if (ctx->count == 0) {
     return;
   }
 
@@ -2085,31 +2443,31 @@ static void effect_speed_pulse(void) {
 
   // Pulse frequency increases with speed
   float pulse_speed = 0.05f + (speed_kmh / 200.0f) * 0.2f;
-  float pulse       = sinf(effect_counter * pulse_speed) * 0.5f + 0.5f;
-  uint8_t bright    = (uint8_t)(current_config.brightness * (0.3f + pulse * 0.7f));
+  float pulse       = sinf(ctx->frame * pulse_speed) * 0.5f + 0.5f;
+  uint8_t bright    = (uint8_t)(ctx->config->brightness * (0.3f + pulse * 0.7f));
 
   rgb_t final_color = apply_brightness(color, bright);
-  fill_solid(final_color);
+  fill_solid(ctx, final_color);
 }
 
 // Effect: Throttle Wave - Wave following throttle position
-static void effect_throttle_wave(void) {
-  fill_solid((rgb_t){0, 0, 0});
+static void effect_throttle_wave(effect_ctx_t *ctx) {
+  fill_solid(ctx, (rgb_t){0, 0, 0});
 
-  if (led_count == 0) {
+  if (ctx->count == 0) {
     return;
   }
 
   // accel_pedal_pos is 0-100
   uint8_t throttle = led_effects_get_accel_pedal_pos();
-  int wave_length  = (led_count * throttle) / 100;
+  int wave_length  = (ctx->count * throttle) / 100;
   if (wave_length < 1)
     wave_length = 1;
 
-  int center             = led_count / 2;
+  int center             = ctx->count / 2;
 
-  rgb_t color1           = color_to_rgb(current_config.color1);
-  rgb_t color2           = color_to_rgb_fallback(current_config.color2, 0xFF8000);
+  rgb_t color1           = color_to_rgb(ctx->config->color1);
+  rgb_t color2           = color_to_rgb_fallback(ctx->config->color2, 0xFF8000);
 
   float intensity_factor = throttle / 100.0f;
 
@@ -2119,181 +2477,189 @@ static void effect_throttle_wave(void) {
 
     float t          = i / (float)wave_length;
     rgb_t color      = rgb_lerp(color1, color2, t);
-    uint8_t bright   = (uint8_t)(current_config.brightness * intensity_factor * (1.0f - t * 0.5f));
+    uint8_t bright   = (uint8_t)(ctx->config->brightness * intensity_factor * (1.0f - t * 0.5f));
 
     if (offset_left >= 0) {
-      int idx   = current_config.reverse ? (led_count - 1 - offset_left) : offset_left;
-      leds[idx] = apply_brightness(color, bright);
+      *led_at(ctx, offset_left) = apply_brightness(color, bright);
     }
-    if (offset_right < led_count && offset_right != offset_left) {
-      int idx   = current_config.reverse ? (led_count - 1 - offset_right) : offset_right;
-      leds[idx] = apply_brightness(color, bright);
+    if (offset_right < ctx->count && offset_right != offset_left) {
+      *led_at(ctx, offset_right) = apply_brightness(color, bright);
     }
   }
 }
 
 // Effect: Aurora - Aurora borealis effect
-static void effect_aurora(void) {
-  if (led_count == 0) {
+static void effect_aurora(effect_ctx_t *ctx) {
+  if (ctx->count == 0) {
     return;
   }
 
-  float speed_factor = current_config.speed / 100.0f;
+  float speed_factor = ctx->config->speed / 100.0f;
   if (speed_factor < 0.1f)
     speed_factor = 0.1f;
 
-  rgb_t green  = color_to_rgb_fallback(current_config.color1, 0x00FF80);
-  rgb_t blue   = color_to_rgb_fallback(current_config.color2, 0x0080FF);
-  rgb_t purple = color_to_rgb_fallback(current_config.color3, 0x8000FF);
-
-  for (int i = 0; i < led_count; i++) {
-    float t     = effect_counter * speed_factor * 0.02f;
-    float pos   = i / (float)led_count;
-    float wave1 = sinf(t + pos * 3.14f) * 0.5f + 0.5f;
-    float wave2 = sinf(t * 0.5f + pos * 6.28f) * 0.5f + 0.5f;
-    float wave3 = sinf(t * 1.5f - pos * 4.0f) * 0.5f + 0.5f;
-
+  rgb_t green    = color_to_rgb_fallback(ctx->config->color1, 0x00FF80);
+  rgb_t blue     = color_to_rgb_fallback(ctx->config->color2, 0x0080FF);
+  rgb_t purple   = color_to_rgb_fallback(ctx->config->color3, 0x8000FF);
+
+  // Three waves: sin(t + pos * 3.14), sin(0.5 t + pos * 6.28), sin(1.5 t - pos * 4),
+  // t = frame * speed_factor * 0.02 and pos = i / count
+  float t_rate   = speed_factor * 0.02f;
+  uint32_t wave1 = ctx->frame * fixed_phase_from_radians(t_rate);
+  uint32_t wave2 = ctx->frame * fixed_phase_from_radians(t_rate * 0.5f);
+  uint32_t wave3 = ctx->frame * fixed_phase_from_radians(t_rate * 1.5f);
+  uint32_t step1 = fixed_phase_from_radians(3.14f / ctx->count);
+  uint32_t step2 = fixed_phase_from_radians(6.28f / ctx->count);
+  uint32_t step3 = fixed_phase_from_radians(-4.0f / ctx->count);
+
+  for (int i = 0; i < ctx->count; i++) {
+    uint8_t w1 = fixed_sin8(wave1 >> 16);
+    uint8_t w2 = fixed_sin8(wave2 >> 16);
+    uint8_t w3 = fixed_sin8(wave3 >> 16);
+    wave1 += step1;
+    wave2 += step2;
+    wave3 += step3;
+
+    // Green -> blue -> purple -> green over thirds of wave 1
     rgb_t color;
-    if (wave1 < 0.33f) {
-      color = rgb_lerp(green, blue, wave1 * 3.0f);
-    } else if (wave1 < 0.66f) {
-      color = rgb_lerp(blue, purple, (wave1 - 0.33f) * 3.0f);
+    if (w1 < 84) {
+      color = rgb_lerp_q8(green, blue, w1 * 3);
+    } else if (w1 < 168) {
+      color = rgb_lerp_q8(blue, purple, (w1 - 84) * 3);
     } else {
-      color = rgb_lerp(purple, green, (wave1 - 0.66f) * 3.0f);
+      color = rgb_lerp_q8(purple, green, w1 >= 253 ? 255 : (w1 - 168) * 3);
     }
 
-    float intensity = (wave2 + wave3) / 2.0f * 0.8f + 0.2f;
-    uint8_t bright  = (uint8_t)(current_config.brightness * intensity);
+    // (w2 + w3) / 2 * 0.8 + 0.2
+    uint8_t intensity = 51 + (uint8_t)(((w2 + w3) * 205u) >> 9);
+    uint8_t bright    = fixed_scale8(ctx->config->brightness, intensity);
 
-    int idx         = current_config.reverse ? (led_count - 1 - i) : i;
-    leds[idx]       = apply_brightness(color, bright);
+    *led_at(ctx, i)   = apply_brightness(color, bright);
   }
 }
 
 // Effect: Digital Glitch - Digital glitch effect
-static void effect_digital_glitch(void) {
-  if (led_count == 0) {
+static void effect_digital_glitch(effect_ctx_t *ctx) {
+  if (ctx->count == 0) {
+    return;
+  }
+
+  // New glitches once per frame period: higher frame rates hold each pattern longer
+  if (ctx->steps == 0) {
     return;
   }
 
   // Base color (dark)
-  rgb_t base = color_to_rgb_fallback(current_config.color1, 0x000000);
-  fill_solid(apply_brightness(base, current_config.brightness / 4));
+  rgb_t base = color_to_rgb_fallback(ctx->config->color1, 0x000000);
+  fill_solid(ctx, apply_brightness(base, ctx->config->brightness / 4));
 
   // Glitch probability based on speed
-  int glitch_prob        = 5 + (current_config.speed / 10);
+  int glitch_prob        = 5 + (ctx->config->speed / 10);
 
   rgb_t glitch_colors[3] = {color_to_rgb(0xFF0000), color_to_rgb(0x00FF00), color_to_rgb(0x0000FF)};
 
-  for (int i = 0; i < led_count; i++) {
-    if ((esp_random() % 100) < glitch_prob) {
-      rgb_t color   = glitch_colors[esp_random() % 3];
-      int idx       = current_config.reverse ? (led_count - 1 - i) : i;
-      uint8_t power = (uint8_t)(esp_random() % current_config.brightness);
-      leds[idx]     = apply_brightness(color, power);
+  // glitch_prob % per LED, one random byte each (drawn in batches)
+  uint32_t threshold     = glitch_prob * 256 / 100;
+  uint8_t noise[64];
+  for (int i = 0; i < ctx->count; i++) {
+    if (i % sizeof(noise) == 0) {
+      size_t left = ctx->count - i;
+      random_fill(ctx, noise, left < sizeof(noise) ? left : sizeof(noise));
+    }
+    if (noise[i % sizeof(noise)] < threshold) {
+      rgb_t color     = glitch_colors[random_below(ctx, 3)];
+      uint8_t power   = (uint8_t)random_below(ctx, ctx->config->brightness);
+      *led_at(ctx, i) = apply_brightness(color, power);
     }
   }
 
-  // Occasional full glitch
-  if ((effect_counter % 100) < 5) {
-    rgb_t flash = glitch_colors[esp_random() % 3];
-    for (int i = 0; i < led_count; i++) {
-      if ((esp_random() % 2) == 0) {
-        int idx   = current_config.reverse ? (led_count - 1 - i) : i;
-        leds[idx] = apply_brightness(flash, current_config.brightness);
+  // Occasional full glitch (one random bit per LED)
+  if ((ctx->frame % 100) < 5) {
+    rgb_t flash   = glitch_colors[random_below(ctx, 3)];
+    uint32_t bits = 0;
+    for (int i = 0; i < ctx->count; i++) {
+      if (i % 32 == 0) {
+        bits = effect_random(ctx);
+      }
+      bool lit = bits & 1;
+      bits >>= 1;
+      if (lit) {
+        *led_at(ctx, i) = apply_brightness(flash, ctx->config->brightness);
       }
     }
   }
 }
 
 // Effect: Fireworks - Fireworks explosions
-static void effect_fireworks(void) {
+static void effect_fireworks(effect_ctx_t *ctx) {
   // Fade existing LEDs
-  for (int i = 0; i < led_count; i++) {
-    leds[i].r = (leds[i].r * FADE_FACTOR_MEDIUM) / FADE_DIVISOR;
-    leds[i].g = (leds[i].g * FADE_FACTOR_MEDIUM) / FADE_DIVISOR;
-    leds[i].b = (leds[i].b * FADE_FACTOR_MEDIUM) / FADE_DIVISOR;
-  }
+  fade_all(ctx, FADE_FACTOR_MEDIUM);
 
-  if (led_count == 0) {
+  if (ctx->count == 0) {
     return;
   }
 
   // Spawn new firework randomly
-  int spawn_prob = 2 + (current_config.speed / 20);
-  if ((esp_random() % 100) < spawn_prob) {
-    int center       = esp_random() % led_count;
-    int explosion_sz = 3 + (esp_random() % 8);
+  int spawn_prob = 2 + (ctx->config->speed / 20);
+  if (chance_per_period(ctx, spawn_prob, 100)) {
+    int center       = random_below(ctx, ctx->count);
+    int explosion_sz = 3 + random_below(ctx, 8);
 
-    rgb_t colors[3]  = {color_to_rgb(current_config.color1), color_to_rgb_fallback(current_config.color2, 0xFFFF00), color_to_rgb_fallback(current_config.color3, 0xFF00FF)};
-    rgb_t color      = colors[esp_random() % 3];
+    rgb_t colors[3]  = {color_to_rgb(ctx->config->color1), color_to_rgb_fallback(ctx->config->color2, 0xFFFF00), color_to_rgb_fallback(ctx->config->color3, 0xFF00FF)};
+    rgb_t color      = colors[random_below(ctx, 3)];
 
     for (int i = 0; i < explosion_sz; i++) {
       int offset_left   = center - i;
       int offset_right  = center + i;
 
-      uint8_t intensity = (uint8_t)(current_config.brightness * (explosion_sz - i) / explosion_sz);
+      uint8_t intensity = (uint8_t)(ctx->config->brightness * (explosion_sz - i) / explosion_sz);
 
       if (offset_left >= 0) {
-        int idx       = current_config.reverse ? (led_count - 1 - offset_left) : offset_left;
-        rgb_t new_pix = apply_brightness(color, intensity);
-        leds[idx]     = rgb_max(leds[idx], new_pix);
+        rgb_t new_pix             = apply_brightness(color, intensity);
+        *led_at(ctx, offset_left) = rgb_max(*led_at(ctx, offset_left), new_pix);
       }
-      if (offset_right < led_count && offset_right != offset_left) {
-        int idx       = current_config.reverse ? (led_count - 1 - offset_right) : offset_right;
-        rgb_t new_pix = apply_brightness(color, intensity);
-        leds[idx]     = rgb_max(leds[idx], new_pix);
+      if (offset_right < ctx->count && offset_right != offset_left) {
+        rgb_t new_pix              = apply_brightness(color, intensity);
+        *led_at(ctx, offset_right) = rgb_max(*led_at(ctx, offset_right), new_pix);
       }
     }
   }
 }
 
 // Effect: Binary Code - Scrolling binary code
-static void effect_binary_code(void) {
-  if (led_count == 0) {
+static void effect_binary_code(effect_ctx_t *ctx) {
+  if (ctx->count == 0) {
     return;
   }
 
-  int speed_divider = 256 - current_config.speed;
+  int speed_divider = 256 - ctx->config->speed;
   if (speed_divider < 10)
     speed_divider = 10;
 
-  int scroll_pos  = (effect_counter * 100 / speed_divider) % led_count;
+  int scroll_pos  = (ctx->frame * 100 / speed_divider) % ctx->count;
 
-  rgb_t on_color  = color_to_rgb_fallback(current_config.color1, 0x00FF00);
-  rgb_t off_color = color_to_rgb_fallback(current_config.color2, 0x001100);
+  rgb_t on_color  = color_to_rgb_fallback(ctx->config->color1, 0x00FF00);
+  rgb_t off_color = color_to_rgb_fallback(ctx->config->color2, 0x001100);
 
-  for (int i = 0; i < led_count; i++) {
-    int pos        = (i + scroll_pos) % led_count;
+  for (int i = 0; i < ctx->count; i++) {
+    int pos         = (i + scroll_pos) % ctx->count;
     // Use pseudo-random pattern based on position
-    bool is_on     = ((pos * 17 + effect_counter / 10) % 2) == 0;
+    bool is_on      = ((pos * 17 + ctx->frame / 10) % 2) == 0;
 
-    rgb_t color    = is_on ? on_color : off_color;
-    uint8_t bright = is_on ? current_config.brightness : (current_config.brightness / 8);
+    rgb_t color     = is_on ? on_color : off_color;
+    uint8_t bright  = is_on ? ctx->config->brightness : (ctx->config->brightness / 8);
 
-    int idx        = current_config.reverse ? (led_count - 1 - i) : i;
-    leds[idx]      = apply_brightness(color, bright);
+    *led_at(ctx, i) = apply_brightness(color, bright);
   }
 }
 
 // Effect: Audio Waterfall - Audio FFT waterfall
-static void effect_audio_waterfall(void) {
-  if (led_count == 0) {
+static void effect_audio_waterfall(effect_ctx_t *ctx) {
+  if (ctx->count == 0) {
     return;
   }
 
-  // Scroll existing data
-  if (current_config.reverse) {
-    for (int i = 0; i < led_count - 1; i++) {
-      leds[i] = leds[i + 1];
-    }
-  } else {
-    for (int i = led_count - 1; i > 0; i--) {
-      leds[i] = leds[i - 1];
-    }
-  }
-
-  // Add new FFT data at the edge
+  // New FFT data for the edge
   rgb_t new_color = {0, 0, 0};
   if (audio_input_is_enabled()) {
     audio_data_t audio_data;
@@ -2303,9 +2669,9 @@ static void effect_audio_waterfall(void) {
         level = 1.0f;
 
       // Color based on frequency content
-      rgb_t low_color  = color_to_rgb_fallback(current_config.color1, 0xFF0000);
-      rgb_t mid_color  = color_to_rgb_fallback(current_config.color2, 0x00FF00);
-      rgb_t hi_color   = color_to_rgb_fallback(current_config.color3, 0x0000FF);
+      rgb_t low_color  = color_to_rgb_fallback(ctx->config->color1, 0xFF0000);
+      rgb_t mid_color  = color_to_rgb_fallback(ctx->config->color2, 0x00FF00);
+      rgb_t hi_color   = color_to_rgb_fallback(ctx->config->color3, 0x0000FF);
 
       float bass_level = audio_data.bass;
       if (bass_level < 0.5f) {
@@ -2314,57 +2680,61 @@ static void effect_audio_waterfall(void) {
         new_color = rgb_lerp(mid_color, hi_color, (bass_level - 0.5f) * 2.0f);
       }
 
-      uint8_t bright = (uint8_t)(current_config.brightness * level);
+      uint8_t bright = (uint8_t)(ctx->config->brightness * level);
       new_color      = apply_brightness(new_color, bright);
     }
   }
 
-  int edge_idx   = current_config.reverse ? led_count - 1 : 0;
-  leds[edge_idx] = new_color;
+  // Scroll one LED per frame period
+  for (uint32_t step = 0; step < ctx->steps; step++) {
+    for (int i = ctx->count - 1; i > 0; i--) {
+      *led_at(ctx, i) = *led_at(ctx, i - 1);
+    }
+    *led_at(ctx, 0) = new_color;
+  }
 }
 
 // Effect: Beat Ripple - Ripple on beat detection
-static void effect_beat_ripple(void) {
+typedef struct {
+  uint32_t last_beat_frame;
+  int ripple_pos;
+} beat_ripple_state_t;
+
+static void effect_beat_ripple(effect_ctx_t *ctx) {
+  beat_ripple_state_t *state = ctx->state;
+
   // Fade existing
-  for (int i = 0; i < led_count; i++) {
-    leds[i].r = (leds[i].r * FADE_FACTOR_SLOW) / FADE_DIVISOR;
-    leds[i].g = (leds[i].g * FADE_FACTOR_SLOW) / FADE_DIVISOR;
-    leds[i].b = (leds[i].b * FADE_FACTOR_SLOW) / FADE_DIVISOR;
-  }
+  fade_all(ctx, FADE_FACTOR_SLOW);
 
-  if (led_count == 0) {
+  if (ctx->count == 0) {
     return;
   }
 
-  static uint32_t last_beat_frame = 0;
-  static int ripple_pos           = 0;
-
   if (audio_input_is_enabled()) {
     audio_data_t audio_data;
     if (audio_input_get_data(&audio_data)) {
       // Detect beat (simple threshold on bass)
-      if (audio_data.bass > 0.7f && (effect_counter - last_beat_frame) > 10) {
-        last_beat_frame = effect_counter;
-        ripple_pos      = 0;
+      if (audio_data.bass > 0.7f && (ctx->frame - state->last_beat_frame) > 10) {
+        state->last_beat_frame = ctx->frame;
+        state->ripple_pos      = 0;
       }
     }
   }
 
   // Draw ripple expanding from center
-  if ((effect_counter - last_beat_frame) < 30) {
-    ripple_pos++;
-    int center     = led_count / 2;
+  if ((ctx->frame - state->last_beat_frame) < 30) {
+    state->ripple_pos += ctx->steps;
+    int center     = ctx->count / 2;
 
-    rgb_t color    = color_to_rgb(current_config.color1);
+    rgb_t color    = color_to_rgb(ctx->config->color1);
     int max_radius = 15;
-    if (ripple_pos < max_radius) {
-      for (int i = -ripple_pos; i <= ripple_pos; i++) {
+    if (state->ripple_pos < max_radius) {
+      for (int i = -state->ripple_pos; i <= state->ripple_pos; i++) {
         int idx = center + i;
-        if (idx >= 0 && idx < led_count) {
-          int mapped_idx    = current_config.reverse ? (led_count - 1 - idx) : idx;
-          uint8_t intensity = (uint8_t)(current_config.brightness * (max_radius - ripple_pos) / max_radius);
+        if (idx >= 0 && idx < ctx->count) {
+          uint8_t intensity = (uint8_t)(ctx->config->brightness * (max_radius - state->ripple_pos) / max_radius);
           rgb_t new_pix     = apply_brightness(color, intensity);
-          leds[mapped_idx]  = rgb_max(leds[mapped_idx], new_pix);
+          *led_at(ctx, idx) = rgb_max(*led_at(ctx, idx), new_pix);
         }
       }
     }
@@ -2372,14 +2742,14 @@ static void effect_beat_ripple(void) {
 }
 
 // Effect: Stereo VU Meter - Stereo VU meter
-static void effect_stereo_vu_meter(void) {
-  fill_solid((rgb_t){0, 0, 0});
+static void effect_stereo_vu_meter(effect_ctx_t *ctx) {
+  fill_solid(ctx, (rgb_t){0, 0, 0});
 
-  if (led_count == 0) {
+  if (ctx->count == 0) {
     return;
   }
 
-  int half          = led_count / 2;
+  int half          = ctx->count / 2;
 
   // For now, use mono audio for both sides
   // In future, could use stereo input
@@ -2401,9 +2771,9 @@ static void effect_stereo_vu_meter(void) {
   int left_leds  = (int)(half * left_level);
   int right_leds = (int)(half * right_level);
 
-  rgb_t green    = color_to_rgb_fallback(current_config.color1, 0x00FF00);
-  rgb_t yellow   = color_to_rgb_fallback(current_config.color2, 0xFFFF00);
-  rgb_t red      = color_to_rgb_fallback(current_config.color3, 0xFF0000);
+  rgb_t green    = color_to_rgb_fallback(ctx->config->color1, 0x00FF00);
+  rgb_t yellow   = color_to_rgb_fallback(ctx->config->color2, 0xFFFF00);
+  rgb_t red      = color_to_rgb_fallback(ctx->config->color3, 0xFF0000);
 
   // Left channel
   for (int i = 0; i < half; i++) {
@@ -2416,8 +2786,7 @@ static void effect_stereo_vu_meter(void) {
       } else {
         color = red;
       }
-      int idx   = current_config.reverse ? (led_count - 1 - i) : i;
-      leds[idx] = apply_brightness(color, current_config.brightness);
+      *led_at(ctx, i) = apply_brightness(color, ctx->config->brightness);
     }
   }
 
@@ -2432,14 +2801,13 @@ static void effect_stereo_vu_meter(void) {
       } else {
         color = red;
       }
-      int idx   = current_config.reverse ? i : (led_count - 1 - i);
-      leds[idx] = apply_brightness(color, current_config.brightness);
+      *led_at(ctx, ctx->count - 1 - i) = apply_brightness(color, ctx->config->brightness);
     }
   }
 }
 
 // Effect function table
-typedef void (*effect_func_t)(void);
+typedef void (*effect_func_t)(effect_ctx_t *ctx);
 static const effect_func_t effect_functions[] = {
     [EFFECT_OFF]                = NULL,
     [EFFECT_SOLID]              = effect_solid,
@@ -2489,6 +2857,377 @@ static const effect_func_t effect_functions[] = {
     [EFFECT_STEREO_VU_METER]    = effect_stereo_vu_meter,
 };
 
+// Effects whose pixels carry over to the next frame (trails, fades, scrolling)
+static bool effect_keeps_pixels(led_effect_t effect) {
+  switch (effect) {
+  case EFFECT_TWINKLE:
+  case EFFECT_SCAN:
+  case EFFECT_SPARKLE_OVERLAY:
+  case EFFECT_DIGITAL_GLITCH:
+  case EFFECT_FIREWORKS:
+  case EFFECT_AUDIO_WATERFALL:
+  case EFFECT_BEAT_RIPPLE:
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Render skip: how an effect's pixels change over time. A layer whose effect is not
+// dynamic keeps its last pixels in its state slot and shows them again as long as its
+// inputs (layer_inputs) are unchanged
+typedef enum {
+  EFFECT_TEMPORAL_DYNAMIC,  // Randomness, elapsed time or audio: rendered every frame
+  EFFECT_TEMPORAL_PERIODIC, // Follows the animation frame in steps of effect_period
+  EFFECT_TEMPORAL_STATIC,   // Only follows the config and the vehicle fields it reads
+} effect_temporal_t;
+
+static effect_temporal_t effect_temporal(led_effect_t effect) {
+  switch (effect) {
+  case EFFECT_SOLID:
+  case EFFECT_VEHICLE_SYNC:
+  case EFFECT_BRAKE_LIGHT:
+  case EFFECT_POWER_METER:
+  case EFFECT_POWER_METER_CENTER:
+  case EFFECT_THROTTLE_WAVE:
+    return EFFECT_TEMPORAL_STATIC;
+  case EFFECT_BREATHING:
+  case EFFECT_RAINBOW:
+  case EFFECT_RAINBOW_CYCLE:
+  case EFFECT_THEATER_CHASE:
+  case EFFECT_RUNNING_LIGHTS:
+  case EFFECT_KNIGHT_RIDER:
+  case EFFECT_FADE:
+  case EFFECT_STROBE:
+  case EFFECT_TURN_SIGNAL:
+  case EFFECT_HAZARD:
+  case EFFECT_BLINDSPOT_FLASH:
+  case EFFECT_COMET:
+  case EFFECT_RIPPLE_WAVE:
+  case EFFECT_DUAL_GRADIENT:
+  case EFFECT_CENTER_OUT_SCAN:
+  case EFFECT_SEQUENTIAL_FADE:
+  case EFFECT_WAVE_COLLISION:
+  case EFFECT_SNAKE_CHASE:
+  case EFFECT_LAVA_LAMP:
+  case EFFECT_SPEED_PULSE:
+  case EFFECT_AURORA:
+  case EFFECT_BINARY_CODE:
+    return EFFECT_TEMPORAL_PERIODIC;
+  default:
+    return EFFECT_TEMPORAL_DYNAMIC;
+  }
+}
+
+// Period of a periodic effect, num / den animation frames: its pixels only change with
+// frame * den / num. Most step every frame, so they are only skipped when a frame is
+// rendered twice (above 50 FPS, or a slave's clock held back)
+static void effect_period(const effect_config_t *config, uint32_t *num, uint32_t *den) {
+  *num = 1;
+  *den = 1;
+  switch (config->effect) {
+  case EFFECT_RAINBOW:
+    *num = 50;
+    *den = config->speed + 10;
+    break;
+  case EFFECT_RAINBOW_CYCLE:
+    *num = 50;
+    *den = config->speed < 10 ? 10 : config->speed;
+    break;
+  default:
+    break;
+  }
+}
+
+// Vehicle fields read by an effect, folded into its inputs
+static uint32_t hash_vehicle_inputs(uint32_t hash, led_effect_t effect) {
+  const vehicle_state_t *state = &last_vehicle_state;
+  switch (effect) {
+  case EFFECT_VEHICLE_SYNC:
+    hash = hash_word(hash, state->door_front_left_open | state->door_front_right_open << 1 | state->door_rear_left_open << 2 | state->door_rear_right_open << 3);
+    hash = hash_word(hash, state->charging | state->locked << 1);
+    return hash_float(hash, state->speed_kph);
+  case EFFECT_BRAKE_LIGHT:
+    return hash_word(hash, state->brake_pressed);
+  case EFFECT_POWER_METER:
+  case EFFECT_POWER_METER_CENTER:
+    hash = hash_word(hash, state->train_type);
+    hash = hash_float(hash, state->rear_power);
+    hash = hash_float(hash, state->front_power);
+    hash = hash_float(hash, state->rear_power_limit);
+    hash = hash_float(hash, state->front_power_limit);
+    return hash_float(hash, state->max_regen);
+  case EFFECT_THROTTLE_WAVE:
+    return hash_word(hash, state->accel_pedal_pos);
+  case EFFECT_SPEED_PULSE:
+    return hash_float(hash, state->speed_kph);
+  default:
+    return hash;
+  }
+}
+
+// Everything the pixels of a non-dynamic layer depend on, before layer_scale (dynamic
+// brightness and audio modulation are applied to the kept pixels like to new ones)
+static uint32_t layer_inputs(const effect_config_t *config, uint32_t frame) {
+  uint32_t hash = hash_word(HASH_SEED, config->effect);
+  hash          = hash_word(hash, config->brightness | config->speed << 8 | config->reverse << 16);
+  hash          = hash_word(hash, config->color1);
+  hash          = hash_word(hash, config->color2);
+  hash          = hash_word(hash, config->color3);
+  hash          = hash_word(hash, max_allowed_brightness);
+  hash          = hash_vehicle_inputs(hash, config->effect);
+  if (effect_temporal(config->effect) == EFFECT_TEMPORAL_PERIODIC) {
+    uint32_t num;
+    uint32_t den;
+    effect_period(config, &num, &den);
+    hash = hash_word(hash, (uint32_t)((uint64_t)frame * den / num));
+  }
+  return hash;
+}
+
+// Pixels kept for the render skip, after the instance state, when the layer has a slot
+static size_t effect_skip_size(led_effect_t effect, uint16_t count) {
+  if (effect_temporal(effect) == EFFECT_TEMPORAL_DYNAMIC || effect_keeps_pixels(effect)) {
+    return 0;
+  }
+  return count * sizeof(rgb_t);
+}
+
+// Effect-specific part of the instance state (ctx->state)
+static size_t effect_private_size(led_effect_t effect, uint16_t count) {
+  switch (effect) {
+  case EFFECT_FIRE:
+    return count * sizeof(uint16_t);
+  case EFFECT_CHARGE_STATUS:
+    return sizeof(float);
+  case EFFECT_BEAT_RIPPLE:
+    return sizeof(beat_ripple_state_t);
+  default:
+    return 0;
+  }
+}
+
+// Instance state: private part (4-byte aligned), then the carried-over pixels
+static size_t effect_state_size(led_effect_t effect, uint16_t count) {
+  size_t size = (effect_private_size(effect, count) + 3) & ~(size_t)3;
+  if (effect_keeps_pixels(effect)) {
+    size += count * sizeof(rgb_t);
+  }
+  return size;
+}
+
+static void release_idle_slots(void) {
+  for (int i = 0; i < LED_LAYER_COUNT; i++) {
+    if (effect_slots[i].effect != EFFECT_OFF && (int32_t)(frame_time_ms - effect_slots[i].time_ms) > EFFECT_STATE_IDLE_MS) {
+      effect_slots[i].effect = EFFECT_OFF;
+    }
+  }
+}
+
+// Move the live slots to the front of the arena, keeping their order and content
+static void compact_state_arena(void) {
+  uint8_t *arena = (uint8_t *)state_arena;
+  uint32_t used  = 0;
+  while (true) {
+    effect_slot_t *next = NULL;
+    for (int i = 0; i < LED_LAYER_COUNT; i++) {
+      effect_slot_t *slot = &effect_slots[i];
+      if (slot->effect != EFFECT_OFF && slot->size > 0 && slot->offset >= used && (next == NULL || slot->offset < next->offset)) {
+        next = slot;
+      }
+    }
+    if (next == NULL) {
+      break;
+    }
+    if (next->offset != used) {
+      memmove(arena + used, arena + next->offset, next->size);
+      next->offset = used;
+    }
+    used += next->size;
+  }
+  state_arena_used = used;
+}
+
+static bool allocate_slot(effect_slot_t *slot, uint32_t size) {
+  if (size == 0) {
+    slot->offset = 0;
+    slot->size   = 0;
+    return true;
+  }
+  if (state_arena_used + size > state_arena_size) {
+    release_idle_slots();
+    compact_state_arena();
+    if (state_arena_used + size > state_arena_size) {
+      return false;
+    }
+  }
+  slot->offset = state_arena_used;
+  slot->size   = size;
+  state_arena_used += size;
+  memset((uint8_t *)state_arena + slot->offset, 0, size);
+  return true;
+}
+
+// Random sequence of a layer instance: unrelated between layers, the same for the
+// same seed, effect and length
+static uint32_t layer_seed(uint8_t layer, led_effect_t effect, uint16_t count) {
+  uint32_t h = random_seed ^ (layer * 0x9E3779B9u) ^ ((uint32_t)effect << 16) ^ count;
+  // murmur3 finalizer
+  h ^= h >> 16;
+  h *= 0x85EBCA6Bu;
+  h ^= h >> 13;
+  h *= 0xC2B2AE35u;
+  h ^= h >> 16;
+  return h != 0 ? h : 1; // xorshift32 sticks at 0
+}
+
+// Attach the layer's state to ctx and advance its clock. The state is sized for capacity
+// LEDs (ctx->count may be fewer: accel modulation). It starts zeroed (and the random
+// sequence from layer_seed) when the layer changes effect or capacity, or was not
+// rendered for EFFECT_STATE_IDLE_MS.
+// Returns false if the effect has state but the arena has no room for it.
+static bool bind_layer_state(effect_ctx_t *ctx, uint8_t layer, led_effect_t effect, uint16_t capacity) {
+  ctx->dt_ms  = LED_EFFECT_FRAME_MS;
+  ctx->steps  = 1;
+  ctx->state  = NULL;
+  ctx->rng    = layer_seed(layer, effect, capacity);
+  size_t size = effect_state_size(effect, capacity);
+  if (layer >= LED_LAYER_COUNT) {
+    return size == 0;
+  }
+
+  effect_slot_t *slot = &effect_slots[layer];
+  bool fresh          = slot->effect != effect || slot->count != capacity || (int32_t)(frame_time_ms - slot->time_ms) > EFFECT_STATE_IDLE_MS;
+  if (fresh) {
+    if (slot->effect != EFFECT_OFF && state_arena_used == slot->offset + slot->size) {
+      // Last allocation: its space is reused directly
+      state_arena_used = slot->offset;
+    }
+    slot->effect     = EFFECT_OFF;
+    // The render skip's copy of the pixels is optional: without room, the layer renders every frame
+    size_t skip_size = effect_skip_size(effect, capacity);
+    bool allocated   = skip_size > 0 && allocate_slot(slot, (uint32_t)(size + skip_size));
+    if (!allocated && !allocate_slot(slot, (uint32_t)size)) {
+      return false;
+    }
+    slot->effect       = effect;
+    slot->count        = capacity;
+    slot->rng          = ctx->rng;
+    slot->inputs_valid = false;
+  } else {
+    // A slave's clock may be corrected backwards: that frame counts as no time
+    int32_t dt_ms = (int32_t)(frame_time_ms - slot->time_ms);
+    int32_t steps = (int32_t)(ctx->frame - slot->frame);
+    ctx->dt_ms    = dt_ms <= 0 ? 0 : (dt_ms < FRAME_DT_MAX_MS ? (uint32_t)dt_ms : FRAME_DT_MAX_MS);
+    ctx->steps    = steps <= 0 ? 0 : (steps < FRAME_STEPS_MAX ? (uint32_t)steps : FRAME_STEPS_MAX);
+    ctx->rng      = slot->rng;
+  }
+  slot->frame   = ctx->frame;
+  slot->time_ms = frame_time_ms;
+  ctx->state    = slot->size > 0 ? (uint8_t *)state_arena + slot->offset : NULL;
+  return true;
+}
+
+static bool layer_renders_black(const effect_config_t *config, uint16_t count) {
+  return count == 0 || config->effect == EFFECT_OFF || config->effect >= EFFECT_MAX || effect_functions[config->effect] == NULL;
+}
+
+// Render one layer into out[0..count), its state kept for capacity LEDs (at least count):
+// returns its layer_scale, not yet applied
+static uint16_t render_layer(const effect_config_t *config, uint8_t layer, can_event_type_t event, uint32_t frame, rgb_t *out, uint16_t count, uint16_t capacity) {
+  if (layer_renders_black(config, count)) {
+    if (layer < LED_LAYER_COUNT) {
+      prepared_layers[layer].ready = false;
+    }
+    memset(out, 0, count * sizeof(rgb_t));
+    return 256;
+  }
+  if (capacity < count) {
+    capacity = count;
+  }
+
+  effect_ctx_t ctx = {.config = config, .frame = frame, .leds = out, .stride = 1, .count = count};
+  if (config->reverse) {
+    ctx.leds   = out + count - 1;
+    ctx.stride = -1;
+  }
+  effect_slot_t *slot        = NULL;
+  prepared_layer_t *prepared = layer < LED_LAYER_COUNT && prepared_layers[layer].ready && prepared_layers[layer].frame == frame ? &prepared_layers[layer] : NULL;
+  if (prepared != NULL) {
+    prepared->ready = false;
+    if (!prepared->bound || effect_slots[layer].effect != config->effect || effect_slots[layer].count != capacity) {
+      // Not what led_effects_prepare_layer bound: binding now could move the arena under
+      // a layer rendering on the other core
+      memset(out, 0, count * sizeof(rgb_t));
+      return 256;
+    }
+    // The arena may have been compacted since: the state is found again from the slot
+    slot      = &effect_slots[layer];
+    ctx.dt_ms = prepared->dt_ms;
+    ctx.steps = prepared->steps;
+    ctx.rng   = prepared->rng;
+    ctx.state = slot->size > 0 ? (uint8_t *)state_arena + slot->offset : NULL;
+  } else if (bind_layer_state(&ctx, layer, config->effect, capacity)) {
+    slot = layer < LED_LAYER_COUNT ? &effect_slots[layer] : NULL;
+  } else {
+    // No room: the effect runs from a blank state every frame
+    if (state_misses++ == 0) {
+      ESP_LOGW(TAG_LED, "Effect state arena full: layer %u rendered without state", layer);
+    }
+    capacity    = count;
+    size_t size = effect_state_size(config->effect, count);
+    if (size > state_scratch_size) {
+      // Layer longer than the strip: not even the scratch fits
+      memset(out, 0, count * sizeof(rgb_t));
+      return 256;
+    }
+    ctx.state = state_scratch;
+    memset(state_scratch, 0, size);
+  }
+
+  // Non-dynamic layer whose slot had room for a copy of its pixels
+  bool skippable = slot != NULL && effect_skip_size(config->effect, capacity) > 0 && slot->size > effect_state_size(config->effect, capacity);
+  rgb_t *kept    = NULL;
+  if (effect_keeps_pixels(config->effect) || skippable) {
+    size_t private_size = (effect_private_size(config->effect, capacity) + 3) & ~(size_t)3;
+    kept                = (rgb_t *)((uint8_t *)ctx.state + private_size);
+  }
+
+  uint32_t inputs = 0;
+  if (skippable) {
+    // The kept pixels are only for the length they were rendered at
+    inputs = hash_word(layer_inputs(config, frame), count);
+    if (slot->inputs_valid && slot->inputs == inputs) {
+      memcpy(out, kept, count * sizeof(rgb_t));
+      portENTER_CRITICAL(&render_stats_lock);
+      output_stats.layers_reused++;
+      portEXIT_CRITICAL(&render_stats_lock);
+      return layer_scale(config, event);
+    }
+  }
+
+  if (effect_keeps_pixels(config->effect)) {
+    memcpy(out, kept, count * sizeof(rgb_t));
+  } else {
+    memset(out, 0, count * sizeof(rgb_t));
+  }
+
+  effect_functions[config->effect](&ctx);
+  portENTER_CRITICAL(&render_stats_lock);
+  output_stats.layers_rendered++;
+  portEXIT_CRITICAL(&render_stats_lock);
+
+  if (kept != NULL) {
+    memcpy(kept, out, count * sizeof(rgb_t));
+  }
+  if (slot != NULL) {
+    slot->rng          = ctx.rng;
+    slot->inputs       = inputs;
+    slot->inputs_valid = skippable;
+  }
+  return layer_scale(config, event);
+}
+
 typedef struct {
   led_effect_t effect;
   const char *id;
@@ -2585,30 +3324,214 @@ static const led_effect_descriptor_t *find_effect_descriptor_by_id(const char *i
   return NULL;
 }
 
+#if SOC_RMT_SUPPORT_DMA
+#define LED_WIRE_MALLOC_CAPS (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT | MALLOC_CAP_DMA)
+#else
+#define LED_WIRE_MALLOC_CAPS (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+#endif
+
+static size_t align4(size_t size) {
+  return (size + 3) & ~(size_t)3;
+}
+
+static size_t state_arena_bytes(uint16_t count) {
+  size_t size = align4((size_t)count * EFFECT_STATE_BYTES_PER_LED);
+  return size > EFFECT_STATE_ARENA_MIN ? size : EFFECT_STATE_ARENA_MIN;
+}
+
+// Largest state of a layer as long as the strip
+static size_t state_scratch_bytes(uint16_t count) {
+  size_t size = 0;
+  for (int effect = 0; effect < EFFECT_MAX; effect++) {
+    size_t effect_size = effect_state_size((led_effect_t)effect, count);
+    if (effect_size > size) {
+      size = effect_size;
+    }
+  }
+  return align4(size);
+}
+
+static void *alloc_work_memory(size_t size) {
+#ifdef CONFIG_HAS_PSRAM
+  void *ptr = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (ptr != NULL) {
+    return ptr;
+  }
+#endif
+  return heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+}
+
+static void free_led_buffers(led_buffers_t *buffers) {
+  heap_caps_free(buffers->wire);
+  heap_caps_free(buffers->work);
+  memset(buffers, 0, sizeof(*buffers));
+}
+
+static bool alloc_led_buffers(led_buffers_t *buffers, uint16_t count) {
+  memset(buffers, 0, sizeof(*buffers));
+  buffers->wire_size = align4((size_t)count * 3) * 2;
+  buffers->work_size = align4((size_t)count * sizeof(rgb_t)) + state_arena_bytes(count) + state_scratch_bytes(count);
+  buffers->wire      = heap_caps_malloc(buffers->wire_size, LED_WIRE_MALLOC_CAPS);
+  buffers->work      = alloc_work_memory(buffers->work_size);
+  if (buffers->wire == NULL || buffers->work == NULL) {
+    ESP_LOGE(TAG_LED, "Not enough memory for %u LEDs (%u + %u bytes)", count, (unsigned)buffers->wire_size, (unsigned)buffers->work_size);
+    free_led_buffers(buffers);
+    return false;
+  }
+  memset(buffers->wire, 0, buffers->wire_size);
+  memset(buffers->work, 0, buffers->work_size);
+  buffers->led_count = count;
+  return true;
+}
+
+// Point the frame buffers at a set: running layers restart, their state was in the old one
+static void use_led_buffers(const led_buffers_t *buffers) {
+  size_t leds_size   = align4((size_t)buffers->led_count * sizeof(rgb_t));
+  size_t arena_size  = state_arena_bytes(buffers->led_count);
+
+  active_buffers     = *buffers;
+  leds               = (rgb_t *)buffers->work;
+  led_data[0]        = buffers->wire;
+  led_data[1]        = buffers->wire + buffers->wire_size / 2;
+  state_arena        = (uint32_t *)(buffers->work + leds_size);
+  state_arena_size   = arena_size;
+  state_scratch      = (uint32_t *)(buffers->work + leds_size + arena_size);
+  state_scratch_size = buffers->work_size - leds_size - arena_size;
+  for (int i = 0; i < LED_LAYER_COUNT; i++) {
+    effect_slots[i].effect = EFFECT_OFF;
+  }
+  state_arena_used = 0;
+
+  led_count        = buffers->led_count;
+  update_max_allowed_brightness(led_count);
+}
+
+// LED task, between frames: switch to the buffers of a new LED count
+static void apply_pending_led_buffers(void) {
+  led_buffers_t next;
+  portENTER_CRITICAL(&buffers_lock);
+  next                      = pending_buffers;
+  pending_buffers.led_count = 0;
+  portEXIT_CRITICAL(&buffers_lock);
+  if (next.led_count == 0) {
+    return;
+  }
+
+  // The frame on the wire is still read from the old buffers
+  wait_outputs_idle();
+  led_buffers_t previous = active_buffers;
+  use_led_buffers(&next);
+  free_led_buffers(&previous);
+  ESP_LOGI(TAG_LED, "LED buffers resized: %u LEDs (%u bytes internal, %u bytes work)", led_count, (unsigned)next.wire_size, (unsigned)next.work_size);
+}
+
+// LED task, between frames: rebuild the channels for a new output table
+static void apply_pending_outputs(void) {
+  led_output_config_t next[LED_OUTPUT_MAX];
+  portENTER_CRITICAL(&outputs_lock);
+  uint8_t count        = pending_output_count;
+  memcpy(next, pending_outputs, sizeof(next));
+  pending_output_count = 0;
+  portEXIT_CRITICAL(&outputs_lock);
+  if (count == 0) {
+    return;
+  }
+
+  if (!configure_rmt_channels(next, count)) {
+    // Back to the default output rather than no output at all
+    configure_rmt_channels(&default_output, 1);
+  }
+}
+
+// GPIOs of config.h already driven by something else: an output there would take them over
+// (and, saved in settings.json, again at every boot)
+static const int reserved_gpios[] = {CAN_TX_BODY_PIN, CAN_RX_BODY_PIN, CAN_TX_CHASSIS_PIN, CAN_RX_CHASSIS_PIN, I2S_WS_PIN, I2S_SCK_PIN, I2S_SD_PIN, STATUS_LED_GPIO};
+
+static bool gpio_reserved(uint8_t gpio) {
+  for (size_t i = 0; i < sizeof(reserved_gpios) / sizeof(reserved_gpios[0]); i++) {
+    if (reserved_gpios[i] == gpio) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Distinct valid output GPIOs not used elsewhere, known color orders, spans inside MAX_LED_COUNT
+// that do not overlap
+static bool validate_outputs(const led_output_config_t *configs, uint8_t count) {
+  if (configs == NULL || count < 1 || count > LED_OUTPUT_MAX) {
+    ESP_LOGE(TAG_LED, "Invalid output count %u (1-%d)", count, LED_OUTPUT_MAX);
+    return false;
+  }
+  for (int i = 0; i < count; i++) {
+    const led_output_config_t *a = &configs[i];
+    uint32_t a_end               = a->count == 0 ? MAX_LED_COUNT : (uint32_t)a->start + a->count;
+    if (!GPIO_IS_VALID_OUTPUT_GPIO(a->gpio) || a->color_order >= LED_COLOR_ORDER_COUNT || a_end > MAX_LED_COUNT) {
+      ESP_LOGE(TAG_LED, "Invalid output %d (GPIO %u, order %u, LEDs %u+%u)", i, a->gpio, a->color_order, a->start, a->count);
+      return false;
+    }
+    if (gpio_reserved(a->gpio)) {
+      ESP_LOGE(TAG_LED, "Output %d: GPIO %u is already used (CAN, I2S or status LED)", i, a->gpio);
+      return false;
+    }
+    for (int j = 0; j < i; j++) {
+      const led_output_config_t *b = &configs[j];
+      uint32_t b_end               = b->count == 0 ? MAX_LED_COUNT : (uint32_t)b->start + b->count;
+      if (a->gpio == b->gpio || (a->start < b_end && b->start < a_end)) {
+        ESP_LOGE(TAG_LED, "Outputs %d and %d share a GPIO or LEDs", j, i);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 bool led_effects_init(void) {
   uint16_t configured_leds = config_manager_get_led_count();
-  led_count                = sanitize_led_count(configured_leds);
-  update_max_allowed_brightness(led_count);
+  led_buffers_t buffers;
+  if (!alloc_led_buffers(&buffers, sanitize_led_count(configured_leds))) {
+    // The saved count does not fit in this board's memory: start with the default one
+    if (!alloc_led_buffers(&buffers, NUM_LEDS)) {
+      return false;
+    }
+  }
+  free_led_buffers(&active_buffers);
+  use_led_buffers(&buffers);
 
-  if (!configure_rmt_channel()) {
+  // Snap thresholds: changes that should not be shown SIGNAL_SMOOTHER_DELAY_MS late
+  signal_smoother_init(&speed_smoother, 30.0f, 0.0f, 400.0f);
+  signal_smoother_init(&rear_power_smoother, 100.0f, -1000.0f, 1000.0f);
+  signal_smoother_init(&front_power_smoother, 100.0f, -1000.0f, 1000.0f);
+  signal_smoother_init(&pedal_smoother, 40.0f, 0.0f, 100.0f);
+
+  led_output_config_t configured_outputs[LED_OUTPUT_MAX];
+  uint8_t configured_count = config_manager_get_led_outputs(configured_outputs);
+  if (configured_count == 0 || !validate_outputs(configured_outputs, configured_count)) {
+    configured_outputs[0] = default_output;
+    configured_count      = 1;
+  }
+  if (!configure_rmt_channels(configured_outputs, configured_count)) {
     return false;
   }
 
   // Default configuration
   led_effects_reset_config();
 
+  // Effects draw from their own generators (effect_random): only the seeds are hardware random
+  led_effects_set_random_seed(esp_random());
+
   // LED configuration is now managed by config_manager through profiles
 
-  ESP_LOGI(TAG_LED, "LEDs initialized (%d LEDs on GPIO %d)", led_count, LED_PIN);
+  ESP_LOGI(TAG_LED, "LEDs initialized (%d LEDs on %u outputs)", led_count, output_count);
   return true;
 }
 
 void led_effects_deinit(void) {
   // Turn off all LEDs
-  fill_solid((rgb_t){0, 0, 0});
+  memset(leds, 0, led_count * sizeof(rgb_t));
   led_strip_show();
 
-  cleanup_rmt_channel();
+  cleanup_rmt_channels();
 
   ESP_LOGI(TAG_LED, "LEDs deinitialized");
 }
@@ -2619,12 +3542,59 @@ bool led_effects_set_led_count(uint16_t requested_led_count) {
     return false;
   }
 
-  led_count = requested_led_count;
-  update_max_allowed_brightness(led_count);
-  ESP_LOGI(TAG_LED, "LED count updated: %d", led_count);
+  if (requested_led_count == led_count && pending_buffers.led_count == 0) {
+    return true;
+  }
+
+  // Allocated here, so that a count that does not fit is refused, and handed to the
+  // LED task: the current buffers may be in use by a frame
+  led_buffers_t buffers;
+  if (!alloc_led_buffers(&buffers, requested_led_count)) {
+    return false;
+  }
+  led_buffers_t replaced;
+  portENTER_CRITICAL(&buffers_lock);
+  replaced        = pending_buffers;
+  pending_buffers = buffers;
+  portEXIT_CRITICAL(&buffers_lock);
+  if (replaced.led_count != 0) {
+    free_led_buffers(&replaced);
+  }
+  ESP_LOGI(TAG_LED, "LED count updated: %d", requested_led_count);
   return true;
 }
 
+bool led_effects_set_outputs(const led_output_config_t *configs, uint8_t count) {
+  if (!validate_outputs(configs, count)) {
+    return false;
+  }
+  portENTER_CRITICAL(&outputs_lock);
+  memcpy(pending_outputs, configs, count * sizeof(led_output_config_t));
+  pending_output_count = count;
+  portEXIT_CRITICAL(&outputs_lock);
+  ESP_LOGI(TAG_LED, "LED outputs updated: %u", count);
+  return true;
+}
+
+uint8_t led_effects_get_outputs(led_output_config_t *configs) {
+  portENTER_CRITICAL(&outputs_lock);
+  uint8_t count = pending_output_count;
+  if (count != 0) {
+    memcpy(configs, pending_outputs, count * sizeof(led_output_config_t));
+  } else {
+    count = active_output_count;
+    memcpy(configs, output_configs, count * sizeof(led_output_config_t));
+  }
+  portEXIT_CRITICAL(&outputs_lock);
+  return count;
+}
+
+void led_effects_get_output_stats(led_output_stats_t *stats) {
+  if (stats != NULL) {
+    *stats = output_stats;
+  }
+}
+
 uint16_t led_effects_get_led_count(void) {
   return led_count;
 }
@@ -2695,16 +3665,48 @@ void led_effects_get_config(effect_config_t *config) {
   }
 }
 
+static uint32_t current_anim_frame(void) {
+  return anim_clock_now_ms() / LED_EFFECT_FRAME_MS;
+}
+
+// Called with signal_lock held
+static void apply_smoothed_signals(uint32_t now_ms) {
+  last_vehicle_state.speed_kph       = signal_smoother_value(&speed_smoother, now_ms);
+  last_vehicle_state.rear_power      = signal_smoother_value(&rear_power_smoother, now_ms);
+  last_vehicle_state.front_power     = signal_smoother_value(&front_power_smoother, now_ms);
+  last_vehicle_state.accel_pedal_pos = (uint8_t)lroundf(signal_smoother_value(&pedal_smoother, now_ms));
+}
+
+// Start of a frame: continuous signals at the frame's animation time
+static void refresh_smoothed_signals(uint32_t now_ms) {
+  if (!signals_smoothed) {
+    return;
+  }
+  portENTER_CRITICAL(&signal_lock);
+  apply_smoothed_signals(now_ms);
+  portEXIT_CRITICAL(&signal_lock);
+}
+
+void led_effects_begin_frame(void) {
+  apply_pending_led_buffers();
+  apply_pending_outputs();
+
+  uint32_t now_ms = anim_clock_now_ms();
+  // Frames follow the animation clock: devices sharing it show the same frame.
+  // Each layer measures its elapsed time from its own previous frame (bind_layer_state).
+  frame_time_ms   = now_ms;
+  effect_counter  = now_ms / LED_EFFECT_FRAME_MS;
+  refresh_smoothed_signals(now_ms);
+}
+
 void led_effects_update(void) {
-  led_effects_set_event_context(CAN_EVENT_NONE);
   // Display nothing if config_manager handles active events
   if (config_manager_has_active_events()) {
-    effect_counter++;
     return;
   }
 
   if (!enabled && !ota_progress_mode && !ota_ready_mode && !ota_error_mode) {
-    fill_solid((rgb_t){0, 0, 0});
+    memset(leds, 0, led_count * sizeof(rgb_t));
     led_strip_show();
     return;
   }
@@ -2726,85 +3728,78 @@ void led_effects_update(void) {
       ota_last_progress_refresh = now;
     }
 
-    effect_counter++;
     return;
   }
 
   if (ota_error_mode) {
     render_status_display(true);
     led_strip_show();
-    effect_counter++;
     return;
   }
 
   if (ota_ready_mode) {
     render_status_display(false);
     led_strip_show();
-    effect_counter++;
     return;
   }
 
-  // Mode normal
-  if (current_config.effect == EFFECT_OFF) {
-    fill_solid((rgb_t){0, 0, 0});
-  } else if (current_config.effect < EFFECT_MAX && effect_functions[current_config.effect] != NULL) {
-    // If a segment is defined, render only that segment
-    uint16_t segment_start  = current_config.segment_start;
-    uint16_t segment_length = current_config.segment_length;
-
-    // Normalize segment
-    led_effects_normalize_segment(&segment_start, &segment_length, led_count);
-
-    // Calculate dynamic length based on accel_pedal_pos if enabled
-    if (current_config.accel_pedal_pos_enabled) {
-      segment_length = led_effects_apply_accel_modulation(segment_length, last_vehicle_state.accel_pedal_pos, current_config.accel_pedal_offset);
-    }
-
-    // Optimization: full strip without custom segment
-    if (segment_start == 0 && segment_length == led_count) {
-      effect_functions[current_config.effect]();
-    }
-    // Custom segment or reduced strip
-    else {
-      uint16_t saved_led_count = led_count;
+  // Mode normal: the base effect renders straight into its segment of leds[]
+  uint16_t segment_start  = current_config.segment_start;
+  uint16_t segment_length = current_config.segment_length;
 
-      // Set everything to black first
-      fill_solid((rgb_t){0, 0, 0});
+  // Normalize segment
+  led_effects_normalize_segment(&segment_start, &segment_length, led_count);
 
-      // Work on segment only
-      led_count = segment_length;
-      effect_functions[current_config.effect]();
-
-      // Copy the result into the destination segment
-      rgb_t segment_buffer[MAX_LED_COUNT];
-      for (uint16_t i = 0; i < segment_length; i++) {
-        segment_buffer[i] = leds[i];
-      }
-
-      // Restore led_count and reset everything to black
-      led_count = saved_led_count;
-      fill_solid((rgb_t){0, 0, 0});
-
-      // Apply segment at correct location
-      for (uint16_t i = 0; i < segment_length; i++) {
-        uint16_t idx = segment_start + i;
-        if (idx < led_count) {
-          leds[idx] = segment_buffer[i];
-        }
-      }
-    }
+  // Calculate dynamic length based on accel_pedal_pos if enabled (the state stays sized
+  // for the whole segment, so moving the pedal does not restart the effect)
+  uint16_t segment_capacity = segment_length;
+  if (current_config.accel_pedal_pos_enabled) {
+    segment_length = led_effects_apply_accel_modulation(segment_length, last_vehicle_state.accel_pedal_pos, current_config.accel_pedal_offset);
   }
 
-  led_strip_show();
-  effect_counter++;
+  // LEDs outside the segment stay off
+  uint16_t segment_end = segment_start + segment_length;
+  memset(leds, 0, segment_start * sizeof(rgb_t));
+  memset(leds + segment_end, 0, (led_count - segment_end) * sizeof(rgb_t));
+
+  uint16_t scale = render_layer(&current_config, LED_LAYER_BASE, CAN_EVENT_NONE, effect_counter, leds + segment_start, segment_length, segment_capacity);
+  led_strip_show_scaled(scale);
 }
 
 void led_effects_update_vehicle_state(const vehicle_state_t *state) {
   if (state != NULL) {
+    signals_smoothed = false;
     memcpy(&last_vehicle_state, state, sizeof(vehicle_state_t));
   }
 }
 
+void led_effects_update_vehicle_state_at(const vehicle_state_t *state, uint32_t state_time_ms) {
+  if (state == NULL) {
+    return;
+  }
+
+  uint32_t now_ms = anim_clock_now_ms();
+  portENTER_CRITICAL(&signal_lock);
+  if (!signals_smoothed) {
+    signal_smoother_reset(&speed_smoother);
+    signal_smoother_reset(&rear_power_smoother);
+    signal_smoother_reset(&front_power_smoother);
+    signal_smoother_reset(&pedal_smoother);
+    signals_smoothed = true;
+  }
+  signal_smoother_push(&speed_smoother, state_time_ms, state->speed_kph, now_ms);
+  signal_smoother_push(&rear_power_smoother, state_time_ms, state->rear_power, now_ms);
+  signal_smoother_push(&front_power_smoother, state_time_ms, state->front_power, now_ms);
+  signal_smoother_push(&pedal_smoother, state_time_ms, state->accel_pedal_pos, now_ms);
+  memcpy(&last_vehicle_state, state, sizeof(vehicle_state_t));
+  apply_smoothed_signals(now_ms);
+  portEXIT_CRITICAL(&signal_lock);
+}
+
+uint32_t led_effects_get_signal_snaps(void) {
+  return speed_smoother.snaps + rear_power_smoother.snaps + front_power_smoother.snaps + pedal_smoother.snaps;
+}
+
 void led_effects_start_progress_display(void) {
   ota_ready_mode            = false;
   ota_error_mode            = false;
@@ -2917,69 +3912,65 @@ void led_effects_reset_config(void) {
   ESP_LOGI(TAG_LED, "Configuration reset");
 }
 
+void led_effects_set_random_seed(uint32_t seed) {
+  random_seed = seed;
+  // Running layers restart from the new seed
+  for (int i = 0; i < LED_LAYER_COUNT; i++) {
+    effect_slots[i].effect = EFFECT_OFF;
+  }
+  state_arena_used = 0;
+}
+
 uint32_t led_effects_get_frame_counter(void) {
   return effect_counter;
 }
 
 void led_effects_advance_frame_counter(void) {
-  effect_counter++;
+  effect_counter = current_anim_frame();
 }
 
-void led_effects_render_to_buffer(const effect_config_t *config, uint16_t segment_start, uint16_t segment_length, uint32_t frame_counter, led_rgb_t *out_buffer) {
-  if (config == NULL || out_buffer == NULL) {
+void led_effects_render_layer(const effect_config_t *config, uint8_t layer, uint16_t event, uint32_t frame_counter, led_rgb_t *out, uint16_t count, uint16_t capacity) {
+  if (config == NULL || out == NULL) {
     return;
   }
 
-  // segment_length == 0 signifie "utiliser toute la strip"
-  if (segment_length == 0) {
-    segment_length = led_count;
-  }
-
-  // Valider segment_start
-  if (segment_start >= led_count) {
-    return;
+  can_event_type_t event_type = event < CAN_EVENT_MAX ? (can_event_type_t)event : CAN_EVENT_NONE;
+  uint16_t scale              = render_layer(config, layer, event_type, frame_counter, out, count, capacity);
+  if (scale < 256) {
+    for (uint16_t i = 0; i < count; i++) {
+      out[i] = scale_pixel(out[i], scale);
+    }
   }
+}
 
-  // Adjust length if the segment overflows
-  if ((segment_start + segment_length) > led_count) {
-    segment_length = led_count - segment_start;
+bool led_effects_prepare_layer(const effect_config_t *config, uint8_t layer, uint32_t frame_counter, uint16_t count, uint16_t capacity) {
+  if (config == NULL || layer >= LED_LAYER_COUNT) {
+    return false;
   }
-
-  // Save current state
-  effect_config_t saved_config = current_config;
-  uint16_t saved_led_count     = led_count;
-  uint32_t saved_counter       = effect_counter;
-
-  // Work on segment only
-  led_count                    = segment_length;
-  effect_counter               = frame_counter;
-  current_config               = *config;
-
-  fill_solid((rgb_t){0, 0, 0});
-  if (current_config.effect == EFFECT_OFF) {
-    // rien a faire
-  } else if (current_config.effect < EFFECT_MAX && effect_functions[current_config.effect] != NULL) {
-    effect_functions[current_config.effect]();
+  prepared_layer_t *prepared = &prepared_layers[layer];
+  prepared->ready            = false;
+  prepared->bound            = false;
+  prepared->frame            = frame_counter;
+  if (layer_renders_black(config, count)) {
+    prepared->ready = true;
+    return true;
   }
 
-  for (uint16_t i = 0; i < segment_length; i++) {
-    uint16_t idx = segment_start + i;
-    if (idx >= saved_led_count) {
-      break;
-    }
-    out_buffer[idx].r = leds[i].r;
-    out_buffer[idx].g = leds[i].g;
-    out_buffer[idx].b = leds[i].b;
+  effect_ctx_t ctx = {.config = config, .frame = frame_counter, .stride = 1, .count = count};
+  if (!bind_layer_state(&ctx, layer, config->effect, capacity < count ? count : capacity)) {
+    // Would render from the shared scratch state
+    return false;
   }
-
-  // Restaurer l'etat
-  current_config = saved_config;
-  led_count      = saved_led_count;
-  effect_counter = saved_counter;
+  prepared->dt_ms = ctx.dt_ms;
+  prepared->steps = ctx.steps;
+  prepared->rng   = ctx.rng;
+  prepared->bound = true;
+  prepared->ready = true;
+  return true;
 }
 
 void led_effects_show_buffer(const led_rgb_t *buffer) {
-  if (buffer == NULL) {
+  if (buffer == NULL || leds == NULL) {
     return;
   }
 
@@ -2987,12 +3978,18 @@ void led_effects_show_buffer(const led_rgb_t *buffer) {
     return;
   }
 
-  // Copy the buffer
-  for (uint16_t i = 0; i < led_count; i++) {
-    leds[i].r = buffer[i].r;
-    leds[i].g = buffer[i].g;
-    leds[i].b = buffer[i].b;
+  // Composed straight into the frame buffer: nothing to copy
+  if (buffer != leds) {
+    memcpy(leds, buffer, led_count * sizeof(rgb_t));
   }
 
   led_strip_show();
 }
+
+led_rgb_t *led_effects_get_frame_buffer(void) {
+  return leds;
+}
+
+uint16_t led_effects_get_frame_scale(void) {
+  return frame_scale;
+}
@@ -11,6 +11,7 @@
  * - Boot loop protection (LP SRAM)
  */
 
+#include "anim_clock.h"
 #include "audio_input.h"
 #include "ble_api_service.h"
 #include "boot_loop_guard.h"
@@ -22,6 +23,7 @@
 #include "esp_log.h"
 #include "esp_system.h"
 #include "espnow_link.h"
+#include "frame_scheduler.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "gvret_tcp_server.h" // Optional GVRET TCP service
@@ -30,6 +32,7 @@
 #include "log_stream.h"
 #include "nvs_flash.h"
 #include "ota_update.h"
+#include "render_worker.h"
 #include "reset_button.h"
 #include "sdkconfig.h"
 #include "settings_manager.h"
@@ -46,6 +49,7 @@
 
 #include <stddef.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 // Configuration generated by generate_vehicle_can_config.py
@@ -108,7 +112,10 @@ static void espnow_vehicle_state_rx_handler(const vehicle_state_t *state) {
   // Update the shared state with a local timestamp (ticks) for frontend timeouts
   memcpy(&last_vehicle_state, state, sizeof(vehicle_state_t));
   last_vehicle_state.last_update_ms = xTaskGetTickCount();
-  led_effects_update_vehicle_state(&last_vehicle_state);
+  // Continuous signals are interpolated from the master's capture times
+  uint32_t state_ms                 = anim_clock_now_ms();
+  espnow_link_get_state_change_time_ms(&state_ms);
+  led_effects_update_vehicle_state_at(&last_vehicle_state, state_ms);
   web_server_update_vehicle_state(&last_vehicle_state);
 }
 
@@ -116,15 +123,95 @@ static void espnow_test_frame_log(void) {
   ESP_LOGI(TAG_MAIN, "ESP-NOW: test frame received (DE AD BE EF)");
 }
 
+_Static_assert(sizeof(led_rgb_t) == 3, "pixel offload sends led_rgb_t buffers as packed RGB");
+
+// Master: slave frames resampled from the composed frame, grown to the longest slave strip
+static led_rgb_t *offload_buffer = NULL;
+static uint16_t offload_capacity = 0;
+static uint32_t last_offload_ms  = 0;
+
+// Master: stream the frame just composed (base effect and active events) to each offload
+// slave, resampled to its length, so a slave shows the same turn signals and hazards
+static void send_pixel_offload_frames(void) {
+  const led_rgb_t *frame = led_effects_get_frame_buffer();
+  uint16_t count         = led_effects_get_led_count();
+  uint16_t scale         = led_effects_get_frame_scale(); // Base effect alone: not applied in the buffer
+  espnow_pixel_peer_t peers[ESPNOW_MAX_PEERS];
+  size_t peer_count = espnow_link_get_pixel_peers(peers, ESPNOW_MAX_PEERS);
+  if (peer_count == 0 || frame == NULL || count == 0) {
+    return;
+  }
+
+  uint32_t now_ms = anim_clock_now_ms();
+  if (now_ms - last_offload_ms < ESPNOW_PIXEL_FRAME_MS) {
+    return;
+  }
+  last_offload_ms = now_ms;
+
+  for (size_t i = 0; i < peer_count; i++) {
+    uint16_t len = peers[i].led_count;
+    if (len == 0 || len > MAX_LED_COUNT) {
+      continue;
+    }
+    if (len == count && scale >= 256) {
+      espnow_link_send_pixel_frame(peers[i].mac, (const uint8_t *)frame, len);
+      continue;
+    }
+    if (len > offload_capacity) {
+      led_rgb_t *grown = realloc(offload_buffer, len * sizeof(led_rgb_t));
+      if (grown == NULL) {
+        continue;
+      }
+      offload_buffer   = grown;
+      offload_capacity = len;
+    }
+    // Nearest LED of the master strip, at the brightness it is shown with
+    for (uint16_t j = 0; j < len; j++) {
+      led_rgb_t px        = frame[(uint32_t)j * count / len];
+      offload_buffer[j].r = (uint8_t)((px.r * scale) >> 8);
+      offload_buffer[j].g = (uint8_t)((px.g * scale) >> 8);
+      offload_buffer[j].b = (uint8_t)((px.b * scale) >> 8);
+    }
+    espnow_link_send_pixel_frame(peers[i].mac, (const uint8_t *)offload_buffer, len);
+  }
+}
+
+// Slave: display the last frame streamed by the master
+static void show_pixel_offload_frame(void) {
+  led_rgb_t *frame = led_effects_get_frame_buffer();
+  uint16_t count   = led_effects_get_led_count();
+  uint16_t len     = 0;
+  if (frame != NULL && espnow_link_take_pixel_frame((uint8_t *)frame, count, &len)) {
+    if (len < count) {
+      memset(frame + len, 0, (count - len) * sizeof(led_rgb_t));
+    }
+    led_effects_show_buffer(frame);
+  }
+}
+
 // LED update task
 static void led_task(void *pvParameters) {
   ESP_LOGI(TAG_MAIN, "LED task started");
+  frame_scheduler_init(settings_get_u8("led_fps", FRAME_SCHEDULER_FPS_DEFAULT));
 
   while (1) {
+    frame_scheduler_begin_frame();
+    // Animation time of this frame, shared by the event overlays and the base effect
+    // (also where a new LED count takes effect, so before the offload frames too)
+    led_effects_begin_frame();
+    if (espnow_link_pixel_offload_active()) {
+      show_pixel_offload_frame();
+      frame_scheduler_wait_next();
+      continue;
+    }
+
     // Render event overlays first so led_effects_update can skip/allow base effect correctly.
     config_manager_update(); // Handle temporary effects
     led_effects_update();
-    vTaskDelay(pdMS_TO_TICKS(20)); // 50 FPS
+    if (espnow_link_get_role() == ESP_NOW_ROLE_MASTER) {
+      send_pixel_offload_frames();
+    }
+    frame_scheduler_wait_next();
   }
 }
 
@@ -133,7 +220,7 @@ static void led_task(void *pvParameters) {
   do {                                                                                                                                                                                                 \
     if (prev->field != curr->field) {                                                                                                                                                                  \
       if (curr->field) {                                                                                                                                                                               \
-        config_manager_process_can_event(on_event);                                                                                                                                                    \
+        config_manager_process_can_event_at(on_event, event_ms);                                                                                                                                       \
       } else {                                                                                                                                                                                         \
         config_manager_stop_event(off_event);                                                                                                                                                          \
       }                                                                                                                                                                                                \
@@ -144,7 +231,7 @@ static void led_task(void *pvParameters) {
   do {                                                                                                                                                                                                 \
     if (prev->field != curr->field) {                                                                                                                                                                  \
       if (curr->field) {                                                                                                                                                                               \
-        config_manager_process_can_event(on_event);                                                                                                                                                    \
+        config_manager_process_can_event_at(on_event, event_ms);                                                                                                                                       \
       } else {                                                                                                                                                                                         \
         config_manager_stop_event(on_event);                                                                                                                                                           \
       }                                                                                                                                                                                                \
@@ -156,22 +243,25 @@ static void can_event_task(void *pvParameters) {
   ESP_LOGI(TAG_MAIN, "CAN events task started");
 
   // Use double buffer with pointer swapping to avoid memcpy
-  static vehicle_state_t state_buffer_a  = {0};
-  static vehicle_state_t state_buffer_b  = {0};
-  vehicle_state_t *curr                  = &state_buffer_a;
-  vehicle_state_t *prev                  = &state_buffer_b;
+  static vehicle_state_t state_buffer_a = {0};
+  static vehicle_state_t state_buffer_b = {0};
+  vehicle_state_t *curr                 = &state_buffer_a;
+  vehicle_state_t *prev                 = &state_buffer_b;
 
   // Counter for periodic BLE dashboard updates (send every 200ms = 4 iterations)
   // uint8_t ble_send_counter = 0;
-  TickType_t last_state_send_ticks       = 0;
-  TickType_t last_config_send_ticks      = 0;
-  const TickType_t min_state_send_period = pdMS_TO_TICKS(50);
-  const TickType_t config_send_period    = pdMS_TO_TICKS(2000);
+  TickType_t last_config_send_ticks     = 0;
+  const TickType_t config_send_period   = pdMS_TO_TICKS(2000);
 
   while (1) {
     // Copy current state (still needed once to get latest data)
     memcpy(curr, &last_vehicle_state, sizeof(vehicle_state_t));
 
+    // Start time of the events detected in this pass, on the shared animation clock.
+    // A slave uses the master's time of the change so timed events end together.
+    uint32_t event_ms = anim_clock_now_ms();
+    espnow_link_get_state_change_time_ms(&event_ms);
+
     // Note: handle_wheel_profile_control is called directly in vehicle_can_callback
     // to avoid missing scroll events that bounce quickly back to 0
 
@@ -190,19 +280,19 @@ static void can_event_task(void *pvParameters) {
 
     if (doors_open_left_now != doors_open_left_before) {
       if (doors_open_left_now) {
-        config_manager_process_can_event(CAN_EVENT_DOOR_OPEN_LEFT);
+        config_manager_process_can_event_at(CAN_EVENT_DOOR_OPEN_LEFT, event_ms);
         config_manager_stop_event(CAN_EVENT_DOOR_CLOSE_LEFT);
       } else {
-        config_manager_process_can_event(CAN_EVENT_DOOR_CLOSE_LEFT);
+        config_manager_process_can_event_at(CAN_EVENT_DOOR_CLOSE_LEFT, event_ms);
         config_manager_stop_event(CAN_EVENT_DOOR_OPEN_LEFT);
       }
     }
     if (doors_open_right_now != doors_open_right_before) {
       if (doors_open_right_now) {
-        config_manager_process_can_event(CAN_EVENT_DOOR_OPEN_RIGHT);
+        config_manager_process_can_event_at(CAN_EVENT_DOOR_OPEN_RIGHT, event_ms);
         config_manager_stop_event(CAN_EVENT_DOOR_CLOSE_RIGHT);
       } else {
-        config_manager_process_can_event(CAN_EVENT_DOOR_CLOSE_RIGHT);
+        config_manager_process_can_event_at(CAN_EVENT_DOOR_CLOSE_RIGHT, event_ms);
         config_manager_stop_event(CAN_EVENT_DOOR_OPEN_RIGHT);
       }
     }
@@ -210,10 +300,10 @@ static void can_event_task(void *pvParameters) {
     // Locking
     if (curr->locked != prev->locked) {
       if (curr->locked) {
-        config_manager_process_can_event(CAN_EVENT_LOCKED);
+        config_manager_process_can_event_at(CAN_EVENT_LOCKED, event_ms);
         config_manager_stop_event(CAN_EVENT_UNLOCKED);
       } else {
-        config_manager_process_can_event(CAN_EVENT_UNLOCKED);
+        config_manager_process_can_event_at(CAN_EVENT_UNLOCKED, event_ms);
         config_manager_stop_event(CAN_EVENT_LOCKED);
       }
     }
@@ -221,16 +311,16 @@ static void can_event_task(void *pvParameters) {
     // Transmission
     if (curr->gear != prev->gear) {
       if (curr->gear == 1) {
-        config_manager_process_can_event(CAN_EVENT_GEAR_PARK);
+        config_manager_process_can_event_at(CAN_EVENT_GEAR_PARK, event_ms);
         config_manager_stop_event(CAN_EVENT_GEAR_REVERSE);
         config_manager_stop_event(CAN_EVENT_GEAR_DRIVE);
       } else if (curr->gear == 2) {
-        config_manager_process_can_event(CAN_EVENT_GEAR_REVERSE);
+        config_manager_process_can_event_at(CAN_EVENT_GEAR_REVERSE, event_ms);
         config_manager_stop_event(CAN_EVENT_GEAR_PARK);
         config_manager_stop_event(CAN_EVENT_GEAR_DRIVE);
       } else if (curr->gear == 3) {
       } else if (curr->gear == 4) {
-        config_manager_process_can_event(CAN_EVENT_GEAR_DRIVE);
+        config_manager_process_can_event_at(CAN_EVENT_GEAR_DRIVE, event_ms);
         config_manager_stop_event(CAN_EVENT_GEAR_PARK);
         config_manager_stop_event(CAN_EVENT_GEAR_REVERSE);
       }
@@ -258,7 +348,7 @@ static void can_event_task(void *pvParameters) {
 
     if (curr->sentry_mode != prev->sentry_mode) {
       if (curr->sentry_mode) {
-        config_manager_process_can_event(CAN_EVENT_SENTRY_MODE_ON);
+        config_manager_process_can_event_at(CAN_EVENT_SENTRY_MODE_ON, event_ms);
       } else {
         config_manager_stop_event(CAN_EVENT_SENTRY_MODE_OFF);
       }
@@ -279,10 +369,10 @@ static void can_event_task(void *pvParameters) {
     // 15 "SNA"
     if (curr->autopilot != prev->autopilot) {
       if (curr->autopilot >= 3 && curr->autopilot <= 5) {
-        config_manager_process_can_event(CAN_EVENT_AUTOPILOT_ENGAGED);
+        config_manager_process_can_event_at(CAN_EVENT_AUTOPILOT_ENGAGED, event_ms);
         config_manager_stop_event(CAN_EVENT_AUTOPILOT_DISENGAGED);
       } else if (curr->autopilot == 9) {
-        config_manager_process_can_event(CAN_EVENT_AUTOPILOT_DISENGAGED);
+        config_manager_process_can_event_at(CAN_EVENT_AUTOPILOT_DISENGAGED, event_ms);
         config_manager_stop_event(CAN_EVENT_AUTOPILOT_ENGAGED);
       }
     }
@@ -295,10 +385,10 @@ static void can_event_task(void *pvParameters) {
 
     if (curr->charging_cable != prev->charging_cable) {
       if (curr->charging_cable) {
-        config_manager_process_can_event(CAN_EVENT_CHARGING_CABLE_CONNECTED);
+        config_manager_process_can_event_at(CAN_EVENT_CHARGING_CABLE_CONNECTED, event_ms);
         config_manager_stop_event(CAN_EVENT_CHARGING_CABLE_DISCONNECTED);
       } else {
-        config_manager_process_can_event(CAN_EVENT_CHARGING_CABLE_DISCONNECTED);
+        config_manager_process_can_event_at(CAN_EVENT_CHARGING_CABLE_DISCONNECTED, event_ms);
         config_manager_stop_event(CAN_EVENT_CHARGING_CABLE_CONNECTED);
       }
     }
@@ -308,11 +398,11 @@ static void can_event_task(void *pvParameters) {
       if (curr->charge_status == 3) {
         // config_manager_process_can_event(CAN_EVENT_CHARGING);
       } else if (curr->charge_status == 4) {
-        config_manager_process_can_event(CAN_EVENT_CHARGE_COMPLETE);
+        config_manager_process_can_event_at(CAN_EVENT_CHARGE_COMPLETE, event_ms);
       } else if (curr->charge_status == 5) {
-        config_manager_process_can_event(CAN_EVENT_CHARGING_STARTED);
+        config_manager_process_can_event_at(CAN_EVENT_CHARGING_STARTED, event_ms);
       } else if (curr->charge_status == 1) {
-        config_manager_process_can_event(CAN_EVENT_CHARGING_STOPPED);
+        config_manager_process_can_event_at(CAN_EVENT_CHARGING_STOPPED, event_ms);
       } else {
         config_manager_stop_event(CAN_EVENT_CHARGING);
         config_manager_stop_event(CAN_EVENT_CHARGE_COMPLETE);
@@ -324,7 +414,7 @@ static void can_event_task(void *pvParameters) {
     // Speed threshold
     if (curr->speed_kph != prev->speed_kph || curr->speed_limit != prev->speed_limit) {
       if (curr->speed_kph > curr->speed_limit) {
-        config_manager_process_can_event(CAN_EVENT_SPEED_THRESHOLD);
+        config_manager_process_can_event_at(CAN_EVENT_SPEED_THRESHOLD, event_ms);
       } else {
         config_manager_stop_event(CAN_EVENT_SPEED_THRESHOLD);
       }
@@ -403,12 +493,10 @@ static void can_event_task(void *pvParameters) {
     }
     // }
 
-    TickType_t now = xTaskGetTickCount();
-    if (vehicle_can_state_dirty_get() && (now - last_state_send_ticks) >= min_state_send_period) {
-      vehicle_can_state_dirty_clear();
-      espnow_link_send_vehicle_state(prev); // Use prev since we swapped
-      last_state_send_ticks = now;
-    }
+    // Every pass: the ESP-NOW scheduler rate-limits each send class itself, so
+    // critical edges are not held back behind changes of slow values
+    vehicle_can_state_dirty_clear();
+    espnow_link_send_vehicle_state(prev, event_ms); // Use prev since we swapped
 
     vTaskDelay(pdMS_TO_TICKS(25)); // Check every 50 ms
   }
@@ -535,7 +623,8 @@ static void monitor_task(void *pvParameters) {
  *    - EXAMPLES: Temporary BLE buffers
  *
  * CHOICE RULES:
- * - LED/RMT buffers: always malloc() (DMA incompatible with PSRAM)
+ * - LED/RMT buffers: internal RAM for the wire buffers (read by the RMT driver);
+ *   composition and effect state in PSRAM when available (led_effects.c)
  * - Config profiles: malloc() (frequent access, small size)
  * - JSON buffers > 4KB: heap_caps_malloc(PSRAM) when available
  * - BLE buffers: heap_caps_malloc(DEFAULT) for compatibility
@@ -732,6 +821,10 @@ void app_main(void) {
   }
   ESP_LOGI(TAG_MAIN, "LEDs initialized");
 
+  // Layer rendering on the second core (dual-core targets, optional)
+  render_worker_set_enabled(settings_get_bool("led_dual_core", false));
+  render_worker_init();
+
   // Configuration manager
   if (!config_manager_init()) {
     ESP_LOGE(TAG_MAIN, "Configuration manager initialization error");
@@ -796,6 +889,9 @@ void app_main(void) {
 
   ESP_ERROR_CHECK(espnow_link_init(espnow_role, espnow_type));
   ESP_LOGI(TAG_MAIN, "ESPNow initialized");
+  if (espnow_role == ESP_NOW_ROLE_SLAVE && settings_get_u8("espnow_offload", 0)) {
+    espnow_link_set_pixel_offload(true, led_effects_get_led_count());
+  }
 
   // Web server
   ESP_ERROR_CHECK(web_server_init());
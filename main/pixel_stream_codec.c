@@ -0,0 +1,210 @@
+#include "pixel_stream_codec.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#define TOKEN_BUFFER_SIZE 256 // Larger than an ESP-NOW payload
+
+static const char *const s_encoding_names[PIXEL_ENC_COUNT] = {
+    [PIXEL_ENC_RAW]         = "raw",
+    [PIXEL_ENC_PALETTE_RLE] = "palette_rle",
+    [PIXEL_ENC_DELTA]       = "delta",
+};
+
+static inline bool same_color(const uint8_t *a, const uint8_t *b) {
+  return a[0] == b[0] && a[1] == b[1] && a[2] == b[2];
+}
+
+static int encode_raw(const uint8_t *px, uint16_t avail, uint8_t *out, size_t out_size, uint16_t *encoded) {
+  uint16_t n = (uint16_t)(out_size / 3 < avail ? out_size / 3 : avail);
+  memcpy(out, px, n * 3u);
+  *encoded = n;
+  return n * 3;
+}
+
+static int encode_palette_rle(const uint8_t *px, uint16_t avail, uint8_t *out, size_t out_size, uint16_t *encoded) {
+  uint8_t palette[PIXEL_STREAM_PALETTE_SIZE * 3];
+  uint8_t tokens[TOKEN_BUFFER_SIZE];
+  uint8_t palette_count = 0;
+  size_t token_count    = 0;
+  uint8_t run_index     = 0;
+  uint8_t run_length    = 0;
+  uint16_t i            = 0;
+
+  for (; i < avail; i++) {
+    const uint8_t *color = px + i * 3;
+    int index            = -1;
+    for (int p = 0; p < palette_count; p++) {
+      if (same_color(palette + p * 3, color)) {
+        index = p;
+        break;
+      }
+    }
+
+    if (index >= 0 && token_count > 0 && index == run_index && run_length < PIXEL_STREAM_MAX_RUN) {
+      tokens[token_count - 1]++;
+      run_length++;
+      continue;
+    }
+
+    // New token, and a new palette entry for an unknown color
+    size_t palette_bytes = (size_t)(palette_count + (index < 0 ? 1 : 0)) * 3;
+    if (1 + palette_bytes + token_count + 1 > out_size || token_count >= sizeof(tokens)) {
+      break;
+    }
+    if (index < 0) {
+      if (palette_count == PIXEL_STREAM_PALETTE_SIZE) {
+        break;
+      }
+      memcpy(palette + palette_count * 3, color, 3);
+      index = palette_count++;
+    }
+    tokens[token_count++] = (uint8_t)(index << 4);
+    run_index             = (uint8_t)index;
+    run_length            = 1;
+  }
+
+  out[0] = palette_count;
+  memcpy(out + 1, palette, palette_count * 3u);
+  memcpy(out + 1 + palette_count * 3, tokens, token_count);
+  *encoded = i;
+  return (int)(1 + palette_count * 3 + token_count);
+}
+
+static int encode_delta(const uint8_t *px, const uint8_t *prev, uint16_t avail, uint8_t *out, size_t out_size, uint16_t *encoded) {
+  size_t pos = 0;
+  uint16_t i = 0;
+
+  while (i < avail && pos < out_size) {
+    uint16_t run = 1;
+    if (same_color(px + i * 3, prev + i * 3)) {
+      while (i + run < avail && run < PIXEL_STREAM_MAX_DELTA_TOKEN && same_color(px + (i + run) * 3, prev + (i + run) * 3)) {
+        run++;
+      }
+      out[pos++] = (uint8_t)(run - 1);
+      i += run;
+      continue;
+    }
+
+    while (i + run < avail && run < PIXEL_STREAM_MAX_DELTA_TOKEN && !same_color(px + (i + run) * 3, prev + (i + run) * 3)) {
+      run++;
+    }
+    uint16_t fit = (uint16_t)((out_size - pos - 1) / 3);
+    if (fit == 0) {
+      break;
+    }
+    if (run > fit) {
+      run = fit;
+    }
+    out[pos++] = (uint8_t)(0x80 | (run - 1));
+    memcpy(out + pos, px + i * 3, run * 3u);
+    pos += run * 3u;
+    i += run;
+  }
+
+  *encoded = i;
+  return (int)pos;
+}
+
+int pixel_stream_encode_chunk(const uint8_t *frame, const uint8_t *prev, uint16_t first, uint16_t count, uint8_t *out, size_t out_size, uint16_t *encoded, pixel_stream_encoding_t *encoding) {
+  if (!frame || !out || !encoded || !encoding || first >= count || out_size < 3) {
+    return -1;
+  }
+
+  const uint8_t *px = frame + first * 3;
+  uint16_t avail    = count - first;
+  uint8_t scratch[TOKEN_BUFFER_SIZE];
+  if (out_size > sizeof(scratch)) {
+    out_size = sizeof(scratch);
+  }
+
+  // Raw is the baseline; an alternative wins with more LEDs, or as many in fewer bytes
+  uint16_t best_leds = 0;
+  int best_len       = encode_raw(px, avail, out, out_size, &best_leds);
+  *encoding          = PIXEL_ENC_RAW;
+
+  for (int enc = PIXEL_ENC_PALETTE_RLE; enc < PIXEL_ENC_COUNT; enc++) {
+    if (enc == PIXEL_ENC_DELTA && !prev) {
+      continue;
+    }
+    uint16_t leds = 0;
+    int len       = enc == PIXEL_ENC_DELTA ? encode_delta(px, prev + first * 3, avail, scratch, out_size, &leds) : encode_palette_rle(px, avail, scratch, out_size, &leds);
+    if (leds > best_leds || (leds == best_leds && len < best_len)) {
+      memcpy(out, scratch, (size_t)len);
+      best_leds = leds;
+      best_len  = len;
+      *encoding = (pixel_stream_encoding_t)enc;
+    }
+  }
+
+  if (best_leds == 0) {
+    return -1;
+  }
+  *encoded = best_leds;
+  return best_len;
+}
+
+int pixel_stream_decode_chunk(pixel_stream_encoding_t encoding, const uint8_t *in, size_t len, uint8_t *frame, uint16_t first, uint16_t led_count) {
+  if (!in || !frame) {
+    return -1;
+  }
+
+  uint8_t *px = frame + first * 3;
+  uint16_t i  = 0;
+
+  switch (encoding) {
+  case PIXEL_ENC_RAW:
+    if (len != led_count * 3u) {
+      return -1;
+    }
+    memcpy(px, in, len);
+    return 0;
+
+  case PIXEL_ENC_PALETTE_RLE: {
+    if (len < 1 || in[0] > PIXEL_STREAM_PALETTE_SIZE || len < 1 + in[0] * 3u) {
+      return -1;
+    }
+    uint8_t palette_count = in[0];
+    const uint8_t *tokens = in + 1 + palette_count * 3;
+    size_t token_count    = len - 1 - palette_count * 3u;
+    for (size_t t = 0; t < token_count; t++) {
+      uint8_t index = tokens[t] >> 4;
+      uint8_t run   = (tokens[t] & 0x0F) + 1;
+      if (index >= palette_count || i + run > led_count) {
+        return -1;
+      }
+      for (uint8_t r = 0; r < run; r++, i++) {
+        memcpy(px + i * 3, in + 1 + index * 3, 3);
+      }
+    }
+    return i == led_count ? 0 : -1;
+  }
+
+  case PIXEL_ENC_DELTA: {
+    size_t pos = 0;
+    while (pos < len) {
+      uint8_t token = in[pos++];
+      uint16_t run  = (token & 0x7F) + 1;
+      if (i + run > led_count) {
+        return -1;
+      }
+      if (token & 0x80) {
+        if (pos + run * 3u > len) {
+          return -1;
+        }
+        memcpy(px + i * 3, in + pos, run * 3u);
+        pos += run * 3u;
+      }
+      i += run;
+    }
+    return i == led_count ? 0 : -1;
+  }
+
+  default:
+    return -1;
+  }
+}
+
+const char *pixel_stream_encoding_name(pixel_stream_encoding_t encoding) {
+  return encoding < PIXEL_ENC_COUNT ? s_encoding_names[encoding] : "unknown";
+}
@@ -0,0 +1,120 @@
+#include "render_worker.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "task_core_utils.h"
+
+#include <string.h>
+
+static const char *TAG = "RENDER_WORKER";
+
+// Same priority as the LED task: the share of a frame is due by the same deadline
+#define RENDER_WORKER_PRIORITY 5
+#define RENDER_WORKER_STACK 4096
+
+static render_worker_stats_t s_stats;
+static portMUX_TYPE s_lock           = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t s_task           = NULL;
+static SemaphoreHandle_t s_start_sem = NULL; // Given by the LED task for each job
+static SemaphoreHandle_t s_done_sem  = NULL; // Given by the worker when the job is done
+static volatile bool s_enabled       = false;
+static render_worker_job_t s_job     = NULL;
+static void *s_job_arg               = NULL;
+static bool s_pending                = false; // A job is on the worker, not waited for yet
+static volatile uint32_t s_job_us    = 0;
+
+static void render_worker_task(void *arg) {
+  (void)arg;
+  while (1) {
+    xSemaphoreTake(s_start_sem, portMAX_DELAY);
+    int64_t start_us = esp_timer_get_time();
+    s_job(s_job_arg);
+    s_job_us = (uint32_t)(esp_timer_get_time() - start_us);
+    xSemaphoreGive(s_done_sem);
+  }
+}
+
+esp_err_t render_worker_init(void) {
+#if CONFIG_FREERTOS_UNICORE
+  ESP_LOGI(TAG, "Single core: layers render on the LED task");
+  return ESP_ERR_NOT_SUPPORTED;
+#else
+  if (s_task != NULL) {
+    return ESP_OK;
+  }
+  s_start_sem = xSemaphoreCreateBinary();
+  s_done_sem  = xSemaphoreCreateBinary();
+  if (s_start_sem == NULL || s_done_sem == NULL) {
+    ESP_LOGE(TAG, "Error creating the worker semaphores");
+    return ESP_ERR_NO_MEM;
+  }
+  if (create_task_on_general_core(render_worker_task, "render_worker", RENDER_WORKER_STACK, NULL, RENDER_WORKER_PRIORITY, &s_task) != pdPASS) {
+    ESP_LOGE(TAG, "Error creating the worker task");
+    s_task = NULL;
+    return ESP_FAIL;
+  }
+  ESP_LOGI(TAG, "Render worker on core %d (split %s)", GENERAL_TASK_CORE, s_enabled ? "on" : "off");
+  return ESP_OK;
+#endif
+}
+
+void render_worker_set_enabled(bool enabled) {
+  if (enabled != s_enabled) {
+    ESP_LOGI(TAG, "Dual-core rendering: %s", enabled ? "on" : "off");
+  }
+  s_enabled = enabled;
+}
+
+bool render_worker_is_enabled(void) {
+  return s_enabled;
+}
+
+bool render_worker_active(void) {
+  return s_enabled && s_task != NULL;
+}
+
+void render_worker_start(render_worker_job_t job, void *arg) {
+  if (!render_worker_active()) {
+    job(arg);
+    return;
+  }
+  s_job     = job;
+  s_job_arg = arg;
+  s_pending = true;
+  xSemaphoreGive(s_start_sem);
+}
+
+void render_worker_wait(void) {
+  if (!s_pending) {
+    return;
+  }
+  int64_t wait_start_us = esp_timer_get_time();
+  xSemaphoreTake(s_done_sem, portMAX_DELAY);
+  uint32_t wait_us = (uint32_t)(esp_timer_get_time() - wait_start_us);
+  s_pending        = false;
+
+  portENTER_CRITICAL(&s_lock);
+  s_stats.frames++;
+  s_stats.worker_us_last = s_job_us;
+  if (s_job_us > s_stats.worker_us_max) {
+    s_stats.worker_us_max = s_job_us;
+  }
+  s_stats.worker_us_total += s_job_us;
+  if (wait_us > s_stats.wait_us_max) {
+    s_stats.wait_us_max = wait_us;
+  }
+  s_stats.wait_us_total += wait_us;
+  portEXIT_CRITICAL(&s_lock);
+}
+
+void render_worker_get_stats(render_worker_stats_t *stats) {
+  if (stats == NULL) {
+    return;
+  }
+  portENTER_CRITICAL(&s_lock);
+  *stats = s_stats;
+  portEXIT_CRITICAL(&s_lock);
+}
@@ -30,6 +30,9 @@ static bool s_batch_dirty                       = false;
 static const system_settings_t DEFAULT_SETTINGS = {
     .active_profile_id         = -1,
     .led_count                 = 122, // NUM_LEDS by default
+    .led_output_count          = 0,
+    .led_fps                   = 50, // FRAME_SCHEDULER_FPS_DEFAULT
+    .led_dual_core             = false,
     .wheel_control_enabled     = false,
     .wheel_control_speed_limit = 5,
     .gvret_autostart           = false,
@@ -94,6 +97,32 @@ esp_err_t settings_manager_load(system_settings_t *settings) {
   item                                = cJSON_GetObjectItem(root, "led_count");
   settings->led_count                 = item ? (uint16_t)item->valueint : DEFAULT_SETTINGS.led_count;
 
+  item                                = cJSON_GetObjectItem(root, "led_fps");
+  settings->led_fps                   = item ? (uint8_t)item->valueint : DEFAULT_SETTINGS.led_fps;
+
+  item                                = cJSON_GetObjectItem(root, "led_dual_core");
+  settings->led_dual_core             = item ? cJSON_IsTrue(item) : DEFAULT_SETTINGS.led_dual_core;
+
+  item                                = cJSON_GetObjectItem(root, "led_outputs");
+  settings->led_output_count          = 0;
+  if (cJSON_IsArray(item)) {
+    cJSON *output;
+    cJSON_ArrayForEach(output, item) {
+      if (settings->led_output_count >= LED_OUTPUT_MAX) {
+        break;
+      }
+      led_output_config_t *config = &settings->led_outputs[settings->led_output_count++];
+      cJSON *field                = cJSON_GetObjectItem(output, "gpio");
+      config->gpio                = field ? (uint8_t)field->valueint : LED_PIN;
+      field                       = cJSON_GetObjectItem(output, "order");
+      config->color_order         = field ? (uint8_t)field->valueint : LED_COLOR_ORDER_GRB;
+      field                       = cJSON_GetObjectItem(output, "start");
+      config->start               = field ? (uint16_t)field->valueint : 0;
+      field                       = cJSON_GetObjectItem(output, "count");
+      config->count               = field ? (uint16_t)field->valueint : 0;
+    }
+  }
+
   item                                = cJSON_GetObjectItem(root, "wheel_control_enabled");
   settings->wheel_control_enabled     = item ? cJSON_IsTrue(item) : DEFAULT_SETTINGS.wheel_control_enabled;
 
@@ -128,6 +157,19 @@ esp_err_t settings_manager_save(const system_settings_t *settings) {
 
   cJSON_AddNumberToObject(root, "active_profile_id", settings->active_profile_id);
   cJSON_AddNumberToObject(root, "led_count", settings->led_count);
+  cJSON_AddNumberToObject(root, "led_fps", settings->led_fps);
+  cJSON_AddBoolToObject(root, "led_dual_core", settings->led_dual_core);
+  if (settings->led_output_count > 0) {
+    cJSON *outputs = cJSON_AddArrayToObject(root, "led_outputs");
+    for (int i = 0; i < settings->led_output_count && i < LED_OUTPUT_MAX; i++) {
+      cJSON *output = cJSON_CreateObject();
+      cJSON_AddNumberToObject(output, "gpio", settings->led_outputs[i].gpio);
+      cJSON_AddNumberToObject(output, "order", settings->led_outputs[i].color_order);
+      cJSON_AddNumberToObject(output, "start", settings->led_outputs[i].start);
+      cJSON_AddNumberToObject(output, "count", settings->led_outputs[i].count);
+      cJSON_AddItemToArray(outputs, output);
+    }
+  }
   cJSON_AddBoolToObject(root, "wheel_control_enabled", settings->wheel_control_enabled);
   cJSON_AddNumberToObject(root, "wheel_control_speed_limit", settings->wheel_control_speed_limit);
   cJSON_AddBoolToObject(root, "gvret_autostart", settings->gvret_autostart);
@@ -202,6 +244,8 @@ uint8_t settings_get_u8(const char *key, uint8_t default_value) {
     return s_settings.espnow_role;
   } else if (strcmp(key, "espnow_type") == 0) {
     return s_settings.espnow_type;
+  } else if (strcmp(key, "led_fps") == 0) {
+    return s_settings.led_fps;
   }
 
   return default_value;
@@ -218,6 +262,8 @@ esp_err_t settings_set_u8(const char *key, uint8_t value) {
     s_settings.espnow_role = value;
   } else if (strcmp(key, "espnow_type") == 0) {
     s_settings.espnow_type = value;
+  } else if (strcmp(key, "led_fps") == 0) {
+    s_settings.led_fps = value;
   } else {
     return ESP_ERR_NOT_FOUND;
   }
@@ -263,6 +309,35 @@ esp_err_t settings_set_u16(const char *key, uint16_t value) {
   return ESP_ERR_NOT_FOUND;
 }
 
+uint8_t settings_get_led_outputs(led_output_config_t *outputs) {
+  if (!s_settings_loaded) {
+    return 0;
+  }
+
+  memcpy(outputs, s_settings.led_outputs, s_settings.led_output_count * sizeof(led_output_config_t));
+  return s_settings.led_output_count;
+}
+
+esp_err_t settings_set_led_outputs(const led_output_config_t *outputs, uint8_t count) {
+  if (!s_settings_loaded) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  if (count > LED_OUTPUT_MAX) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  memcpy(s_settings.led_outputs, outputs, count * sizeof(led_output_config_t));
+  s_settings.led_output_count = count;
+
+  // In batch mode, defer save
+  if (s_batch_mode) {
+    s_batch_dirty = true;
+    return ESP_OK;
+  }
+
+  return settings_manager_save(&s_settings);
+}
+
 bool settings_get_bool(const char *key, bool default_value) {
   if (!s_settings_loaded) {
     return default_value;
@@ -274,6 +349,8 @@ bool settings_get_bool(const char *key, bool default_value) {
     return s_settings.gvret_autostart;
   } else if (strcmp(key, "canserver_autostart") == 0) {
     return s_settings.canserver_autostart;
+  } else if (strcmp(key, "led_dual_core") == 0) {
+    return s_settings.led_dual_core;
   }
 
   return default_value;
@@ -290,6 +367,8 @@ esp_err_t settings_set_bool(const char *key, bool value) {
     s_settings.gvret_autostart = value;
   } else if (strcmp(key, "canserver_autostart") == 0) {
     s_settings.canserver_autostart = value;
+  } else if (strcmp(key, "led_dual_core") == 0) {
+    s_settings.led_dual_core = value;
   } else {
     return ESP_ERR_NOT_FOUND;
   }
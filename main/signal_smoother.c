@@ -0,0 +1,97 @@
+#include "signal_smoother.h"
+
+#include <math.h>
+#include <string.h>
+
+void signal_smoother_init(signal_smoother_t *smoother, float snap_threshold, float min_value, float max_value) {
+  memset(smoother, 0, sizeof(*smoother));
+  smoother->snap_threshold = snap_threshold;
+  smoother->min_value      = min_value;
+  smoother->max_value      = max_value;
+}
+
+void signal_smoother_reset(signal_smoother_t *smoother) {
+  smoother->count = 0;
+}
+
+static void append(signal_smoother_t *smoother, uint32_t time_ms, float value) {
+  if (smoother->count == SIGNAL_SMOOTHER_HISTORY) {
+    memmove(smoother->time_ms, smoother->time_ms + 1, (SIGNAL_SMOOTHER_HISTORY - 1) * sizeof(smoother->time_ms[0]));
+    memmove(smoother->value, smoother->value + 1, (SIGNAL_SMOOTHER_HISTORY - 1) * sizeof(smoother->value[0]));
+    smoother->count--;
+  }
+  smoother->time_ms[smoother->count] = time_ms;
+  smoother->value[smoother->count]   = value;
+  smoother->count++;
+}
+
+void signal_smoother_push(signal_smoother_t *smoother, uint32_t time_ms, float value, uint32_t now_ms) {
+  if (smoother->count == 0) {
+    append(smoother, now_ms - SIGNAL_SMOOTHER_DELAY_MS, value);
+    return;
+  }
+
+  uint8_t last = smoother->count - 1;
+  if (value == smoother->value[last]) {
+    return;
+  }
+
+  if (fabsf(value - signal_smoother_value(smoother, now_ms)) > smoother->snap_threshold) {
+    // Large change: shown now rather than SIGNAL_SMOOTHER_DELAY_MS late
+    smoother->count = 0;
+    smoother->snaps++;
+    append(smoother, now_ms - SIGNAL_SMOOTHER_DELAY_MS, value);
+    return;
+  }
+
+  int32_t elapsed = (int32_t)(time_ms - smoother->time_ms[last]);
+  if (elapsed <= 0) {
+    // Same capture (or out of order): the newest value wins
+    smoother->value[last] = value;
+    return;
+  }
+  if (elapsed > SIGNAL_SMOOTHER_INTERVAL_MS * 3 / 2) {
+    // Only changes are sent: the previous value held until the send before this one
+    append(smoother, time_ms - SIGNAL_SMOOTHER_INTERVAL_MS, smoother->value[last]);
+  }
+  append(smoother, time_ms, value);
+}
+
+float signal_smoother_value(const signal_smoother_t *smoother, uint32_t now_ms) {
+  if (smoother->count == 0) {
+    return 0.0f;
+  }
+
+  uint32_t render_ms = now_ms - SIGNAL_SMOOTHER_DELAY_MS;
+  uint8_t last       = smoother->count - 1;
+  float value        = smoother->value[last];
+
+  if ((int32_t)(render_ms - smoother->time_ms[0]) <= 0) {
+    value = smoother->value[0];
+  } else if ((int32_t)(render_ms - smoother->time_ms[last]) < 0) {
+    for (uint8_t i = 1; i <= last; i++) {
+      if ((int32_t)(render_ms - smoother->time_ms[i]) < 0) {
+        float span = (float)(smoother->time_ms[i] - smoother->time_ms[i - 1]);
+        float t    = (float)(render_ms - smoother->time_ms[i - 1]) / span;
+        value      = smoother->value[i - 1] + (smoother->value[i] - smoother->value[i - 1]) * t;
+        break;
+      }
+    }
+  } else if (last > 0) {
+    // Next sample late: continue the trend for a while, then return to the last value
+    uint32_t span = smoother->time_ms[last] - smoother->time_ms[last - 1];
+    uint32_t late = render_ms - smoother->time_ms[last];
+    if (span <= SIGNAL_SMOOTHER_INTERVAL_MS * 3 / 2 && late < 2 * SIGNAL_SMOOTHER_EXTRAPOLATE_MS) {
+      float slope   = (smoother->value[last] - smoother->value[last - 1]) / (float)span;
+      uint32_t step = late <= SIGNAL_SMOOTHER_EXTRAPOLATE_MS ? late : 2 * SIGNAL_SMOOTHER_EXTRAPOLATE_MS - late;
+      value += slope * (float)step;
+    }
+  }
+
+  if (value < smoother->min_value) {
+    value = smoother->min_value;
+  } else if (value > smoother->max_value) {
+    value = smoother->max_value;
+  }
+  return value;
+}
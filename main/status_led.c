@@ -9,16 +9,6 @@
 
 #include <math.h>
 
-// GPIO for the status LED (integrated WS2812)
-#if CONFIG_IDF_TARGET_ESP32S3
-#define STATUS_LED_GPIO 21
-#elif CONFIG_IDF_TARGET_ESP32C6
-// Disabled on C6 to free RMT for the main LED strip
-#define STATUS_LED_GPIO 8 // No LED on other boards
-#else
-#define STATUS_LED_GPIO -1 // No LED on other boards
-#endif
-
 #define STATUS_LED_MEM_BLOCK_SYMBOLS 48
 
 #define STATUS_LED_RMT_RESOLUTION 10000000 // 10MHz
@@ -156,6 +156,64 @@ void vehicle_can_process_frame_static(const can_frame_t *frame, vehicle_state_t
   state->last_update_ms = frame->timestamp_ms;
 }
 
+// ---------------------------------------------------------------------------
+// Single signal access (live signal watch)
+// ---------------------------------------------------------------------------
+
+esp_err_t vehicle_can_find_signal(const char *name, uint16_t *msg_index, uint8_t *sig_index) {
+  if (!name || !msg_index || !sig_index) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  // "Message.Signal" restricts the search to one message
+  const char *sig_name = name;
+  size_t msg_name_len  = 0;
+  const char *dot      = strchr(name, '.');
+  if (dot) {
+    msg_name_len = (size_t)(dot - name);
+    sig_name     = dot + 1;
+  }
+
+  for (uint16_t m = 0; m < g_can_message_count; m++) {
+    const can_message_def_t *msg = &g_can_messages[m];
+    if (msg_name_len > 0 && (strncmp(msg->name, name, msg_name_len) != 0 || msg->name[msg_name_len] != '\0')) {
+      continue;
+    }
+    for (uint8_t i = 0; i < msg->signal_count; i++) {
+      if (strcmp(msg->signals[i].name, sig_name) == 0) {
+        *msg_index = m;
+        *sig_index = i;
+        return ESP_OK;
+      }
+    }
+  }
+  return ESP_ERR_NOT_FOUND;
+}
+
+bool vehicle_can_decode_signal(const can_message_def_t *msg, uint8_t sig_index, const uint8_t *data, uint8_t dlc, float *value) {
+  if (!msg || sig_index >= msg->signal_count || !data || !value) {
+    return false;
+  }
+
+  const can_signal_def_t *sig = &msg->signals[sig_index];
+  if (sig->mux_type == SIGNAL_MUX_MULTIPLEXED) {
+    // Only present in frames carrying its multiplexer value
+    bool mux_match = false;
+    for (uint8_t i = 0; i < msg->signal_count; i++) {
+      if (msg->signals[i].mux_type == SIGNAL_MUX_MULTIPLEXER) {
+        mux_match = decode_signal_raw(&msg->signals[i], data, dlc) == sig->mux_value;
+        break;
+      }
+    }
+    if (!mux_match) {
+      return false;
+    }
+  }
+
+  *value = decode_signal_value(sig, data, dlc);
+  return true;
+}
+
 // ---------------------------------------------------------------------------
 // Conversion to BLE CONFIG format
 // ---------------------------------------------------------------------------
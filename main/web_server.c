@@ -12,9 +12,12 @@
 
 #include "web_server.h"
 
+#include "anim_clock.h"
 #include "audio_input.h"
 #include "cJSON.h"
 #include "can_bus.h"
+#include "can_frame_hub.h"
+#include "can_signal_watch.h"
 #include "canserver_udp_server.h" // For the CANServer UDP service
 #include "config.h"
 #include "config_manager.h"
@@ -24,11 +27,14 @@
 #include "esp_system.h"
 #include "esp_timer.h"
 #include "espnow_link.h"
+#include "espnow_state_codec.h"
+#include "frame_scheduler.h"
 #include "gvret_tcp_server.h" // For the GVRET TCP service
 #include "led_effects.h"
 #include "log_stream.h" // For real-time log streaming
 #include "nvs_flash.h"
 #include "ota_update.h"
+#include "render_worker.h"
 #include "settings_manager.h"
 #include "spiffs_storage.h"
 #include "vehicle_can_unified.h"
@@ -54,7 +60,7 @@
 
 // System limit constants
 #define LED_COUNT_MIN 1
-#define LED_COUNT_MAX 200
+#define LED_COUNT_MAX MAX_LED_COUNT
 #define MAX_CONTENT_LENGTH 4096
 
 // Timing constants
@@ -64,7 +70,7 @@
 #define RETRY_DELAY_MAX_MS 500
 
 // Server configuration constants
-#define HTTP_MAX_URI_HANDLERS 60
+#define HTTP_MAX_URI_HANDLERS 64
 #define HTTP_MAX_OPEN_SOCKETS 13
 
 // Default configuration constants
@@ -353,6 +359,69 @@ static esp_err_t status_handler(httpd_req_t *req) {
   cJSON_AddNumberToObject(can_chassis, "er", can_chassis_status.errors);
   cJSON_AddItemToObject(root, "cbc", can_chassis);
 
+  // LED output timing
+  led_output_stats_t output_stats;
+  led_effects_get_output_stats(&output_stats);
+  cJSON *led_out = cJSON_CreateObject();
+  cJSON_AddNumberToObject(led_out, "frames", output_stats.frames);
+  cJSON_AddNumberToObject(led_out, "wire_us", output_stats.wire_us);
+  cJSON_AddNumberToObject(led_out, "wire_fps_max", output_stats.wire_us ? 1000000 / output_stats.wire_us : 0);
+  cJSON_AddNumberToObject(led_out, "fps", output_stats.interval_us_total ? (double)output_stats.frames * 1000000.0 / (double)output_stats.interval_us_total : 0);
+  cJSON_AddNumberToObject(led_out, "interval_min_us", output_stats.interval_us_min);
+  cJSON_AddNumberToObject(led_out, "interval_max_us", output_stats.interval_us_max);
+  cJSON_AddNumberToObject(led_out, "waits", output_stats.waits);
+  cJSON_AddNumberToObject(led_out, "wait_max_us", output_stats.wait_us_max);
+  cJSON_AddNumberToObject(led_out, "timeouts", output_stats.timeouts);
+  uint32_t shown = output_stats.frames + output_stats.suppressed;
+  cJSON_AddNumberToObject(led_out, "suppressed", output_stats.suppressed);
+  cJSON_AddNumberToObject(led_out, "tx_skip_pct", shown ? 100.0 * output_stats.suppressed / shown : 0);
+  uint32_t layers = output_stats.layers_rendered + output_stats.layers_reused;
+  cJSON_AddNumberToObject(led_out, "layers_reused", output_stats.layers_reused);
+  cJSON_AddNumberToObject(led_out, "render_skip_pct", layers ? 100.0 * output_stats.layers_reused / layers : 0);
+  cJSON_AddItemToObject(root, "led_out", led_out);
+
+  // Frame scheduling
+  frame_scheduler_stats_t frame_stats;
+  frame_scheduler_get_stats(&frame_stats);
+  cJSON *frames = cJSON_CreateObject();
+  cJSON_AddNumberToObject(frames, "target_fps", frame_stats.target_fps);
+  cJSON_AddNumberToObject(frames, "period_us", frame_stats.period_us);
+  cJSON_AddNumberToObject(frames, "frames", frame_stats.frames);
+  cJSON_AddNumberToObject(frames, "fps", frame_stats.interval_us_total ? (double)(frame_stats.frames - 1) * 1000000.0 / (double)frame_stats.interval_us_total : 0);
+  cJSON_AddNumberToObject(frames, "overruns", frame_stats.overruns);
+  cJSON_AddNumberToObject(frames, "skipped", frame_stats.skipped);
+  cJSON_AddNumberToObject(frames, "frame_us", frame_stats.frame_us_last);
+  cJSON_AddNumberToObject(frames, "frame_max_us", frame_stats.frame_us_max);
+  cJSON_AddNumberToObject(frames, "frame_avg_us", frame_stats.frames ? (double)frame_stats.frame_us_total / frame_stats.frames : 0);
+  cJSON_AddNumberToObject(frames, "interval_max_us", frame_stats.interval_us_max);
+  cJSON *hist_bounds = cJSON_AddArrayToObject(frames, "hist_bounds_us");
+  cJSON *hist        = cJSON_AddArrayToObject(frames, "hist");
+  for (int i = 0; i < FRAME_SCHEDULER_HISTOGRAM_BUCKETS; i++) {
+    if (i < FRAME_SCHEDULER_HISTOGRAM_BUCKETS - 1) {
+      cJSON_AddItemToArray(hist_bounds, cJSON_CreateNumber(frame_scheduler_histogram_bounds_us[i]));
+    }
+    cJSON_AddItemToArray(hist, cJSON_CreateNumber(frame_stats.histogram[i]));
+  }
+  cJSON_AddItemToObject(root, "frames", frames);
+
+  // Event layer composition
+  config_manager_compositor_stats_t compositor_stats;
+  config_manager_get_compositor_stats(&compositor_stats);
+  cJSON *compositor = cJSON_CreateObject();
+  cJSON_AddNumberToObject(compositor, "frames", compositor_stats.frames);
+  cJSON_AddNumberToObject(compositor, "rendered", compositor_stats.layers_rendered);
+  cJSON_AddNumberToObject(compositor, "occluded", compositor_stats.layers_occluded);
+  cJSON_AddNumberToObject(compositor, "base_occluded", compositor_stats.base_occluded);
+  cJSON_AddNumberToObject(compositor, "split", compositor_stats.split_frames);
+  render_worker_stats_t worker_stats;
+  render_worker_get_stats(&worker_stats);
+  cJSON_AddNumberToObject(compositor, "worker_us", worker_stats.worker_us_last);
+  cJSON_AddNumberToObject(compositor, "worker_max_us", worker_stats.worker_us_max);
+  cJSON_AddNumberToObject(compositor, "worker_avg_us", worker_stats.frames ? (double)worker_stats.worker_us_total / worker_stats.frames : 0);
+  cJSON_AddNumberToObject(compositor, "barrier_max_us", worker_stats.wait_us_max);
+  cJSON_AddNumberToObject(compositor, "barrier_avg_us", worker_stats.frames ? (double)worker_stats.wait_us_total / worker_stats.frames : 0);
+  cJSON_AddItemToObject(root, "compositor", compositor);
+
   // Vehicle status
   uint32_t now        = xTaskGetTickCount();
   bool vehicle_active = (now - current_vehicle_state.last_update_ms) < pdMS_TO_TICKS(VEHICLE_STATE_TIMEOUT_MS);
@@ -547,10 +616,26 @@ static esp_err_t config_handler(httpd_req_t *req) {
 
   // Add LED hardware configuration
   cJSON_AddNumberToObject(root, "lc", config_manager_get_led_count());
+  led_output_config_t outputs[LED_OUTPUT_MAX];
+  uint8_t output_count = led_effects_get_outputs(outputs);
+  cJSON *outs          = cJSON_AddArrayToObject(root, "outs");
+  for (int i = 0; i < output_count; i++) {
+    cJSON *out = cJSON_CreateObject();
+    cJSON_AddNumberToObject(out, "gpio", outputs[i].gpio);
+    cJSON_AddNumberToObject(out, "order", outputs[i].color_order);
+    cJSON_AddNumberToObject(out, "start", outputs[i].start);
+    cJSON_AddNumberToObject(out, "count", outputs[i].count);
+    cJSON_AddItemToArray(outs, out);
+  }
+  cJSON_AddNumberToObject(root, "outs_max", LED_OUTPUT_MAX);
 
   // Global settings (wheel control)
   cJSON_AddBoolToObject(root, "wheel_ctl", config_manager_get_wheel_control_enabled());
   cJSON_AddNumberToObject(root, "wheel_spd", config_manager_get_wheel_control_speed_limit());
+  cJSON_AddNumberToObject(root, "fps", frame_scheduler_get_fps());
+#if !CONFIG_FREERTOS_UNICORE
+  cJSON_AddBoolToObject(root, "dual_core", render_worker_is_enabled());
+#endif
 
   const char *json_string = cJSON_PrintUnformatted(root);
   httpd_resp_set_type(req, "application/json");
@@ -610,6 +695,76 @@ static esp_err_t espnow_config_get_handler(httpd_req_t *req) {
     }
   }
 
+  espnow_state_stats_t state_stats;
+  espnow_link_get_state_stats(&state_stats);
+  cJSON *state = cJSON_CreateObject();
+  cJSON_AddNumberToObject(state, "packets", state_stats.packets);
+  cJSON_AddNumberToObject(state, "keyframes", state_stats.keyframes);
+  cJSON_AddNumberToObject(state, "bytes", state_stats.bytes);
+  cJSON_AddNumberToObject(state, "seq_gaps", state_stats.seq_gaps);
+  cJSON_AddNumberToObject(state, "keyframe_requests", state_stats.keyframe_requests);
+  cJSON_AddNumberToObject(state, "version_mismatch", state_stats.version_mismatch);
+  cJSON_AddNumberToObject(state, "streams", state_stats.streams);
+  cJSON_AddNumberToObject(state, "redundant", state_stats.redundant);
+  cJSON_AddNumberToObject(state, "signal_snaps", led_effects_get_signal_snaps());
+  cJSON *classes = cJSON_CreateObject();
+  for (int c = 0; c < ESPNOW_CLASS_COUNT; c++) {
+    const espnow_class_stats_t *cs = &state_stats.classes[c];
+    cJSON *cls                     = cJSON_CreateObject();
+    cJSON_AddNumberToObject(cls, "packets", cs->packets);
+    cJSON_AddNumberToObject(cls, "deliveries", cs->deliveries);
+    cJSON_AddNumberToObject(cls, "latency_avg_us", cs->deliveries ? (double)(cs->latency_total_us / cs->deliveries) : 0);
+    cJSON_AddNumberToObject(cls, "latency_max_us", cs->latency_max_us);
+    cJSON_AddItemToObject(classes, espnow_state_class_name((espnow_state_class_t)c), cls);
+  }
+  cJSON_AddItemToObject(state, "classes", classes);
+  cJSON_AddItemToObject(root, "state_stream", state);
+
+  anim_clock_status_t clock_status;
+  anim_clock_get_status(&clock_status);
+  cJSON *clock = cJSON_CreateObject();
+  cJSON_AddBoolToObject(clock, "reference", clock_status.reference);
+  cJSON_AddBoolToObject(clock, "synced", clock_status.synced);
+  cJSON_AddNumberToObject(clock, "offset_us", (double)clock_status.offset_us);
+  cJSON_AddNumberToObject(clock, "skew_ppm", clock_status.skew_ppm);
+  cJSON_AddNumberToObject(clock, "delay_us", clock_status.delay_us);
+  cJSON_AddNumberToObject(clock, "samples", clock_status.samples);
+  cJSON_AddNumberToObject(clock, "steps", clock_status.steps);
+  cJSON_AddItemToObject(root, "clock", clock);
+
+  espnow_pixel_stats_t pixel_stats;
+  espnow_link_get_pixel_stats(&pixel_stats);
+  espnow_pixel_peer_t pixel_peers[ESPNOW_MAX_PEERS];
+  cJSON *pixels = cJSON_CreateObject();
+  cJSON_AddBoolToObject(pixels, "enabled", settings_get_u8("espnow_offload", 0) != 0);
+  cJSON_AddBoolToObject(pixels, "active", espnow_link_pixel_offload_active());
+  cJSON_AddNumberToObject(pixels, "peers", (double)espnow_link_get_pixel_peers(pixel_peers, ESPNOW_MAX_PEERS));
+  cJSON_AddNumberToObject(pixels, "frames", pixel_stats.frames);
+  cJSON_AddNumberToObject(pixels, "keyframes", pixel_stats.keyframes);
+  cJSON_AddNumberToObject(pixels, "packets", pixel_stats.packets);
+  cJSON_AddNumberToObject(pixels, "bytes", pixel_stats.bytes);
+  cJSON_AddNumberToObject(pixels, "raw_bytes", pixel_stats.raw_bytes);
+  cJSON_AddNumberToObject(pixels, "encode_us_avg", pixel_stats.frames ? (double)(pixel_stats.encode_us / pixel_stats.frames) : 0);
+  cJSON_AddNumberToObject(pixels, "dropped", pixel_stats.dropped);
+  cJSON_AddNumberToObject(pixels, "keyframe_requests", pixel_stats.keyframe_requests);
+  cJSON *encodings = cJSON_CreateObject();
+  for (int e = 0; e < PIXEL_ENC_COUNT; e++) {
+    cJSON_AddNumberToObject(encodings, pixel_stream_encoding_name((pixel_stream_encoding_t)e), pixel_stats.chunks[e]);
+  }
+  cJSON_AddItemToObject(pixels, "chunks", encodings);
+  cJSON_AddItemToObject(root, "pixel_offload", pixels);
+
+  espnow_rx_stats_t rx_stats;
+  espnow_link_get_rx_stats(&rx_stats);
+  cJSON *rx = cJSON_CreateObject();
+  cJSON_AddNumberToObject(rx, "packets", rx_stats.packets);
+  cJSON_AddNumberToObject(rx, "dropped", rx_stats.dropped);
+  cJSON_AddNumberToObject(rx, "oversize", rx_stats.oversize);
+  cJSON_AddNumberToObject(rx, "queue_max", rx_stats.queue_max);
+  cJSON_AddNumberToObject(rx, "latency_avg_us", rx_stats.packets ? (double)(rx_stats.latency_total_us / rx_stats.packets) : 0);
+  cJSON_AddNumberToObject(rx, "latency_max_us", rx_stats.latency_max_us);
+  cJSON_AddItemToObject(root, "rx", rx);
+
   const char *json_string = cJSON_PrintUnformatted(root);
   httpd_resp_set_type(req, "application/json");
   httpd_resp_sendstr(req, json_string);
@@ -628,6 +783,7 @@ static esp_err_t espnow_config_post_handler(httpd_req_t *req) {
 
   const cJSON *role_json             = cJSON_GetObjectItem(root, "role");
   const cJSON *type_json             = cJSON_GetObjectItem(root, "type");
+  const cJSON *offload_json          = cJSON_GetObjectItem(root, "pixel_offload");
 
   espnow_role_t new_role             = espnow_link_get_role();
   espnow_slave_type_t new_slave_type = espnow_link_get_slave_type();
@@ -652,6 +808,17 @@ static esp_err_t espnow_config_post_handler(httpd_req_t *req) {
   // Update the current state so the response and future requests reflect the new choices immediately
   espnow_link_set_role_type(new_role, new_slave_type);
 
+  // Pixel offload applies at once on a slave
+  if (cJSON_IsBool(offload_json)) {
+    bool offload = cJSON_IsTrue(offload_json);
+    if (settings_set_u8("espnow_offload", offload ? 1 : 0) != ESP_OK) {
+      err2 = ESP_FAIL;
+    }
+    if (new_role == ESP_NOW_ROLE_SLAVE) {
+      espnow_link_set_pixel_offload(offload, led_effects_get_led_count());
+    }
+  }
+
   cJSON_Delete(root);
 
   if (err1 != ESP_OK || err2 != ESP_OK) {
@@ -771,6 +938,11 @@ static esp_err_t espnow_peers_get_handler(httpd_req_t *req) {
     uint64_t age_ms = (peers[i].last_seen_us && now_us > peers[i].last_seen_us) ? (now_us - peers[i].last_seen_us) / 1000ULL : 0;
     cJSON_AddNumberToObject(p, "age_ms", (double)age_ms);
     cJSON_AddNumberToObject(p, "channel", (double)peers[i].channel);
+    uint8_t stream      = 0;
+    uint8_t field_count = espnow_state_field_count();
+    espnow_link_get_peer_subscription(peers[i].mac, &stream, &field_count);
+    cJSON_AddNumberToObject(p, "stream", stream);
+    cJSON_AddNumberToObject(p, "fields", field_count);
     cJSON_AddItemToArray(root, p);
   }
 
@@ -879,6 +1051,9 @@ static esp_err_t config_post_handler(httpd_req_t *req) {
   const cJSON *led_count_json = cJSON_GetObjectItem(root, "lc");
   const cJSON *wheel_ctl_json = cJSON_GetObjectItem(root, "wheel_ctl");
   const cJSON *wheel_spd_json = cJSON_GetObjectItem(root, "wheel_spd");
+  const cJSON *fps_json       = cJSON_GetObjectItem(root, "fps");
+  const cJSON *outs_json      = cJSON_GetObjectItem(root, "outs");
+  const cJSON *dual_core_json = cJSON_GetObjectItem(root, "dual_core");
 
   if (led_count_json == NULL) {
     httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Missing led_count");
@@ -896,24 +1071,80 @@ static esp_err_t config_post_handler(httpd_req_t *req) {
     config_manager_set_wheel_control_speed_limit(wheel_spd_json->valueint);
   }
 
+  // Target frame rate (optional)
+  if (fps_json && cJSON_IsNumber(fps_json)) {
+    if (fps_json->valueint < FRAME_SCHEDULER_FPS_MIN || fps_json->valueint > FRAME_SCHEDULER_FPS_MAX) {
+      httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "fps must be 10-100");
+      cJSON_Delete(root);
+      return ESP_FAIL;
+    }
+    frame_scheduler_set_fps((uint8_t)fps_json->valueint);
+    if (settings_set_u8("led_fps", (uint8_t)fps_json->valueint) != ESP_OK) {
+      ESP_LOGW(TAG_WEBSERVER, "Failed to save the frame rate");
+    }
+  }
+
+  // Layer rendering split across both cores (optional, dual-core targets)
+  if (dual_core_json && cJSON_IsBool(dual_core_json)) {
+    render_worker_set_enabled(cJSON_IsTrue(dual_core_json));
+    if (settings_set_bool("led_dual_core", cJSON_IsTrue(dual_core_json)) != ESP_OK) {
+      ESP_LOGW(TAG_WEBSERVER, "Failed to save the dual-core rendering setting");
+    }
+  }
+
   // Validation
   if (led_count < LED_COUNT_MIN || led_count > LED_COUNT_MAX) {
-    httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "led_count must be 1-200");
+    char message[48];
+    snprintf(message, sizeof(message), "led_count must be %d-%d", LED_COUNT_MIN, LED_COUNT_MAX);
+    httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, message);
     cJSON_Delete(root);
     return ESP_FAIL;
   }
 
-  // Save to SPIFFS (LED count only)
-  bool success = config_manager_set_led_count(led_count);
+  // Strip outputs (optional): [{gpio, order, start, count}], count 0 up to the end of the strip
+  if (outs_json && cJSON_IsArray(outs_json)) {
+    led_output_config_t outputs[LED_OUTPUT_MAX];
+    int output_count = cJSON_GetArraySize(outs_json);
+    bool valid       = output_count >= 1 && output_count <= LED_OUTPUT_MAX;
+    for (int i = 0; valid && i < output_count; i++) {
+      const cJSON *out   = cJSON_GetArrayItem(outs_json, i);
+      const cJSON *gpio  = cJSON_GetObjectItem(out, "gpio");
+      const cJSON *order = cJSON_GetObjectItem(out, "order");
+      const cJSON *start = cJSON_GetObjectItem(out, "start");
+      const cJSON *count = cJSON_GetObjectItem(out, "count");
+      if (!cJSON_IsNumber(gpio) || gpio->valueint < 0 || gpio->valueint > UINT8_MAX) {
+        valid = false;
+        break;
+      }
+      outputs[i].gpio        = (uint8_t)gpio->valueint;
+      outputs[i].color_order = cJSON_IsNumber(order) ? (uint8_t)order->valueint : LED_COLOR_ORDER_GRB;
+      outputs[i].start       = cJSON_IsNumber(start) ? (uint16_t)start->valueint : 0;
+      outputs[i].count       = cJSON_IsNumber(count) ? (uint16_t)count->valueint : 0;
+    }
+    // Applied from the next frame; refused if GPIOs repeat or spans overlap
+    if (!valid || !led_effects_set_outputs(outputs, (uint8_t)output_count)) {
+      httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid outputs");
+      cJSON_Delete(root);
+      return ESP_FAIL;
+    }
+    if (!config_manager_set_led_outputs(outputs, (uint8_t)output_count)) {
+      ESP_LOGW(TAG_WEBSERVER, "Failed to save the LED outputs");
+    }
+  }
 
   cJSON_Delete(root);
 
-  if (success) {
-    if (!led_effects_set_led_count(led_count)) {
-      httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to apply new LED count");
-      return ESP_FAIL;
-    }
+  // Apply first: the LED buffers are allocated for the new count, a count that does
+  // not fit in memory is refused rather than saved
+  if (!led_effects_set_led_count(led_count)) {
+    httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Not enough memory for this LED count");
+    return ESP_FAIL;
+  }
+
+  // Save to SPIFFS (LED count only)
+  bool success = config_manager_set_led_count(led_count);
 
+  if (success) {
     cJSON *response = cJSON_CreateObject();
     cJSON_AddStringToObject(response, "st", "ok");
     cJSON_AddStringToObject(response, "msg", "Configuration saved and applied.");
@@ -1642,6 +1873,7 @@ typedef bool (*server_is_running_fn_t)(void);
 typedef int (*server_get_client_count_fn_t)(void);
 typedef bool (*server_get_autostart_fn_t)(void);
 typedef esp_err_t (*server_set_autostart_fn_t)(bool);
+typedef void (*server_add_stats_fn_t)(cJSON *root);
 
 // Generic helper for start
 static esp_err_t handle_server_start(httpd_req_t *req, server_start_fn_t start_fn, const char *name) {
@@ -1671,7 +1903,12 @@ static esp_err_t handle_server_stop(httpd_req_t *req, server_stop_fn_t stop_fn,
 }
 
 // Generic helper for status
-static esp_err_t handle_server_status(httpd_req_t *req, server_is_running_fn_t is_running_fn, server_get_client_count_fn_t get_clients_fn, server_get_autostart_fn_t get_autostart_fn, int port) {
+static esp_err_t handle_server_status(httpd_req_t *req,
+                                      server_is_running_fn_t is_running_fn,
+                                      server_get_client_count_fn_t get_clients_fn,
+                                      server_get_autostart_fn_t get_autostart_fn,
+                                      server_add_stats_fn_t add_stats_fn,
+                                      int port) {
   httpd_resp_set_type(req, "application/json");
 
   cJSON *root = cJSON_CreateObject();
@@ -1679,6 +1916,9 @@ static esp_err_t handle_server_status(httpd_req_t *req, server_is_running_fn_t i
   cJSON_AddNumberToObject(root, "clients", get_clients_fn());
   cJSON_AddNumberToObject(root, "port", port);
   cJSON_AddBoolToObject(root, "autostart", get_autostart_fn());
+  if (add_stats_fn) {
+    add_stats_fn(root);
+  }
 
   const char *json_str = cJSON_PrintUnformatted(root);
   httpd_resp_sendstr(req, json_str);
@@ -1742,9 +1982,25 @@ static esp_err_t gvret_stop_handler(httpd_req_t *req) {
   return handle_server_stop(req, gvret_tcp_server_stop, "GVRET");
 }
 
+// Streaming counters for the GVRET status response
+static void gvret_add_stats(cJSON *root) {
+  gvret_tcp_stats_t stats;
+  if (gvret_tcp_server_get_stats(&stats) != ESP_OK) {
+    return;
+  }
+
+  cJSON *stats_obj = cJSON_CreateObject();
+  cJSON_AddNumberToObject(stats_obj, "frames_sent", stats.frames_sent);
+  cJSON_AddNumberToObject(stats_obj, "bytes_sent", stats.bytes_sent);
+  cJSON_AddNumberToObject(stats_obj, "frames_dropped", stats.frames_dropped);
+  cJSON_AddNumberToObject(stats_obj, "overflows", stats.overflow_events);
+  cJSON_AddNumberToObject(stats_obj, "evicted", stats.clients_evicted);
+  cJSON_AddItemToObject(root, "stats", stats_obj);
+}
+
 // Handler to get GVRET TCP server status
 static esp_err_t gvret_status_handler(httpd_req_t *req) {
-  return handle_server_status(req, gvret_tcp_server_is_running, gvret_tcp_server_get_client_count, gvret_tcp_server_get_autostart, 23);
+  return handle_server_status(req, gvret_tcp_server_is_running, gvret_tcp_server_get_client_count, gvret_tcp_server_get_autostart, gvret_add_stats, 23);
 }
 
 // Handler to set autostart for the GVRET TCP server
@@ -1766,9 +2022,25 @@ static esp_err_t canserver_stop_handler(httpd_req_t *req) {
   return handle_server_stop(req, canserver_udp_server_stop, "CANServer");
 }
 
+// Batching counters for the CANServer status response
+static void canserver_add_stats(cJSON *root) {
+  canserver_udp_stats_t stats;
+  if (canserver_udp_server_get_stats(&stats) != ESP_OK) {
+    return;
+  }
+
+  cJSON *stats_obj = cJSON_CreateObject();
+  cJSON_AddNumberToObject(stats_obj, "frames_queued", stats.frames_queued);
+  cJSON_AddNumberToObject(stats_obj, "frames_dropped", stats.frames_dropped);
+  cJSON_AddNumberToObject(stats_obj, "packets_sent", stats.packets_sent);
+  cJSON_AddNumberToObject(stats_obj, "send_errors", stats.send_errors);
+  cJSON_AddNumberToObject(stats_obj, "batch_interval_ms", stats.batch_interval_ms);
+  cJSON_AddItemToObject(root, "stats", stats_obj);
+}
+
 // Handler to get CANServer UDP server status
 static esp_err_t canserver_status_handler(httpd_req_t *req) {
-  return handle_server_status(req, canserver_udp_server_is_running, canserver_udp_server_get_client_count, canserver_udp_server_get_autostart, 1338);
+  return handle_server_status(req, canserver_udp_server_is_running, canserver_udp_server_get_client_count, canserver_udp_server_get_autostart, canserver_add_stats, 1338);
 }
 
 // Handler to set autostart for the CANServer UDP server
@@ -1776,6 +2048,151 @@ static esp_err_t canserver_autostart_handler(httpd_req_t *req) {
   return handle_server_autostart(req, canserver_udp_server_set_autostart);
 }
 
+// ============================================================================
+// CAN ID Filter API Handlers (GVRET + CANServer clients)
+// ============================================================================
+
+typedef esp_err_t (*server_get_client_filters_fn_t)(int slot, can_id_filter_client_info_t *out);
+typedef esp_err_t (*server_set_client_filters_fn_t)(int slot, const can_id_filter_rule_t *rules, int count);
+
+// Append every connected client of a server with its filter rules
+static void add_client_filters(cJSON *root, const char *name, server_get_client_filters_fn_t get_fn) {
+  cJSON *clients_arr = cJSON_CreateArray();
+  can_id_filter_client_info_t info;
+
+  for (int slot = 0; get_fn(slot, &info) != ESP_ERR_INVALID_ARG; slot++) {
+    if (!info.active) {
+      continue;
+    }
+    cJSON *client = cJSON_CreateObject();
+    cJSON_AddNumberToObject(client, "slot", slot);
+    cJSON_AddStringToObject(client, "ip", info.ip);
+    cJSON_AddNumberToObject(client, "port", info.port);
+
+    cJSON *filters = cJSON_CreateArray();
+    for (int i = 0; i < info.rule_count; i++) {
+      cJSON *rule = cJSON_CreateObject();
+      cJSON_AddNumberToObject(rule, "id", info.rules[i].id);
+      cJSON_AddNumberToObject(rule, "mask", info.rules[i].mask);
+      cJSON_AddBoolToObject(rule, "extended", info.rules[i].extended);
+      cJSON_AddItemToArray(filters, rule);
+    }
+    cJSON_AddItemToObject(client, "filters", filters);
+    cJSON_AddItemToArray(clients_arr, client);
+  }
+
+  cJSON_AddItemToObject(root, name, clients_arr);
+}
+
+// Handler to list CAN ID filters of connected streaming clients
+static esp_err_t can_filters_get_handler(httpd_req_t *req) {
+  httpd_resp_set_type(req, "application/json");
+
+  cJSON *root = cJSON_CreateObject();
+  add_client_filters(root, "gvret", gvret_tcp_server_get_client_filters);
+  add_client_filters(root, "canserver", canserver_udp_server_get_client_filters);
+
+  const char *json_str = cJSON_PrintUnformatted(root);
+  httpd_resp_sendstr(req, json_str);
+
+  cJSON_free((void *)json_str);
+  cJSON_Delete(root);
+
+  return ESP_OK;
+}
+
+// Handler to replace the CAN ID filters of one client
+// Body: {"server":"gvret"|"canserver","slot":0,"filters":[{"id":280,"mask":2047,"extended":false}]}
+// An empty filter list streams every frame again.
+static esp_err_t can_filters_post_handler(httpd_req_t *req) {
+  char content[1024];
+  cJSON *json = NULL;
+  if (parse_json_request(req, content, sizeof(content), &json) != ESP_OK) {
+    return ESP_FAIL;
+  }
+
+  httpd_resp_set_type(req, "application/json");
+
+  const cJSON *server                   = cJSON_GetObjectItem(json, "server");
+  const cJSON *slot                     = cJSON_GetObjectItem(json, "slot");
+  const cJSON *filters                  = cJSON_GetObjectItem(json, "filters");
+
+  server_set_client_filters_fn_t set_fn = NULL;
+
+  if (cJSON_IsString(server) && strcmp(server->valuestring, "gvret") == 0) {
+    set_fn = gvret_tcp_server_set_client_filters;
+  } else if (cJSON_IsString(server) && strcmp(server->valuestring, "canserver") == 0) {
+    set_fn = canserver_udp_server_set_client_filters;
+  }
+
+  if (!set_fn || !cJSON_IsNumber(slot) || !cJSON_IsArray(filters) || cJSON_GetArraySize(filters) > CAN_ID_FILTER_MAX_RULES) {
+    cJSON_Delete(json);
+    httpd_resp_sendstr(req, "{\"status\":\"error\",\"message\":\"Invalid filter request\"}");
+    return ESP_OK;
+  }
+
+  can_id_filter_rule_t rules[CAN_ID_FILTER_MAX_RULES];
+  int count = 0;
+  const cJSON *item;
+  cJSON_ArrayForEach(item, filters) {
+    const cJSON *id       = cJSON_GetObjectItem(item, "id");
+    const cJSON *mask     = cJSON_GetObjectItem(item, "mask");
+    const cJSON *extended = cJSON_GetObjectItem(item, "extended");
+    if (!cJSON_IsNumber(id)) {
+      continue;
+    }
+    rules[count].extended = cJSON_IsTrue(extended);
+    rules[count].id       = (uint32_t)id->valuedouble;
+    rules[count].mask     = cJSON_IsNumber(mask) ? (uint32_t)mask->valuedouble : 0x1FFFFFFF; // Exact match by default
+    count++;
+  }
+
+  esp_err_t err = set_fn(slot->valueint, rules, count);
+  ESP_LOGI(TAG_WEBSERVER, "CAN filters for %s slot %d: %d rule(s), %s", server->valuestring, slot->valueint, count, esp_err_to_name(err));
+  cJSON_Delete(json);
+
+  if (err == ESP_OK) {
+    httpd_resp_sendstr(req, "{\"status\":\"ok\"}");
+  } else {
+    httpd_resp_sendstr(req, "{\"status\":\"error\",\"message\":\"Client not connected\"}");
+  }
+
+  return ESP_OK;
+}
+
+// Handler to get per-consumer counters of the shared CAN frame hub
+static esp_err_t can_hub_stats_handler(httpd_req_t *req) {
+  httpd_resp_set_type(req, "application/json");
+
+  cJSON *root = cJSON_CreateObject();
+  cJSON_AddNumberToObject(root, "published", can_hub_get_published_count());
+  cJSON_AddNumberToObject(root, "ring_size", CAN_HUB_RING_SIZE);
+
+  cJSON *consumers = cJSON_CreateArray();
+  can_hub_consumer_stats_t stats;
+  for (int i = 0; i < CAN_HUB_MAX_CONSUMERS; i++) {
+    if (can_hub_get_consumer_stats(i, &stats) != ESP_OK) {
+      continue;
+    }
+    cJSON *consumer = cJSON_CreateObject();
+    cJSON_AddStringToObject(consumer, "name", stats.name);
+    cJSON_AddBoolToObject(consumer, "enabled", stats.enabled);
+    cJSON_AddNumberToObject(consumer, "backlog", stats.backlog);
+    cJSON_AddNumberToObject(consumer, "read", stats.frames_read);
+    cJSON_AddNumberToObject(consumer, "lost", stats.frames_lost);
+    cJSON_AddItemToArray(consumers, consumer);
+  }
+  cJSON_AddItemToObject(root, "consumers", consumers);
+
+  const char *json_str = cJSON_PrintUnformatted(root);
+  httpd_resp_sendstr(req, json_str);
+
+  cJSON_free((void *)json_str);
+  cJSON_Delete(root);
+
+  return ESP_OK;
+}
+
 // ============================================================================
 // Server-Sent Events (SSE) for Live Logs
 // ============================================================================
@@ -1825,6 +2242,215 @@ static esp_err_t log_stream_handler(httpd_req_t *req) {
   return ESP_OK;
 }
 
+// ============================================================================
+// Live CAN signal watch (decoded values, SSE)
+// ============================================================================
+
+#define WATCH_SSE_MAX_CLIENTS 2
+
+static int watch_sse_clients[WATCH_SSE_MAX_CLIENTS] = {-1, -1};
+static portMUX_TYPE watch_sse_lock                  = portMUX_INITIALIZER_UNLOCKED;
+static char watch_sse_buffer[64 + CAN_WATCH_BATCH_MAX * 40];
+
+static const char *watch_mode_names[] = {"change", "rate", "minmax"};
+
+// Sink called by the watch task: one SSE event per batch, {"u":[[id,kind,ts,value],...]}
+static void watch_sse_sink(const can_watch_update_t *updates, int count) {
+  int len = snprintf(watch_sse_buffer, sizeof(watch_sse_buffer), "data: {\"u\":[");
+  for (int i = 0; i < count && len < (int)sizeof(watch_sse_buffer) - 48; i++) {
+    len += snprintf(watch_sse_buffer + len,
+                    sizeof(watch_sse_buffer) - len,
+                    "%s[%u,%u,%lu,%.6g]",
+                    i > 0 ? "," : "",
+                    updates[i].watch_id,
+                    updates[i].kind,
+                    (unsigned long)updates[i].timestamp_ms,
+                    (double)updates[i].value);
+  }
+  len += snprintf(watch_sse_buffer + len, sizeof(watch_sse_buffer) - len, "]}\n\n");
+
+  for (int i = 0; i < WATCH_SSE_MAX_CLIENTS; i++) {
+    int fd = watch_sse_clients[i];
+    if (fd < 0) {
+      continue;
+    }
+    // A partial event would corrupt the stream: a client that cannot keep up is dropped
+    int sent = send(fd, watch_sse_buffer, len, MSG_DONTWAIT);
+    if (sent != len) {
+      ESP_LOGW(TAG_WEBSERVER, "Signal watch client fd=%d dropped (sent %d/%d, errno=%d)", fd, sent, len, errno);
+      portENTER_CRITICAL(&watch_sse_lock);
+      watch_sse_clients[i] = -1;
+      portEXIT_CRITICAL(&watch_sse_lock);
+      httpd_sess_trigger_close(server, fd);
+    }
+  }
+}
+
+// Session context destructor: httpd closed the socket, its fd may be reused. The context is
+// the session's fd + 1 (never NULL): a slot already released by watch_sse_sink may hold a
+// new client by now, so only the slot still holding this fd is cleared.
+static void watch_sse_session_closed(void *ctx) {
+  int fd = (int)(intptr_t)ctx - 1;
+  portENTER_CRITICAL(&watch_sse_lock);
+  for (int i = 0; i < WATCH_SSE_MAX_CLIENTS; i++) {
+    if (watch_sse_clients[i] == fd) {
+      watch_sse_clients[i] = -1;
+    }
+  }
+  portEXIT_CRITICAL(&watch_sse_lock);
+}
+
+static esp_err_t can_watch_stream_handler(httpd_req_t *req) {
+  int fd = httpd_req_to_sockfd(req);
+
+  if (can_signal_watch_add_sink(watch_sse_sink) != ESP_OK) {
+    httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Signal watch unavailable");
+    return ESP_FAIL;
+  }
+
+  int slot = -1;
+  portENTER_CRITICAL(&watch_sse_lock);
+  for (int i = 0; i < WATCH_SSE_MAX_CLIENTS; i++) {
+    if (watch_sse_clients[i] < 0) {
+      slot = i;
+      break;
+    }
+  }
+  portEXIT_CRITICAL(&watch_sse_lock);
+  if (slot < 0) {
+    httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Max signal watch clients reached");
+    return ESP_FAIL;
+  }
+
+  const char *headers = "HTTP/1.1 200 OK\r\n"
+                        "Content-Type: text/event-stream\r\n"
+                        "Cache-Control: no-cache\r\n"
+                        "Connection: keep-alive\r\n"
+                        "Access-Control-Allow-Origin: *\r\n"
+                        "\r\n"
+                        ": signal watch connected\n\n";
+  if (send(fd, headers, strlen(headers), 0) <= 0) {
+    return ESP_FAIL;
+  }
+
+  // Published only once the headers are out, so updates never precede them
+  portENTER_CRITICAL(&watch_sse_lock);
+  watch_sse_clients[slot] = fd;
+  portEXIT_CRITICAL(&watch_sse_lock);
+
+  ESP_LOGI(TAG_WEBSERVER, "Signal watch client registered (fd=%d, slot=%d)", fd, slot);
+  req->sess_ctx = (void *)(intptr_t)(fd + 1);
+  req->free_ctx = watch_sse_session_closed;
+  httpd_sess_set_recv_override(req->handle, fd, sse_recv_override);
+  return ESP_OK;
+}
+
+// Handler to list watched signals and their last values
+static esp_err_t can_watch_get_handler(httpd_req_t *req) {
+  httpd_resp_set_type(req, "application/json");
+
+  can_watch_stats_t stats;
+  can_signal_watch_get_stats(&stats);
+
+  cJSON *root = cJSON_CreateObject();
+  cJSON_AddNumberToObject(root, "frames_matched", stats.frames_matched);
+  cJSON_AddNumberToObject(root, "values_decoded", stats.values_decoded);
+  cJSON_AddNumberToObject(root, "updates_sent", stats.updates_sent);
+  cJSON_AddNumberToObject(root, "frames_lost", stats.frames_lost);
+
+  cJSON *watches = cJSON_CreateArray();
+  can_watch_info_t info;
+  for (int i = 0; i < CAN_WATCH_MAX_SIGNALS; i++) {
+    if (can_signal_watch_get_info(i, &info) != ESP_OK) {
+      continue;
+    }
+    cJSON *watch = cJSON_CreateObject();
+    cJSON_AddNumberToObject(watch, "id", info.watch_id);
+    cJSON_AddStringToObject(watch, "signal", info.request.name);
+    cJSON_AddNumberToObject(watch, "can_id", info.can_id);
+    cJSON_AddStringToObject(watch, "mode", watch_mode_names[info.request.mode]);
+    cJSON_AddNumberToObject(watch, "interval_ms", info.request.interval_ms);
+    cJSON_AddNumberToObject(watch, "deadband", info.request.deadband);
+    cJSON_AddNumberToObject(watch, "bus", info.bus);
+    if (info.has_value) {
+      cJSON_AddNumberToObject(watch, "value", info.last_value);
+    }
+    cJSON_AddNumberToObject(watch, "decoded", info.decoded);
+    cJSON_AddNumberToObject(watch, "sent", info.sent);
+    cJSON_AddItemToArray(watches, watch);
+  }
+  cJSON_AddItemToObject(root, "watches", watches);
+
+  const char *json_str = cJSON_PrintUnformatted(root);
+  httpd_resp_sendstr(req, json_str);
+
+  cJSON_free((void *)json_str);
+  cJSON_Delete(root);
+
+  return ESP_OK;
+}
+
+// Handler to subscribe/unsubscribe signals
+// Body: {"action":"add","signal":"DI_vehicleSpeed","mode":"change"|"rate"|"minmax","interval_ms":100,"deadband":0.5}
+//       {"action":"remove","id":3} / {"action":"clear"}
+static esp_err_t can_watch_post_handler(httpd_req_t *req) {
+  char content[BUFFER_SIZE_LARGE];
+  cJSON *json = NULL;
+  if (parse_json_request(req, content, sizeof(content), &json) != ESP_OK) {
+    return ESP_FAIL;
+  }
+
+  httpd_resp_set_type(req, "application/json");
+
+  const cJSON *action = cJSON_GetObjectItem(json, "action");
+  char response[BUFFER_SIZE_SMALL];
+  esp_err_t err = ESP_ERR_INVALID_ARG;
+
+  if (cJSON_IsString(action) && strcmp(action->valuestring, "add") == 0) {
+    const cJSON *signal         = cJSON_GetObjectItem(json, "signal");
+    const cJSON *mode           = cJSON_GetObjectItem(json, "mode");
+    const cJSON *interval       = cJSON_GetObjectItem(json, "interval_ms");
+    const cJSON *deadband       = cJSON_GetObjectItem(json, "deadband");
+
+    can_watch_request_t request = {.mode = CAN_WATCH_MODE_CHANGE};
+    if (cJSON_IsString(mode)) {
+      for (int m = 0; m < (int)(sizeof(watch_mode_names) / sizeof(watch_mode_names[0])); m++) {
+        if (strcmp(mode->valuestring, watch_mode_names[m]) == 0) {
+          request.mode = (can_watch_mode_t)m;
+        }
+      }
+    }
+    request.interval_ms = cJSON_IsNumber(interval) ? (uint16_t)MIN(interval->valueint, UINT16_MAX) : 0;
+    request.deadband    = cJSON_IsNumber(deadband) ? (float)deadband->valuedouble : 0.0f;
+
+    uint8_t watch_id    = 0;
+    if (cJSON_IsString(signal)) {
+      snprintf(request.name, sizeof(request.name), "%s", signal->valuestring);
+      err = can_signal_watch_add(&request, &watch_id);
+    }
+    snprintf(response, sizeof(response), "{\"status\":\"%s\",\"id\":%u}", err == ESP_OK ? "ok" : "error", watch_id);
+  } else if (cJSON_IsString(action) && strcmp(action->valuestring, "remove") == 0) {
+    const cJSON *id = cJSON_GetObjectItem(json, "id");
+    if (cJSON_IsNumber(id)) {
+      err = can_signal_watch_remove((uint8_t)id->valueint);
+    }
+    snprintf(response, sizeof(response), "{\"status\":\"%s\"}", err == ESP_OK ? "ok" : "error");
+  } else if (cJSON_IsString(action) && strcmp(action->valuestring, "clear") == 0) {
+    can_signal_watch_clear();
+    err = ESP_OK;
+    snprintf(response, sizeof(response), "{\"status\":\"ok\"}");
+  } else {
+    snprintf(response, sizeof(response), "{\"status\":\"error\",\"message\":\"Unknown action\"}");
+  }
+
+  if (err != ESP_OK) {
+    ESP_LOGW(TAG_WEBSERVER, "Signal watch request failed: %s", esp_err_to_name(err));
+  }
+  cJSON_Delete(json);
+  httpd_resp_sendstr(req, response);
+  return ESP_OK;
+}
+
 static esp_err_t log_file_status_handler(httpd_req_t *req) {
   uint32_t max_index = log_stream_get_file_rotation_max();
   uint32_t current   = log_stream_get_current_file_index();
@@ -2714,6 +3340,26 @@ esp_err_t web_server_start(void) {
     httpd_uri_t canserver_autostart_uri = {.uri = "/api/canserver/autostart", .method = HTTP_POST, .handler = canserver_autostart_handler, .user_ctx = NULL};
     httpd_register_uri_handler(server, &canserver_autostart_uri);
 
+    // CAN ID filters of GVRET/CANServer clients
+    httpd_uri_t can_filters_get_uri = {.uri = "/api/can-filters", .method = HTTP_GET, .handler = can_filters_get_handler, .user_ctx = NULL};
+    httpd_register_uri_handler(server, &can_filters_get_uri);
+
+    httpd_uri_t can_filters_post_uri = {.uri = "/api/can-filters", .method = HTTP_POST, .handler = can_filters_post_handler, .user_ctx = NULL};
+    httpd_register_uri_handler(server, &can_filters_post_uri);
+
+    httpd_uri_t can_hub_stats_uri = {.uri = "/api/can/hub", .method = HTTP_GET, .handler = can_hub_stats_handler, .user_ctx = NULL};
+    httpd_register_uri_handler(server, &can_hub_stats_uri);
+
+    // Live decoded CAN signals
+    httpd_uri_t can_watch_get_uri = {.uri = "/api/can/watch", .method = HTTP_GET, .handler = can_watch_get_handler, .user_ctx = NULL};
+    httpd_register_uri_handler(server, &can_watch_get_uri);
+
+    httpd_uri_t can_watch_post_uri = {.uri = "/api/can/watch", .method = HTTP_POST, .handler = can_watch_post_handler, .user_ctx = NULL};
+    httpd_register_uri_handler(server, &can_watch_post_uri);
+
+    httpd_uri_t can_watch_stream_uri = {.uri = "/api/can/watch/stream", .method = HTTP_GET, .handler = can_watch_stream_handler, .user_ctx = NULL};
+    httpd_register_uri_handler(server, &can_watch_stream_uri);
+
     // Log Streaming route (Server-Sent Events)
     httpd_uri_t log_stream_uri = {.uri = "/api/logs/stream", .method = HTTP_GET, .handler = log_stream_handler, .user_ctx = NULL};
     httpd_register_uri_handler(server, &log_stream_uri);
@@ -0,0 +1,346 @@
+/**
+ * @file effects_bench.c
+ * @brief Host benchmark and golden frames of the LED effects (main/led_effects.c)
+ *
+ * Links the firmware's led_effects.c unchanged against the host stand-ins of
+ * idf_stubs/ (RMT, FreeRTOS, esp_timer) and against scripted versions of the
+ * modules it reads: animation clock, audio input and config manager. Every effect
+ * is rendered through led_effects_render_layer for a number of frames at each
+ * strip length, with a vehicle drive cycle and a 120 BPM audio feed as input.
+ *
+ * Reports the render time per frame and a hash of all the frames of each run. The
+ * clock, the inputs and the random seed are fixed, so the hashes only change when
+ * the rendering does (for a given compiler and flags: effects still use floats).
+ *
+ * Built and run by effects_bench.py.
+ */
+
+#include "anim_clock.h"
+#include "audio_input.h"
+#include "config.h"
+#include "config_manager.h"
+#include "led_effects.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_FRAMES 500 // 10 s at LED_EFFECT_FRAME_MS
+#define MAX_LEDS 2000
+#define MAX_COUNTS 8
+#define BENCH_SEED 0x5EED1234
+#define DRIVE_CYCLE_MS 20000 // Pull away, cruise, brake to a stop, charge
+#define BEAT_MS 500          // 120 BPM
+#define BENCH_PI 3.14159265f
+
+static uint32_t s_now_ms;
+static led_rgb_t s_frame[MAX_LEDS];
+
+// --- Scripted inputs ----------------------------------------------------------
+
+uint32_t anim_clock_now_ms(void) {
+  return s_now_ms;
+}
+
+static float beat_envelope(uint32_t now_ms) {
+  return expf(-(float)(now_ms % BEAT_MS) / 120.0f);
+}
+
+bool audio_input_is_enabled(void) {
+  return true;
+}
+
+void audio_input_set_fft_enabled(bool enable) {
+  (void)enable;
+}
+
+bool audio_input_get_data(audio_data_t *data) {
+  float t     = s_now_ms / 1000.0f;
+  float pulse = beat_envelope(s_now_ms);
+
+  memset(data, 0, sizeof(*data));
+  data->amplitude            = 0.25f + 0.6f * pulse;
+  data->bass                 = pulse;
+  data->mid                  = 0.5f + 0.3f * sinf(t * 1.7f);
+  data->treble               = 0.4f + 0.3f * sinf(t * 4.3f);
+  data->bpm                  = 60000.0f / BEAT_MS;
+  data->beat_detected        = s_now_ms % BEAT_MS < LED_EFFECT_FRAME_MS;
+  data->last_beat_ms         = s_now_ms - s_now_ms % BEAT_MS;
+  data->raw_amplitude        = data->amplitude;
+  data->calibrated_amplitude = data->amplitude;
+  data->auto_gain            = 1.0f;
+  return true;
+}
+
+bool audio_input_get_fft_data(audio_fft_data_t *fft_data) {
+  float t     = s_now_ms / 1000.0f;
+  float pulse = beat_envelope(s_now_ms);
+
+  memset(fft_data, 0, sizeof(*fft_data));
+  for (int b = 0; b < AUDIO_FFT_BANDS; b++) {
+    float level = 0.45f + 0.35f * sinf(t * 2.0f + b * 0.7f);
+    if (b < 3) {
+      level = 0.3f + 0.7f * pulse;
+    }
+    fft_data->bands[b] = level;
+    if (level > fft_data->bands[fft_data->dominant_band]) {
+      fft_data->dominant_band = b;
+    }
+  }
+  fft_data->bass_energy       = pulse;
+  fft_data->mid_energy        = 0.5f + 0.3f * sinf(t * 1.7f);
+  fft_data->treble_energy     = 0.4f + 0.3f * sinf(t * 4.3f);
+  fft_data->spectral_centroid = 1500.0f + 1000.0f * sinf(t * 0.5f);
+  fft_data->peak_freq         = fft_data->spectral_centroid;
+  fft_data->kick_detected     = s_now_ms % BEAT_MS < LED_EFFECT_FRAME_MS;
+  fft_data->snare_detected    = (s_now_ms + BEAT_MS / 2) % BEAT_MS < LED_EFFECT_FRAME_MS;
+  fft_data->vocal_detected    = fft_data->mid_energy > 0.6f;
+  return true;
+}
+
+bool config_manager_get_dynamic_brightness(bool *enabled, uint8_t *rate) {
+  *enabled = false;
+  *rate    = 0;
+  return true;
+}
+
+bool config_manager_is_dynamic_brightness_excluded(can_event_type_t event) {
+  (void)event;
+  return false;
+}
+
+bool config_manager_has_active_events(void) {
+  return false;
+}
+
+uint16_t config_manager_get_led_count(void) {
+  return NUM_LEDS;
+}
+
+uint8_t config_manager_get_led_outputs(led_output_config_t *outputs) {
+  (void)outputs;
+  return 0;
+}
+
+static void script_vehicle(uint32_t now_ms, vehicle_state_t *state) {
+  uint32_t t     = now_ms % DRIVE_CYCLE_MS;
+  float progress = (float)t / DRIVE_CYCLE_MS;
+
+  memset(state, 0, sizeof(*state));
+  state->brightness        = 100;
+  state->train_type        = 0;
+  state->rear_power_limit  = 300.0f;
+  state->front_power_limit = 200.0f;
+  state->max_regen         = 60.0f;
+  state->soc_percent       = 20.0f + 60.0f * (float)(now_ms % (3 * DRIVE_CYCLE_MS)) / (3 * DRIVE_CYCLE_MS);
+
+  if (progress < 0.8f) {
+    // Speed rises then falls back to 0: power while accelerating, regen while braking
+    float phase            = progress / 0.8f;
+    float slope            = cosf(2.0f * BENCH_PI * phase);
+    state->speed_kph       = 130.0f * sinf(BENCH_PI * phase) * sinf(BENCH_PI * phase);
+    state->accel_pedal_pos = slope > 0.0f ? (uint8_t)(80.0f * slope) : 0;
+    state->brake_pressed   = slope < -0.3f;
+    state->rear_power      = slope > 0.0f ? 180.0f * slope : 60.0f * slope;
+    state->front_power     = state->rear_power * 0.5f;
+  } else {
+    state->charging        = 1;
+    state->charge_power_kw = 11.0f;
+  }
+  state->door_front_left_open = t < 3000;
+  state->locked               = progress >= 0.8f;
+}
+
+// --- Bench --------------------------------------------------------------------
+
+static double now_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static uint32_t fnv1a(uint32_t hash, const void *data, size_t size) {
+  const uint8_t *bytes = data;
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ bytes[i]) * 16777619u;
+  }
+  return hash;
+}
+
+typedef struct {
+  double us_mean;
+  double us_max;
+  double reused_pct; // Frames the render skip showed again (static and periodic effects)
+  uint32_t hash;
+} run_result_t;
+
+static int bench_effect(led_effect_t effect, int count, int frames, const char *dump_dir, run_result_t *result) {
+  FILE *dump = NULL;
+  if (dump_dir != NULL) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s_%d.rgb", dump_dir, led_effects_enum_to_id(effect), count);
+    dump = fopen(path, "wb");
+    if (dump == NULL) {
+      perror(path);
+      return 1;
+    }
+  }
+
+  effect_config_t config;
+  led_effects_reset_config();
+  led_effects_get_config(&config);
+  config.effect = effect;
+
+  // Frame buffers and power limit for this length, from the next frame
+  if (!led_effects_set_led_count((uint16_t)count)) {
+    fprintf(stderr, "led_effects_set_led_count(%d) failed\n", count);
+    return 1;
+  }
+  // Every run starts from blank layers and the same generators
+  led_effects_set_random_seed(BENCH_SEED);
+
+  led_output_stats_t stats_before;
+  led_effects_get_output_stats(&stats_before);
+
+  double total_us = 0;
+  result->us_max  = 0;
+  result->hash    = 2166136261u;
+  for (int f = 0; f < frames; f++) {
+    vehicle_state_t state;
+    s_now_ms = (uint32_t)f * LED_EFFECT_FRAME_MS;
+    script_vehicle(s_now_ms, &state);
+    led_effects_update_vehicle_state(&state);
+    led_effects_begin_frame();
+
+    double start = now_us();
+    led_effects_render_layer(&config, LED_LAYER_BASE, CAN_EVENT_NONE, led_effects_get_frame_counter(), s_frame, (uint16_t)count, (uint16_t)count);
+    double elapsed = now_us() - start;
+
+    total_us += elapsed;
+    if (elapsed > result->us_max) {
+      result->us_max = elapsed;
+    }
+    result->hash = fnv1a(result->hash, s_frame, count * sizeof(led_rgb_t));
+    if (dump != NULL) {
+      fwrite(s_frame, sizeof(led_rgb_t), count, dump);
+    }
+  }
+  result->us_mean = total_us / frames;
+
+  led_output_stats_t stats;
+  led_effects_get_output_stats(&stats);
+  result->reused_pct = 100.0 * (stats.layers_reused - stats_before.layers_reused) / frames;
+
+  if (dump != NULL) {
+    fclose(dump);
+  }
+  return 0;
+}
+
+static void usage(const char *name) {
+  fprintf(stderr, "usage: %s [-f frames] [-e effect_id]... [-g golden_file] [-d dump_dir] [leds...]\n", name);
+}
+
+int main(int argc, char **argv) {
+  static const int default_counts[] = {60, 122, 200, 1000};
+  int counts[MAX_COUNTS];
+  int count_total           = 0;
+  int frames                = DEFAULT_FRAMES;
+  const char *golden_path   = NULL;
+  const char *dump_dir      = NULL;
+  bool selected[EFFECT_MAX] = {false};
+  bool filtered             = false;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "f:e:g:d:")) != -1) {
+    switch (opt) {
+    case 'f':
+      frames = atoi(optarg);
+      break;
+    case 'e': {
+      led_effect_t effect = led_effects_id_to_enum(optarg);
+      if (effect == EFFECT_OFF || strcmp(led_effects_enum_to_id(effect), optarg) != 0) {
+        fprintf(stderr, "Unknown effect: %s\n", optarg);
+        return 2;
+      }
+      selected[effect] = true;
+      filtered         = true;
+      break;
+    }
+    case 'g':
+      golden_path = optarg;
+      break;
+    case 'd':
+      dump_dir = optarg;
+      break;
+    default:
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (frames <= 0) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  for (int i = optind; i < argc && count_total < MAX_COUNTS; i++) {
+    int n = atoi(argv[i]);
+    if (n > 0 && n <= MAX_LEDS) {
+      counts[count_total++] = n;
+    }
+  }
+  if (count_total == 0) {
+    memcpy(counts, default_counts, sizeof(default_counts));
+    count_total = sizeof(default_counts) / sizeof(default_counts[0]);
+  }
+
+  FILE *golden = NULL;
+  if (golden_path != NULL) {
+    golden = fopen(golden_path, "w");
+    if (golden == NULL) {
+      perror(golden_path);
+      return 1;
+    }
+    fprintf(golden, "# effects_bench golden frames: effect, leds, FNV-1a of all frames\n");
+    fprintf(golden, "# frames %d\n", frames);
+  }
+
+  if (!led_effects_init()) {
+    fprintf(stderr, "led_effects_init failed\n");
+    return 1;
+  }
+
+  printf("%d frames per effect (%.1f s at %d FPS), seed 0x%08X\n\n", frames, frames * LED_EFFECT_FRAME_MS / 1000.0, 1000 / LED_EFFECT_FRAME_MS, BENCH_SEED);
+  printf("%-20s %5s %9s %9s %7s %10s\n", "effect", "leds", "us/frame", "max us", "reused", "hash");
+
+  for (int c = 0; c < count_total; c++) {
+    double group_us = 0;
+    int group_runs  = 0;
+    for (int e = EFFECT_OFF + 1; e < EFFECT_MAX; e++) {
+      if (filtered && !selected[e]) {
+        continue;
+      }
+      run_result_t result;
+      if (bench_effect((led_effect_t)e, counts[c], frames, dump_dir, &result) != 0) {
+        return 1;
+      }
+      const char *id = led_effects_enum_to_id((led_effect_t)e);
+      printf("%-20s %5d %9.2f %9.2f %6.1f%%   %08X\n", id, counts[c], result.us_mean, result.us_max, result.reused_pct, (unsigned)result.hash);
+      if (golden != NULL) {
+        fprintf(golden, "%s %d %08X\n", id, counts[c], (unsigned)result.hash);
+      }
+      group_us += result.us_mean;
+      group_runs++;
+    }
+    printf("%-20s %5d %9.2f\n\n", "(mean)", counts[c], group_runs > 0 ? group_us / group_runs : 0.0);
+  }
+
+  if (golden != NULL) {
+    fclose(golden);
+  }
+  return 0;
+}
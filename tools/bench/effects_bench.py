@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+"""
+Build and run the host benchmark of the LED effects.
+
+Compiles main/led_effects.c unchanged with tools/bench/effects_bench.c and the
+ESP-IDF stand-ins of tools/bench/idf_stubs using the host C compiler, renders
+every effect for a number of frames at each strip length with a scripted vehicle
+drive cycle and audio feed, and prints the render time per frame.
+
+Each run also gets a hash of all its frames: --golden writes them to a file,
+--check compares against one and fails on any difference. --png writes the
+frames of each run as an image, one row per frame.
+"""
+
+from __future__ import annotations
+
+import argparse
+import os
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+import zlib
+from pathlib import Path
+
+PROJECT_ROOT = Path(__file__).resolve().parents[2]
+STUBS_DIR = PROJECT_ROOT / "tools/bench/idf_stubs"
+SOURCES = [
+    PROJECT_ROOT / "main/led_effects.c",
+    PROJECT_ROOT / "main/fixed_math.c",
+    PROJECT_ROOT / "main/signal_smoother.c",
+    STUBS_DIR / "idf_stubs.c",
+    PROJECT_ROOT / "tools/bench/effects_bench.c",
+]
+
+
+def find_compiler(requested: str | None) -> str:
+    for candidate in (requested, os.environ.get("CC"), "cc", "gcc", "clang"):
+        if candidate and shutil.which(candidate):
+            return candidate
+    print("No C compiler found (set CC or use --cc)", file=sys.stderr)
+    raise SystemExit(1)
+
+
+def read_golden(path: Path) -> tuple[int | None, dict[tuple[str, int], str]]:
+    frames = None
+    hashes = {}
+    for line in path.read_text().splitlines():
+        fields = line.split()
+        if line.startswith("# frames") and len(fields) == 3:
+            frames = int(fields[2])
+        elif fields and not line.startswith("#"):
+            hashes[(fields[0], int(fields[1]))] = fields[2]
+    return frames, hashes
+
+
+def write_png(path: Path, rgb: bytes, width: int) -> None:
+    height = len(rgb) // (width * 3)
+    stride = width * 3
+    # Filter type 0 (none) in front of every row
+    raw = b"".join(b"\x00" + rgb[y * stride:(y + 1) * stride] for y in range(height))
+
+    def chunk(kind: bytes, data: bytes) -> bytes:
+        return struct.pack(">I", len(data)) + kind + data + struct.pack(">I", zlib.crc32(kind + data))
+
+    header = struct.pack(">IIBBBBB", width, height, 8, 2, 0, 0, 0)
+    path.write_bytes(b"\x89PNG\r\n\x1a\n" + chunk(b"IHDR", header) + chunk(b"IDAT", zlib.compress(raw, 9)) + chunk(b"IEND", b""))
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("leds", nargs="*", type=int, help="Strip lengths to test (default: 60 122 200 1000)")
+    parser.add_argument("--frames", type=int, help="Frames per run, 20 ms each (default: 500, or the golden file's with --check)")
+    parser.add_argument("--effect", action="append", default=[], help="Only this effect ID (repeatable, e.g. FIRE)")
+    output = parser.add_mutually_exclusive_group()
+    output.add_argument("--golden", type=Path, help="Write the frame hashes to this file")
+    output.add_argument("--check", type=Path, help="Compare the frame hashes with this file")
+    parser.add_argument("--png", type=Path, help="Write one PNG per effect and strip length to this directory")
+    parser.add_argument("--cc", help="C compiler (default: $CC, cc, gcc or clang)")
+    args = parser.parse_args()
+
+    expected = {}
+    frames = args.frames
+    if args.check:
+        golden_frames, expected = read_golden(args.check)
+        if frames is None:
+            frames = golden_frames
+    if frames is None:
+        frames = 500
+
+    compiler = find_compiler(args.cc)
+    with tempfile.TemporaryDirectory() as tmp:
+        tmp_dir = Path(tmp)
+        binary = tmp_dir / "effects_bench"
+        cmd = [
+            compiler, "-O2", "-std=c11", "-D_POSIX_C_SOURCE=199309L",
+            f"-I{STUBS_DIR}", f"-I{PROJECT_ROOT / 'include'}",
+            *map(str, SOURCES), "-lm", "-o", str(binary),
+        ]
+        build = subprocess.run(cmd)
+        if build.returncode != 0:
+            return build.returncode
+
+        run = [str(binary), "-f", str(frames)]
+        for effect in args.effect:
+            run += ["-e", effect]
+        golden_path = args.golden or (tmp_dir / "golden.txt" if args.check else None)
+        if golden_path:
+            run += ["-g", str(golden_path)]
+        dump_dir = tmp_dir / "frames"
+        if args.png:
+            dump_dir.mkdir()
+            run += ["-d", str(dump_dir)]
+        run += map(str, args.leds)
+
+        result = subprocess.run(run)
+        if result.returncode != 0:
+            return result.returncode
+
+        if args.png:
+            args.png.mkdir(parents=True, exist_ok=True)
+            for frames_file in sorted(dump_dir.glob("*.rgb")):
+                width = int(frames_file.stem.rsplit("_", 1)[1])
+                write_png(args.png / f"{frames_file.stem.lower()}.png", frames_file.read_bytes(), width)
+            print(f"PNG strips written to {args.png}")
+
+        if args.check:
+            _, actual = read_golden(golden_path)
+            changed = [key for key in actual if key in expected and actual[key] != expected[key]]
+            missing = [key for key in actual if key not in expected]
+            for effect, leds in changed:
+                print(f"CHANGED {effect} at {leds} LEDs: {expected[(effect, leds)]} -> {actual[(effect, leds)]}")
+            for effect, leds in missing:
+                print(f"NO GOLDEN {effect} at {leds} LEDs")
+            print(f"{len(actual) - len(changed) - len(missing)}/{len(actual)} runs match {args.check}")
+            if changed:
+                return 1
+        elif args.golden:
+            print(f"Frame hashes written to {args.golden}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,8 @@
+// Host stand-in for the ESP-IDF header of the same name (tools/bench/effects_bench.py)
+#pragma once
+
+#include "esp_err.h"
+
+typedef int gpio_num_t;
+
+#define GPIO_IS_VALID_OUTPUT_GPIO(gpio_num) ((gpio_num) >= 0 && (gpio_num) < 31)
@@ -0,0 +1,6 @@
+// Host stand-in for the ESP-IDF header of the same name (tools/bench/effects_bench.py)
+#pragma once
+
+#include "driver/rmt_types.h"
+
+esp_err_t rmt_del_encoder(rmt_encoder_handle_t encoder);
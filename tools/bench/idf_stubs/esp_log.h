@@ -0,0 +1,9 @@
+// Host stand-in for the ESP-IDF header of the same name (tools/bench/effects_bench.py)
+// Logs are dropped: the bench output is the timing table and the frame hashes.
+#pragma once
+
+#define ESP_LOGE(tag, ...) ((void)(tag))
+#define ESP_LOGW(tag, ...) ((void)(tag))
+#define ESP_LOGI(tag, ...) ((void)(tag))
+#define ESP_LOGD(tag, ...) ((void)(tag))
+#define ESP_LOGV(tag, ...) ((void)(tag))
@@ -0,0 +1,6 @@
+// Host stand-in for the ESP-IDF header of the same name (tools/bench/effects_bench.py)
+#pragma once
+
+#include <stdint.h>
+
+int64_t esp_timer_get_time(void);
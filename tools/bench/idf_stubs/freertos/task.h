@@ -0,0 +1,6 @@
+// Host stand-in for the FreeRTOS header of the same name (tools/bench/effects_bench.py)
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+TickType_t xTaskGetTickCount(void);
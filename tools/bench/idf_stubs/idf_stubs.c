@@ -0,0 +1,121 @@
+/**
+ * @file idf_stubs.c
+ * @brief Host implementations of the ESP-IDF and FreeRTOS calls made by main/led_effects.c
+ *
+ * The RMT driver accepts every frame and completes it at once, the semaphores are
+ * always available and esp_random is a fixed xorshift sequence, so runs repeat exactly.
+ *
+ * Built and run by effects_bench.py.
+ */
+
+#include "driver/rmt_tx.h"
+#include "esp_err.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "led_strip_encoder.h"
+
+#include <time.h>
+
+static uint32_t s_random = 0x2545F491;
+
+static int s_handle;
+
+const char *esp_err_to_name(esp_err_t code) {
+  return code == ESP_OK ? "ESP_OK" : "ESP_FAIL";
+}
+
+uint32_t esp_random(void) {
+  s_random ^= s_random << 13;
+  s_random ^= s_random >> 17;
+  s_random ^= s_random << 5;
+  return s_random;
+}
+
+int64_t esp_timer_get_time(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+TickType_t xTaskGetTickCount(void) {
+  return (TickType_t)(esp_timer_get_time() / 1000);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+  return &s_handle;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks_to_wait) {
+  (void)semaphore;
+  (void)ticks_to_wait;
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+  (void)semaphore;
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t *higher_priority_task_woken) {
+  (void)semaphore;
+  if (higher_priority_task_woken != NULL) {
+    *higher_priority_task_woken = pdFALSE;
+  }
+  return pdTRUE;
+}
+
+esp_err_t rmt_new_tx_channel(const rmt_tx_channel_config_t *config, rmt_channel_handle_t *ret_chan) {
+  (void)config;
+  *ret_chan = (rmt_channel_handle_t)&s_handle;
+  return ESP_OK;
+}
+
+esp_err_t rmt_new_led_strip_encoder(const led_strip_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder) {
+  (void)config;
+  *ret_encoder = (rmt_encoder_handle_t)&s_handle;
+  return ESP_OK;
+}
+
+esp_err_t rmt_tx_register_event_callbacks(rmt_channel_handle_t tx_channel, const rmt_tx_event_callbacks_t *cbs, void *user_data) {
+  (void)tx_channel;
+  (void)cbs;
+  (void)user_data;
+  return ESP_OK;
+}
+
+esp_err_t rmt_transmit(rmt_channel_handle_t tx_channel, rmt_encoder_handle_t encoder, const void *payload, size_t payload_bytes, const rmt_transmit_config_t *config) {
+  (void)tx_channel;
+  (void)encoder;
+  (void)payload;
+  (void)payload_bytes;
+  (void)config;
+  return ESP_OK;
+}
+
+esp_err_t rmt_tx_wait_all_done(rmt_channel_handle_t tx_channel, int timeout_ms) {
+  (void)tx_channel;
+  (void)timeout_ms;
+  return ESP_OK;
+}
+
+esp_err_t rmt_enable(rmt_channel_handle_t channel) {
+  (void)channel;
+  return ESP_OK;
+}
+
+esp_err_t rmt_disable(rmt_channel_handle_t channel) {
+  (void)channel;
+  return ESP_OK;
+}
+
+esp_err_t rmt_del_channel(rmt_channel_handle_t channel) {
+  (void)channel;
+  return ESP_OK;
+}
+
+esp_err_t rmt_del_encoder(rmt_encoder_handle_t encoder) {
+  (void)encoder;
+  return ESP_OK;
+}
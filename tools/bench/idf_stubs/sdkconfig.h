@@ -0,0 +1,4 @@
+// Host stand-in for the generated sdkconfig.h (tools/bench/effects_bench.py)
+#pragma once
+
+#define CONFIG_IDF_TARGET_ESP32C6 1
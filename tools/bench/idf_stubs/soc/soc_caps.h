@@ -0,0 +1,5 @@
+// Host stand-in for the ESP-IDF header of the same name (tools/bench/effects_bench.py)
+#pragma once
+
+#define SOC_RMT_SUPPORT_DMA 0
+#define SOC_RMT_MEM_WORDS_PER_CHANNEL 48
@@ -0,0 +1,145 @@
+/**
+ * @file pixel_codec_bench.c
+ * @brief Host benchmark of the ESP-NOW pixel stream codec (main/pixel_stream_codec.c)
+ *
+ * Streams frames rendered by the firmware's led_effects.c (frame dumps of
+ * effects_bench, one file per effect and strip length, every LED_EFFECT_FRAME_MS)
+ * at the offload rate, cutting every frame into chunks the way espnow_link does:
+ * keyframe once per second, deltas against the previous frame otherwise. Reports
+ * packets and bytes per frame, ratio against raw RGB and encode time per frame,
+ * and checks that every frame decodes back exactly.
+ *
+ * Built and run by pixel_codec_bench.py.
+ */
+
+#include "pixel_stream_codec.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define FRAME_MS 20                 // LED_EFFECT_FRAME_MS, between two dumped frames
+#define OFFLOAD_FRAME_MS 40         // ESPNOW_PIXEL_FRAME_MS
+#define PACKET_HEADER 12            // sizeof(msg_pixels_hdr_t)
+#define KEYFRAME_INTERVAL_FRAMES 25 // ESPNOW_PIXEL_KEYFRAME_INTERVAL_US at OFFLOAD_FRAME_MS
+#define MAX_LEDS 2000
+
+static double now_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+// path: frames of one effect, named <EFFECT_ID>_<leds>.rgb
+static int bench_effect(const char *path) {
+  static uint8_t frame[MAX_LEDS * 3];
+  static uint8_t prev[MAX_LEDS * 3];
+  static uint8_t decoded[MAX_LEDS * 3];
+  uint8_t payload[PIXEL_STREAM_MAX_CHUNK];
+  uint64_t packets                 = 0;
+  uint64_t bytes                   = 0;
+  uint64_t chunks[PIXEL_ENC_COUNT] = {0};
+  double encode_us                 = 0.0;
+  uint32_t frames                  = 0;
+
+  const char *base = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+  const char *sep  = strrchr(base, '_');
+  int count        = sep ? atoi(sep + 1) : 0;
+  if (count <= 0 || count > MAX_LEDS) {
+    fprintf(stderr, "%s: not a <EFFECT_ID>_<leds>.rgb frame dump\n", path);
+    return 1;
+  }
+  char name[64];
+  snprintf(name, sizeof(name), "%.*s", (int)(sep - base), base);
+
+  FILE *dump = fopen(path, "rb");
+  if (dump == NULL) {
+    perror(path);
+    return 1;
+  }
+  memset(decoded, 0, sizeof(decoded));
+
+  // The effect renders every FRAME_MS, the master streams every OFFLOAD_FRAME_MS
+  for (uint32_t f = 0; fread(frame, 3, count, dump) == (size_t)count; f++) {
+    if (f % (OFFLOAD_FRAME_MS / FRAME_MS) != 0) {
+      continue;
+    }
+    bool keyframe = frames % KEYFRAME_INTERVAL_FRAMES == 0;
+
+    double start  = now_us();
+    for (uint16_t first = 0; first < count;) {
+      uint16_t encoded = 0;
+      pixel_stream_encoding_t encoding;
+      int len = pixel_stream_encode_chunk(frame, keyframe ? NULL : prev, first, (uint16_t)count, payload, sizeof(payload), &encoded, &encoding);
+      if (len < 0) {
+        fprintf(stderr, "%s: encode failed at LED %u\n", name, first);
+        fclose(dump);
+        return 1;
+      }
+      encode_us += now_us() - start;
+      if (pixel_stream_decode_chunk(encoding, payload, (size_t)len, decoded, first, encoded) != 0) {
+        fprintf(stderr, "%s: decode failed at LED %u\n", name, first);
+        fclose(dump);
+        return 1;
+      }
+      start = now_us();
+      packets++;
+      bytes += PACKET_HEADER + (size_t)len;
+      chunks[encoding]++;
+      first += encoded;
+    }
+    encode_us += now_us() - start;
+
+    if (memcmp(frame, decoded, count * 3u) != 0) {
+      fprintf(stderr, "%s: frame %u does not round-trip\n", name, frames);
+      fclose(dump);
+      return 1;
+    }
+    memcpy(prev, frame, count * 3u);
+    frames++;
+  }
+  fclose(dump);
+  if (frames == 0) {
+    fprintf(stderr, "%s: no frame\n", path);
+    return 1;
+  }
+
+  static int last_count = 0; // A blank line between strip lengths
+  if (last_count != 0 && count != last_count) {
+    printf("\n");
+  }
+  last_count = count;
+
+  double raw_bytes = (double)frames * (count * 3 + PACKET_HEADER * ((count * 3 + PIXEL_STREAM_MAX_CHUNK - 1) / PIXEL_STREAM_MAX_CHUNK));
+  printf("%-16s %5d %8.2f %9.1f %7.2f %9.2f   %3.0f%% / %3.0f%% / %3.0f%%\n",
+         name,
+         count,
+         (double)packets / frames,
+         (double)bytes / frames,
+         raw_bytes / bytes,
+         encode_us / frames,
+         100.0 * chunks[PIXEL_ENC_RAW] / packets,
+         100.0 * chunks[PIXEL_ENC_PALETTE_RLE] / packets,
+         100.0 * chunks[PIXEL_ENC_DELTA] / packets);
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s frames.rgb... (from effects_bench -d)\n", argv[0]);
+    return 2;
+  }
+
+  printf("%d FPS, keyframe every %d frames, %d-byte chunks\n\n", 1000 / OFFLOAD_FRAME_MS, KEYFRAME_INTERVAL_FRAMES, PIXEL_STREAM_MAX_CHUNK);
+  printf("%-16s %5s %8s %9s %7s %9s   %s\n", "effect", "leds", "pkt/frm", "bytes/frm", "ratio", "enc us", "raw / palette_rle / delta");
+
+  for (int i = 1; i < argc; i++) {
+    if (bench_effect(argv[i]) != 0) {
+      return 1;
+    }
+  }
+  printf("\n");
+  return 0;
+}
@@ -0,0 +1,77 @@
+#!/usr/bin/env python3
+"""
+Build and run the host benchmark of the ESP-NOW pixel stream codec.
+
+Builds effects_bench (main/led_effects.c unchanged, see effects_bench.py) to
+render the effects and dump their frames, then compiles main/pixel_stream_codec.c
+with tools/bench/pixel_codec_bench.c using the host C compiler and streams those
+frames through the codec. Prints, per effect and strip length, the packets and
+bytes sent per frame, the ratio against raw RGB and the encode time per frame.
+"""
+
+from __future__ import annotations
+
+import argparse
+import subprocess
+import sys
+import tempfile
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parent))
+import effects_bench  # noqa: E402
+
+PROJECT_ROOT = effects_bench.PROJECT_ROOT
+SOURCES = [
+    PROJECT_ROOT / "main/pixel_stream_codec.c",
+    PROJECT_ROOT / "tools/bench/pixel_codec_bench.c",
+]
+DEFAULT_EFFECTS = ["SOLID", "BREATHING", "RAINBOW", "THEATER_CHASE", "RUNNING_LIGHTS", "SCAN", "TWINKLE", "FIRE"]
+DEFAULT_LEDS = [60, 122, 200]
+RENDER_FRAME_MS = 20  # LED_EFFECT_FRAME_MS
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("leds", nargs="*", type=int, help="Strip lengths to test (default: 60 122 200)")
+    parser.add_argument("--seconds", type=int, default=60, help="Streamed time per run (default: 60)")
+    parser.add_argument("--effect", action="append", default=[], help="Only this effect ID (repeatable, default: " + " ".join(DEFAULT_EFFECTS) + ")")
+    parser.add_argument("--cc", help="C compiler (default: $CC, cc, gcc or clang)")
+    args = parser.parse_args()
+
+    leds = args.leds or DEFAULT_LEDS
+    effects = args.effect or DEFAULT_EFFECTS
+    compiler = effects_bench.find_compiler(args.cc)
+    with tempfile.TemporaryDirectory() as tmp:
+        tmp_dir = Path(tmp)
+        renderer = tmp_dir / "effects_bench"
+        binary = tmp_dir / "pixel_codec_bench"
+        builds = [
+            [
+                compiler, "-O2", "-std=c11", "-D_POSIX_C_SOURCE=199309L",
+                f"-I{effects_bench.STUBS_DIR}", f"-I{PROJECT_ROOT / 'include'}",
+                *map(str, effects_bench.SOURCES), "-lm", "-o", str(renderer),
+            ],
+            [compiler, "-O2", "-std=c11", "-D_POSIX_C_SOURCE=199309L", f"-I{PROJECT_ROOT / 'include'}", *map(str, SOURCES), "-lm", "-o", str(binary)],
+        ]
+        for cmd in builds:
+            build = subprocess.run(cmd)
+            if build.returncode != 0:
+                return build.returncode
+
+        # Frames of the firmware's effects, one file per effect and strip length
+        dump_dir = tmp_dir / "frames"
+        dump_dir.mkdir()
+        render = [str(renderer), "-f", str(args.seconds * 1000 // RENDER_FRAME_MS), "-d", str(dump_dir)]
+        for effect in effects:
+            render += ["-e", effect]
+        render += map(str, leds)
+        result = subprocess.run(render, stdout=subprocess.DEVNULL)
+        if result.returncode != 0:
+            return result.returncode
+
+        dumps = [str(dump_dir / f"{effect}_{count}.rgb") for count in leds for effect in effects]
+        return subprocess.run([str(binary), *dumps]).returncode
+
+
+if __name__ == "__main__":
+    sys.exit(main())